@@ -0,0 +1,118 @@
+#ifndef IMAGE_REASSEMBLER_H
+#define IMAGE_REASSEMBLER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Fragment wire format constants
+#define IMAGE_FRAGMENT_MAGIC            0x4653  // "SF", little-endian on the wire
+#define IMAGE_FRAGMENT_HEADER_SIZE      16
+#define IMAGE_FRAGMENT_DEFAULT_PAYLOAD  1400    // Fits a 1500-byte MTU with IP, UDP and this header
+#define IMAGE_REASSEMBLER_MAX_FRAGMENTS 256     // 350 KB at the default payload
+#define IMAGE_REASSEMBLER_REORDER_WINDOW 16     // Frames a late fragment may lag behind
+#define IMAGE_REASSEMBLER_RESYNC_STALE  32      // Stale fragments in a row that restart the ids
+
+// Fragment header, all fields little-endian:
+//   0 magic, 2 frame_id, 4 frame_size, 8 index, 10 count, 12 payload_size, 14 reserved
+// Fragment i carries bytes [i * payload_size, i * payload_size + len) of the frame.
+typedef struct {
+    uint16_t frame_id;          // Increments per frame, wraps
+    uint32_t frame_size;        // Size of the whole compressed image
+    uint16_t index;
+    uint16_t count;             // Fragments in this frame
+    uint16_t payload_size;      // Payload of every fragment but the last
+} image_fragment_header_t;
+
+// What to do with a fragment
+typedef enum {
+    IMAGE_FRAGMENT_ACCEPT = 0,  // Copy the payload to the returned offset
+    IMAGE_FRAGMENT_COMPLETE,    // Copy the payload, then the frame is whole
+    IMAGE_FRAGMENT_DUPLICATE,   // Already have it
+    IMAGE_FRAGMENT_STALE,       // Belongs to a frame given up on
+    IMAGE_FRAGMENT_INVALID      // Inconsistent header or does not fit the buffer
+} image_fragment_result_t;
+
+// Reassembly statistics
+typedef struct {
+    uint32_t fragments;         // Accepted fragments
+    uint32_t duplicates;
+    uint32_t stale;
+    uint32_t invalid;
+    uint32_t frames_completed;
+    uint32_t frames_incomplete; // Replaced by a newer frame before they were whole
+    uint32_t resyncs;           // Frame ids started over, e.g. after a sender restart
+} image_reassembler_stats_t;
+
+// Reassembly of one frame at a time into a caller-owned buffer
+typedef struct {
+    size_t capacity;
+    bool active;                // A frame is in progress
+    bool have_last;             // A frame has been started since reset
+    uint16_t frame_id;
+    uint32_t frame_size;
+    uint16_t count;
+    uint16_t payload_size;
+    uint16_t received;
+    uint16_t stale_run;         // Stale fragments since the last accepted one
+    uint32_t bitmap[IMAGE_REASSEMBLER_MAX_FRAGMENTS / 32];
+    image_reassembler_stats_t stats;
+} image_reassembler_t;
+
+// Function prototypes
+
+/**
+ * @brief Reset the reassembler
+ *
+ * @param r Reassembler
+ * @param capacity Size of the frame buffer the payloads are copied into
+ */
+void image_reassembler_reset(image_reassembler_t *r, size_t capacity);
+
+/**
+ * @brief Decode a fragment header
+ *
+ * @param data Start of the datagram
+ * @param len Bytes available at data
+ * @param header Pointer to store the header
+ * @return true if the header is complete and carries the magic
+ */
+bool image_fragment_parse(const uint8_t *data, size_t len, image_fragment_header_t *header);
+
+/**
+ * @brief Encode a fragment header
+ *
+ * @param header Header to encode
+ * @param data Buffer of at least IMAGE_FRAGMENT_HEADER_SIZE bytes
+ */
+void image_fragment_write(const image_fragment_header_t *header, uint8_t *data);
+
+/**
+ * @brief Account for a fragment and find where its payload goes
+ *
+ * A fragment of a newer frame abandons the frame in progress. Fragments of
+ * an older frame are stale, unless the frame is more than
+ * IMAGE_REASSEMBLER_REORDER_WINDOW frames back or IMAGE_REASSEMBLER_RESYNC_STALE
+ * of them arrive in a row: then the sender has restarted its frame ids and
+ * the fragment starts a new frame. The caller
+ * copies the payload into its frame buffer at *offset for ACCEPT and
+ * COMPLETE, and hands the buffer on after COMPLETE.
+ *
+ * @param r Reassembler
+ * @param header Decoded header
+ * @param payload_len Payload bytes after the header
+ * @param offset Pointer to store the payload offset in the frame
+ * @return image_fragment_result_t What to do with the payload
+ */
+image_fragment_result_t image_reassembler_add(image_reassembler_t *r, const image_fragment_header_t *header,
+                                              size_t payload_len, uint32_t *offset);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IMAGE_REASSEMBLER_H
@@ -0,0 +1,96 @@
+#ifndef IMAGE_STREAM_H
+#define IMAGE_STREAM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "image_reassembler.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Image stream configuration constants
+#define IMAGE_STREAM_DEFAULT_PORT       5005
+#define IMAGE_STREAM_TASK_NAME          "image_stream"
+#define IMAGE_STREAM_DEFAULT_CORE       0
+#define IMAGE_STREAM_DEFAULT_PRIO       6       // Above the decoder, so fragments do not pile up in lwIP
+#define IMAGE_STREAM_DEFAULT_STACK_SIZE 4096
+#define IMAGE_STREAM_RECV_TIMEOUT_MS    100     // How often the task checks for stop
+
+// Image stream configuration
+typedef struct {
+    uint16_t port;                      // UDP port, 0 for IMAGE_STREAM_DEFAULT_PORT
+    uint16_t fragment_payload;          // Expected payload per fragment, 0 for IMAGE_FRAGMENT_DEFAULT_PAYLOAD
+} image_stream_config_t;
+
+// Image stream statistics
+typedef struct {
+    uint32_t datagrams;
+    uint32_t chained;                   // Datagrams spread over several pbufs (IP fragmented)
+    uint32_t rejected;                  // Too short or without the fragment magic
+    uint64_t payload_bytes;             // Copied into frame slots
+    uint32_t frames_committed;          // Handed to the render scheduler
+    uint32_t cycles_per_mb;             // CPU cycles from pbuf to frame slot per MB of payload
+    uint32_t max_datagram_cycles;
+    uint16_t fragments_per_frame;       // At max_image_size and the expected payload
+    uint16_t recvmbox_size;             // Datagrams lwIP queues for the socket
+    image_reassembler_stats_t reassembly;
+} image_stream_stats_t;
+
+// Function prototypes
+
+/**
+ * @brief Initialize the image stream receiver
+ *
+ * render_scheduler must be initialized first; fragments are written
+ * straight into its image slots.
+ *
+ * @param config Image stream configuration
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t image_stream_init(const image_stream_config_t *config);
+
+/**
+ * @brief Deinitialize the image stream receiver
+ *
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t image_stream_deinit(void);
+
+/**
+ * @brief Bind the UDP port and start the receive task
+ *
+ * The task is placed through the task topology table under
+ * IMAGE_STREAM_TASK_NAME. Binding does not need an IP address yet.
+ *
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t image_stream_start(void);
+
+/**
+ * @brief Stop the receive task and close the port
+ *
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t image_stream_stop(void);
+
+/**
+ * @brief Get image stream statistics
+ *
+ * @param stats Pointer to store statistics
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t image_stream_get_stats(image_stream_stats_t *stats);
+
+/**
+ * @brief Reset image stream statistics
+ */
+void image_stream_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IMAGE_STREAM_H
@@ -0,0 +1,131 @@
+#include "image_reassembler.h"
+#include <string.h>
+
+static uint16_t get_le16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_le32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void put_le16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_le32(uint8_t *p, uint32_t v)
+{
+    put_le16(p, (uint16_t)v);
+    put_le16(p + 2, (uint16_t)(v >> 16));
+}
+
+void image_reassembler_reset(image_reassembler_t *r, size_t capacity)
+{
+    memset(r, 0, sizeof(*r));
+    r->capacity = capacity;
+}
+
+bool image_fragment_parse(const uint8_t *data, size_t len, image_fragment_header_t *header)
+{
+    if (len < IMAGE_FRAGMENT_HEADER_SIZE || get_le16(data) != IMAGE_FRAGMENT_MAGIC) {
+        return false;
+    }
+    header->frame_id = get_le16(data + 2);
+    header->frame_size = get_le32(data + 4);
+    header->index = get_le16(data + 8);
+    header->count = get_le16(data + 10);
+    header->payload_size = get_le16(data + 12);
+    return true;
+}
+
+void image_fragment_write(const image_fragment_header_t *header, uint8_t *data)
+{
+    put_le16(data, IMAGE_FRAGMENT_MAGIC);
+    put_le16(data + 2, header->frame_id);
+    put_le32(data + 4, header->frame_size);
+    put_le16(data + 8, header->index);
+    put_le16(data + 10, header->count);
+    put_le16(data + 12, header->payload_size);
+    put_le16(data + 14, 0);
+}
+
+// The header must describe a frame that fits, split the way it claims
+static bool header_valid(const image_reassembler_t *r, const image_fragment_header_t *header, size_t payload_len)
+{
+    if (header->count == 0 || header->count > IMAGE_REASSEMBLER_MAX_FRAGMENTS ||
+        header->index >= header->count || header->payload_size == 0 ||
+        header->frame_size == 0 || header->frame_size > r->capacity) {
+        return false;
+    }
+    uint32_t expected_count = (header->frame_size + header->payload_size - 1) / header->payload_size;
+    if (expected_count != header->count) {
+        return false;
+    }
+    uint32_t offset = (uint32_t)header->index * header->payload_size;
+    uint32_t expected_len = header->index == header->count - 1 ? header->frame_size - offset : header->payload_size;
+    return payload_len == expected_len;
+}
+
+image_fragment_result_t image_reassembler_add(image_reassembler_t *r, const image_fragment_header_t *header,
+                                              size_t payload_len, uint32_t *offset)
+{
+    if (!header_valid(r, header, payload_len)) {
+        r->stats.invalid++;
+        return IMAGE_FRAGMENT_INVALID;
+    }
+
+    if (!r->have_last || header->frame_id != r->frame_id) {
+        // Serial number order, so the id may wrap
+        int16_t age = (int16_t)(r->frame_id - header->frame_id);
+        if (r->have_last && age > 0) {
+            // Late fragments of a recent frame are dropped; a frame further
+            // back, or a run of stale ones, means the sender started over
+            if (age <= IMAGE_REASSEMBLER_REORDER_WINDOW && ++r->stale_run < IMAGE_REASSEMBLER_RESYNC_STALE) {
+                r->stats.stale++;
+                return IMAGE_FRAGMENT_STALE;
+            }
+            r->stats.resyncs++;
+        }
+        if (r->active) {
+            r->stats.frames_incomplete++;
+        }
+        r->have_last = true;
+        r->active = true;
+        r->frame_id = header->frame_id;
+        r->frame_size = header->frame_size;
+        r->count = header->count;
+        r->payload_size = header->payload_size;
+        r->received = 0;
+        memset(r->bitmap, 0, sizeof(r->bitmap));
+    } else if (!r->active) {
+        // Late copy of a fragment of the frame already handed on
+        r->stats.duplicates++;
+        return IMAGE_FRAGMENT_DUPLICATE;
+    } else if (header->frame_size != r->frame_size || header->payload_size != r->payload_size) {
+        r->stats.invalid++;
+        return IMAGE_FRAGMENT_INVALID;
+    }
+
+    uint32_t word = header->index / 32;
+    uint32_t bit = 1u << (header->index % 32);
+    if (r->bitmap[word] & bit) {
+        r->stats.duplicates++;
+        return IMAGE_FRAGMENT_DUPLICATE;
+    }
+    r->bitmap[word] |= bit;
+    r->received++;
+    r->stale_run = 0;
+    r->stats.fragments++;
+    *offset = (uint32_t)header->index * header->payload_size;
+
+    if (r->received == r->count) {
+        r->active = false;
+        r->stats.frames_completed++;
+        return IMAGE_FRAGMENT_COMPLETE;
+    }
+    return IMAGE_FRAGMENT_ACCEPT;
+}
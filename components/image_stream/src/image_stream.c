@@ -0,0 +1,300 @@
+#include "image_stream.h"
+#include "render_scheduler.h"
+#include "task_topology.h"
+#include "esp_log.h"
+#include "esp_cpu.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/event_groups.h"
+#include "lwip/api.h"
+#include "lwip/pbuf.h"
+#include <string.h>
+
+static const char *TAG = "IMAGE_STREAM";
+
+// Task exit bit
+#define RECEIVE_EXITED_BIT      BIT0
+
+// Placement used when the firmware task table has no entry
+static const task_topology_entry_t receive_task_defaults = {
+    .name = IMAGE_STREAM_TASK_NAME,
+    .core = IMAGE_STREAM_DEFAULT_CORE,
+    .priority = IMAGE_STREAM_DEFAULT_PRIO,
+    .stack_size = IMAGE_STREAM_DEFAULT_STACK_SIZE,
+    .stack = TASK_STACK_INTERNAL,
+};
+
+// Global state
+static bool image_stream_initialized = false;
+static volatile bool image_stream_running = false;
+static image_stream_config_t current_config = {0};
+static image_stream_stats_t current_stats = {0};
+static uint64_t total_cycles = 0;
+static bool reassembly_reset = false;   // The receive task owns the reassembler counters
+static portMUX_TYPE stream_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Receive task state
+static struct netconn *conn = NULL;
+static TaskHandle_t receive_task_handle = NULL;
+static EventGroupHandle_t task_events = NULL;
+static image_reassembler_t reassembler;
+static uint8_t *fill_buffer = NULL;     // Render scheduler slot the current frame is written into
+
+// Forward declarations
+static void receive_task(void *pvParameters);
+
+esp_err_t image_stream_init(const image_stream_config_t *config)
+{
+    if (image_stream_initialized) {
+        ESP_LOGW(TAG, "Image stream already initialized");
+        return ESP_OK;
+    }
+
+    if (!config) {
+        ESP_LOGE(TAG, "Configuration cannot be NULL");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memcpy(&current_config, config, sizeof(image_stream_config_t));
+    if (current_config.port == 0) {
+        current_config.port = IMAGE_STREAM_DEFAULT_PORT;
+    }
+    if (current_config.fragment_payload == 0) {
+        current_config.fragment_payload = IMAGE_FRAGMENT_DEFAULT_PAYLOAD;
+    }
+
+    size_t capacity;
+    esp_err_t ret = render_scheduler_acquire_image(&fill_buffer, &capacity);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Render scheduler must be initialized first");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // lwIP queues datagrams per socket in its recvmbox; a frame that arrives
+    // in one burst needs room for all its fragments or the tail is dropped
+    uint32_t fragments = (capacity + current_config.fragment_payload - 1) / current_config.fragment_payload;
+    if (fragments > IMAGE_REASSEMBLER_MAX_FRAGMENTS) {
+        ESP_LOGE(TAG, "%zu byte images need %lu fragments, more than %d",
+                 capacity, fragments, IMAGE_REASSEMBLER_MAX_FRAGMENTS);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (fragments > CONFIG_LWIP_UDP_RECVMBOX_SIZE) {
+        ESP_LOGW(TAG, "A full frame is %lu fragments, lwIP queues %d: keep the sender paced",
+                 fragments, CONFIG_LWIP_UDP_RECVMBOX_SIZE);
+    }
+
+    task_events = xEventGroupCreate();
+    if (!task_events) {
+        ESP_LOGE(TAG, "Failed to create event group");
+        return ESP_ERR_NO_MEM;
+    }
+
+    image_reassembler_reset(&reassembler, capacity);
+    memset(&current_stats, 0, sizeof(image_stream_stats_t));
+    total_cycles = 0;
+    current_stats.fragments_per_frame = fragments;
+    current_stats.recvmbox_size = CONFIG_LWIP_UDP_RECVMBOX_SIZE;
+
+    image_stream_initialized = true;
+    ESP_LOGI(TAG, "Image stream initialized: port %u, %zu byte slots, %lu fragments per frame",
+             current_config.port, capacity, fragments);
+    return ESP_OK;
+}
+
+esp_err_t image_stream_deinit(void)
+{
+    if (!image_stream_initialized) {
+        return ESP_OK;
+    }
+
+    image_stream_stop();
+
+    vEventGroupDelete(task_events);
+    task_events = NULL;
+    fill_buffer = NULL;
+    image_stream_initialized = false;
+
+    ESP_LOGI(TAG, "Image stream deinitialized");
+    return ESP_OK;
+}
+
+esp_err_t image_stream_start(void)
+{
+    if (!image_stream_initialized) {
+        ESP_LOGE(TAG, "Image stream not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (image_stream_running) {
+        ESP_LOGW(TAG, "Image stream already started");
+        return ESP_OK;
+    }
+
+    // netconn rather than a socket: datagrams arrive as the driver's pbufs, without a copy
+    conn = netconn_new(NETCONN_UDP);
+    if (!conn) {
+        ESP_LOGE(TAG, "Failed to create UDP connection");
+        return ESP_ERR_NO_MEM;
+    }
+    err_t err = netconn_bind(conn, IP_ADDR_ANY, current_config.port);
+    if (err != ERR_OK) {
+        ESP_LOGE(TAG, "Failed to bind UDP port %u: %d", current_config.port, err);
+        netconn_delete(conn);
+        conn = NULL;
+        return ESP_FAIL;
+    }
+    netconn_set_recvtimeout(conn, IMAGE_STREAM_RECV_TIMEOUT_MS);
+
+    xEventGroupClearBits(task_events, RECEIVE_EXITED_BIT);
+    image_stream_running = true;
+
+    esp_err_t ret = task_topology_create_default(&receive_task_defaults, receive_task, NULL, &receive_task_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create receive task: %s", esp_err_to_name(ret));
+        image_stream_running = false;
+        receive_task_handle = NULL;
+        netconn_delete(conn);
+        conn = NULL;
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "Image stream listening on UDP port %u", current_config.port);
+    return ESP_OK;
+}
+
+esp_err_t image_stream_stop(void)
+{
+    if (!image_stream_running) {
+        return ESP_OK;
+    }
+
+    ESP_LOGI(TAG, "Stopping image stream");
+
+    // The task notices within one receive timeout
+    image_stream_running = false;
+    xEventGroupWaitBits(task_events, RECEIVE_EXITED_BIT, pdTRUE, pdTRUE, portMAX_DELAY);
+    receive_task_handle = NULL;
+
+    netconn_delete(conn);
+    conn = NULL;
+
+    ESP_LOGI(TAG, "Image stream stopped");
+    return ESP_OK;
+}
+
+esp_err_t image_stream_get_stats(image_stream_stats_t *stats)
+{
+    if (!stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&stream_lock);
+    memcpy(stats, &current_stats, sizeof(image_stream_stats_t));
+    if (current_stats.payload_bytes) {
+        stats->cycles_per_mb = (uint32_t)((total_cycles << 20) / current_stats.payload_bytes);
+    }
+    portEXIT_CRITICAL(&stream_lock);
+
+    return ESP_OK;
+}
+
+void image_stream_reset_stats(void)
+{
+    portENTER_CRITICAL(&stream_lock);
+    uint16_t fragments = current_stats.fragments_per_frame;
+    uint16_t mbox = current_stats.recvmbox_size;
+    memset(&current_stats, 0, sizeof(image_stream_stats_t));
+    current_stats.fragments_per_frame = fragments;
+    current_stats.recvmbox_size = mbox;
+    total_cycles = 0;
+    reassembly_reset = true;
+    portEXIT_CRITICAL(&stream_lock);
+}
+
+// Copy one datagram's payload into the frame slot; returns the bytes copied
+static size_t receive_datagram(struct pbuf *p, bool *rejected, bool *committed)
+{
+    // The header is normally in the first pbuf; copy it out only if it is split
+    uint8_t raw[IMAGE_FRAGMENT_HEADER_SIZE];
+    const uint8_t *header_data = p->payload;
+    if (p->len < IMAGE_FRAGMENT_HEADER_SIZE) {
+        if (pbuf_copy_partial(p, raw, IMAGE_FRAGMENT_HEADER_SIZE, 0) != IMAGE_FRAGMENT_HEADER_SIZE) {
+            *rejected = true;
+            return 0;
+        }
+        header_data = raw;
+    }
+
+    image_fragment_header_t header;
+    if (!image_fragment_parse(header_data, p->tot_len, &header)) {
+        *rejected = true;
+        return 0;
+    }
+
+    uint32_t offset;
+    size_t payload_len = p->tot_len - IMAGE_FRAGMENT_HEADER_SIZE;
+    image_fragment_result_t result = image_reassembler_add(&reassembler, &header, payload_len, &offset);
+    if (result != IMAGE_FRAGMENT_ACCEPT && result != IMAGE_FRAGMENT_COMPLETE) {
+        return 0;
+    }
+
+    // The only copy: driver buffer straight into the PSRAM slot, across the pbuf chain
+    pbuf_copy_partial(p, fill_buffer + offset, payload_len, IMAGE_FRAGMENT_HEADER_SIZE);
+
+    if (result == IMAGE_FRAGMENT_COMPLETE) {
+        size_t capacity;
+        if (render_scheduler_commit_image(header.frame_size) == ESP_OK) {
+            *committed = true;
+        }
+        render_scheduler_acquire_image(&fill_buffer, &capacity);
+    }
+    return payload_len;
+}
+
+static void receive_task(void *pvParameters)
+{
+    ESP_LOGI(TAG, "Receive task started on core %d", xPortGetCoreID());
+
+    while (image_stream_running) {
+        struct netbuf *buf;
+        err_t err = netconn_recv(conn, &buf);
+        if (err == ERR_TIMEOUT) {
+            continue;
+        }
+        if (err != ERR_OK) {
+            ESP_LOGW(TAG, "Receive failed: %d", err);
+            vTaskDelay(pdMS_TO_TICKS(IMAGE_STREAM_RECV_TIMEOUT_MS));
+            continue;
+        }
+
+        // Cycles from the queued pbuf to the pbuf released, including reassembly
+        uint32_t start = esp_cpu_get_cycle_count();
+        bool chained = buf->p->next != NULL;
+        bool rejected = false;
+        bool committed = false;
+        size_t copied = receive_datagram(buf->p, &rejected, &committed);
+        netbuf_delete(buf);
+        uint32_t cycles = esp_cpu_get_cycle_count() - start;
+
+        portENTER_CRITICAL(&stream_lock);
+        current_stats.datagrams++;
+        current_stats.chained += chained;
+        current_stats.rejected += rejected;
+        current_stats.frames_committed += committed;
+        current_stats.payload_bytes += copied;
+        if (reassembly_reset) {
+            memset(&reassembler.stats, 0, sizeof(reassembler.stats));
+            reassembly_reset = false;
+        }
+        current_stats.reassembly = reassembler.stats;
+        total_cycles += cycles;
+        if (cycles > current_stats.max_datagram_cycles) {
+            current_stats.max_datagram_cycles = cycles;
+        }
+        portEXIT_CRITICAL(&stream_lock);
+    }
+
+    ESP_LOGI(TAG, "Receive task stopped");
+    xEventGroupSetBits(task_events, RECEIVE_EXITED_BIT);
+    vTaskDelete(NULL);
+}
@@ -0,0 +1,164 @@
+#include "unity.h"
+#include "image_reassembler.h"
+#include <string.h>
+
+#define TEST_CAPACITY   4096
+#define TEST_PAYLOAD    1000
+
+static image_reassembler_t r;
+
+static image_fragment_header_t make_header(uint16_t frame_id, uint32_t frame_size, uint16_t index)
+{
+    image_fragment_header_t header = {
+        .frame_id = frame_id,
+        .frame_size = frame_size,
+        .index = index,
+        .count = (frame_size + TEST_PAYLOAD - 1) / TEST_PAYLOAD,
+        .payload_size = TEST_PAYLOAD
+    };
+    return header;
+}
+
+static size_t payload_len(const image_fragment_header_t *header)
+{
+    return header->index == header->count - 1 ? header->frame_size - header->index * TEST_PAYLOAD : TEST_PAYLOAD;
+}
+
+static image_fragment_result_t add(uint16_t frame_id, uint32_t frame_size, uint16_t index, uint32_t *offset)
+{
+    image_fragment_header_t header = make_header(frame_id, frame_size, index);
+    return image_reassembler_add(&r, &header, payload_len(&header), offset);
+}
+
+void setUp(void) {
+    image_reassembler_reset(&r, TEST_CAPACITY);
+}
+
+void tearDown(void) {
+}
+
+void test_header_round_trip() {
+    image_fragment_header_t header = make_header(0xBEEF, 2500, 2);
+    uint8_t data[IMAGE_FRAGMENT_HEADER_SIZE];
+    image_fragment_write(&header, data);
+
+    // Little-endian on the wire
+    TEST_ASSERT_EQUAL_UINT8(0x53, data[0]);
+    TEST_ASSERT_EQUAL_UINT8(0x46, data[1]);
+    TEST_ASSERT_EQUAL_UINT8(0xEF, data[2]);
+
+    image_fragment_header_t parsed;
+    TEST_ASSERT_TRUE(image_fragment_parse(data, sizeof(data), &parsed));
+    TEST_ASSERT_EQUAL_UINT16(0xBEEF, parsed.frame_id);
+    TEST_ASSERT_EQUAL_UINT32(2500, parsed.frame_size);
+    TEST_ASSERT_EQUAL_UINT16(2, parsed.index);
+    TEST_ASSERT_EQUAL_UINT16(3, parsed.count);
+    TEST_ASSERT_EQUAL_UINT16(TEST_PAYLOAD, parsed.payload_size);
+
+    TEST_ASSERT_FALSE(image_fragment_parse(data, IMAGE_FRAGMENT_HEADER_SIZE - 1, &parsed));
+    data[0] = 0;
+    TEST_ASSERT_FALSE(image_fragment_parse(data, sizeof(data), &parsed));
+}
+
+void test_out_of_order_fragments_complete_frame() {
+    uint32_t offset;
+    TEST_ASSERT_EQUAL(IMAGE_FRAGMENT_ACCEPT, add(1, 2500, 2, &offset));
+    TEST_ASSERT_EQUAL_UINT32(2000, offset);
+    TEST_ASSERT_EQUAL(IMAGE_FRAGMENT_ACCEPT, add(1, 2500, 0, &offset));
+    TEST_ASSERT_EQUAL_UINT32(0, offset);
+    TEST_ASSERT_EQUAL(IMAGE_FRAGMENT_DUPLICATE, add(1, 2500, 0, &offset));
+    TEST_ASSERT_EQUAL(IMAGE_FRAGMENT_COMPLETE, add(1, 2500, 1, &offset));
+    TEST_ASSERT_EQUAL_UINT32(1000, offset);
+
+    // A late copy after the frame was handed on
+    TEST_ASSERT_EQUAL(IMAGE_FRAGMENT_DUPLICATE, add(1, 2500, 1, &offset));
+
+    TEST_ASSERT_EQUAL_UINT32(3, r.stats.fragments);
+    TEST_ASSERT_EQUAL_UINT32(2, r.stats.duplicates);
+    TEST_ASSERT_EQUAL_UINT32(1, r.stats.frames_completed);
+}
+
+void test_newer_frame_abandons_current() {
+    uint32_t offset;
+    TEST_ASSERT_EQUAL(IMAGE_FRAGMENT_ACCEPT, add(7, 2500, 0, &offset));
+    TEST_ASSERT_EQUAL(IMAGE_FRAGMENT_ACCEPT, add(8, 1500, 0, &offset));
+    TEST_ASSERT_EQUAL_UINT32(1, r.stats.frames_incomplete);
+
+    // The rest of frame 7 is no longer wanted
+    TEST_ASSERT_EQUAL(IMAGE_FRAGMENT_STALE, add(7, 2500, 1, &offset));
+    TEST_ASSERT_EQUAL(IMAGE_FRAGMENT_COMPLETE, add(8, 1500, 1, &offset));
+    TEST_ASSERT_EQUAL_UINT32(1, r.stats.stale);
+}
+
+void test_frame_id_wraps() {
+    uint32_t offset;
+    TEST_ASSERT_EQUAL(IMAGE_FRAGMENT_COMPLETE, add(0xFFFF, 500, 0, &offset));
+    TEST_ASSERT_EQUAL(IMAGE_FRAGMENT_COMPLETE, add(0, 500, 0, &offset));
+    TEST_ASSERT_EQUAL(IMAGE_FRAGMENT_STALE, add(0xFFFE, 500, 0, &offset));
+}
+
+void test_follows_sender_restart() {
+    uint32_t offset;
+
+    // Ids far behind the last frame start over at once
+    TEST_ASSERT_EQUAL(IMAGE_FRAGMENT_COMPLETE, add(1000, 500, 0, &offset));
+    TEST_ASSERT_EQUAL(IMAGE_FRAGMENT_ACCEPT, add(0, 1500, 0, &offset));
+    TEST_ASSERT_EQUAL(IMAGE_FRAGMENT_COMPLETE, add(0, 1500, 1, &offset));
+    TEST_ASSERT_EQUAL(IMAGE_FRAGMENT_COMPLETE, add(1, 500, 0, &offset));
+    TEST_ASSERT_EQUAL_UINT32(1, r.stats.resyncs);
+
+    // Ids just behind are stale until enough fragments of them arrive in a row
+    TEST_ASSERT_EQUAL(IMAGE_FRAGMENT_COMPLETE, add(100, 500, 0, &offset));
+    uint32_t sent = 0;
+    for (; sent < IMAGE_REASSEMBLER_RESYNC_STALE - 1; sent++) {
+        TEST_ASSERT_EQUAL(IMAGE_FRAGMENT_STALE, add(90 + sent / 4, 4000, sent % 4, &offset));
+    }
+    TEST_ASSERT_EQUAL(IMAGE_FRAGMENT_ACCEPT, add(90 + sent / 4, 4000, sent % 4, &offset));
+    for (uint16_t index = 0; index < 3; index++) {
+        TEST_ASSERT_EQUAL(IMAGE_FRAGMENT_ACCEPT, add(98, 4000, index, &offset));
+    }
+    TEST_ASSERT_EQUAL(IMAGE_FRAGMENT_COMPLETE, add(98, 4000, 3, &offset));
+    TEST_ASSERT_EQUAL_UINT32(IMAGE_REASSEMBLER_RESYNC_STALE - 1, r.stats.stale);
+    TEST_ASSERT_EQUAL_UINT32(2, r.stats.resyncs);
+}
+
+void test_rejects_inconsistent_headers() {
+    uint32_t offset;
+
+    // Larger than the frame buffer
+    TEST_ASSERT_EQUAL(IMAGE_FRAGMENT_INVALID, add(1, TEST_CAPACITY + 1, 0, &offset));
+
+    // Payload length does not match the split
+    image_fragment_header_t header = make_header(1, 2500, 0);
+    TEST_ASSERT_EQUAL(IMAGE_FRAGMENT_INVALID, image_reassembler_add(&r, &header, 999, &offset));
+
+    // Fragment count does not match the size
+    header.count = 2;
+    TEST_ASSERT_EQUAL(IMAGE_FRAGMENT_INVALID, image_reassembler_add(&r, &header, TEST_PAYLOAD, &offset));
+
+    // Index beyond the count
+    header = make_header(1, 2500, 3);
+    TEST_ASSERT_EQUAL(IMAGE_FRAGMENT_INVALID, image_reassembler_add(&r, &header, 500, &offset));
+
+    // A different split within the frame in progress
+    TEST_ASSERT_EQUAL(IMAGE_FRAGMENT_ACCEPT, add(2, 2500, 0, &offset));
+    header = make_header(2, 3000, 1);
+    TEST_ASSERT_EQUAL(IMAGE_FRAGMENT_INVALID, image_reassembler_add(&r, &header, TEST_PAYLOAD, &offset));
+
+    TEST_ASSERT_EQUAL_UINT32(5, r.stats.invalid);
+    TEST_ASSERT_EQUAL_UINT32(1, r.stats.fragments);
+}
+
+// Unity テストランナー関数
+void app_main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_header_round_trip);
+    RUN_TEST(test_out_of_order_fragments_complete_frame);
+    RUN_TEST(test_newer_frame_abandons_current);
+    RUN_TEST(test_frame_id_wraps);
+    RUN_TEST(test_follows_sender_restart);
+    RUN_TEST(test_rejects_inconsistent_headers);
+
+    UNITY_END();
+}
@@ -0,0 +1,120 @@
+#ifndef LED_COLOR_H
+#define LED_COLOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "led_output.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Color pipeline defaults
+#define LED_COLOR_DEFAULT_GAMMA             2.6f
+#define LED_COLOR_DEFAULT_BRIGHTNESS        255
+#define LED_COLOR_DEFAULT_MA_PER_CHANNEL    20.0f   // WS2812B at full drive
+#define LED_COLOR_DEFAULT_IDLE_MA_PER_LED   1.0f    // Quiescent draw with all channels off
+#define LED_COLOR_LUT_SIZE                  256
+
+// Color pipeline configuration
+typedef struct {
+    float gamma;                // Exponent of the 8-bit to linear gamma curve
+    uint8_t brightness;         // Global brightness, 255 = full scale
+    bool dither;                // Temporal error diffusion back to 8 bits
+    uint32_t current_limit_ma;  // Frame is scaled down above this draw, 0 = no limit
+    float ma_per_channel;       // Current of one channel at full drive
+    float idle_ma_per_led;      // Current of one LED with all channels off
+} led_color_config_t;
+
+// Color pipeline statistics
+typedef struct {
+    uint32_t frames_processed;
+    uint32_t frames_limited;        // Frames scaled down by the current limiter
+    uint32_t estimated_ma;          // Draw of the last frame before limiting
+    uint32_t output_ma;             // Draw of the last frame after limiting
+    uint16_t limiter_scale;         // Last limiter scale, 65535 = not limited
+} led_color_stats_t;
+
+// Function prototypes
+
+/**
+ * @brief Initialize the color pipeline
+ *
+ * Builds the gamma LUT and allocates one dither residual per LED channel.
+ *
+ * @param config Color pipeline configuration
+ * @param num_leds Number of LEDs per frame
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t led_color_init(const led_color_config_t *config, uint16_t num_leds);
+
+/**
+ * @brief Deinitialize the color pipeline
+ *
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t led_color_deinit(void);
+
+/**
+ * @brief Convert one RGB888 frame to LED pixels
+ *
+ * Each channel goes through the gamma LUT into 8.8 fixed-point linear light, is
+ * scaled by brightness and the current limiter, then reduced back to 8 bits.
+ * With dithering enabled the truncated low byte of every channel is carried
+ * into the next frame, so dim colors average out to the right level instead
+ * of banding.
+ *
+ * @param rgb Input frame, num_leds pixels in R, G, B order
+ * @param index_map Logical to physical index map, NULL for identity
+ * @param out Output pixel buffer (e.g. the LED output back buffer)
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t led_color_process(const uint8_t *rgb, const uint16_t *index_map, led_pixel_t *out);
+
+/**
+ * @brief Set global brightness
+ *
+ * @param brightness Brightness, 255 = full scale
+ */
+void led_color_set_brightness(uint8_t brightness);
+
+/**
+ * @brief Rebuild the gamma LUT
+ *
+ * Call from the task that runs led_color_process().
+ *
+ * @param gamma Gamma exponent, 1.0 = linear
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t led_color_set_gamma(float gamma);
+
+/**
+ * @brief Set the current budget
+ *
+ * @param limit_ma Maximum estimated draw in mA, 0 = no limit
+ */
+void led_color_set_current_limit(uint32_t limit_ma);
+
+/**
+ * @brief Get the gamma LUT
+ *
+ * @return const uint16_t* LED_COLOR_LUT_SIZE entries of 8.8 fixed-point linear light,
+ *         NULL if not initialized
+ */
+const uint16_t *led_color_get_gamma_lut(void);
+
+/**
+ * @brief Get color pipeline statistics
+ *
+ * @param stats Pointer to store statistics
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t led_color_get_stats(led_color_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LED_COLOR_H
@@ -0,0 +1,98 @@
+#ifndef LED_GEOMETRY_H
+#define LED_GEOMETRY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Geometry limits
+#define LED_GEOMETRY_MAX_CHAINS     8
+#define LED_GEOMETRY_MAX_LEDS       8192
+
+// One LED on the sphere
+typedef struct {
+    float x;            // Unit direction from the sphere center
+    float y;
+    float z;
+    uint8_t chain;      // Output chain the LED is wired to
+    uint16_t chain_pos; // Position along the chain, 0 = first after the data pin
+} led_geometry_entry_t;
+
+// Sphere LED layout, indexed by logical LED index
+typedef struct {
+    led_geometry_entry_t *leds;
+    uint16_t num_leds;
+    uint8_t num_chains;
+    uint16_t chain_length[LED_GEOMETRY_MAX_CHAINS];
+} led_geometry_t;
+
+/**
+ * @brief Parse a sphere geometry file
+ *
+ * The file is CSV text with one LED per line:
+ *
+ *     # index,chain,position,x,y,z
+ *     0,0,0,0.000,0.000,1.000
+ *
+ * Lines starting with '#' and blank lines are ignored. Every logical index
+ * from 0 to N-1 must appear once, and the positions on each chain must be
+ * contiguous from 0.
+ *
+ * @param text Geometry file contents (need not be NUL terminated)
+ * @param len Length of text in bytes
+ * @param geometry Output geometry, release with led_geometry_free()
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_ARG on malformed input
+ */
+esp_err_t led_geometry_parse(const char *text, size_t len, led_geometry_t *geometry);
+
+/**
+ * @brief Generate an evenly spaced sphere geometry
+ *
+ * Places LEDs on a Fibonacci lattice from the +z pole to the -z pole and
+ * splits them into num_chains consecutive chains of near-equal length.
+ * Useful for bring-up before the measured geometry file is available.
+ *
+ * @param num_leds Number of LEDs
+ * @param num_chains Number of chains
+ * @param geometry Output geometry, release with led_geometry_free()
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t led_geometry_generate(uint16_t num_leds, uint8_t num_chains, led_geometry_t *geometry);
+
+/**
+ * @brief Release memory held by a parsed geometry
+ *
+ * @param geometry Geometry to free
+ */
+void led_geometry_free(led_geometry_t *geometry);
+
+/**
+ * @brief Offset of each chain in a buffer holding all chains back to back
+ *
+ * @param geometry Parsed geometry
+ * @param chain_offset Output array of LED_GEOMETRY_MAX_CHAINS offsets
+ */
+void led_geometry_chain_offsets(const led_geometry_t *geometry, uint16_t *chain_offset);
+
+/**
+ * @brief Build the logical to physical LED index map
+ *
+ * Physical indices address a buffer holding all chains back to back, so the
+ * renderer can write pixel i of the sphere to buffer[map[i]].
+ *
+ * @param geometry Parsed geometry
+ * @param map Output array of num_leds entries
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t led_geometry_build_index_map(const led_geometry_t *geometry, uint16_t *map);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LED_GEOMETRY_H
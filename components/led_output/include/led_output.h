@@ -0,0 +1,164 @@
+#ifndef LED_OUTPUT_H
+#define LED_OUTPUT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "driver/gpio.h"
+#include "ws2812_encoder.h"
+#include "led_geometry.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// LED output configuration constants
+#define LED_OUTPUT_DEFAULT_GPIO             GPIO_NUM_35
+#define LED_OUTPUT_DEFAULT_RESOLUTION_HZ    10000000    // 0.1us per tick
+#define LED_OUTPUT_DEFAULT_MEM_SYMBOLS      1024        // DMA buffer, refilled in halves
+#define LED_OUTPUT_NON_DMA_MEM_SYMBOLS      48          // One RMT memory block
+#define LED_OUTPUT_CHUNK_SYMBOLS            192         // 8 LEDs encoded per chunk
+#define LED_OUTPUT_MAX_LEDS                 8192
+#define LED_OUTPUT_MAX_CHAINS               4           // RMT TX channels on ESP32-S3
+
+// One LED in wire order (WS2812 expects green first)
+typedef struct {
+    uint8_t g;
+    uint8_t r;
+    uint8_t b;
+} led_pixel_t;
+
+// One independent LED chain
+typedef struct {
+    gpio_num_t gpio;
+    uint16_t num_leds;
+} led_chain_config_t;
+
+// LED output configuration
+typedef struct {
+    led_chain_config_t chains[LED_OUTPUT_MAX_CHAINS];
+    uint8_t num_chains;
+    uint32_t resolution_hz;
+    size_t mem_block_symbols;           // Symbols for the DMA chain
+    bool with_dma;                      // Chain 0 uses DMA, the others ping-pong RMT memory
+    const led_geometry_t *geometry;     // Optional: chain lengths and logical index map
+} led_output_config_t;
+
+// LED output statistics
+typedef struct {
+    uint32_t frames_submitted;
+    uint32_t frames_completed;
+    uint32_t frames_rejected;       // submit_frame() while previous frame still on the wire
+    uint32_t last_frame_time_us;    // submit to transmission done
+    uint32_t frame_time_budget_us;  // theoretical wire time of the longest chain
+    float achieved_fps;             // completed frames over the last measurement window
+    float max_fps;                  // theoretical upper bound for the longest chain
+    uint8_t num_chains;
+    uint16_t longest_chain_leds;
+} led_output_stats_t;
+
+// Frame completion callback, called from the RMT ISR
+typedef void (*led_output_done_callback_t)(uint32_t frame_seq, void *user_ctx);
+
+// Function prototypes
+
+/**
+ * @brief Initialize LED output on one RMT TX channel per chain
+ *
+ * Allocates two pixel buffers in internal RAM so one can be rendered while
+ * the other is being clocked out. Each buffer holds all chains back to back.
+ * With more than one chain the channels are started together through an RMT
+ * sync manager, so the frame time is that of the longest chain.
+ *
+ * If config->geometry is set, chain lengths are taken from it (non-zero
+ * num_leds entries must match) and a logical to physical index map is built.
+ *
+ * @param config LED output configuration
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t led_output_init(const led_output_config_t *config);
+
+/**
+ * @brief Deinitialize LED output
+ *
+ * Waits for the frame in flight, then releases the channel and buffers.
+ *
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t led_output_deinit(void);
+
+/**
+ * @brief Get the buffer the renderer should fill for the next frame
+ *
+ * The pointer changes after every successful led_output_submit_frame().
+ * Chains are stored back to back in physical order; use the index map to
+ * address LEDs by their logical sphere index.
+ *
+ * @return led_pixel_t* Back buffer of num_leds pixels, NULL if not initialized
+ */
+led_pixel_t *led_output_get_back_buffer(void);
+
+/**
+ * @brief Get the logical to physical LED index map
+ *
+ * @return const uint16_t* Map of num_leds entries, NULL when logical and
+ *         physical order are the same (no geometry configured)
+ */
+const uint16_t *led_output_get_index_map(void);
+
+/**
+ * @brief Submit the back buffer for transmission without blocking
+ *
+ * Swaps front and back buffers and queues every chain of the new front
+ * buffer on its RMT channel. Completion is signalled through the done
+ * callback and led_output_wait_done().
+ *
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_STATE if the previous
+ *         frame is still being transmitted
+ */
+esp_err_t led_output_submit_frame(void);
+
+/**
+ * @brief Wait until the frame in flight has been clocked out
+ *
+ * @param timeout_ms Maximum time to wait
+ * @return esp_err_t ESP_OK when idle, ESP_ERR_TIMEOUT otherwise
+ */
+esp_err_t led_output_wait_done(uint32_t timeout_ms);
+
+/**
+ * @brief Check if any chain of the current frame is still being transmitted
+ *
+ * @return true if busy, false otherwise
+ */
+bool led_output_is_busy(void);
+
+/**
+ * @brief Set frame completion callback
+ *
+ * @param callback Callback invoked from ISR context once all chains are done
+ * @param user_ctx User context passed to the callback
+ */
+void led_output_set_done_callback(led_output_done_callback_t callback, void *user_ctx);
+
+/**
+ * @brief Get LED output statistics
+ *
+ * @param stats Pointer to store statistics
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t led_output_get_stats(led_output_stats_t *stats);
+
+/**
+ * @brief Get number of LEDs driven across all chains
+ *
+ * @return uint16_t Number of LEDs, 0 if not initialized
+ */
+uint16_t led_output_get_num_leds(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LED_OUTPUT_H
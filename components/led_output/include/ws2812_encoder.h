@@ -0,0 +1,103 @@
+#ifndef WS2812_ENCODER_H
+#define WS2812_ENCODER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// WS2812 bit timing (nanoseconds, 800kHz protocol)
+#define WS2812_T0H_NS           400
+#define WS2812_T0L_NS           850
+#define WS2812_T1H_NS           800
+#define WS2812_T1L_NS           450
+#define WS2812_BIT_PERIOD_NS    1250
+#define WS2812_RESET_US         300     // WS2812B-V5 latches after >280us low
+
+#define WS2812_BITS_PER_LED     24
+#define WS2812_BYTES_PER_LED    3
+
+// Maximum duration of one half of a symbol (15-bit field)
+#define WS2812_SYMBOL_DURATION_MAX  0x7FFF
+
+// One RMT symbol; same bit layout as rmt_symbol_word_t so the encoder
+// output can be handed to the RMT copy encoder without conversion
+typedef union {
+    struct {
+        uint16_t duration0 : 15;
+        uint16_t level0 : 1;
+        uint16_t duration1 : 15;
+        uint16_t level1 : 1;
+    };
+    uint32_t val;
+} ws2812_symbol_t;
+
+// Symbols for a given RMT tick resolution
+typedef struct {
+    uint32_t resolution_hz;
+    ws2812_symbol_t bit0;
+    ws2812_symbol_t bit1;
+    ws2812_symbol_t reset;
+} ws2812_timing_t;
+
+/**
+ * @brief Compute WS2812 bit and reset symbols for an RMT tick resolution
+ *
+ * @param resolution_hz RMT channel resolution (e.g. 10000000 for 0.1us ticks)
+ * @param timing Output timing symbols
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_ARG if the resolution
+ *         is too coarse to represent the bit timing or too fine for the reset code
+ */
+esp_err_t ws2812_timing_init(uint32_t resolution_hz, ws2812_timing_t *timing);
+
+/**
+ * @brief Encode a GRB byte stream into RMT symbols, one chunk at a time
+ *
+ * The symbol stream for a frame is 8 symbols per byte (MSB first) followed
+ * by a single reset symbol. The encoder is stateless: the caller passes the
+ * number of symbols already produced for this frame and receives the next
+ * chunk, so it can be driven directly from an RMT encoder callback.
+ *
+ * @param timing Timing symbols from ws2812_timing_init()
+ * @param data GRB wire-order bytes
+ * @param data_size Number of bytes in data
+ * @param symbols_written Symbols already produced for this frame
+ * @param symbols Output symbol buffer
+ * @param symbols_free Capacity of the output buffer
+ * @param done Set to true once the reset symbol has been produced
+ * @return size_t Number of symbols written to the output buffer
+ */
+size_t ws2812_encode(const ws2812_timing_t *timing, const uint8_t *data, size_t data_size,
+                     size_t symbols_written, ws2812_symbol_t *symbols, size_t symbols_free,
+                     bool *done);
+
+/**
+ * @brief Total number of symbols needed for a frame of data_size bytes
+ */
+size_t ws2812_frame_symbols(size_t data_size);
+
+/**
+ * @brief Wire time of one frame including the reset code
+ *
+ * @param num_leds Number of LEDs on the chain
+ * @return uint32_t Frame time in microseconds
+ */
+uint32_t ws2812_frame_time_us(size_t num_leds);
+
+/**
+ * @brief Upper bound of the refresh rate for a chain length
+ *
+ * @param num_leds Number of LEDs on the chain
+ * @return float Frames per second
+ */
+float ws2812_max_fps(size_t num_leds);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WS2812_ENCODER_H
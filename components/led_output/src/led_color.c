@@ -0,0 +1,217 @@
+#include "led_color.h"
+#include "esp_log.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "LED_COLOR";
+
+// Full scale of the internal 8.8 fixed-point linear representation, so the
+// high byte is the 8-bit output level and the low byte the dither fraction
+#define LED_COLOR_LINEAR_MAX    (255U << 8)
+// Fixed-point one for the combined brightness/limiter scale
+#define LED_COLOR_SCALE_ONE     65536U
+// LEDs quantized per block before being scattered into the output buffer
+#define LED_COLOR_BLOCK_LEDS    32
+
+// Global state
+static bool led_color_initialized = false;
+static led_color_config_t current_config = {0};
+static uint16_t num_leds = 0;
+static uint16_t gamma_lut[LED_COLOR_LUT_SIZE];
+static uint8_t *residual = NULL;    // Low byte carried to the next frame, 3 per LED
+static led_color_stats_t current_stats = {0};
+
+static esp_err_t build_gamma_lut(float gamma)
+{
+    if (!(gamma > 0.0f) || gamma > 8.0f) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    for (int i = 0; i < LED_COLOR_LUT_SIZE; i++) {
+        float linear = powf((float)i / (float)(LED_COLOR_LUT_SIZE - 1), gamma);
+        gamma_lut[i] = (uint16_t)lrintf(linear * (float)LED_COLOR_LINEAR_MAX);
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t led_color_init(const led_color_config_t *config, uint16_t leds)
+{
+    if (led_color_initialized) {
+        ESP_LOGW(TAG, "Color pipeline already initialized");
+        return ESP_OK;
+    }
+
+    if (!config || leds == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = build_gamma_lut(config->gamma);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Invalid gamma: %.2f", config->gamma);
+        return ret;
+    }
+
+    residual = calloc((size_t)leds * 3, sizeof(uint8_t));
+    if (!residual) {
+        ESP_LOGE(TAG, "Failed to allocate dither residuals");
+        return ESP_ERR_NO_MEM;
+    }
+
+    memcpy(&current_config, config, sizeof(led_color_config_t));
+    num_leds = leds;
+    memset(&current_stats, 0, sizeof(led_color_stats_t));
+    current_stats.limiter_scale = UINT16_MAX;
+    led_color_initialized = true;
+
+    ESP_LOGI(TAG, "Color pipeline initialized: %u LEDs, gamma %.2f, brightness %u, limit %lu mA",
+             leds, config->gamma, config->brightness, (unsigned long)config->current_limit_ma);
+    return ESP_OK;
+}
+
+esp_err_t led_color_deinit(void)
+{
+    if (!led_color_initialized) {
+        return ESP_OK;
+    }
+
+    free(residual);
+    residual = NULL;
+    num_leds = 0;
+    led_color_initialized = false;
+
+    return ESP_OK;
+}
+
+// Sum of the gamma-corrected channels; branch-free so it vectorizes
+static uint32_t sum_linear(const uint8_t *restrict rgb, size_t channels)
+{
+    uint32_t sum = 0;
+    for (size_t i = 0; i < channels; i++) {
+        sum += gamma_lut[rgb[i]];
+    }
+    return sum;
+}
+
+// Estimated draw of a frame whose linear channel sum is scaled by scale / LED_COLOR_SCALE_ONE
+static float estimate_ma(uint32_t linear_sum, uint32_t scale)
+{
+    float full_scale_channels = (float)linear_sum / (float)LED_COLOR_LINEAR_MAX;
+    return (float)num_leds * current_config.idle_ma_per_led +
+           full_scale_channels * ((float)scale / (float)LED_COLOR_SCALE_ONE) * current_config.ma_per_channel;
+}
+
+// Scale linear light, add the carried residual and keep the new low byte
+static void quantize_dither(const uint8_t *restrict rgb, uint8_t *restrict res,
+                            uint8_t *restrict out, size_t channels, uint32_t scale)
+{
+    for (size_t i = 0; i < channels; i++) {
+        uint32_t value = ((gamma_lut[rgb[i]] * scale) >> 16) + res[i];
+        res[i] = (uint8_t)value;
+        value >>= 8;
+        out[i] = (uint8_t)value;
+    }
+}
+
+static void quantize_round(const uint8_t *restrict rgb, uint8_t *restrict out,
+                           size_t channels, uint32_t scale)
+{
+    for (size_t i = 0; i < channels; i++) {
+        out[i] = (uint8_t)((((gamma_lut[rgb[i]] * scale) >> 16) + 128) >> 8);
+    }
+}
+
+esp_err_t led_color_process(const uint8_t *rgb, const uint16_t *index_map, led_pixel_t *out)
+{
+    if (!led_color_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!rgb || !out) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const size_t channels = (size_t)num_leds * 3;
+
+    // Brightness 255 maps exactly to LED_COLOR_SCALE_ONE
+    uint32_t scale = ((uint32_t)current_config.brightness * LED_COLOR_SCALE_ONE + 127) / 255;
+    uint32_t limiter = LED_COLOR_SCALE_ONE;
+
+    // First pass: estimate the draw at the requested brightness
+    uint32_t linear_sum = sum_linear(rgb, channels);
+    float draw_ma = estimate_ma(linear_sum, scale);
+    float output_ma = draw_ma;
+
+    if (current_config.current_limit_ma > 0 && draw_ma > (float)current_config.current_limit_ma) {
+        float idle_ma = (float)num_leds * current_config.idle_ma_per_led;
+        float budget = (float)current_config.current_limit_ma - idle_ma;
+        float variable = draw_ma - idle_ma;
+        float ratio = budget > 0.0f ? budget / variable : 0.0f;
+        limiter = (uint32_t)(ratio * (float)LED_COLOR_SCALE_ONE);
+        scale = (uint32_t)(((uint64_t)scale * limiter) >> 16);
+        output_ma = estimate_ma(linear_sum, scale);
+        current_stats.frames_limited++;
+    }
+
+    // Second pass: scale and quantize in RGB order, then scatter to wire order
+    uint8_t quantized[LED_COLOR_BLOCK_LEDS * 3];
+    for (size_t base = 0; base < num_leds; base += LED_COLOR_BLOCK_LEDS) {
+        size_t count = num_leds - base < LED_COLOR_BLOCK_LEDS ? num_leds - base : LED_COLOR_BLOCK_LEDS;
+        const uint8_t *src = &rgb[base * 3];
+
+        if (current_config.dither) {
+            quantize_dither(src, &residual[base * 3], quantized, count * 3, scale);
+        } else {
+            quantize_round(src, quantized, count * 3, scale);
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            size_t logical = base + i;
+            led_pixel_t *pixel = &out[index_map ? index_map[logical] : logical];
+            pixel->r = quantized[i * 3];
+            pixel->g = quantized[i * 3 + 1];
+            pixel->b = quantized[i * 3 + 2];
+        }
+    }
+
+    current_stats.frames_processed++;
+    current_stats.estimated_ma = (uint32_t)draw_ma;
+    current_stats.output_ma = (uint32_t)output_ma;
+    current_stats.limiter_scale = limiter >= LED_COLOR_SCALE_ONE ? UINT16_MAX : (uint16_t)limiter;
+
+    return ESP_OK;
+}
+
+void led_color_set_brightness(uint8_t brightness)
+{
+    current_config.brightness = brightness;
+}
+
+esp_err_t led_color_set_gamma(float gamma)
+{
+    esp_err_t ret = build_gamma_lut(gamma);
+    if (ret == ESP_OK) {
+        current_config.gamma = gamma;
+    }
+    return ret;
+}
+
+void led_color_set_current_limit(uint32_t limit_ma)
+{
+    current_config.current_limit_ma = limit_ma;
+}
+
+const uint16_t *led_color_get_gamma_lut(void)
+{
+    return led_color_initialized ? gamma_lut : NULL;
+}
+
+esp_err_t led_color_get_stats(led_color_stats_t *stats)
+{
+    if (!stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memcpy(stats, &current_stats, sizeof(led_color_stats_t));
+    return ESP_OK;
+}
@@ -0,0 +1,233 @@
+#include "led_geometry.h"
+#include "esp_log.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "LED_GEOMETRY";
+
+#define LED_GEOMETRY_LINE_MAX   128
+
+// Copy the next line into buf and advance *pos; returns false at end of text
+static bool next_line(const char *text, size_t len, size_t *pos, char *buf, size_t buf_size)
+{
+    if (*pos >= len) {
+        return false;
+    }
+
+    size_t start = *pos;
+    size_t end = start;
+    while (end < len && text[end] != '\n') {
+        end++;
+    }
+    *pos = end < len ? end + 1 : end;
+
+    size_t line_len = end - start;
+    if (line_len > 0 && text[start + line_len - 1] == '\r') {
+        line_len--;
+    }
+    if (line_len >= buf_size) {
+        line_len = buf_size - 1;
+    }
+    memcpy(buf, &text[start], line_len);
+    buf[line_len] = '\0';
+    return true;
+}
+
+static bool is_data_line(const char *line)
+{
+    while (*line == ' ' || *line == '\t') {
+        line++;
+    }
+    return *line != '\0' && *line != '#';
+}
+
+esp_err_t led_geometry_parse(const char *text, size_t len, led_geometry_t *geometry)
+{
+    if (!text || !geometry) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(geometry, 0, sizeof(led_geometry_t));
+
+    char line[LED_GEOMETRY_LINE_MAX];
+    size_t pos = 0;
+    size_t count = 0;
+
+    // First pass: count LEDs
+    while (next_line(text, len, &pos, line, sizeof(line))) {
+        if (is_data_line(line)) {
+            count++;
+        }
+    }
+
+    if (count == 0 || count > LED_GEOMETRY_MAX_LEDS) {
+        ESP_LOGE(TAG, "Invalid LED count: %zu", count);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    geometry->leds = calloc(count, sizeof(led_geometry_entry_t));
+    bool *seen = calloc(count, sizeof(bool));
+    if (!geometry->leds || !seen) {
+        free(seen);
+        led_geometry_free(geometry);
+        return ESP_ERR_NO_MEM;
+    }
+    geometry->num_leds = (uint16_t)count;
+
+    // Second pass: fill entries
+    pos = 0;
+    size_t line_no = 0;
+    esp_err_t ret = ESP_OK;
+    while (next_line(text, len, &pos, line, sizeof(line))) {
+        line_no++;
+        if (!is_data_line(line)) {
+            continue;
+        }
+
+        int index, chain, chain_pos;
+        float x, y, z;
+        if (sscanf(line, "%d,%d,%d,%f,%f,%f", &index, &chain, &chain_pos, &x, &y, &z) != 6) {
+            ESP_LOGE(TAG, "Line %zu: expected index,chain,position,x,y,z", line_no);
+            ret = ESP_ERR_INVALID_ARG;
+            break;
+        }
+        if (index < 0 || (size_t)index >= count || seen[index]) {
+            ESP_LOGE(TAG, "Line %zu: invalid or duplicate LED index %d", line_no, index);
+            ret = ESP_ERR_INVALID_ARG;
+            break;
+        }
+        if (chain < 0 || chain >= LED_GEOMETRY_MAX_CHAINS || chain_pos < 0 || (size_t)chain_pos >= count) {
+            ESP_LOGE(TAG, "Line %zu: invalid chain %d position %d", line_no, chain, chain_pos);
+            ret = ESP_ERR_INVALID_ARG;
+            break;
+        }
+
+        seen[index] = true;
+        led_geometry_entry_t *led = &geometry->leds[index];
+        led->x = x;
+        led->y = y;
+        led->z = z;
+        led->chain = (uint8_t)chain;
+        led->chain_pos = (uint16_t)chain_pos;
+
+        geometry->chain_length[chain]++;
+        if (chain + 1 > geometry->num_chains) {
+            geometry->num_chains = (uint8_t)(chain + 1);
+        }
+    }
+    free(seen);
+
+    if (ret == ESP_OK) {
+        // Each chain must be wired 0..length-1 without gaps or duplicates
+        uint16_t *map = malloc(count * sizeof(uint16_t));
+        if (!map) {
+            ret = ESP_ERR_NO_MEM;
+        } else {
+            ret = led_geometry_build_index_map(geometry, map);
+            free(map);
+        }
+    }
+
+    if (ret != ESP_OK) {
+        led_geometry_free(geometry);
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "Parsed geometry: %u LEDs on %u chains", geometry->num_leds, geometry->num_chains);
+    return ESP_OK;
+}
+
+esp_err_t led_geometry_generate(uint16_t num_leds, uint8_t num_chains, led_geometry_t *geometry)
+{
+    if (!geometry || num_leds == 0 || num_chains == 0 ||
+        num_chains > LED_GEOMETRY_MAX_CHAINS || num_chains > num_leds) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(geometry, 0, sizeof(led_geometry_t));
+    geometry->leds = calloc(num_leds, sizeof(led_geometry_entry_t));
+    if (!geometry->leds) {
+        return ESP_ERR_NO_MEM;
+    }
+    geometry->num_leds = num_leds;
+    geometry->num_chains = num_chains;
+
+    // Golden angle between consecutive LEDs, uniform steps in z
+    const float golden_angle = 2.39996323f;
+    uint16_t index = 0;
+    for (uint8_t c = 0; c < num_chains; c++) {
+        uint16_t length = num_leds / num_chains + (c < num_leds % num_chains ? 1 : 0);
+        geometry->chain_length[c] = length;
+
+        for (uint16_t p = 0; p < length; p++, index++) {
+            float z = 1.0f - (2.0f * index + 1.0f) / (float)num_leds;
+            float radius = sqrtf(1.0f - z * z);
+            float theta = golden_angle * index;
+
+            led_geometry_entry_t *led = &geometry->leds[index];
+            led->x = radius * cosf(theta);
+            led->y = radius * sinf(theta);
+            led->z = z;
+            led->chain = c;
+            led->chain_pos = p;
+        }
+    }
+
+    return ESP_OK;
+}
+
+void led_geometry_free(led_geometry_t *geometry)
+{
+    if (!geometry) {
+        return;
+    }
+    free(geometry->leds);
+    memset(geometry, 0, sizeof(led_geometry_t));
+}
+
+void led_geometry_chain_offsets(const led_geometry_t *geometry, uint16_t *chain_offset)
+{
+    uint16_t offset = 0;
+    for (int c = 0; c < LED_GEOMETRY_MAX_CHAINS; c++) {
+        chain_offset[c] = offset;
+        offset += geometry->chain_length[c];
+    }
+}
+
+esp_err_t led_geometry_build_index_map(const led_geometry_t *geometry, uint16_t *map)
+{
+    if (!geometry || !geometry->leds || !map) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint16_t offsets[LED_GEOMETRY_MAX_CHAINS];
+    led_geometry_chain_offsets(geometry, offsets);
+
+    bool *used = calloc(geometry->num_leds, sizeof(bool));
+    if (!used) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t ret = ESP_OK;
+    for (uint16_t i = 0; i < geometry->num_leds; i++) {
+        const led_geometry_entry_t *led = &geometry->leds[i];
+        if (led->chain >= geometry->num_chains || led->chain_pos >= geometry->chain_length[led->chain]) {
+            ESP_LOGE(TAG, "LED %u: position %u beyond end of chain %u", i, led->chain_pos, led->chain);
+            ret = ESP_ERR_INVALID_ARG;
+            break;
+        }
+        uint16_t physical = offsets[led->chain] + led->chain_pos;
+        if (used[physical]) {
+            ESP_LOGE(TAG, "LED %u: chain %u position %u already taken", i, led->chain, led->chain_pos);
+            ret = ESP_ERR_INVALID_ARG;
+            break;
+        }
+        used[physical] = true;
+        map[i] = physical;
+    }
+
+    free(used);
+    return ret;
+}
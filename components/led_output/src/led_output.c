@@ -0,0 +1,592 @@
+#include "led_output.h"
+#include "esp_log.h"
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "driver/rmt_tx.h"
+#include "driver/rmt_encoder.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "LED_OUTPUT";
+
+_Static_assert(sizeof(ws2812_symbol_t) == sizeof(rmt_symbol_word_t),
+               "ws2812_symbol_t must match rmt_symbol_word_t");
+
+// Achieved frame rate is averaged over this window
+#define LED_OUTPUT_FPS_WINDOW_US    1000000
+
+// Chunked WS2812 encoder: expands pixels with ws2812_encode() into a small
+// internal buffer and feeds it to the copy encoder, so the DMA ping-pong
+// buffer is refilled chunk by chunk without a full-frame symbol buffer
+typedef struct {
+    rmt_encoder_t base;
+    rmt_encoder_handle_t copy_encoder;
+    ws2812_timing_t timing;
+    size_t stream_pos;      // symbols of this frame already placed in chunks
+    size_t chunk_len;       // symbols pending in chunk
+    bool stream_done;       // reset symbol has been placed in a chunk
+    ws2812_symbol_t chunk[LED_OUTPUT_CHUNK_SYMBOLS];
+} led_chunk_encoder_t;
+
+// One RMT channel driving one chain
+typedef struct {
+    rmt_channel_handle_t channel;
+    led_chunk_encoder_t *encoder;
+    uint16_t offset;        // First LED of this chain in the pixel buffers
+    uint16_t num_leds;
+} led_chain_t;
+
+// Global state
+static bool led_output_initialized = false;
+static led_output_config_t current_config = {0};
+static led_chain_t chains[LED_OUTPUT_MAX_CHAINS];
+static uint8_t num_chains = 0;
+static uint16_t total_leds = 0;
+static uint16_t longest_chain_leds = 0;
+static rmt_sync_manager_handle_t sync_manager = NULL;
+static uint16_t *index_map = NULL;
+static SemaphoreHandle_t frame_done_sem = NULL;
+static portMUX_TYPE led_output_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Double buffering
+static led_pixel_t *pixel_buffers[2] = {NULL, NULL};
+static volatile uint8_t back_index = 0;
+static volatile uint8_t chains_pending = 0;
+
+// Callback
+static led_output_done_callback_t done_callback = NULL;
+static void *done_callback_ctx = NULL;
+
+// Statistics
+static led_output_stats_t current_stats = {0};
+static uint32_t frame_seq = 0;
+static int64_t frame_submit_time_us = 0;
+static int64_t fps_window_start_us = 0;
+static uint32_t fps_window_frames = 0;
+
+// Forward declarations
+static esp_err_t led_chunk_encoder_new(uint32_t resolution_hz, led_chunk_encoder_t **ret_encoder);
+static size_t led_chunk_encode(rmt_encoder_t *encoder, rmt_channel_handle_t channel,
+                               const void *primary_data, size_t data_size,
+                               rmt_encode_state_t *ret_state);
+static esp_err_t led_chunk_encoder_reset(rmt_encoder_t *encoder);
+static esp_err_t led_chunk_encoder_del(rmt_encoder_t *encoder);
+static bool led_tx_done_isr(rmt_channel_handle_t channel, const rmt_tx_done_event_data_t *edata,
+                            void *user_ctx);
+static void release_resources(void);
+static esp_err_t resolve_chain_lengths(const led_output_config_t *config, uint16_t *lengths);
+
+static size_t led_chunk_encode(rmt_encoder_t *encoder, rmt_channel_handle_t channel,
+                               const void *primary_data, size_t data_size,
+                               rmt_encode_state_t *ret_state)
+{
+    led_chunk_encoder_t *enc = __containerof(encoder, led_chunk_encoder_t, base);
+    rmt_encoder_handle_t copy = enc->copy_encoder;
+    rmt_encode_state_t state = RMT_ENCODING_RESET;
+    size_t encoded = 0;
+
+    while (true) {
+        if (enc->chunk_len == 0) {
+            if (enc->stream_done) {
+                state |= RMT_ENCODING_COMPLETE;
+                enc->stream_pos = 0;
+                enc->stream_done = false;
+                break;
+            }
+            bool done = false;
+            enc->chunk_len = ws2812_encode(&enc->timing, primary_data, data_size,
+                                           enc->stream_pos, enc->chunk,
+                                           LED_OUTPUT_CHUNK_SYMBOLS, &done);
+            enc->stream_pos += enc->chunk_len;
+            enc->stream_done = done;
+            if (enc->chunk_len == 0) {
+                continue;
+            }
+        }
+
+        // The copy encoder keeps its own offset into the chunk across MEM_FULL
+        rmt_encode_state_t copy_state = RMT_ENCODING_RESET;
+        encoded += copy->encode(copy, channel, enc->chunk,
+                                enc->chunk_len * sizeof(ws2812_symbol_t), &copy_state);
+        if (copy_state & RMT_ENCODING_COMPLETE) {
+            enc->chunk_len = 0;
+        }
+        if (copy_state & RMT_ENCODING_MEM_FULL) {
+            state |= RMT_ENCODING_MEM_FULL;
+            break;
+        }
+    }
+
+    *ret_state = state;
+    return encoded;
+}
+
+static esp_err_t led_chunk_encoder_reset(rmt_encoder_t *encoder)
+{
+    led_chunk_encoder_t *enc = __containerof(encoder, led_chunk_encoder_t, base);
+    rmt_encoder_reset(enc->copy_encoder);
+    enc->stream_pos = 0;
+    enc->chunk_len = 0;
+    enc->stream_done = false;
+    return ESP_OK;
+}
+
+static esp_err_t led_chunk_encoder_del(rmt_encoder_t *encoder)
+{
+    led_chunk_encoder_t *enc = __containerof(encoder, led_chunk_encoder_t, base);
+    rmt_del_encoder(enc->copy_encoder);
+    heap_caps_free(enc);
+    return ESP_OK;
+}
+
+static esp_err_t led_chunk_encoder_new(uint32_t resolution_hz, led_chunk_encoder_t **ret_encoder)
+{
+    // Accessed from the RMT ISR, so keep it in internal RAM
+    led_chunk_encoder_t *enc = heap_caps_calloc(1, sizeof(led_chunk_encoder_t),
+                                                MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!enc) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t ret = ws2812_timing_init(resolution_hz, &enc->timing);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Unsupported RMT resolution: %lu Hz", resolution_hz);
+        heap_caps_free(enc);
+        return ret;
+    }
+
+    rmt_copy_encoder_config_t copy_config = {};
+    ret = rmt_new_copy_encoder(&copy_config, &enc->copy_encoder);
+    if (ret != ESP_OK) {
+        heap_caps_free(enc);
+        return ret;
+    }
+
+    enc->base.encode = led_chunk_encode;
+    enc->base.reset = led_chunk_encoder_reset;
+    enc->base.del = led_chunk_encoder_del;
+
+    *ret_encoder = enc;
+    return ESP_OK;
+}
+
+static bool IRAM_ATTR led_tx_done_isr(rmt_channel_handle_t channel, const rmt_tx_done_event_data_t *edata,
+                                      void *user_ctx)
+{
+    BaseType_t high_task_wakeup = pdFALSE;
+    int64_t now = esp_timer_get_time();
+    bool frame_done = false;
+    uint32_t seq;
+
+    portENTER_CRITICAL_ISR(&led_output_lock);
+    if (chains_pending > 0) {
+        chains_pending--;
+    }
+    seq = frame_seq;
+
+    // The frame is done once the last chain has been clocked out
+    if (chains_pending == 0) {
+        frame_done = true;
+        current_stats.frames_completed++;
+        current_stats.last_frame_time_us = (uint32_t)(now - frame_submit_time_us);
+
+        fps_window_frames++;
+        int64_t window_us = now - fps_window_start_us;
+        if (window_us >= LED_OUTPUT_FPS_WINDOW_US) {
+            current_stats.achieved_fps = (float)fps_window_frames * 1000000.0f / (float)window_us;
+            fps_window_start_us = now;
+            fps_window_frames = 0;
+        }
+    }
+    portEXIT_CRITICAL_ISR(&led_output_lock);
+
+    if (!frame_done) {
+        return false;
+    }
+
+    xSemaphoreGiveFromISR(frame_done_sem, &high_task_wakeup);
+
+    if (done_callback) {
+        done_callback(seq, done_callback_ctx);
+    }
+
+    return high_task_wakeup == pdTRUE;
+}
+
+static void release_resources(void)
+{
+    if (sync_manager) {
+        rmt_del_sync_manager(sync_manager);
+        sync_manager = NULL;
+    }
+
+    for (int c = 0; c < LED_OUTPUT_MAX_CHAINS; c++) {
+        if (chains[c].channel) {
+            rmt_disable(chains[c].channel);
+            rmt_del_channel(chains[c].channel);
+        }
+        if (chains[c].encoder) {
+            rmt_del_encoder(&chains[c].encoder->base);
+        }
+    }
+    memset(chains, 0, sizeof(chains));
+    num_chains = 0;
+
+    if (frame_done_sem) {
+        vSemaphoreDelete(frame_done_sem);
+        frame_done_sem = NULL;
+    }
+
+    for (int i = 0; i < 2; i++) {
+        if (pixel_buffers[i]) {
+            heap_caps_free(pixel_buffers[i]);
+            pixel_buffers[i] = NULL;
+        }
+    }
+
+    free(index_map);
+    index_map = NULL;
+}
+
+static esp_err_t resolve_chain_lengths(const led_output_config_t *config, uint16_t *lengths)
+{
+    const led_geometry_t *geometry = config->geometry;
+
+    if (geometry && geometry->num_chains != config->num_chains) {
+        ESP_LOGE(TAG, "Geometry has %u chains, %u configured", geometry->num_chains, config->num_chains);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint32_t total = 0;
+    for (int c = 0; c < config->num_chains; c++) {
+        uint16_t length = config->chains[c].num_leds;
+        if (geometry) {
+            if (length != 0 && length != geometry->chain_length[c]) {
+                ESP_LOGE(TAG, "Chain %d: %u LEDs configured, geometry has %u",
+                         c, length, geometry->chain_length[c]);
+                return ESP_ERR_INVALID_ARG;
+            }
+            length = geometry->chain_length[c];
+        }
+        if (length == 0) {
+            ESP_LOGE(TAG, "Chain %d has no LEDs", c);
+            return ESP_ERR_INVALID_ARG;
+        }
+        lengths[c] = length;
+        total += length;
+    }
+
+    if (total > LED_OUTPUT_MAX_LEDS) {
+        ESP_LOGE(TAG, "Too many LEDs: %lu", total);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t led_output_init(const led_output_config_t *config)
+{
+    if (led_output_initialized) {
+        ESP_LOGW(TAG, "LED output already initialized");
+        return ESP_OK;
+    }
+
+    if (!config || config->num_chains == 0 || config->num_chains > LED_OUTPUT_MAX_CHAINS) {
+        ESP_LOGE(TAG, "Invalid configuration");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint16_t lengths[LED_OUTPUT_MAX_CHAINS] = {0};
+    esp_err_t ret = resolve_chain_lengths(config, lengths);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "Initializing LED output: %u chains, DMA: %s",
+             config->num_chains, config->with_dma ? "yes" : "no");
+
+    memcpy(&current_config, config, sizeof(led_output_config_t));
+    current_config.geometry = NULL;
+    if (current_config.resolution_hz == 0) {
+        current_config.resolution_hz = LED_OUTPUT_DEFAULT_RESOLUTION_HZ;
+    }
+    if (current_config.mem_block_symbols == 0) {
+        current_config.mem_block_symbols = LED_OUTPUT_DEFAULT_MEM_SYMBOLS;
+    }
+
+    // Lay the chains out back to back
+    memset(chains, 0, sizeof(chains));
+    num_chains = config->num_chains;
+    total_leds = 0;
+    longest_chain_leds = 0;
+    for (int c = 0; c < num_chains; c++) {
+        chains[c].offset = total_leds;
+        chains[c].num_leds = lengths[c];
+        current_config.chains[c].num_leds = lengths[c];
+        total_leds += lengths[c];
+        if (lengths[c] > longest_chain_leds) {
+            longest_chain_leds = lengths[c];
+        }
+    }
+
+    if (config->geometry) {
+        index_map = malloc((size_t)total_leds * sizeof(uint16_t));
+        if (!index_map) {
+            ret = ESP_ERR_NO_MEM;
+            goto err;
+        }
+        ret = led_geometry_build_index_map(config->geometry, index_map);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to build LED index map");
+            goto err;
+        }
+    }
+
+    // Pixel buffers are read by the encoder from the RMT ISR
+    size_t buffer_size = (size_t)total_leds * sizeof(led_pixel_t);
+    for (int i = 0; i < 2; i++) {
+        pixel_buffers[i] = heap_caps_calloc(1, buffer_size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        if (!pixel_buffers[i]) {
+            ESP_LOGE(TAG, "Failed to allocate pixel buffer %d (%zu bytes)", i, buffer_size);
+            ret = ESP_ERR_NO_MEM;
+            goto err;
+        }
+    }
+
+    frame_done_sem = xSemaphoreCreateBinary();
+    if (!frame_done_sem) {
+        ESP_LOGE(TAG, "Failed to create frame done semaphore");
+        ret = ESP_ERR_NO_MEM;
+        goto err;
+    }
+
+    rmt_tx_event_callbacks_t callbacks = {
+        .on_trans_done = led_tx_done_isr,
+    };
+    rmt_channel_handle_t channel_handles[LED_OUTPUT_MAX_CHAINS];
+
+    for (int c = 0; c < num_chains; c++) {
+        // Only one TX channel has a DMA path; the rest refill RMT memory from the ISR
+        bool use_dma = current_config.with_dma && c == 0;
+        rmt_tx_channel_config_t channel_config = {
+            .gpio_num = current_config.chains[c].gpio,
+            .clk_src = RMT_CLK_SRC_DEFAULT,
+            .resolution_hz = current_config.resolution_hz,
+            .mem_block_symbols = use_dma ? current_config.mem_block_symbols : LED_OUTPUT_NON_DMA_MEM_SYMBOLS,
+            .trans_queue_depth = 2,
+            .flags.with_dma = use_dma,
+        };
+
+        ret = rmt_new_tx_channel(&channel_config, &chains[c].channel);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Chain %d: failed to create RMT TX channel on GPIO %d: %s",
+                     c, channel_config.gpio_num, esp_err_to_name(ret));
+            goto err;
+        }
+
+        ret = led_chunk_encoder_new(current_config.resolution_hz, &chains[c].encoder);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Chain %d: failed to create LED encoder: %s", c, esp_err_to_name(ret));
+            goto err;
+        }
+
+        ret = rmt_tx_register_event_callbacks(chains[c].channel, &callbacks, &chains[c]);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Chain %d: failed to register TX callback: %s", c, esp_err_to_name(ret));
+            goto err;
+        }
+
+        ret = rmt_enable(chains[c].channel);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Chain %d: failed to enable RMT channel: %s", c, esp_err_to_name(ret));
+            goto err;
+        }
+
+        channel_handles[c] = chains[c].channel;
+        ESP_LOGI(TAG, "Chain %d: GPIO %d, %u LEDs, %s", c, channel_config.gpio_num,
+                 chains[c].num_leds, use_dma ? "DMA" : "RMT memory");
+    }
+
+    // Start all chains on the same clock edge
+    if (num_chains > 1) {
+        rmt_sync_manager_config_t sync_config = {
+            .tx_channel_array = channel_handles,
+            .array_size = num_chains,
+        };
+        ret = rmt_new_sync_manager(&sync_config, &sync_manager);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to create sync manager: %s", esp_err_to_name(ret));
+            goto err;
+        }
+    }
+
+    // Reset statistics
+    memset(&current_stats, 0, sizeof(led_output_stats_t));
+    current_stats.frame_time_budget_us = ws2812_frame_time_us(longest_chain_leds);
+    current_stats.max_fps = ws2812_max_fps(longest_chain_leds);
+    current_stats.num_chains = num_chains;
+    current_stats.longest_chain_leds = longest_chain_leds;
+    frame_seq = 0;
+    fps_window_start_us = esp_timer_get_time();
+    fps_window_frames = 0;
+
+    back_index = 0;
+    chains_pending = 0;
+    led_output_initialized = true;
+
+    ESP_LOGI(TAG, "LED output initialized: %u LEDs, frame time %lu us, max %.1f fps",
+             total_leds, current_stats.frame_time_budget_us, current_stats.max_fps);
+    return ESP_OK;
+
+err:
+    release_resources();
+    return ret;
+}
+
+esp_err_t led_output_deinit(void)
+{
+    if (!led_output_initialized) {
+        return ESP_OK;
+    }
+
+    ESP_LOGI(TAG, "Deinitializing LED output");
+
+    for (int c = 0; c < num_chains; c++) {
+        rmt_tx_wait_all_done(chains[c].channel, -1);
+    }
+    release_resources();
+
+    led_output_initialized = false;
+    chains_pending = 0;
+
+    ESP_LOGI(TAG, "LED output deinitialized");
+    return ESP_OK;
+}
+
+led_pixel_t *led_output_get_back_buffer(void)
+{
+    if (!led_output_initialized) {
+        return NULL;
+    }
+    return pixel_buffers[back_index];
+}
+
+const uint16_t *led_output_get_index_map(void)
+{
+    return index_map;
+}
+
+esp_err_t led_output_submit_frame(void)
+{
+    if (!led_output_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    portENTER_CRITICAL(&led_output_lock);
+    if (chains_pending > 0) {
+        current_stats.frames_rejected++;
+        portEXIT_CRITICAL(&led_output_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    uint8_t front_index = back_index;
+    back_index ^= 1;
+    chains_pending = num_chains;
+    frame_seq++;
+    current_stats.frames_submitted++;
+    frame_submit_time_us = esp_timer_get_time();
+    portEXIT_CRITICAL(&led_output_lock);
+
+    // Drop a completion left over from a previous frame
+    xSemaphoreTake(frame_done_sem, 0);
+
+    // All channels are idle here, so the sync manager can be rearmed
+    if (sync_manager) {
+        rmt_sync_reset(sync_manager);
+    }
+
+    rmt_transmit_config_t tx_config = {
+        .loop_count = 0,
+    };
+    led_pixel_t *front = pixel_buffers[front_index];
+
+    for (int c = 0; c < num_chains; c++) {
+        esp_err_t ret = rmt_transmit(chains[c].channel, &chains[c].encoder->base,
+                                     &front[chains[c].offset],
+                                     (size_t)chains[c].num_leds * sizeof(led_pixel_t), &tx_config);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Chain %d: failed to queue frame: %s", c, esp_err_to_name(ret));
+            if (sync_manager) {
+                // The queued chains wait for the whole group and will never
+                // start: drop their transactions and rearm the group
+                for (int q = 0; q < c; q++) {
+                    rmt_disable(chains[q].channel);
+                    rmt_enable(chains[q].channel);
+                }
+                rmt_sync_reset(sync_manager);
+                portENTER_CRITICAL(&led_output_lock);
+                chains_pending = 0;
+                portEXIT_CRITICAL(&led_output_lock);
+                return ret;
+            }
+            // Chains that were not queued will never report completion
+            portENTER_CRITICAL(&led_output_lock);
+            chains_pending -= (uint8_t)(num_chains - c);
+            portEXIT_CRITICAL(&led_output_lock);
+            return ret;
+        }
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t led_output_wait_done(uint32_t timeout_ms)
+{
+    if (!led_output_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (chains_pending == 0) {
+        return ESP_OK;
+    }
+
+    if (xSemaphoreTake(frame_done_sem, pdMS_TO_TICKS(timeout_ms)) != pdTRUE && chains_pending > 0) {
+        return ESP_ERR_TIMEOUT;
+    }
+
+    return ESP_OK;
+}
+
+bool led_output_is_busy(void)
+{
+    return chains_pending > 0;
+}
+
+void led_output_set_done_callback(led_output_done_callback_t callback, void *user_ctx)
+{
+    portENTER_CRITICAL(&led_output_lock);
+    done_callback = callback;
+    done_callback_ctx = user_ctx;
+    portEXIT_CRITICAL(&led_output_lock);
+}
+
+esp_err_t led_output_get_stats(led_output_stats_t *stats)
+{
+    if (!stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&led_output_lock);
+    memcpy(stats, &current_stats, sizeof(led_output_stats_t));
+    portEXIT_CRITICAL(&led_output_lock);
+
+    return ESP_OK;
+}
+
+uint16_t led_output_get_num_leds(void)
+{
+    return led_output_initialized ? total_leds : 0;
+}
@@ -0,0 +1,115 @@
+#include "ws2812_encoder.h"
+
+// Convert nanoseconds to RMT ticks, rounded to nearest
+static uint32_t ns_to_ticks(uint32_t ns, uint32_t resolution_hz)
+{
+    return (uint32_t)(((uint64_t)ns * resolution_hz + 500000000ULL) / 1000000000ULL);
+}
+
+esp_err_t ws2812_timing_init(uint32_t resolution_hz, ws2812_timing_t *timing)
+{
+    if (!timing || resolution_hz == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint32_t t0h = ns_to_ticks(WS2812_T0H_NS, resolution_hz);
+    uint32_t t0l = ns_to_ticks(WS2812_T0L_NS, resolution_hz);
+    uint32_t t1h = ns_to_ticks(WS2812_T1H_NS, resolution_hz);
+    uint32_t t1l = ns_to_ticks(WS2812_T1L_NS, resolution_hz);
+    uint64_t reset_ticks = (uint64_t)WS2812_RESET_US * resolution_hz / 1000000ULL;
+
+    // Every phase must be representable and 0/1 must be distinguishable
+    if (t0h == 0 || t0l == 0 || t1h == 0 || t1l == 0 || t0h >= t1h) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (t1h > WS2812_SYMBOL_DURATION_MAX || t0l > WS2812_SYMBOL_DURATION_MAX ||
+        reset_ticks > 2ULL * WS2812_SYMBOL_DURATION_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    timing->resolution_hz = resolution_hz;
+
+    timing->bit0.val = 0;
+    timing->bit0.level0 = 1;
+    timing->bit0.duration0 = t0h;
+    timing->bit0.level1 = 0;
+    timing->bit0.duration1 = t0l;
+
+    timing->bit1.val = 0;
+    timing->bit1.level0 = 1;
+    timing->bit1.duration0 = t1h;
+    timing->bit1.level1 = 0;
+    timing->bit1.duration1 = t1l;
+
+    // Reset code is a single low symbol split across both halves
+    timing->reset.val = 0;
+    timing->reset.level0 = 0;
+    timing->reset.duration0 = (uint16_t)(reset_ticks / 2);
+    timing->reset.level1 = 0;
+    timing->reset.duration1 = (uint16_t)(reset_ticks - reset_ticks / 2);
+
+    return ESP_OK;
+}
+
+size_t ws2812_encode(const ws2812_timing_t *timing, const uint8_t *data, size_t data_size,
+                     size_t symbols_written, ws2812_symbol_t *symbols, size_t symbols_free,
+                     bool *done)
+{
+    const size_t data_symbols = data_size * 8;
+    const uint32_t bit0 = timing->bit0.val;
+    const uint32_t bit1 = timing->bit1.val;
+    size_t pos = symbols_written;
+    size_t out = 0;
+
+    *done = false;
+
+    // Finish a partially encoded byte so the main loop can work byte-aligned
+    while ((pos & 7) != 0 && pos < data_symbols && out < symbols_free) {
+        uint8_t byte = data[pos >> 3];
+        symbols[out++].val = (byte & (0x80 >> (pos & 7))) ? bit1 : bit0;
+        pos++;
+    }
+
+    // Whole bytes, MSB first
+    while (pos < data_symbols && symbols_free - out >= 8) {
+        uint8_t byte = data[pos >> 3];
+        for (int bit = 0; bit < 8; bit++) {
+            symbols[out + bit].val = (byte & (0x80 >> bit)) ? bit1 : bit0;
+        }
+        out += 8;
+        pos += 8;
+    }
+
+    // Tail of the buffer that cannot hold a whole byte
+    while (pos < data_symbols && out < symbols_free) {
+        uint8_t byte = data[pos >> 3];
+        symbols[out++].val = (byte & (0x80 >> (pos & 7))) ? bit1 : bit0;
+        pos++;
+    }
+
+    if (pos == data_symbols && out < symbols_free) {
+        symbols[out++].val = timing->reset.val;
+        *done = true;
+    } else if (pos > data_symbols) {
+        // Caller already consumed the whole frame including the reset symbol
+        *done = true;
+    }
+
+    return out;
+}
+
+size_t ws2812_frame_symbols(size_t data_size)
+{
+    return data_size * 8 + 1;
+}
+
+uint32_t ws2812_frame_time_us(size_t num_leds)
+{
+    uint64_t bit_ns = (uint64_t)num_leds * WS2812_BITS_PER_LED * WS2812_BIT_PERIOD_NS;
+    return (uint32_t)((bit_ns + 999) / 1000) + WS2812_RESET_US;
+}
+
+float ws2812_max_fps(size_t num_leds)
+{
+    return 1000000.0f / (float)ws2812_frame_time_us(num_leds);
+}
@@ -0,0 +1,149 @@
+#include "unity.h"
+#include "led_color.h"
+#include <string.h>
+
+#define TEST_NUM_LEDS   10
+
+static led_color_config_t config;
+static uint8_t rgb[TEST_NUM_LEDS * 3];
+static led_pixel_t out[TEST_NUM_LEDS];
+
+void setUp(void) {
+    config = (led_color_config_t){
+        .gamma = 1.0f,
+        .brightness = 255,
+        .dither = false,
+        .current_limit_ma = 0,
+        .ma_per_channel = LED_COLOR_DEFAULT_MA_PER_CHANNEL,
+        .idle_ma_per_led = LED_COLOR_DEFAULT_IDLE_MA_PER_LED,
+    };
+    memset(rgb, 0, sizeof(rgb));
+    memset(out, 0, sizeof(out));
+}
+
+void tearDown(void) {
+    led_color_deinit();
+}
+
+void test_gamma_lut_is_monotonic() {
+    config.gamma = LED_COLOR_DEFAULT_GAMMA;
+    TEST_ASSERT_EQUAL(ESP_OK, led_color_init(&config, TEST_NUM_LEDS));
+
+    const uint16_t *lut = led_color_get_gamma_lut();
+    TEST_ASSERT_NOT_NULL(lut);
+    TEST_ASSERT_EQUAL(0, lut[0]);
+    TEST_ASSERT_EQUAL(255 << 8, lut[255]);
+    for (int i = 1; i < LED_COLOR_LUT_SIZE; i++) {
+        TEST_ASSERT_TRUE(lut[i] >= lut[i - 1]);
+    }
+    // Mid-grey is much darker than half in linear light
+    TEST_ASSERT_TRUE(lut[128] < (255 << 8) / 4);
+}
+
+void test_linear_full_brightness_is_identity() {
+    TEST_ASSERT_EQUAL(ESP_OK, led_color_init(&config, TEST_NUM_LEDS));
+
+    for (int i = 0; i < TEST_NUM_LEDS * 3; i++) {
+        rgb[i] = (uint8_t)(i * 25);
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, led_color_process(rgb, NULL, out));
+
+    for (int i = 0; i < TEST_NUM_LEDS; i++) {
+        TEST_ASSERT_EQUAL(rgb[i * 3], out[i].r);
+        TEST_ASSERT_EQUAL(rgb[i * 3 + 1], out[i].g);
+        TEST_ASSERT_EQUAL(rgb[i * 3 + 2], out[i].b);
+    }
+}
+
+void test_brightness_scales_output() {
+    config.brightness = 128;
+    TEST_ASSERT_EQUAL(ESP_OK, led_color_init(&config, TEST_NUM_LEDS));
+
+    memset(rgb, 200, sizeof(rgb));
+    TEST_ASSERT_EQUAL(ESP_OK, led_color_process(rgb, NULL, out));
+    TEST_ASSERT_INT_WITHIN(1, 100, out[0].r);
+
+    led_color_set_brightness(0);
+    TEST_ASSERT_EQUAL(ESP_OK, led_color_process(rgb, NULL, out));
+    TEST_ASSERT_EQUAL(0, out[0].g);
+}
+
+void test_index_map_scatters_pixels() {
+    TEST_ASSERT_EQUAL(ESP_OK, led_color_init(&config, TEST_NUM_LEDS));
+
+    uint16_t map[TEST_NUM_LEDS];
+    for (int i = 0; i < TEST_NUM_LEDS; i++) {
+        map[i] = (uint16_t)(TEST_NUM_LEDS - 1 - i);
+    }
+    rgb[0] = 10;    // Logical LED 0: R
+    rgb[1] = 20;    // G
+    rgb[2] = 30;    // B
+
+    TEST_ASSERT_EQUAL(ESP_OK, led_color_process(rgb, map, out));
+    TEST_ASSERT_EQUAL(10, out[TEST_NUM_LEDS - 1].r);
+    TEST_ASSERT_EQUAL(20, out[TEST_NUM_LEDS - 1].g);
+    TEST_ASSERT_EQUAL(30, out[TEST_NUM_LEDS - 1].b);
+    TEST_ASSERT_EQUAL(0, out[0].r);
+}
+
+void test_dither_preserves_average_level() {
+    // 1/4 brightness of level 1 is 0.25 LSB: rounding would always emit 0
+    config.brightness = 64;
+    config.dither = true;
+    TEST_ASSERT_EQUAL(ESP_OK, led_color_init(&config, TEST_NUM_LEDS));
+
+    memset(rgb, 1, sizeof(rgb));
+    uint32_t sum = 0;
+    const int frames = 256;
+    for (int f = 0; f < frames; f++) {
+        TEST_ASSERT_EQUAL(ESP_OK, led_color_process(rgb, NULL, out));
+        TEST_ASSERT_TRUE(out[3].b <= 1);
+        sum += out[3].b;
+    }
+    // 256 * 64/255 = 64.25 of 256 per frame
+    TEST_ASSERT_INT_WITHIN(1, 64, sum);
+}
+
+void test_current_limiter_caps_draw() {
+    // 10 LEDs full white: 10 * (3 * 20 + 1) = 610 mA
+    config.current_limit_ma = 310;
+    TEST_ASSERT_EQUAL(ESP_OK, led_color_init(&config, TEST_NUM_LEDS));
+
+    memset(rgb, 255, sizeof(rgb));
+    TEST_ASSERT_EQUAL(ESP_OK, led_color_process(rgb, NULL, out));
+
+    led_color_stats_t stats;
+    TEST_ASSERT_EQUAL(ESP_OK, led_color_get_stats(&stats));
+    TEST_ASSERT_EQUAL(1, stats.frames_limited);
+    TEST_ASSERT_INT_WITHIN(1, 610, stats.estimated_ma);
+    TEST_ASSERT_TRUE(stats.output_ma <= 310);
+    TEST_ASSERT_INT_WITHIN(2, 128, out[0].r);
+
+    // A dark frame stays under budget and is not touched
+    memset(rgb, 10, sizeof(rgb));
+    TEST_ASSERT_EQUAL(ESP_OK, led_color_process(rgb, NULL, out));
+    TEST_ASSERT_EQUAL(ESP_OK, led_color_get_stats(&stats));
+    TEST_ASSERT_EQUAL(1, stats.frames_limited);
+    TEST_ASSERT_EQUAL(10, out[0].r);
+}
+
+void test_process_requires_init() {
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, led_color_process(rgb, NULL, out));
+    config.gamma = 0.0f;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, led_color_init(&config, TEST_NUM_LEDS));
+}
+
+// Unity テストランナー関数
+void app_main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_gamma_lut_is_monotonic);
+    RUN_TEST(test_linear_full_brightness_is_identity);
+    RUN_TEST(test_brightness_scales_output);
+    RUN_TEST(test_index_map_scatters_pixels);
+    RUN_TEST(test_dither_preserves_average_level);
+    RUN_TEST(test_current_limiter_caps_draw);
+    RUN_TEST(test_process_requires_init);
+
+    UNITY_END();
+}
@@ -0,0 +1,105 @@
+#include "unity.h"
+#include "led_geometry.h"
+#include <string.h>
+
+static led_geometry_t geometry;
+
+void setUp(void) {
+    memset(&geometry, 0, sizeof(geometry));
+}
+
+void tearDown(void) {
+    led_geometry_free(&geometry);
+}
+
+void test_parse_two_chains() {
+    // Logical order interleaves the chains; chain 1 is wired in reverse
+    const char *text =
+        "# index,chain,position,x,y,z\n"
+        "0,0,0,0.0,0.0,1.0\n"
+        "1,1,2,1.0,0.0,0.0\n"
+        "\n"
+        "2,0,1,0.0,1.0,0.0\r\n"
+        "3,1,1,-1.0,0.0,0.0\n"
+        "4,1,0,0.0,0.0,-1.0";
+
+    TEST_ASSERT_EQUAL(ESP_OK, led_geometry_parse(text, strlen(text), &geometry));
+    TEST_ASSERT_EQUAL(5, geometry.num_leds);
+    TEST_ASSERT_EQUAL(2, geometry.num_chains);
+    TEST_ASSERT_EQUAL(2, geometry.chain_length[0]);
+    TEST_ASSERT_EQUAL(3, geometry.chain_length[1]);
+    TEST_ASSERT_EQUAL(1, geometry.leds[1].chain);
+    TEST_ASSERT_EQUAL(2, geometry.leds[1].chain_pos);
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f, geometry.leds[4].z);
+
+    uint16_t offsets[LED_GEOMETRY_MAX_CHAINS];
+    led_geometry_chain_offsets(&geometry, offsets);
+    TEST_ASSERT_EQUAL(0, offsets[0]);
+    TEST_ASSERT_EQUAL(2, offsets[1]);
+
+    uint16_t map[5];
+    const uint16_t expected[5] = {0, 4, 1, 3, 2};
+    TEST_ASSERT_EQUAL(ESP_OK, led_geometry_build_index_map(&geometry, map));
+    TEST_ASSERT_EQUAL_UINT16_ARRAY(expected, map, 5);
+}
+
+void test_parse_rejects_duplicate_index() {
+    const char *text =
+        "0,0,0,0,0,1\n"
+        "0,0,1,0,1,0\n";
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, led_geometry_parse(text, strlen(text), &geometry));
+    TEST_ASSERT_NULL(geometry.leds);
+}
+
+void test_parse_rejects_gap_in_chain() {
+    // Position 1 on chain 0 is missing
+    const char *text =
+        "0,0,0,0,0,1\n"
+        "1,0,2,0,1,0\n";
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, led_geometry_parse(text, strlen(text), &geometry));
+}
+
+void test_parse_rejects_malformed_line() {
+    const char *text =
+        "0,0,0,0,0,1\n"
+        "1,0,1,0.5\n";
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, led_geometry_parse(text, strlen(text), &geometry));
+}
+
+void test_parse_rejects_empty_file() {
+    const char *text = "# no LEDs\n\n";
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, led_geometry_parse(text, strlen(text), &geometry));
+}
+
+void test_generate_splits_chains_evenly() {
+    TEST_ASSERT_EQUAL(ESP_OK, led_geometry_generate(10, 3, &geometry));
+    TEST_ASSERT_EQUAL(10, geometry.num_leds);
+    TEST_ASSERT_EQUAL(3, geometry.num_chains);
+    TEST_ASSERT_EQUAL(4, geometry.chain_length[0]);
+    TEST_ASSERT_EQUAL(3, geometry.chain_length[1]);
+    TEST_ASSERT_EQUAL(3, geometry.chain_length[2]);
+
+    for (int i = 0; i < geometry.num_leds; i++) {
+        const led_geometry_entry_t *led = &geometry.leds[i];
+        float norm = led->x * led->x + led->y * led->y + led->z * led->z;
+        TEST_ASSERT_FLOAT_WITHIN(1e-4f, 1.0f, norm);
+    }
+
+    uint16_t map[10];
+    TEST_ASSERT_EQUAL(ESP_OK, led_geometry_build_index_map(&geometry, map));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, led_geometry_generate(2, 3, &geometry));
+}
+
+// Unity テストランナー関数
+void app_main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_parse_two_chains);
+    RUN_TEST(test_parse_rejects_duplicate_index);
+    RUN_TEST(test_parse_rejects_gap_in_chain);
+    RUN_TEST(test_parse_rejects_malformed_line);
+    RUN_TEST(test_parse_rejects_empty_file);
+    RUN_TEST(test_generate_splits_chains_evenly);
+
+    UNITY_END();
+}
@@ -0,0 +1,138 @@
+#include "unity.h"
+#include "ws2812_encoder.h"
+#include <string.h>
+
+#define TEST_RESOLUTION_HZ  10000000    // 0.1us ticks
+
+static ws2812_timing_t timing;
+
+void setUp(void) {
+    TEST_ASSERT_EQUAL(ESP_OK, ws2812_timing_init(TEST_RESOLUTION_HZ, &timing));
+}
+
+void tearDown(void) {
+}
+
+void test_timing_symbols_at_10mhz() {
+    // 0.1us ticks: T0H 0.4us, T0L 0.85us, T1H 0.8us, T1L 0.45us
+    TEST_ASSERT_EQUAL(1, timing.bit0.level0);
+    TEST_ASSERT_EQUAL(4, timing.bit0.duration0);
+    TEST_ASSERT_EQUAL(0, timing.bit0.level1);
+    TEST_ASSERT_EQUAL(9, timing.bit0.duration1);
+
+    TEST_ASSERT_EQUAL(1, timing.bit1.level0);
+    TEST_ASSERT_EQUAL(8, timing.bit1.duration0);
+    TEST_ASSERT_EQUAL(0, timing.bit1.level1);
+    TEST_ASSERT_EQUAL(5, timing.bit1.duration1);
+
+    // Reset: 300us low, split across both halves
+    TEST_ASSERT_EQUAL(0, timing.reset.level0);
+    TEST_ASSERT_EQUAL(0, timing.reset.level1);
+    TEST_ASSERT_EQUAL(3000, timing.reset.duration0 + timing.reset.duration1);
+}
+
+void test_bit_period_within_tolerance() {
+    // WS2812 accepts +/-150ns per phase; total period should stay near 1.25us
+    uint32_t period0 = timing.bit0.duration0 + timing.bit0.duration1;
+    uint32_t period1 = timing.bit1.duration0 + timing.bit1.duration1;
+    TEST_ASSERT_INT_WITHIN(2, 12, period0);
+    TEST_ASSERT_INT_WITHIN(2, 12, period1);
+}
+
+void test_timing_rejects_coarse_resolution() {
+    ws2812_timing_t coarse;
+    // 1MHz cannot distinguish a 0.4us from a 0.8us high phase
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, ws2812_timing_init(1000000, &coarse));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, ws2812_timing_init(0, &coarse));
+}
+
+void test_encode_single_pixel_msb_first() {
+    const uint8_t grb[3] = {0xA5, 0x00, 0xFF};
+    ws2812_symbol_t symbols[32];
+    bool done = false;
+
+    size_t n = ws2812_encode(&timing, grb, sizeof(grb), 0, symbols, 32, &done);
+    TEST_ASSERT_EQUAL(25, n);
+    TEST_ASSERT_TRUE(done);
+
+    // 0xA5 = 1010 0101
+    const uint8_t expected_bits[8] = {1, 0, 1, 0, 0, 1, 0, 1};
+    for (int i = 0; i < 8; i++) {
+        uint32_t expected = expected_bits[i] ? timing.bit1.val : timing.bit0.val;
+        TEST_ASSERT_EQUAL_HEX32(expected, symbols[i].val);
+    }
+    for (int i = 8; i < 16; i++) {
+        TEST_ASSERT_EQUAL_HEX32(timing.bit0.val, symbols[i].val);
+    }
+    for (int i = 16; i < 24; i++) {
+        TEST_ASSERT_EQUAL_HEX32(timing.bit1.val, symbols[i].val);
+    }
+    TEST_ASSERT_EQUAL_HEX32(timing.reset.val, symbols[24].val);
+}
+
+void test_encode_in_chunks_matches_single_pass() {
+    uint8_t grb[30];
+    for (size_t i = 0; i < sizeof(grb); i++) {
+        grb[i] = (uint8_t)(i * 37 + 11);
+    }
+
+    const size_t total = ws2812_frame_symbols(sizeof(grb));
+    ws2812_symbol_t reference[241];
+    ws2812_symbol_t chunked[241];
+    bool done = false;
+
+    TEST_ASSERT_EQUAL(241, total);
+    TEST_ASSERT_EQUAL(total, ws2812_encode(&timing, grb, sizeof(grb), 0, reference, total, &done));
+    TEST_ASSERT_TRUE(done);
+
+    // Odd chunk sizes exercise the unaligned head and tail paths
+    const size_t chunk_sizes[] = {1, 3, 7, 8, 13, 64};
+    for (size_t c = 0; c < sizeof(chunk_sizes) / sizeof(chunk_sizes[0]); c++) {
+        memset(chunked, 0, sizeof(chunked));
+        size_t written = 0;
+        done = false;
+        while (!done) {
+            size_t room = total - written < chunk_sizes[c] ? total - written : chunk_sizes[c];
+            size_t n = ws2812_encode(&timing, grb, sizeof(grb), written, &chunked[written], room, &done);
+            TEST_ASSERT_TRUE(n > 0 || done);
+            written += n;
+        }
+        TEST_ASSERT_EQUAL(total, written);
+        TEST_ASSERT_EQUAL_MEMORY(reference, chunked, sizeof(reference));
+    }
+}
+
+void test_encode_after_completion_reports_done() {
+    const uint8_t grb[3] = {1, 2, 3};
+    ws2812_symbol_t symbols[4];
+    bool done = false;
+
+    size_t n = ws2812_encode(&timing, grb, sizeof(grb), ws2812_frame_symbols(sizeof(grb)), symbols, 4, &done);
+    TEST_ASSERT_EQUAL(0, n);
+    TEST_ASSERT_TRUE(done);
+}
+
+void test_frame_time_for_long_chains() {
+    // 30us per LED plus reset
+    TEST_ASSERT_EQUAL(330, ws2812_frame_time_us(1));
+    TEST_ASSERT_EQUAL(90300, ws2812_frame_time_us(3000));
+
+    // A single 3000 LED chain caps refresh near 11Hz
+    float fps = ws2812_max_fps(3000);
+    TEST_ASSERT_TRUE(fps > 11.0f && fps < 11.1f);
+}
+
+// Unity テストランナー関数
+void app_main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_timing_symbols_at_10mhz);
+    RUN_TEST(test_bit_period_within_tolerance);
+    RUN_TEST(test_timing_rejects_coarse_resolution);
+    RUN_TEST(test_encode_single_pixel_msb_first);
+    RUN_TEST(test_encode_in_chunks_matches_single_pass);
+    RUN_TEST(test_encode_after_completion_reports_done);
+    RUN_TEST(test_frame_time_for_long_chains);
+
+    UNITY_END();
+}
@@ -0,0 +1,108 @@
+#ifndef RENDER_MATH_H
+#define RENDER_MATH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Orientation prediction limits
+#define RENDER_MATH_IMU_HISTORY             16      // IMU samples kept for prediction
+#define RENDER_MATH_MIN_VELOCITY_DT_US      5000    // Shortest baseline for angular velocity
+#define RENDER_MATH_MAX_PREDICTION_US       100000  // Longest extrapolation horizon
+
+// Unit quaternion, same layout as bno055_quaternion_t
+typedef struct {
+    float w;
+    float x;
+    float y;
+    float z;
+} render_quat_t;
+
+// Timestamped orientation sample
+typedef struct {
+    int64_t timestamp_us;
+    render_quat_t q;
+} render_imu_sample_t;
+
+// Ring of recent orientation samples
+typedef struct {
+    render_imu_sample_t samples[RENDER_MATH_IMU_HISTORY];
+    uint8_t head;       // Next slot to write
+    uint8_t count;
+} render_imu_history_t;
+
+/**
+ * @brief Hamilton product a * b
+ */
+render_quat_t render_quat_multiply(render_quat_t a, render_quat_t b);
+
+/**
+ * @brief Conjugate (inverse of a unit quaternion)
+ */
+render_quat_t render_quat_conjugate(render_quat_t q);
+
+/**
+ * @brief Normalize to unit length; returns identity for a zero quaternion
+ */
+render_quat_t render_quat_normalize(render_quat_t q);
+
+/**
+ * @brief Rotate vector v by q (q * v * q^-1)
+ *
+ * @param q Unit quaternion
+ * @param v Input vector, 3 floats
+ * @param out Rotated vector, 3 floats (may alias v)
+ */
+void render_quat_rotate(render_quat_t q, const float *v, float *out);
+
+/**
+ * @brief Append an orientation sample to the history
+ *
+ * Samples older than the newest one are ignored.
+ *
+ * @param history IMU history
+ * @param sample Orientation sample
+ */
+void render_imu_history_push(render_imu_history_t *history, const render_imu_sample_t *sample);
+
+/**
+ * @brief Predict the orientation at a given time
+ *
+ * Extrapolates the newest sample with the angular velocity measured between
+ * it and the most recent sample at least RENDER_MATH_MIN_VELOCITY_DT_US older.
+ * The horizon is clamped to RENDER_MATH_MAX_PREDICTION_US.
+ *
+ * @param history IMU history
+ * @param timestamp_us Time to predict for
+ * @param q Predicted orientation
+ * @param horizon_us Extrapolation horizon actually used (may be NULL)
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_STATE if empty
+ */
+esp_err_t render_imu_predict(const render_imu_history_t *history, int64_t timestamp_us,
+                             render_quat_t *q, int64_t *horizon_us);
+
+/**
+ * @brief Map a unit direction to equirectangular pixel coordinates
+ *
+ * Longitude runs from -pi at column 0 to +pi at the right edge, latitude
+ * from +z at row 0 down to -z at the bottom row.
+ *
+ * @param dir Unit direction, 3 floats
+ * @param width Image width in pixels
+ * @param height Image height in pixels
+ * @param col Output column, 0..width-1
+ * @param row Output row, 0..height-1
+ */
+void render_equirect_lookup(const float *dir, uint16_t width, uint16_t height,
+                            uint16_t *col, uint16_t *row);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RENDER_MATH_H
@@ -0,0 +1,172 @@
+#ifndef RENDER_SCHEDULER_H
+#define RENDER_SCHEDULER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "led_geometry.h"
+#include "render_math.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Render scheduler configuration constants
+#define RENDER_SCHEDULER_DEFAULT_IMAGE_WIDTH    320
+#define RENDER_SCHEDULER_DEFAULT_IMAGE_HEIGHT   160
+#define RENDER_SCHEDULER_DEFAULT_MAX_IMAGE_SIZE 32768   // Matches ROS2_MANAGER_FRAME_BUFFER_SIZE
+#define RENDER_SCHEDULER_DECODE_TASK_NAME       "render_decode"
+#define RENDER_SCHEDULER_RENDER_TASK_NAME       "render_output"
+#define RENDER_SCHEDULER_DEFAULT_DECODE_CORE    0
+#define RENDER_SCHEDULER_DEFAULT_RENDER_CORE    1
+#define RENDER_SCHEDULER_DEFAULT_DECODE_PRIO    5
+#define RENDER_SCHEDULER_DEFAULT_RENDER_PRIO    10
+#define RENDER_SCHEDULER_DEFAULT_STACK_SIZE     4096
+#define RENDER_SCHEDULER_DEADLINE_SLACK_US      500     // LED idle time tolerated before a miss is counted
+
+// Decode one compressed image into an RGB888 equirectangular frame
+typedef esp_err_t (*render_decode_fn_t)(const uint8_t *data, size_t size,
+                                        uint8_t *rgb, uint16_t width, uint16_t height,
+                                        void *user_ctx);
+
+// Render scheduler configuration
+typedef struct {
+    uint16_t image_width;               // Decoded equirectangular frame size
+    uint16_t image_height;
+    size_t max_image_size;              // Largest compressed image accepted
+    render_decode_fn_t decode;
+    void *decode_ctx;
+    const led_geometry_t *geometry;     // LED directions, logical order
+} render_scheduler_config_t;
+
+// Latency of one pipeline stage
+typedef struct {
+    uint32_t last_us;
+    uint32_t avg_us;                    // Exponential moving average
+    uint32_t max_us;
+} render_stage_stats_t;
+
+// Render scheduler statistics
+typedef struct {
+    uint32_t images_submitted;
+    uint32_t images_dropped;            // Replaced before the decoder picked them up
+    uint32_t images_decoded;
+    uint32_t decode_errors;
+    uint32_t imu_samples;
+    uint32_t frames_rendered;           // Includes re-renders of the same image
+    uint32_t deadline_misses;           // LED output sat idle waiting for a frame
+    render_stage_stats_t decode;        // Image arrival to decoded frame
+    render_stage_stats_t project;       // Orientation prediction and sphere lookup
+    render_stage_stats_t color;         // Gamma, dithering and scatter
+    render_stage_stats_t output_wait;   // Waiting for the previous frame to leave the wire
+    render_stage_stats_t photon_age;    // Image arrival to predicted photon time
+    uint32_t prediction_horizon_us;     // Last IMU sample to predicted photon time
+} render_scheduler_stats_t;
+
+// Function prototypes
+
+/**
+ * @brief Initialize the render scheduler
+ *
+ * led_output and led_color must be initialized first. Allocates the
+ * three compressed image slots and three decoded frames in PSRAM.
+ *
+ * @param config Render scheduler configuration
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t render_scheduler_init(const render_scheduler_config_t *config);
+
+/**
+ * @brief Deinitialize the render scheduler
+ *
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t render_scheduler_deinit(void);
+
+/**
+ * @brief Start the decode and render tasks
+ *
+ * Both tasks are placed through the task topology table under
+ * RENDER_SCHEDULER_DECODE_TASK_NAME and RENDER_SCHEDULER_RENDER_TASK_NAME;
+ * without table entries decode runs on core 0 and render on core 1.
+ * The render task re-renders the latest decoded frame once per LED frame,
+ * using the orientation predicted for the middle of that frame on the wire.
+ *
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t render_scheduler_start(void);
+
+/**
+ * @brief Stop the decode and render tasks
+ *
+ * Waits for both tasks to finish the frame they are working on.
+ *
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t render_scheduler_stop(void);
+
+/**
+ * @brief Submit a compressed image for decoding
+ *
+ * The data is copied. If the decoder has not picked up the previous image
+ * yet, that image is replaced and counted as dropped.
+ *
+ * @param data Compressed image
+ * @param size Size in bytes
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_SIZE if too large
+ */
+esp_err_t render_scheduler_submit_image(const uint8_t *data, size_t size);
+
+/**
+ * @brief Borrow the fill slot to write the next compressed image in place
+ *
+ * For a receiver that assembles images itself: it writes straight into
+ * the slot instead of into a buffer of its own that submit_image() would
+ * copy again. The slot changes with every commit, so acquire it again
+ * after render_scheduler_commit_image(). Only one task may use the slot.
+ *
+ * @param buffer Pointer to store the slot address (PSRAM)
+ * @param capacity Pointer to store the slot size, max_image_size
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t render_scheduler_acquire_image(uint8_t **buffer, size_t *capacity);
+
+/**
+ * @brief Hand the filled slot to the decoder
+ *
+ * Like render_scheduler_submit_image() without the copy: the slot becomes
+ * the pending image, replacing one the decoder has not picked up yet.
+ *
+ * @param size Size of the image written to the slot
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_SIZE if too large
+ */
+esp_err_t render_scheduler_commit_image(size_t size);
+
+/**
+ * @brief Record an orientation sample
+ *
+ * @param q Sensor orientation (e.g. a bno055_quaternion_t cast)
+ * @param timestamp_us Sample time from esp_timer_get_time()
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t render_scheduler_push_imu(const render_quat_t *q, int64_t timestamp_us);
+
+/**
+ * @brief Get render scheduler statistics
+ *
+ * @param stats Pointer to store statistics
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t render_scheduler_get_stats(render_scheduler_stats_t *stats);
+
+/**
+ * @brief Reset render scheduler statistics
+ */
+void render_scheduler_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RENDER_SCHEDULER_H
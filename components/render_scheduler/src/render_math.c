@@ -0,0 +1,155 @@
+#include "render_math.h"
+#include <math.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+render_quat_t render_quat_multiply(render_quat_t a, render_quat_t b)
+{
+    render_quat_t r = {
+        .w = a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z,
+        .x = a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+        .y = a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+        .z = a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+    };
+    return r;
+}
+
+render_quat_t render_quat_conjugate(render_quat_t q)
+{
+    render_quat_t r = { .w = q.w, .x = -q.x, .y = -q.y, .z = -q.z };
+    return r;
+}
+
+render_quat_t render_quat_normalize(render_quat_t q)
+{
+    float norm = sqrtf(q.w * q.w + q.x * q.x + q.y * q.y + q.z * q.z);
+    if (norm < 1e-6f) {
+        render_quat_t identity = { .w = 1.0f };
+        return identity;
+    }
+    render_quat_t r = { .w = q.w / norm, .x = q.x / norm, .y = q.y / norm, .z = q.z / norm };
+    return r;
+}
+
+void render_quat_rotate(render_quat_t q, const float *v, float *out)
+{
+    // v' = v + 2w(u x v) + 2u x (u x v), with u the vector part of q
+    float tx = 2.0f * (q.y * v[2] - q.z * v[1]);
+    float ty = 2.0f * (q.z * v[0] - q.x * v[2]);
+    float tz = 2.0f * (q.x * v[1] - q.y * v[0]);
+
+    float x = v[0] + q.w * tx + (q.y * tz - q.z * ty);
+    float y = v[1] + q.w * ty + (q.z * tx - q.x * tz);
+    float z = v[2] + q.w * tz + (q.x * ty - q.y * tx);
+
+    out[0] = x;
+    out[1] = y;
+    out[2] = z;
+}
+
+void render_imu_history_push(render_imu_history_t *history, const render_imu_sample_t *sample)
+{
+    if (history->count > 0) {
+        uint8_t newest = (history->head + RENDER_MATH_IMU_HISTORY - 1) % RENDER_MATH_IMU_HISTORY;
+        if (sample->timestamp_us <= history->samples[newest].timestamp_us) {
+            return;
+        }
+    }
+
+    history->samples[history->head] = *sample;
+    history->samples[history->head].q = render_quat_normalize(sample->q);
+    history->head = (history->head + 1) % RENDER_MATH_IMU_HISTORY;
+    if (history->count < RENDER_MATH_IMU_HISTORY) {
+        history->count++;
+    }
+}
+
+// Rotation of angle |omega| * dt about omega, as a quaternion
+static render_quat_t quat_from_rotation_vector(float rx, float ry, float rz)
+{
+    float angle = sqrtf(rx * rx + ry * ry + rz * rz);
+    if (angle < 1e-9f) {
+        render_quat_t identity = { .w = 1.0f };
+        return identity;
+    }
+    float s = sinf(angle * 0.5f) / angle;
+    render_quat_t r = { .w = cosf(angle * 0.5f), .x = rx * s, .y = ry * s, .z = rz * s };
+    return r;
+}
+
+esp_err_t render_imu_predict(const render_imu_history_t *history, int64_t timestamp_us,
+                             render_quat_t *q, int64_t *horizon_us)
+{
+    if (!history || !q) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (history->count == 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uint8_t newest_index = (history->head + RENDER_MATH_IMU_HISTORY - 1) % RENDER_MATH_IMU_HISTORY;
+    const render_imu_sample_t *newest = &history->samples[newest_index];
+
+    int64_t horizon = timestamp_us - newest->timestamp_us;
+    if (horizon < 0) {
+        horizon = 0;
+    } else if (horizon > RENDER_MATH_MAX_PREDICTION_US) {
+        horizon = RENDER_MATH_MAX_PREDICTION_US;
+    }
+    if (horizon_us) {
+        *horizon_us = horizon;
+    }
+
+    // Find a baseline sample far enough back for a stable velocity estimate
+    const render_imu_sample_t *base = NULL;
+    for (uint8_t i = 1; i < history->count; i++) {
+        uint8_t index = (newest_index + RENDER_MATH_IMU_HISTORY - i) % RENDER_MATH_IMU_HISTORY;
+        if (newest->timestamp_us - history->samples[index].timestamp_us >= RENDER_MATH_MIN_VELOCITY_DT_US) {
+            base = &history->samples[index];
+            break;
+        }
+    }
+
+    if (!base || horizon == 0) {
+        *q = newest->q;
+        return ESP_OK;
+    }
+
+    // World-frame rotation from base to newest, taking the short way round
+    render_quat_t delta = render_quat_multiply(newest->q, render_quat_conjugate(base->q));
+    if (delta.w < 0.0f) {
+        delta.w = -delta.w;
+        delta.x = -delta.x;
+        delta.y = -delta.y;
+        delta.z = -delta.z;
+    }
+
+    float vec_norm = sqrtf(delta.x * delta.x + delta.y * delta.y + delta.z * delta.z);
+    float angle = 2.0f * atan2f(vec_norm, delta.w);
+    float scale = 0.0f;
+    if (vec_norm > 1e-9f) {
+        float dt = (float)(newest->timestamp_us - base->timestamp_us);
+        scale = angle / vec_norm * ((float)horizon / dt);
+    }
+
+    render_quat_t step = quat_from_rotation_vector(delta.x * scale, delta.y * scale, delta.z * scale);
+    *q = render_quat_normalize(render_quat_multiply(step, newest->q));
+    return ESP_OK;
+}
+
+void render_equirect_lookup(const float *dir, uint16_t width, uint16_t height,
+                            uint16_t *col, uint16_t *row)
+{
+    float lon = atan2f(dir[1], dir[0]);
+    float z = dir[2] > 1.0f ? 1.0f : (dir[2] < -1.0f ? -1.0f : dir[2]);
+    float lat = asinf(z);
+
+    int c = (int)((lon + (float)M_PI) * (float)width / (2.0f * (float)M_PI));
+    int r = (int)(((float)M_PI * 0.5f - lat) * (float)height / (float)M_PI);
+
+    *col = (uint16_t)(c >= width ? width - 1 : (c < 0 ? 0 : c));
+    *row = (uint16_t)(r >= height ? height - 1 : (r < 0 ? 0 : r));
+}
@@ -0,0 +1,583 @@
+#include "render_scheduler.h"
+#include "led_output.h"
+#include "led_color.h"
+#include "task_topology.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+#include <string.h>
+
+static const char *TAG = "RENDER_SCHEDULER";
+
+// Decoded frames: one being rendered, one latest, one being decoded into
+#define RENDER_FRAME_COUNT      3
+#define RENDER_NO_FRAME         0xFF
+
+// Stage averages use a 1/16 exponential moving average
+#define RENDER_EMA_SHIFT        4
+
+// Placement used when the firmware task table has no entry
+static const task_topology_entry_t decode_task_defaults = {
+    .name = RENDER_SCHEDULER_DECODE_TASK_NAME,
+    .core = RENDER_SCHEDULER_DEFAULT_DECODE_CORE,
+    .priority = RENDER_SCHEDULER_DEFAULT_DECODE_PRIO,
+    .stack_size = RENDER_SCHEDULER_DEFAULT_STACK_SIZE,
+    .stack = TASK_STACK_INTERNAL,
+};
+
+static const task_topology_entry_t render_task_defaults = {
+    .name = RENDER_SCHEDULER_RENDER_TASK_NAME,
+    .core = RENDER_SCHEDULER_DEFAULT_RENDER_CORE,
+    .priority = RENDER_SCHEDULER_DEFAULT_RENDER_PRIO,
+    .stack_size = RENDER_SCHEDULER_DEFAULT_STACK_SIZE,
+    .stack = TASK_STACK_INTERNAL,
+};
+
+// Task exit bits
+#define DECODE_EXITED_BIT       BIT0
+#define RENDER_EXITED_BIT       BIT1
+
+// Decoded equirectangular frame
+typedef struct {
+    uint8_t *rgb;
+    int64_t arrival_us;     // When the compressed image was submitted
+} render_frame_t;
+
+// Global state
+static bool render_scheduler_initialized = false;
+static volatile bool render_scheduler_running = false;
+static render_scheduler_config_t current_config = {0};
+static render_scheduler_stats_t current_stats = {0};
+static portMUX_TYPE render_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Compressed image slots, swapped under image_mutex
+static SemaphoreHandle_t image_mutex = NULL;
+static uint8_t *pending_image = NULL;
+static size_t pending_size = 0;
+static int64_t pending_arrival_us = 0;
+static bool image_pending = false;
+static uint8_t *decode_image = NULL;
+static uint8_t *fill_image = NULL;      // Lent to the stream receiver, swapped in on commit
+
+// Decoded frames, indices guarded by render_lock
+static render_frame_t frames[RENDER_FRAME_COUNT];
+static uint8_t latest_frame = RENDER_NO_FRAME;
+static uint8_t rendering_frame = RENDER_NO_FRAME;
+
+// Orientation history, guarded by render_lock
+static render_imu_history_t imu_history;
+
+// Per-LED colors in logical order, written by the render task
+static uint8_t *led_rgb = NULL;
+
+// Tasks
+static TaskHandle_t decode_task_handle = NULL;
+static TaskHandle_t render_task_handle = NULL;
+static EventGroupHandle_t task_events = NULL;
+
+// Forward declarations
+static void decode_task(void *pvParameters);
+static void render_task(void *pvParameters);
+
+static void stage_record(render_stage_stats_t *stage, int64_t duration_us)
+{
+    uint32_t us = duration_us < 0 ? 0 : (uint32_t)duration_us;
+    stage->last_us = us;
+    if (stage->avg_us == 0) {
+        stage->avg_us = us;
+    } else {
+        stage->avg_us = stage->avg_us - (stage->avg_us >> RENDER_EMA_SHIFT) + (us >> RENDER_EMA_SHIFT);
+    }
+    if (us > stage->max_us) {
+        stage->max_us = us;
+    }
+}
+
+static void release_buffers(void)
+{
+    if (image_mutex) {
+        vSemaphoreDelete(image_mutex);
+        image_mutex = NULL;
+    }
+    if (task_events) {
+        vEventGroupDelete(task_events);
+        task_events = NULL;
+    }
+
+    heap_caps_free(pending_image);
+    heap_caps_free(decode_image);
+    heap_caps_free(fill_image);
+    pending_image = NULL;
+    decode_image = NULL;
+    fill_image = NULL;
+
+    for (int i = 0; i < RENDER_FRAME_COUNT; i++) {
+        heap_caps_free(frames[i].rgb);
+        frames[i].rgb = NULL;
+    }
+
+    heap_caps_free(led_rgb);
+    led_rgb = NULL;
+}
+
+esp_err_t render_scheduler_init(const render_scheduler_config_t *config)
+{
+    if (render_scheduler_initialized) {
+        ESP_LOGW(TAG, "Render scheduler already initialized");
+        return ESP_OK;
+    }
+
+    if (!config || !config->decode || !config->geometry || !config->geometry->leds) {
+        ESP_LOGE(TAG, "Invalid configuration");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint16_t num_leds = led_output_get_num_leds();
+    if (num_leds == 0 || num_leds != config->geometry->num_leds) {
+        ESP_LOGE(TAG, "LED output must be initialized with the same geometry (%u LEDs, geometry %u)",
+                 num_leds, config->geometry->num_leds);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    memcpy(&current_config, config, sizeof(render_scheduler_config_t));
+    if (current_config.image_width == 0 || current_config.image_height == 0) {
+        current_config.image_width = RENDER_SCHEDULER_DEFAULT_IMAGE_WIDTH;
+        current_config.image_height = RENDER_SCHEDULER_DEFAULT_IMAGE_HEIGHT;
+    }
+    if (current_config.max_image_size == 0) {
+        current_config.max_image_size = RENDER_SCHEDULER_DEFAULT_MAX_IMAGE_SIZE;
+    }
+
+    ESP_LOGI(TAG, "Initializing render scheduler: %ux%u frames, %u LEDs",
+             current_config.image_width, current_config.image_height, num_leds);
+
+    image_mutex = xSemaphoreCreateMutex();
+    task_events = xEventGroupCreate();
+    if (!image_mutex || !task_events) {
+        ESP_LOGE(TAG, "Failed to create synchronization primitives");
+        release_buffers();
+        return ESP_ERR_NO_MEM;
+    }
+
+    // Large buffers live in PSRAM; only the per-LED colors stay internal
+    size_t frame_size = (size_t)current_config.image_width * current_config.image_height * 3;
+    pending_image = heap_caps_malloc(current_config.max_image_size, MALLOC_CAP_SPIRAM);
+    decode_image = heap_caps_malloc(current_config.max_image_size, MALLOC_CAP_SPIRAM);
+    fill_image = heap_caps_malloc(current_config.max_image_size, MALLOC_CAP_SPIRAM);
+    for (int i = 0; i < RENDER_FRAME_COUNT; i++) {
+        frames[i].rgb = heap_caps_calloc(1, frame_size, MALLOC_CAP_SPIRAM);
+        frames[i].arrival_us = 0;
+    }
+    led_rgb = heap_caps_calloc((size_t)num_leds * 3, 1, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+
+    bool allocated = pending_image && decode_image && fill_image && led_rgb;
+    for (int i = 0; i < RENDER_FRAME_COUNT; i++) {
+        allocated = allocated && frames[i].rgb;
+    }
+    if (!allocated) {
+        ESP_LOGE(TAG, "Failed to allocate frame buffers (%zu bytes per frame)", frame_size);
+        release_buffers();
+        return ESP_ERR_NO_MEM;
+    }
+
+    image_pending = false;
+    latest_frame = RENDER_NO_FRAME;
+    rendering_frame = RENDER_NO_FRAME;
+    memset(&imu_history, 0, sizeof(imu_history));
+    memset(&current_stats, 0, sizeof(render_scheduler_stats_t));
+
+    render_scheduler_initialized = true;
+    ESP_LOGI(TAG, "Render scheduler initialized successfully");
+    return ESP_OK;
+}
+
+esp_err_t render_scheduler_deinit(void)
+{
+    if (!render_scheduler_initialized) {
+        return ESP_OK;
+    }
+
+    render_scheduler_stop();
+    release_buffers();
+    render_scheduler_initialized = false;
+
+    ESP_LOGI(TAG, "Render scheduler deinitialized");
+    return ESP_OK;
+}
+
+esp_err_t render_scheduler_start(void)
+{
+    if (!render_scheduler_initialized) {
+        ESP_LOGE(TAG, "Render scheduler not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (render_scheduler_running) {
+        ESP_LOGW(TAG, "Render scheduler already started");
+        return ESP_OK;
+    }
+
+    xEventGroupClearBits(task_events, DECODE_EXITED_BIT | RENDER_EXITED_BIT);
+    render_scheduler_running = true;
+
+    esp_err_t ret = task_topology_create_default(&decode_task_defaults, decode_task, NULL, &decode_task_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create decode task: %s", esp_err_to_name(ret));
+        decode_task_handle = NULL;
+        render_scheduler_running = false;
+        return ret;
+    }
+
+    ret = task_topology_create_default(&render_task_defaults, render_task, NULL, &render_task_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create render task: %s", esp_err_to_name(ret));
+        render_task_handle = NULL;
+        render_scheduler_stop();
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "Render scheduler started");
+    return ESP_OK;
+}
+
+esp_err_t render_scheduler_stop(void)
+{
+    if (!render_scheduler_running) {
+        return ESP_OK;
+    }
+
+    ESP_LOGI(TAG, "Stopping render scheduler");
+
+    render_scheduler_running = false;
+
+    EventBits_t wait_bits = 0;
+    if (decode_task_handle) {
+        wait_bits |= DECODE_EXITED_BIT;
+        xTaskNotifyGive(decode_task_handle);
+    }
+    if (render_task_handle) {
+        wait_bits |= RENDER_EXITED_BIT;
+    }
+    if (wait_bits) {
+        xEventGroupWaitBits(task_events, wait_bits, pdTRUE, pdTRUE, portMAX_DELAY);
+    }
+
+    decode_task_handle = NULL;
+    render_task_handle = NULL;
+
+    ESP_LOGI(TAG, "Render scheduler stopped");
+    return ESP_OK;
+}
+
+esp_err_t render_scheduler_submit_image(const uint8_t *data, size_t size)
+{
+    if (!render_scheduler_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (!data || size == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (size > current_config.max_image_size) {
+        ESP_LOGW(TAG, "Image too large: %zu bytes (max %zu)", size, current_config.max_image_size);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    int64_t now = esp_timer_get_time();
+
+    xSemaphoreTake(image_mutex, portMAX_DELAY);
+    bool replaced = image_pending;
+    memcpy(pending_image, data, size);
+    pending_size = size;
+    pending_arrival_us = now;
+    image_pending = true;
+    xSemaphoreGive(image_mutex);
+
+    portENTER_CRITICAL(&render_lock);
+    current_stats.images_submitted++;
+    if (replaced) {
+        current_stats.images_dropped++;
+    }
+    portEXIT_CRITICAL(&render_lock);
+
+    if (decode_task_handle) {
+        xTaskNotifyGive(decode_task_handle);
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t render_scheduler_acquire_image(uint8_t **buffer, size_t *capacity)
+{
+    if (!render_scheduler_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (!buffer || !capacity) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Only the producer swaps the fill slot, so it can be handed out unlocked
+    *buffer = fill_image;
+    *capacity = current_config.max_image_size;
+    return ESP_OK;
+}
+
+esp_err_t render_scheduler_commit_image(size_t size)
+{
+    if (!render_scheduler_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (size == 0 || size > current_config.max_image_size) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    int64_t now = esp_timer_get_time();
+
+    xSemaphoreTake(image_mutex, portMAX_DELAY);
+    bool replaced = image_pending;
+    uint8_t *image = pending_image;
+    pending_image = fill_image;
+    fill_image = image;
+    pending_size = size;
+    pending_arrival_us = now;
+    image_pending = true;
+    xSemaphoreGive(image_mutex);
+
+    portENTER_CRITICAL(&render_lock);
+    current_stats.images_submitted++;
+    if (replaced) {
+        current_stats.images_dropped++;
+    }
+    portEXIT_CRITICAL(&render_lock);
+
+    if (decode_task_handle) {
+        xTaskNotifyGive(decode_task_handle);
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t render_scheduler_push_imu(const render_quat_t *q, int64_t timestamp_us)
+{
+    if (!q) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    render_imu_sample_t sample = {
+        .timestamp_us = timestamp_us,
+        .q = *q,
+    };
+
+    portENTER_CRITICAL(&render_lock);
+    render_imu_history_push(&imu_history, &sample);
+    current_stats.imu_samples++;
+    portEXIT_CRITICAL(&render_lock);
+
+    return ESP_OK;
+}
+
+esp_err_t render_scheduler_get_stats(render_scheduler_stats_t *stats)
+{
+    if (!stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&render_lock);
+    memcpy(stats, &current_stats, sizeof(render_scheduler_stats_t));
+    portEXIT_CRITICAL(&render_lock);
+
+    return ESP_OK;
+}
+
+void render_scheduler_reset_stats(void)
+{
+    portENTER_CRITICAL(&render_lock);
+    memset(&current_stats, 0, sizeof(render_scheduler_stats_t));
+    portEXIT_CRITICAL(&render_lock);
+}
+
+// Pick a frame that is neither the latest nor being rendered
+static uint8_t acquire_decode_frame(void)
+{
+    uint8_t index = 0;
+    portENTER_CRITICAL(&render_lock);
+    while (index == latest_frame || index == rendering_frame) {
+        index++;
+    }
+    portEXIT_CRITICAL(&render_lock);
+    return index;
+}
+
+static void decode_task(void *pvParameters)
+{
+    ESP_LOGI(TAG, "Decode task started on core %d", xPortGetCoreID());
+
+    while (render_scheduler_running) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (!render_scheduler_running) {
+            break;
+        }
+
+        // Take ownership of the pending image by swapping slots
+        xSemaphoreTake(image_mutex, portMAX_DELAY);
+        if (!image_pending) {
+            xSemaphoreGive(image_mutex);
+            continue;
+        }
+        uint8_t *image = pending_image;
+        pending_image = decode_image;
+        decode_image = image;
+        size_t size = pending_size;
+        int64_t arrival_us = pending_arrival_us;
+        image_pending = false;
+        xSemaphoreGive(image_mutex);
+
+        uint8_t index = acquire_decode_frame();
+        esp_err_t ret = current_config.decode(image, size, frames[index].rgb,
+                                              current_config.image_width, current_config.image_height,
+                                              current_config.decode_ctx);
+        int64_t decoded_us = esp_timer_get_time();
+
+        portENTER_CRITICAL(&render_lock);
+        if (ret == ESP_OK) {
+            frames[index].arrival_us = arrival_us;
+            latest_frame = index;
+            current_stats.images_decoded++;
+            stage_record(&current_stats.decode, decoded_us - arrival_us);
+        } else {
+            current_stats.decode_errors++;
+        }
+        portEXIT_CRITICAL(&render_lock);
+
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "Image decode failed: %s", esp_err_to_name(ret));
+        }
+    }
+
+    ESP_LOGI(TAG, "Decode task stopped");
+    xEventGroupSetBits(task_events, DECODE_EXITED_BIT);
+    vTaskDelete(NULL);
+}
+
+// Sample the decoded frame at every LED direction rotated into the world frame
+static void project_frame(const render_frame_t *frame, render_quat_t orientation)
+{
+    const led_geometry_t *geometry = current_config.geometry;
+    const uint16_t width = current_config.image_width;
+    const uint16_t height = current_config.image_height;
+
+    for (uint16_t i = 0; i < geometry->num_leds; i++) {
+        const led_geometry_entry_t *led = &geometry->leds[i];
+        float dir[3] = {led->x, led->y, led->z};
+        float world[3];
+        uint16_t col, row;
+
+        render_quat_rotate(orientation, dir, world);
+        render_equirect_lookup(world, width, height, &col, &row);
+
+        const uint8_t *src = &frame->rgb[((size_t)row * width + col) * 3];
+        uint8_t *dst = &led_rgb[(size_t)i * 3];
+        dst[0] = src[0];
+        dst[1] = src[1];
+        dst[2] = src[2];
+    }
+}
+
+static void render_task(void *pvParameters)
+{
+    ESP_LOGI(TAG, "Render task started on core %d", xPortGetCoreID());
+
+    led_output_stats_t output_stats;
+    led_output_get_stats(&output_stats);
+    const int64_t frame_time_us = output_stats.frame_time_budget_us;
+    const uint32_t wait_timeout_ms = (uint32_t)(frame_time_us / 1000) * 2 + 10;
+
+    int64_t last_submit_us = 0;
+    int64_t render_estimate_us = 0;
+    bool first_frame = true;
+
+    while (render_scheduler_running) {
+        portENTER_CRITICAL(&render_lock);
+        uint8_t index = latest_frame;
+        rendering_frame = index;
+        portEXIT_CRITICAL(&render_lock);
+
+        if (index == RENDER_NO_FRAME) {
+            // Nothing decoded yet
+            vTaskDelay(pdMS_TO_TICKS(10));
+            continue;
+        }
+
+        int64_t start_us = esp_timer_get_time();
+
+        // The new frame goes on the wire when the current one is done, or as
+        // soon as it is rendered if the output is idle; photons are emitted
+        // on average half a frame later
+        int64_t wire_start_us = start_us + render_estimate_us;
+        if (!first_frame && last_submit_us + frame_time_us > wire_start_us) {
+            wire_start_us = last_submit_us + frame_time_us;
+        }
+        int64_t photon_us = wire_start_us + frame_time_us / 2;
+
+        render_imu_history_t history;
+        portENTER_CRITICAL(&render_lock);
+        memcpy(&history, &imu_history, sizeof(history));
+        portEXIT_CRITICAL(&render_lock);
+
+        render_quat_t orientation = { .w = 1.0f };
+        int64_t horizon_us = 0;
+        render_imu_predict(&history, photon_us, &orientation, &horizon_us);
+
+        project_frame(&frames[index], orientation);
+        int64_t arrival_us = frames[index].arrival_us;
+
+        portENTER_CRITICAL(&render_lock);
+        rendering_frame = RENDER_NO_FRAME;
+        portEXIT_CRITICAL(&render_lock);
+
+        int64_t projected_us = esp_timer_get_time();
+
+        // The back buffer is free while the previous frame is on the wire
+        led_color_process(led_rgb, led_output_get_index_map(), led_output_get_back_buffer());
+        int64_t rendered_us = esp_timer_get_time();
+
+        bool missed = !first_frame && !led_output_is_busy() &&
+                      rendered_us > last_submit_us + frame_time_us + RENDER_SCHEDULER_DEADLINE_SLACK_US;
+
+        led_output_wait_done(wait_timeout_ms);
+        int64_t ready_us = esp_timer_get_time();
+
+        esp_err_t ret = led_output_submit_frame();
+        if (ret == ESP_OK) {
+            last_submit_us = esp_timer_get_time();
+            first_frame = false;
+        } else {
+            ESP_LOGW(TAG, "Failed to submit LED frame: %s", esp_err_to_name(ret));
+        }
+
+        render_estimate_us = rendered_us - start_us;
+
+        portENTER_CRITICAL(&render_lock);
+        current_stats.frames_rendered++;
+        if (missed) {
+            current_stats.deadline_misses++;
+        }
+        stage_record(&current_stats.project, projected_us - start_us);
+        stage_record(&current_stats.color, rendered_us - projected_us);
+        stage_record(&current_stats.output_wait, ready_us - rendered_us);
+        stage_record(&current_stats.photon_age, photon_us - arrival_us);
+        current_stats.prediction_horizon_us = (uint32_t)horizon_us;
+        portEXIT_CRITICAL(&render_lock);
+    }
+
+    ESP_LOGI(TAG, "Render task stopped");
+    xEventGroupSetBits(task_events, RENDER_EXITED_BIT);
+    vTaskDelete(NULL);
+}
@@ -0,0 +1,144 @@
+#include "unity.h"
+#include "render_math.h"
+#include <math.h>
+#include <string.h>
+
+#define TEST_EPSILON    1e-3f
+
+static render_imu_history_t history;
+
+// Rotation of angle radians about the z axis
+static render_quat_t quat_about_z(float angle)
+{
+    render_quat_t q = { .w = cosf(angle * 0.5f), .z = sinf(angle * 0.5f) };
+    return q;
+}
+
+static void push_sample(int64_t timestamp_us, render_quat_t q)
+{
+    render_imu_sample_t sample = { .timestamp_us = timestamp_us, .q = q };
+    render_imu_history_push(&history, &sample);
+}
+
+void setUp(void) {
+    memset(&history, 0, sizeof(history));
+}
+
+void tearDown(void) {
+}
+
+void test_rotate_quarter_turn_about_z() {
+    const float x_axis[3] = {1.0f, 0.0f, 0.0f};
+    float out[3];
+
+    render_quat_rotate(quat_about_z((float)M_PI / 2.0f), x_axis, out);
+    TEST_ASSERT_FLOAT_WITHIN(TEST_EPSILON, 0.0f, out[0]);
+    TEST_ASSERT_FLOAT_WITHIN(TEST_EPSILON, 1.0f, out[1]);
+    TEST_ASSERT_FLOAT_WITHIN(TEST_EPSILON, 0.0f, out[2]);
+}
+
+void test_multiply_composes_rotations() {
+    render_quat_t a = quat_about_z(0.3f);
+    render_quat_t b = quat_about_z(0.5f);
+    render_quat_t ab = render_quat_multiply(a, b);
+    render_quat_t expected = quat_about_z(0.8f);
+
+    TEST_ASSERT_FLOAT_WITHIN(TEST_EPSILON, expected.w, ab.w);
+    TEST_ASSERT_FLOAT_WITHIN(TEST_EPSILON, expected.z, ab.z);
+
+    render_quat_t identity = render_quat_multiply(a, render_quat_conjugate(a));
+    TEST_ASSERT_FLOAT_WITHIN(TEST_EPSILON, 1.0f, identity.w);
+}
+
+void test_predict_empty_history_fails() {
+    render_quat_t q;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, render_imu_predict(&history, 1000, &q, NULL));
+}
+
+void test_predict_single_sample_holds_orientation() {
+    push_sample(1000, quat_about_z(0.4f));
+
+    render_quat_t q;
+    int64_t horizon = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, render_imu_predict(&history, 21000, &q, &horizon));
+    TEST_ASSERT_EQUAL(20000, horizon);
+    TEST_ASSERT_FLOAT_WITHIN(TEST_EPSILON, quat_about_z(0.4f).z, q.z);
+}
+
+void test_predict_extrapolates_constant_rate() {
+    // 1 rad/s about z, sampled at 100Hz
+    for (int i = 0; i <= 10; i++) {
+        push_sample(i * 10000, quat_about_z(i * 0.01f));
+    }
+
+    render_quat_t q;
+    TEST_ASSERT_EQUAL(ESP_OK, render_imu_predict(&history, 150000, &q, NULL));
+
+    // 50ms past the newest sample at 0.1 rad
+    render_quat_t expected = quat_about_z(0.15f);
+    TEST_ASSERT_FLOAT_WITHIN(TEST_EPSILON, expected.w, q.w);
+    TEST_ASSERT_FLOAT_WITHIN(TEST_EPSILON, expected.z, q.z);
+}
+
+void test_predict_clamps_horizon() {
+    push_sample(0, quat_about_z(0.0f));
+    push_sample(10000, quat_about_z(0.01f));
+
+    render_quat_t q;
+    int64_t horizon = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, render_imu_predict(&history, 10000 + 5000000, &q, &horizon));
+    TEST_ASSERT_EQUAL(RENDER_MATH_MAX_PREDICTION_US, horizon);
+
+    render_quat_t expected = quat_about_z(0.01f + 0.1f);
+    TEST_ASSERT_FLOAT_WITHIN(TEST_EPSILON, expected.z, q.z);
+}
+
+void test_history_ignores_out_of_order_samples() {
+    push_sample(20000, quat_about_z(0.2f));
+    push_sample(10000, quat_about_z(0.1f));
+    TEST_ASSERT_EQUAL(1, history.count);
+
+    for (int i = 0; i < RENDER_MATH_IMU_HISTORY + 4; i++) {
+        push_sample(30000 + i * 1000, quat_about_z(0.0f));
+    }
+    TEST_ASSERT_EQUAL(RENDER_MATH_IMU_HISTORY, history.count);
+}
+
+void test_equirect_lookup_axes() {
+    uint16_t col, row;
+
+    // +x is longitude 0: image center column, equator row
+    const float x_axis[3] = {1.0f, 0.0f, 0.0f};
+    render_equirect_lookup(x_axis, 320, 160, &col, &row);
+    TEST_ASSERT_EQUAL(160, col);
+    TEST_ASSERT_EQUAL(80, row);
+
+    // Poles map to the first and last rows
+    const float up[3] = {0.0f, 0.0f, 1.0f};
+    const float down[3] = {0.0f, 0.0f, -1.0f};
+    render_equirect_lookup(up, 320, 160, &col, &row);
+    TEST_ASSERT_EQUAL(0, row);
+    render_equirect_lookup(down, 320, 160, &col, &row);
+    TEST_ASSERT_EQUAL(159, row);
+
+    // -x wraps to the edge but stays in range
+    const float back[3] = {-1.0f, 0.0f, 0.0f};
+    render_equirect_lookup(back, 320, 160, &col, &row);
+    TEST_ASSERT_TRUE(col == 0 || col == 319);
+}
+
+// Unity テストランナー関数
+void app_main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_rotate_quarter_turn_about_z);
+    RUN_TEST(test_multiply_composes_rotations);
+    RUN_TEST(test_predict_empty_history_fails);
+    RUN_TEST(test_predict_single_sample_holds_orientation);
+    RUN_TEST(test_predict_extrapolates_constant_rate);
+    RUN_TEST(test_predict_clamps_horizon);
+    RUN_TEST(test_history_ignores_out_of_order_samples);
+    RUN_TEST(test_equirect_lookup_axes);
+
+    UNITY_END();
+}
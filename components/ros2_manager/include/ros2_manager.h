@@ -17,6 +17,7 @@ extern "C" {
 #define ROS2_MANAGER_TOPIC_NAME_MAX_LEN     128
 #define ROS2_MANAGER_FRAME_BUFFER_SIZE      32768  // 32KB for JPEG frames
 #define ROS2_MANAGER_MAX_MESSAGE_SIZE       1024
+#define ROS2_MANAGER_DEFAULT_HINT_TOPIC     "stream_hint"
 
 // ROS2 connection status
 typedef enum {
@@ -69,11 +70,25 @@ typedef struct {
     size_t data_size;       // Size of compressed data
 } ros2_compressed_image_msg_t;
 
+// Image stream settings requested from the host transcoder
+typedef struct {
+    // Header
+    uint32_t seq;
+    uint64_t timestamp_ns;
+    
+    // Recommendation
+    uint32_t bitrate_kbps;
+    uint16_t width;
+    uint16_t height;
+    uint8_t link_quality;   // 0-100, the score the recommendation is based on
+} ros2_stream_hint_msg_t;
+
 // ROS2 configuration structure
 typedef struct {
     char node_name[ROS2_MANAGER_NODE_NAME_MAX_LEN];
     char imu_topic[ROS2_MANAGER_TOPIC_NAME_MAX_LEN];
     char image_topic[ROS2_MANAGER_TOPIC_NAME_MAX_LEN];
+    char hint_topic[ROS2_MANAGER_TOPIC_NAME_MAX_LEN];  // Empty for ROS2_MANAGER_DEFAULT_HINT_TOPIC
     uint32_t publish_rate_hz;
     uint32_t connection_timeout_ms;
     bool auto_reconnect;
@@ -83,11 +98,14 @@ typedef struct {
 typedef struct {
     uint32_t messages_published;
     uint32_t messages_received;
+    uint32_t hints_published;
     uint32_t publish_errors;
     uint32_t receive_errors;
     uint32_t connection_attempts;
     uint32_t successful_connections;
     uint32_t disconnection_events;
+    uint32_t link_pauses;           // Times the link was held across a WiFi roam
+    uint32_t paused_drops;          // IMU messages dropped while the link was paused
     uint32_t total_uptime_ms;
 } ros2_statistics_t;
 
@@ -135,6 +153,26 @@ esp_err_t ros2_manager_stop(void);
  */
 esp_err_t ros2_manager_publish_imu(const ros2_imu_msg_t* imu_data);
 
+/**
+ * @brief Publish a stream quality hint for the host transcoder
+ * 
+ * Only the newest hint is kept; it is sent with the next publish cycle.
+ * 
+ * @param hint Stream hint (seq and timestamp are filled in)
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t ros2_manager_publish_stream_hint(const ros2_stream_hint_msg_t* hint);
+
+/**
+ * @brief Hold traffic while the WiFi link is briefly down
+ * 
+ * The session stays connected; the tasks stop sending and the IMU queue
+ * keeps the newest messages until the link is resumed.
+ * 
+ * @param paused True while the link is down, false to resume
+ */
+void ros2_manager_set_link_paused(bool paused);
+
 /**
  * @brief Check if ROS2 is connected
  * 
@@ -5,6 +5,7 @@
 #include "freertos/task.h"
 #include "freertos/queue.h"
 #include "freertos/timers.h"
+#include "task_topology.h"
 #include <string.h>
 #include <math.h>
 
@@ -14,6 +15,7 @@ static const char *TAG = "ROS2_MANAGER";
 static bool ros2_manager_initialized = false;
 static bool ros2_manager_started = false;
 static bool ros2_mock_mode = false;
+static volatile bool link_paused = false;
 static ros2_status_t current_status = ROS2_STATUS_DISCONNECTED;
 static ros2_manager_config_t current_config = {0};
 static ros2_statistics_t current_stats = {0};
@@ -27,12 +29,31 @@ static ros2_error_callback_t error_callback = NULL;
 static TaskHandle_t publish_task_handle = NULL;
 static TaskHandle_t subscribe_task_handle = NULL;
 static QueueHandle_t imu_publish_queue = NULL;
+static QueueHandle_t hint_publish_queue = NULL;
 static TimerHandle_t connection_timer = NULL;
 
+// Task placement used when the firmware task table has no entry
+static const task_topology_entry_t publish_task_defaults = {
+    .name = "ros2_publish",
+    .core = tskNO_AFFINITY,
+    .priority = 5,
+    .stack_size = 4096,
+    .stack = TASK_STACK_INTERNAL
+};
+
+static const task_topology_entry_t subscribe_task_defaults = {
+    .name = "ros2_subscribe",
+    .core = tskNO_AFFINITY,
+    .priority = 4,
+    .stack_size = 4096,
+    .stack = TASK_STACK_INTERNAL
+};
+
 // Internal state
 static uint32_t initialization_time = 0;
 static uint32_t last_publish_time = 0;
 static uint32_t sequence_number = 0;
+static uint32_t hint_sequence_number = 0;
 
 // Forward declarations
 static void publish_task(void *pvParameters);
@@ -42,6 +63,7 @@ static void notify_status_change(ros2_status_t new_status);
 static void notify_error(esp_err_t error, const char* message);
 static esp_err_t simulate_ros2_connection(void);
 static esp_err_t simulate_ros2_publish(const ros2_imu_msg_t* imu_data);
+static esp_err_t simulate_ros2_publish_hint(const ros2_stream_hint_msg_t* hint);
 static void simulate_image_reception(void);
 
 esp_err_t ros2_manager_init(const ros2_manager_config_t* config)
@@ -64,6 +86,9 @@ esp_err_t ros2_manager_init(const ros2_manager_config_t* config)
     
     // Copy configuration
     memcpy(&current_config, config, sizeof(ros2_manager_config_t));
+    if (current_config.hint_topic[0] == '\0') {
+        strcpy(current_config.hint_topic, ROS2_MANAGER_DEFAULT_HINT_TOPIC);
+    }
     
     // Create IMU publish queue
     imu_publish_queue = xQueueCreate(10, sizeof(ros2_imu_msg_t));
@@ -72,6 +97,14 @@ esp_err_t ros2_manager_init(const ros2_manager_config_t* config)
         return ESP_ERR_NO_MEM;
     }
     
+    // Single slot: a newer hint replaces one not yet sent
+    hint_publish_queue = xQueueCreate(1, sizeof(ros2_stream_hint_msg_t));
+    if (!hint_publish_queue) {
+        ESP_LOGE(TAG, "Failed to create hint publish queue");
+        vQueueDelete(imu_publish_queue);
+        return ESP_ERR_NO_MEM;
+    }
+    
     // Create connection timer
     connection_timer = xTimerCreate("ros2_conn_timer",
                                    pdMS_TO_TICKS(current_config.connection_timeout_ms),
@@ -81,11 +114,13 @@ esp_err_t ros2_manager_init(const ros2_manager_config_t* config)
     if (!connection_timer) {
         ESP_LOGE(TAG, "Failed to create connection timer");
         vQueueDelete(imu_publish_queue);
+        vQueueDelete(hint_publish_queue);
         return ESP_ERR_NO_MEM;
     }
     
     // Reset statistics
     memset(&current_stats, 0, sizeof(ros2_statistics_t));
+    link_paused = false;
     initialization_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
     
     // Initialize status
@@ -113,6 +148,11 @@ esp_err_t ros2_manager_deinit(void)
         imu_publish_queue = NULL;
     }
     
+    if (hint_publish_queue) {
+        vQueueDelete(hint_publish_queue);
+        hint_publish_queue = NULL;
+    }
+    
     if (connection_timer) {
         xTimerDelete(connection_timer, portMAX_DELAY);
         connection_timer = NULL;
@@ -144,13 +184,13 @@ esp_err_t ros2_manager_start(void)
     notify_status_change(ROS2_STATUS_CONNECTING);
     
     // Create publish task
-    if (xTaskCreate(publish_task, "ros2_publish", 4096, NULL, 5, &publish_task_handle) != pdPASS) {
+    if (task_topology_create_default(&publish_task_defaults, publish_task, NULL, &publish_task_handle) != ESP_OK) {
         ESP_LOGE(TAG, "Failed to create publish task");
         return ESP_ERR_NO_MEM;
     }
     
     // Create subscribe task
-    if (xTaskCreate(subscribe_task, "ros2_subscribe", 4096, NULL, 4, &subscribe_task_handle) != pdPASS) {
+    if (task_topology_create_default(&subscribe_task_defaults, subscribe_task, NULL, &subscribe_task_handle) != ESP_OK) {
         ESP_LOGE(TAG, "Failed to create subscribe task");
         vTaskDelete(publish_task_handle);
         publish_task_handle = NULL;
@@ -208,6 +248,17 @@ esp_err_t ros2_manager_publish_imu(const ros2_imu_msg_t* imu_data)
         return ESP_ERR_INVALID_ARG;
     }
     
+    if (link_paused) {
+        // Nothing drains the queue until the link is back: keep the newest samples
+        if (xQueueSend(imu_publish_queue, imu_data, 0) != pdPASS) {
+            ros2_imu_msg_t dropped;
+            xQueueReceive(imu_publish_queue, &dropped, 0);
+            xQueueSend(imu_publish_queue, imu_data, 0);
+            current_stats.paused_drops++;
+        }
+        return ESP_OK;
+    }
+    
     // Queue IMU data for publishing
     if (xQueueSend(imu_publish_queue, imu_data, pdMS_TO_TICKS(100)) != pdPASS) {
         ESP_LOGW(TAG, "IMU publish queue full, dropping message");
@@ -218,6 +269,36 @@ esp_err_t ros2_manager_publish_imu(const ros2_imu_msg_t* imu_data)
     return ESP_OK;
 }
 
+esp_err_t ros2_manager_publish_stream_hint(const ros2_stream_hint_msg_t* hint)
+{
+    if (!ros2_manager_initialized || !ros2_manager_started) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    if (!hint) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    ros2_stream_hint_msg_t msg = *hint;
+    msg.seq = hint_sequence_number++;
+    msg.timestamp_ns = (uint64_t)(xTaskGetTickCount() * portTICK_PERIOD_MS) * 1000000ULL;
+    xQueueOverwrite(hint_publish_queue, &msg);
+    return ESP_OK;
+}
+
+void ros2_manager_set_link_paused(bool paused)
+{
+    if (paused == link_paused) {
+        return;
+    }
+    
+    link_paused = paused;
+    if (paused) {
+        current_stats.link_pauses++;
+    }
+    ESP_LOGI(TAG, "Link %s", paused ? "paused" : "resumed");
+}
+
 bool ros2_manager_is_connected(void)
 {
     return (current_status == ROS2_STATUS_CONNECTED || 
@@ -371,8 +452,8 @@ static void publish_task(void *pvParameters)
         // Wait for next cycle
         vTaskDelayUntil(&xLastWakeTime, xFrequency);
         
-        // Check if we're connected
-        if (!ros2_manager_is_connected()) {
+        // Check if we're connected and the link is up
+        if (!ros2_manager_is_connected() || link_paused) {
             continue;
         }
         
@@ -399,6 +480,18 @@ static void publish_task(void *pvParameters)
             }
         }
         
+        // Stream hint, if a new one is pending
+        ros2_stream_hint_msg_t hint_msg;
+        if (xQueueReceive(hint_publish_queue, &hint_msg, 0) == pdPASS) {
+            esp_err_t result = simulate_ros2_publish_hint(&hint_msg);
+            if (result == ESP_OK) {
+                current_stats.hints_published++;
+            } else {
+                current_stats.publish_errors++;
+                notify_error(result, "Failed to publish stream hint");
+            }
+        }
+        
         // Update status back to connected if no more messages
         if (ros2_manager_is_connected() && current_status == ROS2_STATUS_PUBLISHING) {
             notify_status_change(ROS2_STATUS_CONNECTED);
@@ -416,8 +509,8 @@ static void subscribe_task(void *pvParameters)
     while (1) {
         vTaskDelayUntil(&xLastWakeTime, xFrequency);
         
-        // Check if we're connected
-        if (!ros2_manager_is_connected()) {
+        // Check if we're connected and the link is up
+        if (!ros2_manager_is_connected() || link_paused) {
             continue;
         }
         
@@ -504,6 +597,15 @@ static esp_err_t simulate_ros2_publish(const ros2_imu_msg_t* imu_data)
     return ESP_OK;
 }
 
+static esp_err_t simulate_ros2_publish_hint(const ros2_stream_hint_msg_t* hint)
+{
+    ESP_LOGI(TAG, "Publishing %s: seq=%lu, %lu kbps at %ux%u (link %u)",
+             current_config.hint_topic, hint->seq, hint->bitrate_kbps,
+             hint->width, hint->height, hint->link_quality);
+    
+    return ESP_OK;
+}
+
 static void simulate_image_reception(void)
 {
     static uint32_t sim_counter = 0;
@@ -0,0 +1,120 @@
+#ifndef TASK_TOPOLOGY_H
+#define TASK_TOPOLOGY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Task topology limits
+#define TASK_TOPOLOGY_MAX_TASKS         24
+#define TASK_TOPOLOGY_MIN_STACK_SIZE    1536
+#define TASK_TOPOLOGY_LOW_HEADROOM      512     // Report warns below this many free stack bytes
+#define TASK_TOPOLOGY_REPORT_DELAY_MS   5000    // Let tasks reach steady state before reporting
+
+// Where a task stack is allocated
+typedef enum {
+    TASK_STACK_INTERNAL = 0,    // Internal RAM, required for tasks that run while the flash cache is off
+    TASK_STACK_PSRAM            // PSRAM, for tasks that are neither latency critical nor touch flash
+} task_stack_placement_t;
+
+// One task of the firmware
+typedef struct {
+    const char *name;
+    BaseType_t core;            // 0, 1 or tskNO_AFFINITY
+    UBaseType_t priority;
+    uint32_t stack_size;        // Bytes
+    task_stack_placement_t stack;
+} task_topology_entry_t;
+
+// Function prototypes
+
+/**
+ * @brief Register the firmware task table
+ *
+ * The table is validated (unique names, valid core, priority and stack
+ * size) and must stay valid for the lifetime of the firmware.
+ *
+ * @param table Task table
+ * @param count Number of entries
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_ARG on an invalid table
+ */
+esp_err_t task_topology_init(const task_topology_entry_t *table, size_t count);
+
+/**
+ * @brief Check a task table without registering it
+ *
+ * @param table Task table
+ * @param count Number of entries
+ * @return esp_err_t ESP_OK if the table is valid
+ */
+esp_err_t task_topology_validate(const task_topology_entry_t *table, size_t count);
+
+/**
+ * @brief Look up a task by name
+ *
+ * @param name Task name
+ * @return const task_topology_entry_t* Entry, NULL if the task is not in the table
+ */
+const task_topology_entry_t *task_topology_find(const char *name);
+
+/**
+ * @brief Create a task as described by its table entry
+ *
+ * PSRAM stacks are created with xTaskCreateStaticPinnedToCore() and are not
+ * reclaimed, so they suit tasks that run for the lifetime of the firmware;
+ * creating such a task a second time fails with ESP_ERR_INVALID_STATE.
+ *
+ * @param name Task name, must be in the registered table
+ * @param function Task function
+ * @param arg Task argument
+ * @param handle Created task handle (may be NULL)
+ * @return esp_err_t ESP_OK on success, ESP_ERR_NOT_FOUND if the task is not in the table
+ */
+esp_err_t task_topology_create(const char *name, TaskFunction_t function, void *arg, TaskHandle_t *handle);
+
+/**
+ * @brief Create a component task, letting the table override its defaults
+ *
+ * Components describe the placement they need; if the firmware table has an
+ * entry with the same name, that entry is used instead.
+ *
+ * @param defaults Placement used when the task is not in the table
+ * @param function Task function
+ * @param arg Task argument
+ * @param handle Created task handle (may be NULL)
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t task_topology_create_default(const task_topology_entry_t *defaults, TaskFunction_t function,
+                                       void *arg, TaskHandle_t *handle);
+
+/**
+ * @brief Log the placement and stack high-water mark of every running task
+ *
+ * Tasks from the table are listed with their configured and actual core,
+ * priority and stack headroom; tasks not in the table are listed as
+ * unmanaged. Table tasks that are not running are reported too.
+ *
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t task_topology_report(void);
+
+/**
+ * @brief Get a printable name for a stack placement
+ *
+ * @param stack Stack placement
+ * @return const char* Placement name
+ */
+const char *task_topology_stack_to_string(task_stack_placement_t stack);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TASK_TOPOLOGY_H
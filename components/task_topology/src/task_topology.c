@@ -0,0 +1,285 @@
+#include "task_topology.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "TASK_TOPOLOGY";
+
+// Global state
+static const task_topology_entry_t *topology_table = NULL;
+static size_t topology_count = 0;
+static bool psram_stack_created[TASK_TOPOLOGY_MAX_TASKS];
+static portMUX_TYPE topology_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static esp_err_t validate_entry(const task_topology_entry_t *entry)
+{
+    if (!entry->name || entry->name[0] == '\0' || strlen(entry->name) >= configMAX_TASK_NAME_LEN) {
+        ESP_LOGE(TAG, "Invalid task name");
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (entry->core != tskNO_AFFINITY && (entry->core < 0 || entry->core >= portNUM_PROCESSORS)) {
+        ESP_LOGE(TAG, "%s: invalid core %d", entry->name, (int)entry->core);
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (entry->priority >= configMAX_PRIORITIES) {
+        ESP_LOGE(TAG, "%s: invalid priority %u", entry->name, (unsigned)entry->priority);
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (entry->stack_size < TASK_TOPOLOGY_MIN_STACK_SIZE) {
+        ESP_LOGE(TAG, "%s: stack of %lu bytes is below the %d byte minimum",
+                 entry->name, (unsigned long)entry->stack_size, TASK_TOPOLOGY_MIN_STACK_SIZE);
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (entry->stack != TASK_STACK_INTERNAL && entry->stack != TASK_STACK_PSRAM) {
+        ESP_LOGE(TAG, "%s: invalid stack placement", entry->name);
+        return ESP_ERR_INVALID_ARG;
+    }
+    return ESP_OK;
+}
+
+esp_err_t task_topology_validate(const task_topology_entry_t *table, size_t count)
+{
+    if (!table || count == 0 || count > TASK_TOPOLOGY_MAX_TASKS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        esp_err_t ret = validate_entry(&table[i]);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        for (size_t j = 0; j < i; j++) {
+            if (strcmp(table[i].name, table[j].name) == 0) {
+                ESP_LOGE(TAG, "Duplicate task name: %s", table[i].name);
+                return ESP_ERR_INVALID_ARG;
+            }
+        }
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t task_topology_init(const task_topology_entry_t *table, size_t count)
+{
+    esp_err_t ret = task_topology_validate(table, count);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    portENTER_CRITICAL(&topology_lock);
+    topology_table = table;
+    topology_count = count;
+    memset(psram_stack_created, 0, sizeof(psram_stack_created));
+    portEXIT_CRITICAL(&topology_lock);
+
+    ESP_LOGI(TAG, "Task topology registered: %u tasks", (unsigned)count);
+    return ESP_OK;
+}
+
+static int find_index(const char *name)
+{
+    if (!name) {
+        return -1;
+    }
+    for (size_t i = 0; i < topology_count; i++) {
+        if (strcmp(topology_table[i].name, name) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+const task_topology_entry_t *task_topology_find(const char *name)
+{
+    int index = find_index(name);
+    return index >= 0 ? &topology_table[index] : NULL;
+}
+
+static esp_err_t create_internal(const task_topology_entry_t *entry, TaskFunction_t function,
+                                 void *arg, TaskHandle_t *handle)
+{
+    if (xTaskCreatePinnedToCore(function, entry->name, entry->stack_size, arg,
+                                entry->priority, handle, entry->core) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create task %s", entry->name);
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t create_psram(const task_topology_entry_t *entry, TaskFunction_t function,
+                              void *arg, TaskHandle_t *handle)
+{
+    // The TCB is touched by the scheduler with the cache off, so it stays internal
+    StackType_t *stack = heap_caps_malloc(entry->stack_size, MALLOC_CAP_SPIRAM);
+    StaticTask_t *tcb = heap_caps_malloc(sizeof(StaticTask_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!stack || !tcb) {
+        ESP_LOGE(TAG, "Failed to allocate PSRAM stack for %s", entry->name);
+        heap_caps_free(stack);
+        heap_caps_free(tcb);
+        return ESP_ERR_NO_MEM;
+    }
+
+    TaskHandle_t created = xTaskCreateStaticPinnedToCore(function, entry->name, entry->stack_size, arg,
+                                                         entry->priority, stack, tcb, entry->core);
+    if (!created) {
+        ESP_LOGE(TAG, "Failed to create task %s", entry->name);
+        heap_caps_free(stack);
+        heap_caps_free(tcb);
+        return ESP_FAIL;
+    }
+
+    if (handle) {
+        *handle = created;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t create_task(const task_topology_entry_t *entry, int index, TaskFunction_t function,
+                             void *arg, TaskHandle_t *handle)
+{
+    if (entry->stack == TASK_STACK_INTERNAL) {
+        return create_internal(entry, function, arg, handle);
+    }
+
+    if (index >= 0) {
+        portENTER_CRITICAL(&topology_lock);
+        bool created = psram_stack_created[index];
+        psram_stack_created[index] = true;
+        portEXIT_CRITICAL(&topology_lock);
+
+        if (created) {
+            ESP_LOGE(TAG, "%s already has a PSRAM stack", entry->name);
+            return ESP_ERR_INVALID_STATE;
+        }
+    }
+
+    esp_err_t ret = create_psram(entry, function, arg, handle);
+    if (ret != ESP_OK && index >= 0) {
+        portENTER_CRITICAL(&topology_lock);
+        psram_stack_created[index] = false;
+        portEXIT_CRITICAL(&topology_lock);
+    }
+    return ret;
+}
+
+esp_err_t task_topology_create(const char *name, TaskFunction_t function, void *arg, TaskHandle_t *handle)
+{
+    if (!name || !function) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int index = find_index(name);
+    if (index < 0) {
+        ESP_LOGE(TAG, "Task %s is not in the topology table", name);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    return create_task(&topology_table[index], index, function, arg, handle);
+}
+
+esp_err_t task_topology_create_default(const task_topology_entry_t *defaults, TaskFunction_t function,
+                                       void *arg, TaskHandle_t *handle)
+{
+    if (!defaults || !function) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int index = find_index(defaults->name);
+    if (index >= 0) {
+        return create_task(&topology_table[index], index, function, arg, handle);
+    }
+
+    esp_err_t ret = validate_entry(defaults);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    ESP_LOGD(TAG, "%s not in the topology table, using component defaults", defaults->name);
+    return create_task(defaults, -1, function, arg, handle);
+}
+
+const char *task_topology_stack_to_string(task_stack_placement_t stack)
+{
+    switch (stack) {
+        case TASK_STACK_INTERNAL: return "internal";
+        case TASK_STACK_PSRAM: return "psram";
+        default: return "unknown";
+    }
+}
+
+static void format_core(BaseType_t core, char *buf, size_t size)
+{
+    if (core == tskNO_AFFINITY) {
+        snprintf(buf, size, "any");
+    } else {
+        snprintf(buf, size, "%d", (int)core);
+    }
+}
+
+esp_err_t task_topology_report(void)
+{
+    UBaseType_t capacity = uxTaskGetNumberOfTasks() + 4;
+    TaskStatus_t *status = malloc(capacity * sizeof(TaskStatus_t));
+    if (!status) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    UBaseType_t running = uxTaskGetSystemState(status, capacity, NULL);
+    bool listed[TASK_TOPOLOGY_MAX_TASKS] = {false};
+    char want_core[8];
+    char have_core[8];
+
+    ESP_LOGI(TAG, "=== Task Topology (%u running) ===", (unsigned)running);
+    ESP_LOGI(TAG, "%-20s %-9s %-9s %-9s %-8s %s", "task", "core", "prio", "stack", "where", "headroom");
+
+    for (UBaseType_t i = 0; i < running; i++) {
+        const TaskStatus_t *task = &status[i];
+#if configTASKLIST_INCLUDE_COREID
+        format_core(task->xCoreID, have_core, sizeof(have_core));
+#else
+        snprintf(have_core, sizeof(have_core), "?");
+#endif
+        // In ESP-IDF the high-water mark is in bytes
+        uint32_t headroom = task->usStackHighWaterMark;
+
+        int index = find_index(task->pcTaskName);
+        if (index < 0) {
+            ESP_LOGI(TAG, "%-20s %-9s %-9u %-9s %-8s %lu (unmanaged)", task->pcTaskName, have_core,
+                     (unsigned)task->uxCurrentPriority, "-", "-", (unsigned long)headroom);
+            continue;
+        }
+
+        const task_topology_entry_t *entry = &topology_table[index];
+        listed[index] = true;
+        format_core(entry->core, want_core, sizeof(want_core));
+
+        char core_col[20];
+        char prio_col[20];
+        char stack_col[16];
+        snprintf(core_col, sizeof(core_col), "%s/%s", have_core, want_core);
+        snprintf(prio_col, sizeof(prio_col), "%u/%u", (unsigned)task->uxCurrentPriority, (unsigned)entry->priority);
+        snprintf(stack_col, sizeof(stack_col), "%lu", (unsigned long)entry->stack_size);
+
+        if (headroom < TASK_TOPOLOGY_LOW_HEADROOM) {
+            ESP_LOGW(TAG, "%-20s %-9s %-9s %-9s %-8s %lu (LOW)", entry->name, core_col, prio_col, stack_col,
+                     task_topology_stack_to_string(entry->stack), (unsigned long)headroom);
+        } else {
+            ESP_LOGI(TAG, "%-20s %-9s %-9s %-9s %-8s %lu (%lu%% used)", entry->name, core_col, prio_col, stack_col,
+                     task_topology_stack_to_string(entry->stack), (unsigned long)headroom,
+                     (unsigned long)((entry->stack_size - headroom) * 100 / entry->stack_size));
+        }
+    }
+
+    for (size_t i = 0; i < topology_count; i++) {
+        if (!listed[i]) {
+            ESP_LOGI(TAG, "%-20s not running", topology_table[i].name);
+        }
+    }
+
+    free(status);
+    return ESP_OK;
+}
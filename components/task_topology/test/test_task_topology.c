@@ -0,0 +1,118 @@
+#include "unity.h"
+#include "task_topology.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <string.h>
+
+static SemaphoreHandle_t task_done;
+static volatile BaseType_t task_core;
+
+static const task_topology_entry_t test_tasks[] = {
+    { "topo_core0",  0, 5, 2048, TASK_STACK_INTERNAL },
+    { "topo_core1",  1, 5, 2048, TASK_STACK_INTERNAL },
+    { "topo_psram",  0, 3, 2048, TASK_STACK_PSRAM },
+};
+
+#define TEST_TASK_COUNT (sizeof(test_tasks) / sizeof(test_tasks[0]))
+
+// Records the core it ran on and deletes itself
+static void record_core_task(void *pvParameters)
+{
+    task_core = xPortGetCoreID();
+    xSemaphoreGive(task_done);
+    vTaskDelete(NULL);
+}
+
+void setUp(void) {
+    task_done = xSemaphoreCreateBinary();
+    task_core = -1;
+    TEST_ASSERT_EQUAL(ESP_OK, task_topology_init(test_tasks, TEST_TASK_COUNT));
+}
+
+void tearDown(void) {
+    vSemaphoreDelete(task_done);
+}
+
+void test_validate_accepts_table() {
+    TEST_ASSERT_EQUAL(ESP_OK, task_topology_validate(test_tasks, TEST_TASK_COUNT));
+}
+
+void test_validate_rejects_duplicate_names() {
+    const task_topology_entry_t table[] = {
+        { "dup", 0, 5, 2048, TASK_STACK_INTERNAL },
+        { "dup", 1, 5, 2048, TASK_STACK_INTERNAL },
+    };
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, task_topology_validate(table, 2));
+}
+
+void test_validate_rejects_bad_entries() {
+    const task_topology_entry_t bad_core = { "bad_core", portNUM_PROCESSORS, 5, 2048, TASK_STACK_INTERNAL };
+    const task_topology_entry_t bad_prio = { "bad_prio", 0, configMAX_PRIORITIES, 2048, TASK_STACK_INTERNAL };
+    const task_topology_entry_t small_stack = { "small", 0, 5, TASK_TOPOLOGY_MIN_STACK_SIZE - 1, TASK_STACK_INTERNAL };
+    const task_topology_entry_t long_name = { "name_longer_than_allowed", 0, 5, 2048, TASK_STACK_INTERNAL };
+
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, task_topology_validate(&bad_core, 1));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, task_topology_validate(&bad_prio, 1));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, task_topology_validate(&small_stack, 1));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, task_topology_validate(&long_name, 1));
+}
+
+void test_find_by_name() {
+    const task_topology_entry_t *entry = task_topology_find("topo_core1");
+    TEST_ASSERT_NOT_NULL(entry);
+    TEST_ASSERT_EQUAL(1, entry->core);
+    TEST_ASSERT_NULL(task_topology_find("missing"));
+}
+
+void test_create_unknown_task_fails() {
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, task_topology_create("missing", record_core_task, NULL, NULL));
+}
+
+void test_create_pins_to_core() {
+    TEST_ASSERT_EQUAL(ESP_OK, task_topology_create("topo_core1", record_core_task, NULL, NULL));
+    TEST_ASSERT_TRUE(xSemaphoreTake(task_done, pdMS_TO_TICKS(1000)));
+    TEST_ASSERT_EQUAL(1, task_core);
+
+    TEST_ASSERT_EQUAL(ESP_OK, task_topology_create("topo_core0", record_core_task, NULL, NULL));
+    TEST_ASSERT_TRUE(xSemaphoreTake(task_done, pdMS_TO_TICKS(1000)));
+    TEST_ASSERT_EQUAL(0, task_core);
+}
+
+void test_create_default_prefers_table_entry() {
+    // Same name as a table entry: the table wins over the component default
+    const task_topology_entry_t defaults = { "topo_core1", 0, 5, 2048, TASK_STACK_INTERNAL };
+    TEST_ASSERT_EQUAL(ESP_OK, task_topology_create_default(&defaults, record_core_task, NULL, NULL));
+    TEST_ASSERT_TRUE(xSemaphoreTake(task_done, pdMS_TO_TICKS(1000)));
+    TEST_ASSERT_EQUAL(1, task_core);
+}
+
+void test_create_default_without_table_entry() {
+    const task_topology_entry_t defaults = { "topo_default", 1, 5, 2048, TASK_STACK_INTERNAL };
+    TEST_ASSERT_EQUAL(ESP_OK, task_topology_create_default(&defaults, record_core_task, NULL, NULL));
+    TEST_ASSERT_TRUE(xSemaphoreTake(task_done, pdMS_TO_TICKS(1000)));
+    TEST_ASSERT_EQUAL(1, task_core);
+}
+
+void test_psram_stack_created_once() {
+    TEST_ASSERT_EQUAL(ESP_OK, task_topology_create("topo_psram", record_core_task, NULL, NULL));
+    TEST_ASSERT_TRUE(xSemaphoreTake(task_done, pdMS_TO_TICKS(1000)));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, task_topology_create("topo_psram", record_core_task, NULL, NULL));
+}
+
+// Unity テストランナー関数
+void app_main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_validate_accepts_table);
+    RUN_TEST(test_validate_rejects_duplicate_names);
+    RUN_TEST(test_validate_rejects_bad_entries);
+    RUN_TEST(test_find_by_name);
+    RUN_TEST(test_create_unknown_task_fails);
+    RUN_TEST(test_create_pins_to_core);
+    RUN_TEST(test_create_default_prefers_table_entry);
+    RUN_TEST(test_create_default_without_table_entry);
+    RUN_TEST(test_psram_stack_created_once);
+
+    UNITY_END();
+}
@@ -4,10 +4,15 @@
 #include <string>
 #include <vector>
 #include <functional>
+#include <atomic>
 #include "esp_err.h"
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "deadline_task.hpp"
+#include "heap_snapshot.hpp"
+
+class SoakRecorder;
 
 // Test result enum
 enum class TestResult {
@@ -19,6 +24,16 @@ enum class TestResult {
     TIMEOUT
 };
 
+// Shared hardware a test needs exclusive use of while it runs.
+// TestManager never runs two tests with overlapping resources at the same time.
+enum TestResource : uint32_t {
+    TEST_RESOURCE_NONE      = 0,
+    TEST_RESOURCE_I2C0      = 1u << 0,
+    TEST_RESOURCE_I2C1      = 1u << 1,
+    TEST_RESOURCE_WIFI      = 1u << 2,    // WiFi radio and wifi_manager state
+    TEST_RESOURCE_EXCLUSIVE = 0xFFFFFFFFu // Runs with no other test
+};
+
 // Test status structure
 struct TestStatus {
     TestResult result = TestResult::NOT_RUN;
@@ -34,6 +49,7 @@ struct TestStep {
     std::function<esp_err_t()> execute;
     uint32_t timeout_ms = 5000;
     bool critical = true;  // If true, failure stops the test
+    std::function<void()> cleanup;  // Releases what the step held if it is aborted on timeout
 };
 
 // Base test class
@@ -50,18 +66,54 @@ public:
     // Test runner
     TestResult run();
     
+    // Ask a run that exceeded its deadline to stop; it gets ABORT_GRACE_MS to return
+    static constexpr uint32_t ABORT_GRACE_MS = 2000;
+    void requestAbort() { abort_requested_ = true; }
+    // Abort a run that exceeded its deadline; the task running it must already be gone
+    void abort(uint32_t elapsed_ms);
+    
     // Getters
     const std::string& getName() const { return test_name_; }
     const std::string& getDescription() const { return test_description_; }
     const TestStatus& getStatus() const { return status_; }
+    uint32_t getResources() const { return resources_; }
+    
+    // Resource declaration, a TestResource bitmask
+    void setResources(uint32_t resources) { resources_ = resources; }
+    static uint32_t i2cResource(int port) { return TEST_RESOURCE_I2C0 << port; }
+    
+    // Tags for selection, e.g. "hardware:i2c", "network", "bench", "slow"; see TestFilter
+    void addTag(const std::string& tag);
+    void removeTag(const std::string& tag);
+    const std::vector<std::string>& getTags() const { return tags_; }
+    bool hasTag(const std::string& tag) const;
+    
+    // Heap accounting of the last run, from before setup to after teardown.
+    // A passing run that leaves more than limit_bytes allocated in any region
+    // fails, unless another test ran at the same time and shared the figures.
+    static constexpr size_t HEAP_LEAK_LIMIT_NONE = SIZE_MAX;
+    void setHeapLeakLimit(size_t limit_bytes) { heap_leak_limit_ = limit_bytes; }
+    const HeapRegionUsage& getHeapUsage(HeapRegion region) const { return heap_usage_[(size_t)region]; }
+    bool isHeapUsageShared() const { return heap_usage_shared_; }
+    
+    // Least free stack of the step workers in the last run, in bytes; DeadlineTask::STACK_UNKNOWN without steps
+    uint32_t getStackHighWaterMark() const { return stack_free_min_; }
+    
+    // Where recordLatency() goes during a soak run, set by TestManager::runSoak()
+    void setSoakRecorder(SoakRecorder* recorder, size_t index) { soak_ = recorder; soak_index_ = index; }
     
     // Test utilities
     void addStep(const std::string& name, std::function<esp_err_t()> step, 
-                 uint32_t timeout_ms = 5000, bool critical = true);
-    void logInfo(const char* format, ...);
-    void logError(const char* format, ...);
-    void logPass(const char* format, ...);
-    void logFail(const char* format, ...);
+                 uint32_t timeout_ms = 5000, bool critical = true,
+                 std::function<void()> cleanup = nullptr);
+    // Logged through TestLog; formats must be string literals
+    void logInfo(const char* format, ...) __attribute__((format(printf, 2, 3)));
+    void logError(const char* format, ...) __attribute__((format(printf, 2, 3)));
+    void logPass(const char* format, ...) __attribute__((format(printf, 2, 3)));
+    void logFail(const char* format, ...) __attribute__((format(printf, 2, 3)));
+    // Latency of one operation, e.g. a read in a stability loop. Soak windows take
+    // their percentiles from these instead of the run time; ignored outside a soak.
+    void recordLatency(uint32_t latency_us);
     
     // Static test utilities
     static std::string resultToString(TestResult result);
@@ -72,6 +124,16 @@ protected:
     std::string test_description_;
     TestStatus status_;
     std::vector<TestStep> test_steps_;
+    uint32_t resources_ = TEST_RESOURCE_NONE;
+    std::vector<std::string> tags_;
+    
+    // Cleanup hook for a run aborted on the per-test deadline, defaults to teardown()
+    virtual void onAbort() { teardown(); }
+    
+    // Set once the test or the current step is past its deadline. Steps that
+    // wait or loop check it and return ESP_ERR_TIMEOUT, releasing what they
+    // hold, rather than being deleted after the grace period.
+    bool shouldAbort() const { return abort_requested_ || step_abort_requested_; }
     
     // Protected utilities
     esp_err_t runSteps();
@@ -81,6 +143,29 @@ protected:
     void stopTimer();
 
 private:
+    DeadlineTask step_runner_;
+    std::string timed_out_step_;
+    uint32_t timed_out_step_ms_ = 0;
+    std::atomic<bool> abort_requested_{false};
+    std::atomic<bool> step_abort_requested_{false};
+    
+    // Heap accounting
+    size_t heap_leak_limit_ = HEAP_LEAK_LIMIT_NONE;
+    HeapRegionUsage heap_usage_[HEAP_REGION_COUNT];
+    bool heap_usage_shared_ = false;
+    bool running_ = false;
+    uint32_t stack_free_min_ = DeadlineTask::STACK_UNKNOWN;
+    SoakRecorder* soak_ = nullptr;
+    size_t soak_index_ = 0;
+    
+    // Runs in progress and runs started, over all tests
+    static std::atomic<uint32_t> running_tests_;
+    static std::atomic<uint32_t> runs_started_;
+    
+    TestResult runPhases();
+    TestResult checkHeapUsage(const HeapSnapshot& before, bool shared, TestResult result);
+    void endRun();
+    
     static const char* TAG;
 };
 
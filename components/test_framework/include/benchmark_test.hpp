@@ -0,0 +1,91 @@
+#ifndef BENCHMARK_TEST_HPP
+#define BENCHMARK_TEST_HPP
+
+#include "base_test.hpp"
+#include <string>
+#include <vector>
+#include <functional>
+
+// Benchmark settings
+struct BenchmarkConfig {
+    uint32_t warmup_iterations = 3;     // Untimed calls before measuring (caches, lazy init)
+    uint32_t repetitions = 50;          // Timed samples
+    uint32_t inner_iterations = 1;      // Kernel calls per sample, for kernels close to the timer overhead
+    uint32_t ops_per_call = 0;          // Operations one call performs (e.g. loads), enables ns_per_op
+    uint32_t timeout_ms = 30000;        // Step deadline for one benchmark
+};
+
+// Statistics of one benchmark; times are per kernel call
+struct BenchmarkResult {
+    std::string name;
+    uint32_t repetitions = 0;
+    uint32_t inner_iterations = 0;
+    size_t bytes_per_call = 0;
+    uint32_t ops_per_call = 0;
+    double min_ns = 0.0;
+    double median_ns = 0.0;
+    double p99_ns = 0.0;
+    double max_ns = 0.0;
+    double mean_ns = 0.0;
+    double stddev_ns = 0.0;
+    double throughput_mbps = 0.0;       // Bytes per call over the median, 0 without a byte count
+    double calls_per_sec = 0.0;         // From the median
+    double ns_per_op = 0.0;             // Median over ops_per_call, 0 without an operation count
+};
+
+// High-resolution timestamps: CPU cycle counter on the target, falling back
+// to esp_timer for intervals the 32-bit counter cannot span; steady_clock on the host
+class BenchmarkClock {
+public:
+    struct Timestamp {
+        uint32_t cycles;
+        int64_t time_ns;
+    };
+
+    static Timestamp now();
+    static uint64_t elapsedNs(const Timestamp& start, const Timestamp& end);
+};
+
+// Base class for benchmarks. Subclasses register kernels with addBenchmark()
+// in setup(); execute() runs each one as a step and logs its statistics.
+class BenchmarkTest : public BaseTest {
+public:
+    BenchmarkTest(const std::string& name, const std::string& description);
+    virtual ~BenchmarkTest() = default;
+
+    esp_err_t execute() override;
+
+    // Register a kernel; bytes_per_call enables the throughput figure
+    void addBenchmark(const std::string& name, std::function<void()> kernel, size_t bytes_per_call = 0);
+    void addBenchmark(const std::string& name, std::function<void()> kernel, size_t bytes_per_call,
+                      const BenchmarkConfig& config);
+    // prepare runs untimed right before the benchmark, e.g. to lay out data the kernel walks
+    void addBenchmark(const std::string& name, std::function<void()> prepare, std::function<void()> kernel,
+                      size_t bytes_per_call, const BenchmarkConfig& config);
+
+    void setDefaultConfig(const BenchmarkConfig& config) { default_config_ = config; }
+    const std::vector<BenchmarkResult>& getResults() const { return results_; }
+
+    // Time a kernel without a test around it; stop, checked between repetitions, ends it early
+    static BenchmarkResult measure(const std::string& name, const std::function<void()>& kernel,
+                                   size_t bytes_per_call, const BenchmarkConfig& config,
+                                   const std::function<bool()>& stop = nullptr);
+
+    // Fill the statistics of result from per-call samples; sorts the samples
+    static void computeStatistics(std::vector<double>& samples_ns, BenchmarkResult& result);
+
+    // Log a result as text and report it as a benchmark record
+    static void logResult(const std::string& test_name, const BenchmarkResult& result);
+
+protected:
+    BenchmarkConfig default_config_;
+    std::vector<BenchmarkResult> results_;
+
+private:
+    // Cost of an empty timed region, subtracted from every sample
+    static uint64_t timerOverheadNs();
+
+    static const char* TAG;
+};
+
+#endif // BENCHMARK_TEST_HPP
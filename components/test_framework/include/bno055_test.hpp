@@ -47,6 +47,7 @@ private:
     uint32_t failed_readings_;
     
     // Helper methods
+    void releaseSensor();
     esp_err_t validateQuaternion(const bno055_quaternion_t& quat);
     float calculateMagnitude(const bno055_quaternion_t& quat);
     esp_err_t checkSensorID();
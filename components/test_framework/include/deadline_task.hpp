@@ -0,0 +1,64 @@
+#ifndef DEADLINE_TASK_HPP
+#define DEADLINE_TASK_HPP
+
+#include <functional>
+#include <string>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+// Runs a function in a worker task and waits for it with a deadline.
+// At the deadline the cancel hook, if set, asks the function to return and
+// it gets a grace period to do so. A worker still running after that is
+// deleted; whatever it held must be released by the caller's cleanup hook.
+class DeadlineTask {
+public:
+    enum class Outcome {
+        COMPLETED = 0,
+        CANCELLED,      // Returned within the grace period after the cancel hook
+        TIMED_OUT       // Deleted
+    };
+
+    static constexpr uint32_t DEFAULT_STACK_SIZE = 8192;
+    static constexpr uint32_t STACK_UNKNOWN = UINT32_MAX;
+
+    explicit DeadlineTask(const std::string& name, uint32_t stack_size = DEFAULT_STACK_SIZE);
+    ~DeadlineTask();
+
+    DeadlineTask(const DeadlineTask&) = delete;
+    DeadlineTask& operator=(const DeadlineTask&) = delete;
+
+    // Run function on the caller's core and priority, waiting at most timeout_ms.
+    // If the worker cannot be created the function runs in place without a deadline.
+    Outcome run(std::function<esp_err_t()> function, uint32_t timeout_ms, esp_err_t* result = nullptr);
+
+    // Called from the waiting task at the deadline; the function should see it and return
+    void setCancel(std::function<void()> cancel, uint32_t grace_ms);
+
+    // Delete a worker still in run(), for when the task waiting on it is aborted itself
+    void kill();
+
+    uint32_t getElapsedMs() const { return elapsed_ms_; }
+    // Least free stack of the last worker in bytes, STACK_UNKNOWN if it ran in place
+    uint32_t getStackHighWaterMark() const { return stack_free_; }
+
+private:
+    std::string name_;
+    uint32_t stack_size_;
+    std::function<esp_err_t()> function_;
+    std::function<void()> cancel_;
+    uint32_t grace_ms_;
+    esp_err_t result_;
+    SemaphoreHandle_t done_;
+    TaskHandle_t worker_;
+    uint32_t elapsed_ms_;
+    uint32_t stack_free_;
+
+    static void workerEntry(void* arg);
+    void reapWorker(bool may_be_running);
+
+    static const char* TAG;
+};
+
+#endif // DEADLINE_TASK_HPP
@@ -0,0 +1,50 @@
+#ifndef HEAP_SNAPSHOT_HPP
+#define HEAP_SNAPSHOT_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Heaps tracked per test. DMA-capable memory is part of internal RAM on the
+// ESP32-S3, so DMA usage also shows up under INTERNAL.
+enum class HeapRegion : uint8_t {
+    INTERNAL = 0,
+    SPIRAM,
+    DMA
+};
+
+static constexpr size_t HEAP_REGION_COUNT = 3;
+
+// heap_caps_get_info() figures of one region
+struct HeapRegionInfo {
+    bool present = false;           // No PSRAM fitted or enabled: SPIRAM is absent
+    size_t free_bytes = 0;
+    size_t allocated_bytes = 0;
+    size_t largest_free_block = 0;
+    size_t minimum_free_bytes = 0;  // Low-water mark since boot
+    size_t allocated_blocks = 0;
+};
+
+// Change of one region over a test run, after minus before
+struct HeapRegionUsage {
+    bool present = false;
+    int32_t leaked_bytes = 0;           // Allocated and not returned
+    int32_t allocation_change = 0;      // Blocks not freed
+    int32_t largest_block_change = 0;   // Negative when the region fragmented
+    size_t largest_free_block = 0;      // After the run
+};
+
+// Heap state of all regions at one point in time
+class HeapSnapshot {
+public:
+    static HeapSnapshot capture();
+
+    const HeapRegionInfo& region(HeapRegion region) const { return regions_[(size_t)region]; }
+    HeapRegionUsage usageSince(const HeapSnapshot& before, HeapRegion region) const;
+
+    static const char* regionName(HeapRegion region);
+
+private:
+    HeapRegionInfo regions_[HEAP_REGION_COUNT];
+};
+
+#endif // HEAP_SNAPSHOT_HPP
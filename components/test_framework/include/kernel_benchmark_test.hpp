@@ -0,0 +1,45 @@
+#ifndef KERNEL_BENCHMARK_TEST_HPP
+#define KERNEL_BENCHMARK_TEST_HPP
+
+#include "benchmark_test.hpp"
+#include "led_output.h"
+#include "ws2812_encoder.h"
+#include <vector>
+
+// Benchmarks of the per-frame kernels on the LED render path, one call per
+// frame of num_leds LEDs. Uses the color pipeline, so it must not run while
+// the firmware's own LED output is active.
+class KernelBenchmarkTest : public BenchmarkTest {
+public:
+    KernelBenchmarkTest();
+    virtual ~KernelBenchmarkTest() = default;
+
+    // Implement base test methods
+    esp_err_t setup() override;
+    esp_err_t teardown() override;
+
+    // Configuration
+    void setNumLeds(uint16_t num_leds) { num_leds_ = num_leds; }
+    void setImageSize(uint16_t width, uint16_t height) { image_width_ = width; image_height_ = height; }
+
+private:
+    // Configuration
+    uint16_t num_leds_;
+    uint16_t image_width_;
+    uint16_t image_height_;
+
+    // Frame buffers
+    std::vector<uint8_t> rgb_;
+    std::vector<led_pixel_t> pixels_;
+    std::vector<float> directions_;
+    std::vector<uint16_t> lookup_;
+    std::vector<ws2812_symbol_t> symbols_;
+    ws2812_timing_t timing_;
+    bool color_initialized_;
+
+    // Kernels
+    void encodeFrame();
+    void projectFrame();
+};
+
+#endif // KERNEL_BENCHMARK_TEST_HPP
@@ -0,0 +1,57 @@
+#ifndef MEMORY_BENCHMARK_TEST_HPP
+#define MEMORY_BENCHMARK_TEST_HPP
+
+#include "benchmark_test.hpp"
+#include "freertos/semphr.h"
+#include "esp_async_memcpy.h"
+#include <vector>
+
+// Memory bandwidth and latency of PSRAM, internal SRAM and DMA-capable SRAM:
+// sequential and random read/write/copy per block size, copies between
+// regions, cache-line-stride load latency, the cost of the PSRAM cache
+// workaround barriers, and GDMA async memcpy.
+class MemoryBenchmarkTest : public BenchmarkTest {
+public:
+    MemoryBenchmarkTest();
+    virtual ~MemoryBenchmarkTest();
+
+    // Implement base test methods
+    esp_err_t setup() override;
+    esp_err_t teardown() override;
+
+    // Configuration
+    void setInternalBufferSize(size_t size) { internal_buffer_size_ = size; }
+    void setPSRAMBufferSize(size_t size) { psram_buffer_size_ = size; }
+
+private:
+    // One memory region under test
+    struct Region {
+        const char* name;
+        uint32_t caps;          // heap_caps flags
+        uint8_t* buffer;        // Two halves: source and destination of copies
+        size_t size;            // Bytes per half
+    };
+
+    // Configuration
+    size_t internal_buffer_size_;
+    size_t psram_buffer_size_;
+
+    // Test state
+    std::vector<Region> regions_;
+    async_memcpy_t async_memcpy_;
+    SemaphoreHandle_t async_done_;
+
+    // Benchmark registration
+    void addRegionBenchmarks(const Region& region);
+    void addCrossRegionBenchmarks(const Region& from, const Region& to, size_t block_size);
+    void addLatencyBenchmark(const Region& region, size_t working_set);
+    void addWorkaroundBenchmarks(const Region& psram);
+    void addAsyncMemcpyBenchmark(const Region& from, const Region& to, size_t block_size);
+
+    esp_err_t allocateRegion(const char* name, uint32_t caps, size_t size);
+    void freeRegions();
+    void logMemoryConfig();
+    static bool asyncMemcpyDone(async_memcpy_t mcp_hdl, async_memcpy_event_t* event, void* cb_args);
+};
+
+#endif // MEMORY_BENCHMARK_TEST_HPP
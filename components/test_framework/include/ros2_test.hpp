@@ -36,8 +36,8 @@ public:
     void setExpectedImageCount(int count) { expected_image_count_ = count; }
 
     // BNO055 integration
-    void setBNO055Config(const bno055_config_t& config) { bno055_config_ = config; }
-    void setEnableBNO055(bool enable) { enable_bno055_ = enable; }
+    void setBNO055Config(const bno055_config_t& config) { bno055_config_ = config; updateResources(); }
+    void setEnableBNO055(bool enable) { enable_bno055_ = enable; updateResources(); }
 
 private:
     // Configuration
@@ -76,6 +76,7 @@ private:
     void handleError(esp_err_t error, const char* message);
     
     // Helper methods
+    void updateResources();
     esp_err_t initializeBNO055();
     esp_err_t waitForConnection();
     esp_err_t publishIMUData();
@@ -0,0 +1,124 @@
+#ifndef SOAK_RECORDER_HPP
+#define SOAK_RECORDER_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "esp_err.h"
+#include "heap_snapshot.hpp"
+
+// Soak run settings, see TestManager::runSoak()
+struct SoakConfig {
+    uint32_t duration_ms = 4 * 3600 * 1000;     // Tests are looped until this much time has passed
+    uint32_t window_ms = 60 * 1000;             // Resolution of the time series
+    uint32_t max_windows = 256;                 // Rows kept; when full, neighbours are merged and windows double
+    uint32_t pause_ms = 0;                      // Between test runs
+    bool stop_on_failure = false;
+
+    // Degradation thresholds
+    uint32_t leak_bytes_per_hour = 4096;        // Free heap falling faster, or a test leaving more allocated
+    float latency_growth_percent = 20.0f;       // p95 latency growing more over the soak
+    uint32_t stack_free_min_bytes = 512;        // Step worker stacks closer to overflow
+};
+
+// One test over one window. 32 bytes, so hours of windows fit in a few KB.
+struct SoakWindow {
+    uint32_t start_ms = 0;          // Since the soak started
+    uint32_t duration_ms = 0;
+    uint16_t runs = 0;
+    uint16_t failures = 0;
+    int32_t leaked_bytes = 0;       // Left allocated by the runs, all heaps
+    uint32_t p50_us = 0;            // Latency percentiles, see SoakRecorder::recordLatency()
+    uint32_t p95_us = 0;
+    uint32_t max_us = 0;
+    uint32_t stack_free_min = UINT32_MAX;   // Bytes, UINT32_MAX when unknown
+};
+
+// Free heap over one window, lowest seen after a run; 0 for an absent region
+struct SoakHeapWindow {
+    uint32_t internal_free_min = UINT32_MAX;
+    uint32_t spiram_free_min = UINT32_MAX;
+};
+
+// A degradation found over the whole soak
+struct SoakTrend {
+    enum class Kind {
+        LEAK = 0,
+        LATENCY_GROWTH,
+        STACK_LOW,
+        FAILURES
+    };
+
+    Kind kind;
+    std::string test;               // Empty for the whole system, e.g. a heap region
+    double value;                   // Bytes per hour, percent growth, free stack bytes or failed runs
+    std::string message;
+
+    static const char* kindName(Kind kind);
+};
+
+// Time series of a soak run: per-window run counts, latency percentiles,
+// leaks, stack watermarks and free heap, in one preallocated buffer (PSRAM
+// when fitted). Recording allocates nothing, so it does not disturb the
+// heap figures it records.
+class SoakRecorder {
+public:
+    static constexpr size_t SAMPLES_PER_WINDOW = 128;  // Latencies kept per test and window, the latest
+    static constexpr size_t MIN_TREND_WINDOWS = 4;
+
+    SoakRecorder() = default;
+    ~SoakRecorder();
+
+    SoakRecorder(const SoakRecorder&) = delete;
+    SoakRecorder& operator=(const SoakRecorder&) = delete;
+
+    esp_err_t begin(const std::vector<std::string>& test_names, const SoakConfig& config);
+    void end();
+
+    // Latency of one operation within a run, e.g. a sensor read in a stability loop.
+    // A run that records none counts its own run time as its one sample.
+    void recordLatency(size_t test, uint32_t latency_us);
+    void recordRun(size_t test, uint32_t run_us, bool passed, int32_t leaked_bytes, uint32_t stack_free);
+    void recordHeap(const HeapSnapshot& snapshot);
+
+    // Close the current window at elapsed_ms, unless nothing ran in it;
+    // closeWindowIfDue() only once it is a window long. True when a row was added.
+    bool closeWindow(uint32_t elapsed_ms);
+    bool closeWindowIfDue(uint32_t elapsed_ms);
+
+    // Degradations over the closed windows
+    std::vector<SoakTrend> analyze() const;
+
+    size_t getTestCount() const { return test_names_.size(); }
+    const std::string& getTestName(size_t test) const { return test_names_[test]; }
+    size_t getWindowCount() const { return rows_; }
+    const SoakWindow& getWindow(size_t row, size_t test) const { return windows_[row * test_names_.size() + test]; }
+    const SoakHeapWindow& getHeapWindow(size_t row) const { return heap_windows_[row]; }
+    uint32_t getWindowMs() const { return window_ms_; }
+
+private:
+    SoakConfig config_;
+    std::vector<std::string> test_names_;
+    uint8_t* buffer_ = nullptr;
+    SoakWindow* windows_ = nullptr;         // rows x tests
+    SoakHeapWindow* heap_windows_ = nullptr;
+    uint32_t* samples_ = nullptr;           // tests x SAMPLES_PER_WINDOW, the open window
+    uint32_t* sample_counts_ = nullptr;     // Per test, samples taken in the open window
+    uint32_t* run_latencies_ = nullptr;     // Per test, latencies recorded since the last run ended
+    size_t capacity_ = 0;
+    size_t rows_ = 0;
+    uint32_t window_ms_ = 0;
+    uint32_t window_start_ms_ = 0;
+
+    // The open window
+    SoakWindow* current_ = nullptr;         // One per test, past the last row
+    SoakHeapWindow current_heap_;
+
+    void compact();
+    static void merge(SoakWindow& into, const SoakWindow& next);
+
+    static const char* TAG;
+};
+
+#endif // SOAK_RECORDER_HPP
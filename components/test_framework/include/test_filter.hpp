@@ -0,0 +1,75 @@
+#ifndef TEST_FILTER_HPP
+#define TEST_FILTER_HPP
+
+#include <memory>
+#include <regex>
+#include <string>
+#include <vector>
+#include "esp_err.h"
+#include "base_test.hpp"
+
+// Boolean expression over test tags: tag globs combined with ! (not),
+// & (and), | (or) and parentheses, e.g. "hardware:* & !slow | bench"
+class TagExpression {
+public:
+    esp_err_t parse(const std::string& expression);
+    bool empty() const { return nodes_.empty(); }
+    bool matches(const std::vector<std::string>& tags) const;
+
+private:
+    enum class Op : uint8_t { TAG, NOT, AND, OR };
+    struct Node {
+        Op op;
+        int left;
+        int right;
+        std::string tag;
+    };
+
+    std::vector<Node> nodes_;
+    int root_ = -1;
+
+    // Recursive descent over the text, one level per precedence
+    int parseOr(const std::string& text, size_t& pos);
+    int parseAnd(const std::string& text, size_t& pos);
+    int parseUnary(const std::string& text, size_t& pos);
+    int addNode(Op op, int left, int right, const std::string& tag = "");
+    bool evaluate(int node, const std::vector<std::string>& tags) const;
+};
+
+// Test selection by name, tags and shard. Names match a pattern:
+// "/regex/", a glob with * ? or [set], or else a substring; all ignore case.
+// Sharding splits what name and tags select over shard_count boards.
+class TestFilter {
+public:
+    // Plain pattern, or fields separated by ';': "name=PATTERN;tags=EXPRESSION;shard=N/M"
+    esp_err_t parse(const std::string& spec);
+
+    esp_err_t setNamePattern(const std::string& pattern);
+    esp_err_t setTagExpression(const std::string& expression);
+    // shard counts from 1 to shard_count
+    esp_err_t setShard(uint32_t shard, uint32_t shard_count);
+
+    bool matches(const BaseTest& test) const;
+    // Tests in the shard, in registration order
+    std::vector<std::shared_ptr<BaseTest>> select(const std::vector<std::shared_ptr<BaseTest>>& tests) const;
+
+    std::string describe() const;
+
+    // Whole-string glob match ignoring case
+    static bool globMatch(const char* pattern, const char* text);
+
+private:
+    enum class NameMode : uint8_t { ALL, SUBSTRING, GLOB, REGEX };
+
+    NameMode name_mode_ = NameMode::ALL;
+    std::string name_pattern_;
+    std::regex name_regex_;
+    std::string tag_text_;
+    TagExpression tags_;
+    uint32_t shard_ = 1;
+    uint32_t shard_count_ = 1;
+
+    static const char* TAG;
+};
+
+#endif // TEST_FILTER_HPP
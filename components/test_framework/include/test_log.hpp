@@ -0,0 +1,100 @@
+#ifndef TEST_LOG_HPP
+#define TEST_LOG_HPP
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+// Log path of BaseTest. Immediate by default. In deferred mode a record
+// (format pointer, raw arguments, copies of %s strings) goes into a
+// preallocated ring without formatting or allocating; a low-priority task
+// formats and prints the records whenever no test run is in progress, so
+// console I/O stays out of the measured sections.
+//
+// Formats must be string literals: only the pointer is kept.
+class TestLog {
+public:
+    enum class Level : uint8_t {
+        INFO = 0,
+        ERROR,
+        PASS,       // Info with a check mark
+        FAIL,       // Error with a cross
+        RAW         // Preformatted line printed as-is, e.g. TestReporter records
+    };
+
+    static constexpr size_t DEFAULT_RING_SIZE = 16 * 1024;
+    static constexpr size_t MAX_RECORD_SIZE = 640;     // Longer raw lines are written immediately
+    static constexpr size_t MAX_ARGS = 16;
+
+    // A formatted record
+    struct Entry {
+        Level level;
+        const char* tag;
+        uint32_t time_ms;           // When it was logged
+        char test_name[32];
+        char message[MAX_RECORD_SIZE];
+    };
+
+    // Allocate the ring (PSRAM when fitted) and start the formatter task
+    static esp_err_t enableDeferred(size_t ring_size = DEFAULT_RING_SIZE);
+    // Print what is pending and log immediately again; the ring is kept for re-enabling
+    static void disableDeferred();
+    static bool isDeferred() { return deferred_; }
+
+    static void write(const char* tag, Level level, const char* test_name, const char* format, va_list args)
+        __attribute__((format(printf, 4, 0)));
+    static void log(const char* tag, Level level, const char* test_name, const char* format, ...)
+        __attribute__((format(printf, 4, 5)));
+    static void writeRaw(const char* prefix, const char* text);
+
+    // Test runs in progress hold back formatting; nests across parallel tests
+    static void beginTimedSection();
+    static void endTimedSection();
+
+    // Print pending records in the calling task, unless a test run is in progress
+    static void flush();
+
+    // Take the oldest record, formatted; false when the ring is empty
+    static bool pop(Entry& entry);
+
+    static uint32_t getDroppedCount() { return dropped_; }
+
+private:
+    struct RecordHeader {
+        uint16_t size;              // Whole record, 8-byte aligned; 0 pads to the end of the ring
+        Level level;
+        uint8_t arg_count;
+        uint32_t time_ms;
+        const char* tag;
+        const char* format;         // nullptr: the payload after the name is the text
+    };
+
+    static bool deferred_;
+    static uint8_t* ring_;
+    static size_t ring_size_;
+    static uint32_t write_pos_;
+    static uint32_t read_pos_;
+    static uint32_t used_;          // Bytes between read and write, padding included
+    static uint32_t dropped_;
+    static int timed_sections_;
+    static portMUX_TYPE lock_;
+    static SemaphoreHandle_t drain_mutex_;
+    static SemaphoreHandle_t wake_;
+    static TaskHandle_t formatter_;
+
+    static void writeImmediate(const char* tag, Level level, const char* test_name, const char* message);
+    static size_t packRecord(uint8_t* record, const char* tag, Level level, const char* test_name,
+                             const char* format, va_list args);
+    static bool push(const uint8_t* record, size_t size);
+    static void drain();
+    static void formatMessage(const RecordHeader& header, const uint8_t* record, char* out, size_t size);
+    static void formatterTask(void* arg);
+
+    static const char* TAG;
+};
+
+#endif // TEST_LOG_HPP
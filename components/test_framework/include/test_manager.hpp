@@ -2,6 +2,9 @@
 #define TEST_MANAGER_HPP
 
 #include "base_test.hpp"
+#include "soak_recorder.hpp"
+#include "test_filter.hpp"
+#include "freertos/queue.h"
 #include <vector>
 #include <memory>
 #include <functional>
@@ -18,12 +21,22 @@ public:
     // Test execution
     bool runAllTests();
     bool runTest(const std::string& test_name);
-    bool runTestsMatching(const std::string& pattern);
+    bool runTestsMatching(const std::string& pattern);     // Name pattern, see TestFilter
+    bool runSelected(const TestFilter& filter);
+    
+    // Loop the selected tests, one at a time, for config.duration_ms and
+    // record a time series of them. False on failed runs or degradation trends.
+    bool runSoak(const std::string& pattern, const SoakConfig& config = SoakConfig());
+    bool runSoak(const TestFilter& filter, const SoakConfig& config = SoakConfig());
+    const SoakRecorder& getSoakRecorder() const { return soak_; }
     
     // Test control
     void setStopOnFirstFailure(bool stop) { stop_on_first_failure_ = stop; }
     void setParallelExecution(bool parallel) { parallel_execution_ = parallel; }
     void setTestTimeout(uint32_t timeout_ms) { test_timeout_ms_ = timeout_ms; }
+    void setMaxParallelTests(uint32_t max_tests) { max_parallel_tests_ = max_tests > 0 ? max_tests : 1; }
+    void setStructuredOutput(bool enabled);     // JSON result records, see TestReporter
+    esp_err_t setDeferredLogging(bool enabled); // Test logs printed between test runs, see TestLog
     
     // Results and reporting
     void printTestResults();
@@ -33,6 +46,7 @@ public:
     // Test information
     size_t getTestCount() const { return tests_.size(); }
     std::vector<std::string> getTestNames() const;
+    std::vector<std::string> getTestNames(const TestFilter& filter) const;
     BaseTest* getTest(const std::string& name);
     
     // Statistics
@@ -42,7 +56,8 @@ public:
         uint32_t failed_tests = 0;
         uint32_t skipped_tests = 0;
         uint32_t timeout_tests = 0;
-        uint32_t total_duration_ms = 0;
+        uint32_t total_duration_ms = 0;     // Sum of test durations
+        uint32_t elapsed_ms = 0;            // Wall-clock time of the last run
         float success_rate = 0.0f;
     };
     
@@ -52,6 +67,7 @@ private:
     std::vector<std::shared_ptr<BaseTest>> tests_;
     bool stop_on_first_failure_;
     bool parallel_execution_;
+    uint32_t max_parallel_tests_;
     uint32_t test_timeout_ms_;
     
     // Results tracking
@@ -59,17 +75,35 @@ private:
     uint32_t execution_start_time_;
     uint32_t execution_end_time_;
     
+    // Time series of the last soak run
+    SoakRecorder soak_;
+    
+    // Parallel execution, one pinned worker task per running test.
+    // The test itself runs in a deadline task started by the worker.
+    static constexpr uint32_t WORKER_STACK_SIZE = 4096;
+    struct WorkerContext {
+        TestManager* manager;
+        std::shared_ptr<BaseTest> test;
+        QueueHandle_t done_queue;
+        BaseType_t core;
+        bool passed;
+        TaskHandle_t task;      // Deleted by runParallel() once it reports, null if run in place
+    };
+    static void workerTask(void* arg);
+    
     // Helper methods
+    bool runTestList(const std::vector<std::shared_ptr<BaseTest>>& tests);
+    bool runSequential(const std::vector<std::shared_ptr<BaseTest>>& tests);
+    bool runParallel(const std::vector<std::shared_ptr<BaseTest>>& tests);
+    void reportRunEnd(const std::vector<std::shared_ptr<BaseTest>>& tests, uint32_t elapsed_ms);
     bool executeTest(std::shared_ptr<BaseTest> test);
-    bool checkTestTimeout(std::shared_ptr<BaseTest> test, uint32_t start_time);
+    TestResult runWithDeadline(std::shared_ptr<BaseTest> test, uint32_t* stack_free = nullptr);
+    void reportSoakWindow();
     void updateOverallResult(TestResult test_result);
     void logTestStart(const std::string& test_name);
     void logTestEnd(const std::string& test_name, TestResult result, uint32_t duration_ms);
     void logExecutionSummary();
     
-    // Pattern matching
-    bool matchesPattern(const std::string& text, const std::string& pattern);
-    
     // Formatting helpers
     const char* getResultIcon(TestResult result);
     const char* getResultColorCode(TestResult result);
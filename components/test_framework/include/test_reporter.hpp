@@ -0,0 +1,47 @@
+#ifndef TEST_REPORTER_HPP
+#define TEST_REPORTER_HPP
+
+#include "base_test.hpp"
+#include "benchmark_test.hpp"
+#include "soak_recorder.hpp"
+#include <string>
+
+// Prefix of every record line; host/tools/test_report collects these from a serial log
+#define TEST_REPORT_PREFIX "@TR "
+
+// Machine-readable result stream: one JSON object per line for every step,
+// test, benchmark, soak window and run, next to the human-readable log
+class TestReporter {
+public:
+    static void setEnabled(bool enabled) { enabled_ = enabled; }
+    static bool isEnabled() { return enabled_; }
+
+    static void runStart(size_t test_count, bool parallel);
+    static void runEnd(TestResult result, uint32_t total, uint32_t passed, uint32_t failed,
+                       uint32_t skipped, uint32_t timeout, uint32_t elapsed_ms, uint32_t test_time_ms);
+    static void step(const std::string& test_name, const std::string& step_name, esp_err_t error,
+                     uint32_t duration_ms, bool timed_out);
+    static void test(const BaseTest& test);
+    static void benchmark(const std::string& test_name, const BenchmarkResult& result);
+    static void heap(const std::string& test_name, HeapRegion region, const HeapRegionUsage& usage, bool shared);
+    static void soakWindow(const std::string& test_name, const SoakWindow& window,
+                           const SoakHeapWindow& heap);
+    static void soakTrend(const SoakTrend& trend);
+
+    // JSON string body with quotes, backslashes and control characters escaped
+    static std::string escape(const std::string& text);
+    // Same into a buffer, without allocating; cut short to fit
+    static void escape(const char* text, char* out, size_t size);
+
+private:
+    static constexpr size_t MAX_NAME_SIZE = 96;     // Escaped test, step and benchmark names in records
+
+    static void escapeChar(char c, char* code);
+    static void emit(const char* json);
+    // Record from a literal format starting with TEST_REPORT_PREFIX, through TestLog
+    static void emitFormat(const char* format, ...) __attribute__((format(printf, 1, 2)));
+
+    static bool enabled_;
+};
+
+#endif // TEST_REPORTER_HPP
@@ -1,25 +1,123 @@
 #include "base_test.hpp"
+#include "test_reporter.hpp"
+#include "test_log.hpp"
+#include "soak_recorder.hpp"
+#include <algorithm>
 #include <cstdarg>
+#include <cstdio>
 #include <cstring>
+#include <strings.h>
 
 const char* BaseTest::TAG = "BaseTest";
 
+std::atomic<uint32_t> BaseTest::running_tests_{0};
+std::atomic<uint32_t> BaseTest::runs_started_{0};
+
 BaseTest::BaseTest(const std::string& name, const std::string& description)
-    : test_name_(name), test_description_(description)
+    : test_name_(name), test_description_(description),
+      step_runner_("step_" + name)
 {
     status_.result = TestResult::NOT_RUN;
     status_.message = "";
     status_.duration_ms = 0;
     status_.start_time = 0;
     status_.error_code = 0;
+    
+    // Status messages fit, so updating them does not show up as heap use
+    status_.message.reserve(96);
+    
+    step_runner_.setCancel([this]() { step_abort_requested_ = true; }, ABORT_GRACE_MS);
 }
 
 TestResult BaseTest::run()
+{
+    running_ = true;
+    abort_requested_ = false;
+    TestLog::beginTimedSection();
+    bool shared = running_tests_.fetch_add(1) > 0;
+    uint32_t run_id = runs_started_.fetch_add(1) + 1;
+    for (auto& usage : heap_usage_) {
+        usage = HeapRegionUsage();
+    }
+    stack_free_min_ = DeadlineTask::STACK_UNKNOWN;
+    HeapSnapshot before = HeapSnapshot::capture();
+    
+    TestResult result = runPhases();
+    if (abort_requested_) {
+        // Stopped within the grace period, so teardown ran and the heap is checked
+        logFail("Test timed out after %lu ms, stopped", (unsigned long)status_.duration_ms);
+        char message[64];
+        snprintf(message, sizeof(message), "Test timed out after %lu ms", (unsigned long)status_.duration_ms);
+        updateStatus(TestResult::TIMEOUT, message);
+        result = TestResult::TIMEOUT;
+    }
+    
+    endRun();
+    shared = shared || runs_started_.load() != run_id;
+    return checkHeapUsage(before, shared, result);
+}
+
+void BaseTest::endRun()
+{
+    // Steps are registered by setup() for one run
+    std::vector<TestStep>().swap(test_steps_);
+    
+    if (running_) {
+        running_tests_.fetch_sub(1);
+        running_ = false;
+        TestLog::endTimedSection();
+    }
+}
+
+TestResult BaseTest::checkHeapUsage(const HeapSnapshot& before, bool shared, TestResult result)
+{
+    HeapSnapshot after = HeapSnapshot::capture();
+    heap_usage_shared_ = shared;
+    
+    int exceeded = -1;
+    for (size_t i = 0; i < HEAP_REGION_COUNT; i++) {
+        HeapRegion region = (HeapRegion)i;
+        heap_usage_[i] = after.usageSince(before, region);
+        const HeapRegionUsage& usage = heap_usage_[i];
+        if (!usage.present) {
+            continue;
+        }
+        
+        logInfo("Heap %s: %+ld bytes in %+ld blocks, largest free block %u bytes (%+ld)%s",
+                HeapSnapshot::regionName(region), (long)usage.leaked_bytes, (long)usage.allocation_change,
+                (unsigned)usage.largest_free_block, (long)usage.largest_block_change,
+                shared ? ", shared with concurrent tests" : "");
+        TestReporter::heap(test_name_, region, usage, shared);
+        
+        if (exceeded < 0 && usage.leaked_bytes > 0 && (size_t)usage.leaked_bytes > heap_leak_limit_) {
+            exceeded = i;
+        }
+    }
+    
+    if (exceeded < 0 || result != TestResult::PASSED) {
+        return result;
+    }
+    if (shared) {
+        logInfo("Heap leak limit not enforced, other tests ran at the same time");
+        return result;
+    }
+    
+    char message[96];
+    snprintf(message, sizeof(message), "Leaked %ld bytes of %s heap (limit %u)",
+             (long)heap_usage_[exceeded].leaked_bytes, HeapSnapshot::regionName((HeapRegion)exceeded),
+             (unsigned)heap_leak_limit_);
+    logFail("%s", message);
+    updateStatus(TestResult::FAILED, message);
+    return TestResult::FAILED;
+}
+
+TestResult BaseTest::runPhases()
 {
     logInfo("Starting test: %s", test_name_.c_str());
     logInfo("Description: %s", test_description_.c_str());
     
     updateStatus(TestResult::RUNNING, "Test execution started");
+    timed_out_step_.clear();
     startTimer();
     
     esp_err_t result = ESP_OK;
@@ -40,12 +138,20 @@ TestResult BaseTest::run()
     result = execute();
     if (result != ESP_OK) {
         stopTimer();
-        updateStatus(TestResult::FAILED, "Execute phase failed");
         logError("Execute failed with error: %s", esp_err_to_name(result));
         
         // Still run teardown even if execute failed
         logInfo("=== Teardown Phase ===");
         teardown();
+        
+        if (!timed_out_step_.empty()) {
+            char message[96];
+            snprintf(message, sizeof(message), "Step '%s' timed out after %lu ms",
+                     timed_out_step_.c_str(), (unsigned long)timed_out_step_ms_);
+            updateStatus(TestResult::TIMEOUT, message);
+            return TestResult::TIMEOUT;
+        }
+        updateStatus(TestResult::FAILED, "Execute phase failed");
         return TestResult::FAILED;
     }
     logPass("Execute completed successfully");
@@ -63,19 +169,63 @@ TestResult BaseTest::run()
     
     stopTimer();
     updateStatus(TestResult::PASSED, "Test completed successfully");
-    logPass("Test '%s' PASSED in %lu ms", test_name_.c_str(), status_.duration_ms);
+    logPass("Test '%s' PASSED in %lu ms", test_name_.c_str(), (unsigned long)status_.duration_ms);
     
     return TestResult::PASSED;
 }
 
+void BaseTest::abort(uint32_t elapsed_ms)
+{
+    // A step worker outlives the deleted runner task
+    step_runner_.kill();
+    
+    // What the deleted tasks held is lost; the heap is not checked
+    endRun();
+    
+    logFail("Test timed out after %lu ms, aborting", (unsigned long)elapsed_ms);
+    onAbort();
+    
+    status_.duration_ms = elapsed_ms;
+    char message[64];
+    snprintf(message, sizeof(message), "Test timed out after %lu ms", (unsigned long)elapsed_ms);
+    updateStatus(TestResult::TIMEOUT, message);
+}
+
+void BaseTest::addTag(const std::string& tag)
+{
+    std::string lower = tag;
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return (char)tolower(c); });
+    if (!lower.empty() && !hasTag(lower)) {
+        tags_.push_back(lower);
+    }
+}
+
+void BaseTest::removeTag(const std::string& tag)
+{
+    tags_.erase(std::remove_if(tags_.begin(), tags_.end(),
+                               [&tag](const std::string& own) { return strcasecmp(own.c_str(), tag.c_str()) == 0; }),
+                tags_.end());
+}
+
+bool BaseTest::hasTag(const std::string& tag) const
+{
+    for (const auto& own : tags_) {
+        if (strcasecmp(own.c_str(), tag.c_str()) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
 void BaseTest::addStep(const std::string& name, std::function<esp_err_t()> step, 
-                       uint32_t timeout_ms, bool critical)
+                       uint32_t timeout_ms, bool critical, std::function<void()> cleanup)
 {
     TestStep test_step;
     test_step.name = name;
     test_step.execute = step;
     test_step.timeout_ms = timeout_ms;
     test_step.critical = critical;
+    test_step.cleanup = cleanup;
     
     test_steps_.push_back(test_step);
 }
@@ -83,14 +233,20 @@ void BaseTest::addStep(const std::string& name, std::function<esp_err_t()> step,
 esp_err_t BaseTest::runSteps()
 {
     for (const auto& step : test_steps_) {
+        if (abort_requested_) {
+            return ESP_ERR_TIMEOUT;
+        }
         logInfo("Executing step: %s", step.name.c_str());
         
         esp_err_t result = executeStep(step);
+        TestReporter::step(test_name_, step.name, result, step_runner_.getElapsedMs(),
+                           !timed_out_step_.empty());
         if (result != ESP_OK) {
             logError("Step '%s' failed: %s", step.name.c_str(), esp_err_to_name(result));
             if (step.critical) {
                 return result;
             } else {
+                timed_out_step_.clear();
                 logError("Non-critical step failed, continuing...");
             }
         } else {
@@ -106,8 +262,24 @@ esp_err_t BaseTest::executeStep(const TestStep& step)
         return ESP_ERR_INVALID_ARG;
     }
     
-    // Execute the step
-    esp_err_t result = step.execute();
+    // Execute the step in a worker with the step's deadline
+    esp_err_t result = ESP_OK;
+    step_abort_requested_ = false;
+    DeadlineTask::Outcome outcome = step_runner_.run(step.execute, step.timeout_ms, &result);
+    step_abort_requested_ = false;
+    stack_free_min_ = std::min(stack_free_min_, step_runner_.getStackHighWaterMark());
+    if (outcome != DeadlineTask::Outcome::COMPLETED) {
+        bool deleted = outcome == DeadlineTask::Outcome::TIMED_OUT;
+        logFail("Step '%s' timed out after %lu ms, %s", step.name.c_str(),
+                (unsigned long)step_runner_.getElapsedMs(), deleted ? "aborted" : "stopped");
+        timed_out_step_ = step.name;
+        timed_out_step_ms_ = step_runner_.getElapsedMs();
+        // A step that returned released what it held itself
+        if (deleted && step.cleanup) {
+            step.cleanup();
+        }
+        return ESP_ERR_TIMEOUT;
+    }
     
     return result;
 }
@@ -121,6 +293,8 @@ void BaseTest::updateStatus(TestResult result, const std::string& message)
         // Record error code if failed
         if (result == TestResult::FAILED) {
             status_.error_code = ESP_FAIL;
+        } else if (result == TestResult::TIMEOUT) {
+            status_.error_code = ESP_ERR_TIMEOUT;
         } else {
             status_.error_code = ESP_OK;
         }
@@ -138,15 +312,18 @@ void BaseTest::stopTimer()
     status_.duration_ms = current_time - status_.start_time;
 }
 
+void BaseTest::recordLatency(uint32_t latency_us)
+{
+    if (soak_) {
+        soak_->recordLatency(soak_index_, latency_us);
+    }
+}
+
 void BaseTest::logInfo(const char* format, ...)
 {
     va_list args;
     va_start(args, format);
-    
-    char buffer[256];
-    vsnprintf(buffer, sizeof(buffer), format, args);
-    ESP_LOGI(TAG, "[%s] %s", test_name_.c_str(), buffer);
-    
+    TestLog::write(TAG, TestLog::Level::INFO, test_name_.c_str(), format, args);
     va_end(args);
 }
 
@@ -154,11 +331,7 @@ void BaseTest::logError(const char* format, ...)
 {
     va_list args;
     va_start(args, format);
-    
-    char buffer[256];
-    vsnprintf(buffer, sizeof(buffer), format, args);
-    ESP_LOGE(TAG, "[%s] %s", test_name_.c_str(), buffer);
-    
+    TestLog::write(TAG, TestLog::Level::ERROR, test_name_.c_str(), format, args);
     va_end(args);
 }
 
@@ -166,11 +339,7 @@ void BaseTest::logPass(const char* format, ...)
 {
     va_list args;
     va_start(args, format);
-    
-    char buffer[256];
-    vsnprintf(buffer, sizeof(buffer), format, args);
-    ESP_LOGI(TAG, "[%s] ✓ %s", test_name_.c_str(), buffer);
-    
+    TestLog::write(TAG, TestLog::Level::PASS, test_name_.c_str(), format, args);
     va_end(args);
 }
 
@@ -178,11 +347,7 @@ void BaseTest::logFail(const char* format, ...)
 {
     va_list args;
     va_start(args, format);
-    
-    char buffer[256];
-    vsnprintf(buffer, sizeof(buffer), format, args);
-    ESP_LOGE(TAG, "[%s] ✗ %s", test_name_.c_str(), buffer);
-    
+    TestLog::write(TAG, TestLog::Level::FAIL, test_name_.c_str(), format, args);
     va_end(args);
 }
 
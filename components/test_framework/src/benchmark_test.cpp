@@ -0,0 +1,211 @@
+#include "benchmark_test.hpp"
+#include "test_reporter.hpp"
+#include "test_log.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#ifdef ESP_PLATFORM
+#include "esp_cpu.h"
+#include "esp_timer.h"
+#include "esp_private/esp_clk.h"
+#else
+#include <chrono>
+#endif
+
+const char* BenchmarkTest::TAG = "Benchmark";
+
+BenchmarkClock::Timestamp BenchmarkClock::now()
+{
+    Timestamp ts;
+#ifdef ESP_PLATFORM
+    ts.cycles = esp_cpu_get_cycle_count();
+    ts.time_ns = esp_timer_get_time() * 1000;
+#else
+    ts.cycles = 0;
+    ts.time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    return ts;
+}
+
+uint64_t BenchmarkClock::elapsedNs(const Timestamp& start, const Timestamp& end)
+{
+    uint64_t coarse_ns = (uint64_t)(end.time_ns - start.time_ns);
+#ifdef ESP_PLATFORM
+    // The cycle counter wraps after 2^32 cycles (~17.9 s at 240 MHz); use it
+    // only for intervals well inside one wrap
+    uint32_t cpu_mhz = esp_clk_cpu_freq() / 1000000;
+    uint64_t wrap_ns = (uint64_t)UINT32_MAX * 1000 / cpu_mhz;
+    if (coarse_ns < wrap_ns / 2) {
+        uint32_t cycles = end.cycles - start.cycles;
+        return (uint64_t)cycles * 1000 / cpu_mhz;
+    }
+#endif
+    return coarse_ns;
+}
+
+BenchmarkTest::BenchmarkTest(const std::string& name, const std::string& description)
+    : BaseTest(name, description)
+{
+    // Concurrent tests would skew the timings
+    setResources(TEST_RESOURCE_EXCLUSIVE);
+    addTag("bench");
+}
+
+esp_err_t BenchmarkTest::execute()
+{
+    logInfo("Running %zu benchmarks", test_steps_.size());
+
+    results_.clear();
+    results_.reserve(test_steps_.size());
+
+    esp_err_t ret = runSteps();
+    if (ret != ESP_OK) {
+        logError("Benchmark execution failed");
+        return ret;
+    }
+
+    logPass("%zu benchmarks completed", results_.size());
+    return ESP_OK;
+}
+
+void BenchmarkTest::addBenchmark(const std::string& name, std::function<void()> kernel, size_t bytes_per_call)
+{
+    addBenchmark(name, kernel, bytes_per_call, default_config_);
+}
+
+void BenchmarkTest::addBenchmark(const std::string& name, std::function<void()> kernel, size_t bytes_per_call,
+                                 const BenchmarkConfig& config)
+{
+    addBenchmark(name, nullptr, kernel, bytes_per_call, config);
+}
+
+void BenchmarkTest::addBenchmark(const std::string& name, std::function<void()> prepare, std::function<void()> kernel,
+                                 size_t bytes_per_call, const BenchmarkConfig& config)
+{
+    addStep(name, [this, name, prepare, kernel, bytes_per_call, config]() {
+        if (!kernel || config.repetitions == 0 || config.inner_iterations == 0) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        if (prepare) {
+            prepare();
+        }
+        BenchmarkResult result = measure(name, kernel, bytes_per_call, config, [this]() { return shouldAbort(); });
+        if (shouldAbort()) {
+            return ESP_ERR_TIMEOUT;     // Cut short, not a result
+        }
+        results_.push_back(result);
+        logResult(getName(), results_.back());
+        return ESP_OK;
+    }, config.timeout_ms);
+}
+
+BenchmarkResult BenchmarkTest::measure(const std::string& name, const std::function<void()>& kernel,
+                                       size_t bytes_per_call, const BenchmarkConfig& config,
+                                       const std::function<bool()>& stop)
+{
+    BenchmarkResult result;
+    result.name = name;
+    result.inner_iterations = std::max<uint32_t>(config.inner_iterations, 1);
+    result.bytes_per_call = bytes_per_call;
+    result.ops_per_call = config.ops_per_call;
+
+    for (uint32_t i = 0; i < config.warmup_iterations; i++) {
+        kernel();
+    }
+
+    uint64_t overhead_ns = timerOverheadNs();
+
+    // Allocated before timing starts
+    std::vector<double> samples_ns;
+    samples_ns.reserve(config.repetitions);
+
+    for (uint32_t rep = 0; rep < config.repetitions && !(stop && stop()); rep++) {
+        BenchmarkClock::Timestamp start = BenchmarkClock::now();
+        for (uint32_t i = 0; i < result.inner_iterations; i++) {
+            kernel();
+        }
+        BenchmarkClock::Timestamp end = BenchmarkClock::now();
+
+        uint64_t elapsed_ns = BenchmarkClock::elapsedNs(start, end);
+        elapsed_ns = elapsed_ns > overhead_ns ? elapsed_ns - overhead_ns : 0;
+        samples_ns.push_back((double)elapsed_ns / result.inner_iterations);
+    }
+
+    computeStatistics(samples_ns, result);
+    return result;
+}
+
+void BenchmarkTest::computeStatistics(std::vector<double>& samples_ns, BenchmarkResult& result)
+{
+    result.repetitions = samples_ns.size();
+    if (samples_ns.empty()) {
+        return;
+    }
+
+    std::sort(samples_ns.begin(), samples_ns.end());
+    size_t count = samples_ns.size();
+
+    result.min_ns = samples_ns.front();
+    result.max_ns = samples_ns.back();
+    result.median_ns = (count % 2) ? samples_ns[count / 2]
+                                   : (samples_ns[count / 2 - 1] + samples_ns[count / 2]) / 2.0;
+
+    // Nearest-rank percentile
+    size_t p99_rank = (size_t)std::ceil(0.99 * count);
+    result.p99_ns = samples_ns[p99_rank > 0 ? p99_rank - 1 : 0];
+
+    double sum = 0.0;
+    for (double sample : samples_ns) {
+        sum += sample;
+    }
+    result.mean_ns = sum / count;
+
+    double variance = 0.0;
+    for (double sample : samples_ns) {
+        variance += (sample - result.mean_ns) * (sample - result.mean_ns);
+    }
+    result.stddev_ns = count > 1 ? std::sqrt(variance / (count - 1)) : 0.0;
+
+    if (result.median_ns > 0.0) {
+        result.calls_per_sec = 1e9 / result.median_ns;
+        result.throughput_mbps = result.bytes_per_call * 1e3 / result.median_ns;  // bytes/ns -> MB/s
+        if (result.ops_per_call > 0) {
+            result.ns_per_op = result.median_ns / result.ops_per_call;
+        }
+    }
+}
+
+void BenchmarkTest::logResult(const std::string& test_name, const BenchmarkResult& result)
+{
+    // Through TestLog, so deferred mode keeps console I/O away from the next benchmark
+    if (result.ops_per_call > 0) {
+        TestLog::log(TAG, TestLog::Level::INFO, test_name.c_str(),
+                     "%s: %.2f ns/op (median %.1f ns for %lu ops, p99 %.1f ns)",
+                     result.name.c_str(), result.ns_per_op, result.median_ns,
+                     (unsigned long)result.ops_per_call, result.p99_ns);
+    } else if (result.bytes_per_call > 0) {
+        TestLog::log(TAG, TestLog::Level::INFO, test_name.c_str(),
+                     "%s: median %.1f ns, min %.1f ns, p99 %.1f ns, stddev %.1f ns, %.2f MB/s",
+                     result.name.c_str(), result.median_ns, result.min_ns,
+                     result.p99_ns, result.stddev_ns, result.throughput_mbps);
+    } else {
+        TestLog::log(TAG, TestLog::Level::INFO, test_name.c_str(),
+                     "%s: median %.1f ns, min %.1f ns, p99 %.1f ns, stddev %.1f ns, %.0f calls/s",
+                     result.name.c_str(), result.median_ns, result.min_ns,
+                     result.p99_ns, result.stddev_ns, result.calls_per_sec);
+    }
+    TestReporter::benchmark(test_name, result);
+}
+
+uint64_t BenchmarkTest::timerOverheadNs()
+{
+    uint64_t overhead_ns = UINT64_MAX;
+    for (int i = 0; i < 16; i++) {
+        BenchmarkClock::Timestamp start = BenchmarkClock::now();
+        BenchmarkClock::Timestamp end = BenchmarkClock::now();
+        overhead_ns = std::min(overhead_ns, BenchmarkClock::elapsedNs(start, end));
+    }
+    return overhead_ns;
+}
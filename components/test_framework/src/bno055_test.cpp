@@ -1,4 +1,5 @@
 #include "bno055_test.hpp"
+#include "esp_timer.h"
 #include <cmath>
 #include <algorithm>
 
@@ -17,6 +18,9 @@ BNO055Test::BNO055Test()
     sensor_config_.scl_pin = GPIO_NUM_1;
     sensor_config_.i2c_freq = 100000;  // 100kHz
     sensor_config_.i2c_addr = BNO055_I2C_ADDR;
+    setResources(i2cResource(sensor_config_.i2c_port));
+    addTag("hardware:i2c");
+    addTag("slow");     // Stability phase
     
     // Initialize quaternion data
     last_quaternion_ = {0.0f, 0.0f, 0.0f, 0.0f};
@@ -30,13 +34,17 @@ esp_err_t BNO055Test::setup()
     // Reset counters
     resetCounters();
     
+    // A step aborted mid-transfer releases the I2C driver so the bus is usable again
+    auto release_bus = [this]() { releaseSensor(); };
+    
     // Add test steps
-    addStep("Initialize BNO055 sensor", [this]() { return initializeSensor(); });
-    addStep("Test sensor communication", [this]() { return testSensorCommunication(); });
-    addStep("Test quaternion reading", [this]() { return testQuaternionReading(); });
-    addStep("Test sensor calibration", [this]() { return testSensorCalibration(); });
-    addStep("Test data consistency", [this]() { return testDataConsistency(); });
-    addStep("Perform stability test", [this]() { return performStabilityTest(); });
+    addStep("Initialize BNO055 sensor", [this]() { return initializeSensor(); }, 5000, true, release_bus);
+    addStep("Test sensor communication", [this]() { return testSensorCommunication(); }, 5000, true, release_bus);
+    addStep("Test quaternion reading", [this]() { return testQuaternionReading(); }, 5000, true, release_bus);
+    addStep("Test sensor calibration", [this]() { return testSensorCalibration(); }, 5000, true, release_bus);
+    addStep("Test data consistency", [this]() { return testDataConsistency(); }, 5000, true, release_bus);
+    addStep("Perform stability test", [this]() { return performStabilityTest(); },
+            stability_test_duration_ + 5000, true, release_bus);
     
     logPass("BNO055 test setup completed");
     return ESP_OK;
@@ -76,11 +84,11 @@ esp_err_t BNO055Test::teardown()
 {
     logInfo("Cleaning up BNO055 test");
     
-    // Clear quaternion history
-    quaternion_history_.clear();
+    // Clear quaternion history, releasing its capacity
+    std::vector<bno055_quaternion_t>().swap(quaternion_history_);
     
-    // Note: bno055_deinit() would be called here if the driver supported it
-    sensor_initialized_ = false;
+    // Uninstall the I2C driver, so the next run can install it again
+    releaseSensor();
     
     logPass("BNO055 test cleanup completed");
     return ESP_OK;
@@ -137,12 +145,18 @@ esp_err_t BNO055Test::testQuaternionReading()
     TEST_ASSERT(sensor_initialized_, "Sensor must be initialized first");
     
     for (int i = 0; i < reading_count_; i++) {
+        if (shouldAbort()) {
+            logError("Quaternion reading stopped after %d readings", i);
+            return ESP_ERR_TIMEOUT;
+        }
         bno055_quaternion_t quat;
         esp_err_t ret = ESP_FAIL;
         
         // Retry mechanism for I2C timeouts
         for (int retry = 0; retry < 3; retry++) {
+            int64_t read_start_us = esp_timer_get_time();
             ret = bno055_get_quaternion(&quat);
+            recordLatency((uint32_t)(esp_timer_get_time() - read_start_us));
             if (ret == ESP_OK) {
                 break;
             } else if (retry < 2) {
@@ -276,8 +290,14 @@ esp_err_t BNO055Test::performStabilityTest()
     uint32_t errors_in_stability_test = 0;
     
     while ((xTaskGetTickCount() * portTICK_PERIOD_MS - start_time) < stability_test_duration_) {
+        if (shouldAbort()) {
+            logError("Stability test stopped after %lu readings", (unsigned long)readings_in_stability_test);
+            return ESP_ERR_TIMEOUT;
+        }
         bno055_quaternion_t quat;
+        int64_t read_start_us = esp_timer_get_time();
         esp_err_t ret = bno055_get_quaternion(&quat);
+        recordLatency((uint32_t)(esp_timer_get_time() - read_start_us));
         
         readings_in_stability_test++;
         
@@ -311,6 +331,16 @@ void BNO055Test::setI2CConfig(i2c_port_t port, gpio_num_t sda, gpio_num_t scl, u
     sensor_config_.sda_pin = sda;
     sensor_config_.scl_pin = scl;
     sensor_config_.i2c_freq = freq;
+    setResources(i2cResource(port));
+}
+
+void BNO055Test::releaseSensor()
+{
+    if (sensor_initialized_) {
+        logInfo("Releasing I2C port %d", sensor_config_.i2c_port);
+        bno055_deinit(sensor_config_.i2c_port);
+        sensor_initialized_ = false;
+    }
 }
 
 esp_err_t BNO055Test::validateQuaternion(const bno055_quaternion_t& quat)
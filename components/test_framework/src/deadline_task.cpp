@@ -0,0 +1,121 @@
+#include "deadline_task.hpp"
+#include "esp_log.h"
+
+const char* DeadlineTask::TAG = "DeadlineTask";
+
+DeadlineTask::DeadlineTask(const std::string& name, uint32_t stack_size)
+    : name_(name.substr(0, configMAX_TASK_NAME_LEN - 1)),
+      stack_size_(stack_size),
+      grace_ms_(0),
+      result_(ESP_OK),
+      done_(nullptr),
+      worker_(nullptr),
+      elapsed_ms_(0),
+      stack_free_(STACK_UNKNOWN)
+{
+}
+
+DeadlineTask::~DeadlineTask()
+{
+    kill();
+    if (done_) {
+        vSemaphoreDelete(done_);
+    }
+}
+
+DeadlineTask::Outcome DeadlineTask::run(std::function<esp_err_t()> function, uint32_t timeout_ms, esp_err_t* result)
+{
+    if (!done_) {
+        done_ = xSemaphoreCreateBinary();
+    }
+    
+    function_ = std::move(function);
+    result_ = ESP_OK;
+    stack_free_ = STACK_UNKNOWN;
+    uint32_t start_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    
+    // Same core as the caller, so the worker is never running while the caller deletes it
+    if (done_ == nullptr ||
+        xTaskCreatePinnedToCore(workerEntry, name_.c_str(), stack_size_, this,
+                                uxTaskPriorityGet(nullptr), &worker_, xPortGetCoreID()) != pdPASS) {
+        ESP_LOGW(TAG, "Failed to create worker '%s', running without a deadline", name_.c_str());
+        worker_ = nullptr;
+        result_ = function_();
+        function_ = nullptr;
+        elapsed_ms_ = xTaskGetTickCount() * portTICK_PERIOD_MS - start_time;
+        if (result) {
+            *result = result_;
+        }
+        return Outcome::COMPLETED;
+    }
+    
+    bool returned = xSemaphoreTake(done_, pdMS_TO_TICKS(timeout_ms)) == pdTRUE;
+    bool cancelled = false;
+    if (!returned && cancel_) {
+        // Deleting the worker loses whatever it holds; ask it to return first
+        cancel_();
+        cancelled = true;
+        returned = xSemaphoreTake(done_, pdMS_TO_TICKS(grace_ms_)) == pdTRUE;
+    }
+    elapsed_ms_ = xTaskGetTickCount() * portTICK_PERIOD_MS - start_time;
+    
+    // A finished worker only has its own suspend left to run
+    reapWorker(!returned);
+    
+    // The worker may have finished between the deadline and its deletion
+    if (!returned) {
+        returned = xSemaphoreTake(done_, 0) == pdTRUE;
+    }
+    function_ = nullptr;
+    
+    if (result) {
+        *result = returned ? result_ : ESP_ERR_TIMEOUT;
+    }
+    if (!returned) {
+        return Outcome::TIMED_OUT;
+    }
+    return cancelled ? Outcome::CANCELLED : Outcome::COMPLETED;
+}
+
+void DeadlineTask::setCancel(std::function<void()> cancel, uint32_t grace_ms)
+{
+    cancel_ = std::move(cancel);
+    grace_ms_ = grace_ms;
+}
+
+void DeadlineTask::kill()
+{
+    if (worker_) {
+        ESP_LOGW(TAG, "Deleting worker '%s'", name_.c_str());
+        reapWorker(true);
+    }
+}
+
+void DeadlineTask::reapWorker(bool may_be_running)
+{
+    if (!worker_) {
+        return;
+    }
+    
+    TaskHandle_t worker = worker_;
+    worker_ = nullptr;
+    stack_free_ = uxTaskGetStackHighWaterMark(worker);
+    vTaskDelete(worker);
+    
+    // The caller may have migrated to the other core while it waited;
+    // give a worker deleted there one tick to be switched out
+    if (may_be_running) {
+        vTaskDelay(1);
+    }
+}
+
+void DeadlineTask::workerEntry(void* arg)
+{
+    DeadlineTask* self = static_cast<DeadlineTask*>(arg);
+    
+    self->result_ = self->function_();
+    xSemaphoreGive(self->done_);
+    
+    // The waiting task deletes the worker
+    vTaskSuspend(nullptr);
+}
@@ -0,0 +1,76 @@
+#include "heap_snapshot.hpp"
+
+#include "esp_heap_caps.h"
+
+#ifdef ESP_PLATFORM
+static uint32_t regionCaps(HeapRegion region)
+{
+    switch (region) {
+        case HeapRegion::INTERNAL:  return MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+        case HeapRegion::SPIRAM:    return MALLOC_CAP_SPIRAM;
+        case HeapRegion::DMA:       return MALLOC_CAP_DMA;
+        default:                    return 0;
+    }
+}
+#endif
+
+HeapSnapshot HeapSnapshot::capture()
+{
+    HeapSnapshot snapshot;
+#ifdef ESP_PLATFORM
+    for (size_t i = 0; i < HEAP_REGION_COUNT; i++) {
+        uint32_t caps = regionCaps((HeapRegion)i);
+        HeapRegionInfo& info = snapshot.regions_[i];
+        if (heap_caps_get_total_size(caps) == 0) {
+            continue;
+        }
+        multi_heap_info_t heap_info;
+        heap_caps_get_info(&heap_info, caps);
+        info.present = true;
+        info.free_bytes = heap_info.total_free_bytes;
+        info.allocated_bytes = heap_info.total_allocated_bytes;
+        info.largest_free_block = heap_info.largest_free_block;
+        info.minimum_free_bytes = heap_info.minimum_free_bytes;
+        info.allocated_blocks = heap_info.allocated_blocks;
+    }
+#else
+    // The host has one heap; it stands in for internal RAM
+    multi_heap_info_t heap_info;
+    heap_caps_get_info(&heap_info, MALLOC_CAP_INTERNAL);
+    HeapRegionInfo& info = snapshot.regions_[(size_t)HeapRegion::INTERNAL];
+    info.present = true;
+    info.free_bytes = heap_info.total_free_bytes;
+    info.allocated_bytes = heap_info.total_allocated_bytes;
+    info.largest_free_block = heap_info.largest_free_block;
+    info.minimum_free_bytes = heap_info.minimum_free_bytes;
+    info.allocated_blocks = heap_info.allocated_blocks;
+#endif
+    return snapshot;
+}
+
+HeapRegionUsage HeapSnapshot::usageSince(const HeapSnapshot& before, HeapRegion region) const
+{
+    const HeapRegionInfo& start = before.region(region);
+    const HeapRegionInfo& end = this->region(region);
+
+    HeapRegionUsage usage;
+    usage.present = start.present && end.present;
+    if (!usage.present) {
+        return usage;
+    }
+    usage.leaked_bytes = (int32_t)(end.allocated_bytes - start.allocated_bytes);
+    usage.allocation_change = (int32_t)(end.allocated_blocks - start.allocated_blocks);
+    usage.largest_block_change = (int32_t)(end.largest_free_block - start.largest_free_block);
+    usage.largest_free_block = end.largest_free_block;
+    return usage;
+}
+
+const char* HeapSnapshot::regionName(HeapRegion region)
+{
+    switch (region) {
+        case HeapRegion::INTERNAL:  return "internal";
+        case HeapRegion::SPIRAM:    return "spiram";
+        case HeapRegion::DMA:       return "dma";
+        default:                    return "unknown";
+    }
+}
@@ -0,0 +1,105 @@
+#include "kernel_benchmark_test.hpp"
+#include "led_color.h"
+#include "render_math.h"
+#include <cmath>
+
+KernelBenchmarkTest::KernelBenchmarkTest()
+    : BenchmarkTest("Kernels", "Per-frame LED render path kernel benchmarks"),
+      num_leds_(3000),      // Sphere LED count
+      image_width_(320),
+      image_height_(160),
+      color_initialized_(false)
+{
+}
+
+esp_err_t KernelBenchmarkTest::setup()
+{
+    logInfo("Setting up kernel benchmarks for %u LEDs", num_leds_);
+
+    rgb_.assign((size_t)num_leds_ * 3, 0);
+    pixels_.assign(num_leds_, led_pixel_t{});
+    lookup_.assign((size_t)num_leds_ * 2, 0);
+    symbols_.assign(LED_OUTPUT_CHUNK_SYMBOLS, ws2812_symbol_t{});
+
+    // Gradient frame so the LUT and dither paths see varied input
+    for (size_t i = 0; i < rgb_.size(); i++) {
+        rgb_[i] = (uint8_t)(i * 7);
+    }
+
+    // Fibonacci sphere, roughly the LED layout
+    directions_.resize((size_t)num_leds_ * 3);
+    const float golden_angle = 2.39996323f;
+    for (uint16_t i = 0; i < num_leds_; i++) {
+        float z = 1.0f - 2.0f * (i + 0.5f) / num_leds_;
+        float r = sqrtf(1.0f - z * z);
+        directions_[i * 3 + 0] = r * cosf(golden_angle * i);
+        directions_[i * 3 + 1] = r * sinf(golden_angle * i);
+        directions_[i * 3 + 2] = z;
+    }
+
+    TEST_ASSERT_OK(ws2812_timing_init(LED_OUTPUT_DEFAULT_RESOLUTION_HZ, &timing_));
+
+    led_color_config_t color_config = {
+        .gamma = LED_COLOR_DEFAULT_GAMMA,
+        .brightness = LED_COLOR_DEFAULT_BRIGHTNESS,
+        .dither = true,
+        .current_limit_ma = 0,
+        .ma_per_channel = LED_COLOR_DEFAULT_MA_PER_CHANNEL,
+        .idle_ma_per_led = LED_COLOR_DEFAULT_IDLE_MA_PER_LED,
+    };
+    TEST_ASSERT_OK(led_color_init(&color_config, num_leds_));
+    color_initialized_ = true;
+
+    size_t frame_bytes = (size_t)num_leds_ * WS2812_BYTES_PER_LED;
+    addBenchmark("ws2812_encode frame", [this]() { encodeFrame(); }, frame_bytes);
+    addBenchmark("led_color_process frame", [this]() {
+        led_color_process(rgb_.data(), nullptr, pixels_.data());
+    }, frame_bytes);
+    addBenchmark("render_project frame", [this]() { projectFrame(); });
+
+    logPass("Kernel benchmark setup completed");
+    return ESP_OK;
+}
+
+esp_err_t KernelBenchmarkTest::teardown()
+{
+    logInfo("Cleaning up kernel benchmarks");
+
+    if (color_initialized_) {
+        led_color_deinit();
+        color_initialized_ = false;
+    }
+
+    rgb_ = std::vector<uint8_t>();
+    pixels_ = std::vector<led_pixel_t>();
+    directions_ = std::vector<float>();
+    lookup_ = std::vector<uint16_t>();
+    symbols_ = std::vector<ws2812_symbol_t>();
+
+    logPass("Kernel benchmark cleanup completed");
+    return ESP_OK;
+}
+
+void KernelBenchmarkTest::encodeFrame()
+{
+    // Chunk by chunk, as the RMT encoder callback drives it
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(pixels_.data());
+    size_t data_size = pixels_.size() * WS2812_BYTES_PER_LED;
+    size_t written = 0;
+    bool done = false;
+
+    while (!done) {
+        written += ws2812_encode(&timing_, data, data_size, written, symbols_.data(), symbols_.size(), &done);
+    }
+}
+
+void KernelBenchmarkTest::projectFrame()
+{
+    render_quat_t orientation = render_quat_normalize({0.9f, 0.1f, 0.3f, 0.2f});
+    float rotated[3];
+
+    for (uint16_t i = 0; i < num_leds_; i++) {
+        render_quat_rotate(orientation, &directions_[i * 3], rotated);
+        render_equirect_lookup(rotated, image_width_, image_height_, &lookup_[i * 2], &lookup_[i * 2 + 1]);
+    }
+}
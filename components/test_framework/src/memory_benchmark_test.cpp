@@ -0,0 +1,335 @@
+#include "memory_benchmark_test.hpp"
+#include "esp_heap_caps.h"
+#include "sdkconfig.h"
+#include <algorithm>
+#include <cstring>
+
+// Block sizes measured in every region, plus the larger ones in PSRAM
+static const size_t BLOCK_SIZES[] = { 1024, 4096, 16384, 32768, 262144, 1048576 };
+
+// Buffers are aligned for GDMA access to PSRAM
+#define MEMORY_BENCHMARK_ALIGN      64
+
+#ifdef CONFIG_ESP32S3_DATA_CACHE_LINE_SIZE
+#define MEMORY_BENCHMARK_CACHE_LINE CONFIG_ESP32S3_DATA_CACHE_LINE_SIZE
+#else
+#define MEMORY_BENCHMARK_CACHE_LINE 32
+#endif
+
+// Keeps loads from being optimized away
+static volatile uint32_t sink;
+
+static uint32_t log2Size(size_t value)
+{
+    uint32_t bits = 0;
+    while ((value >>= 1) != 0) {
+        bits++;
+    }
+    return bits;
+}
+
+static std::string sizeLabel(size_t bytes)
+{
+    char label[16];
+    if (bytes >= 1024 * 1024) {
+        snprintf(label, sizeof(label), "%uM", (unsigned)(bytes / (1024 * 1024)));
+    } else {
+        snprintf(label, sizeof(label), "%uK", (unsigned)(bytes / 1024));
+    }
+    return label;
+}
+
+static void sequentialRead(const uint8_t* buffer, size_t size)
+{
+    const uint32_t* words = (const uint32_t*)buffer;
+    uint32_t sum = 0;
+    for (size_t i = 0; i < size / 4; i++) {
+        sum += words[i];
+    }
+    sink = sum;
+}
+
+// Random word accesses; the high bits of an LCG index the block, which must be a power of two
+static void randomRead(const uint8_t* buffer, size_t size)
+{
+    const uint32_t* words = (const uint32_t*)buffer;
+    uint32_t count = size / 4;
+    uint32_t shift = 32 - log2Size(count);
+    uint32_t state = 12345;
+    uint32_t sum = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        state = state * 1664525u + 1013904223u;
+        sum += words[state >> shift];
+    }
+    sink = sum;
+}
+
+static void randomWrite(uint8_t* buffer, size_t size)
+{
+    uint32_t* words = (uint32_t*)buffer;
+    uint32_t count = size / 4;
+    uint32_t shift = 32 - log2Size(count);
+    uint32_t state = 12345;
+    for (uint32_t i = 0; i < count; i++) {
+        state = state * 1664525u + 1013904223u;
+        words[state >> shift] = i;
+    }
+}
+
+// One word per cache line links to the next line of a random single cycle (Sattolo)
+static uint32_t buildChaseChain(uint8_t* buffer, size_t working_set)
+{
+    uint32_t* words = (uint32_t*)buffer;
+    uint32_t stride = MEMORY_BENCHMARK_CACHE_LINE / 4;
+    uint32_t lines = working_set / MEMORY_BENCHMARK_CACHE_LINE;
+
+    for (uint32_t i = 0; i < lines; i++) {
+        words[i * stride] = i;
+    }
+    uint32_t state = 54321;
+    for (uint32_t i = lines - 1; i > 0; i--) {
+        state = state * 1664525u + 1013904223u;
+        uint32_t j = (uint32_t)(((uint64_t)state * i) >> 32);
+        uint32_t tmp = words[i * stride];
+        words[i * stride] = words[j * stride];
+        words[j * stride] = tmp;
+    }
+    for (uint32_t i = 0; i < lines; i++) {
+        words[i * stride] *= stride;
+    }
+    return lines;
+}
+
+static void chase(const uint8_t* buffer, uint32_t hops)
+{
+    const volatile uint32_t* words = (const volatile uint32_t*)buffer;
+    uint32_t index = 0;
+    for (uint32_t i = 0; i < hops; i++) {
+        index = words[index];
+    }
+    sink = index;
+}
+
+MemoryBenchmarkTest::MemoryBenchmarkTest()
+    : BenchmarkTest("MemoryBench", "PSRAM, internal and DMA memory bandwidth and latency"),
+      internal_buffer_size_(32 * 1024),
+      psram_buffer_size_(1024 * 1024),
+      async_memcpy_(nullptr),
+      async_done_(nullptr)
+{
+    addTag("hardware:psram");
+    
+    BenchmarkConfig config;
+    config.warmup_iterations = 2;
+    config.repetitions = 20;
+    setDefaultConfig(config);
+}
+
+MemoryBenchmarkTest::~MemoryBenchmarkTest()
+{
+    teardown();
+}
+
+esp_err_t MemoryBenchmarkTest::setup()
+{
+    logInfo("Setting up memory benchmarks");
+    logMemoryConfig();
+
+    // Internal regions are optional: there may not be room for both
+    if (allocateRegion("psram", MALLOC_CAP_SPIRAM, psram_buffer_size_) != ESP_OK) {
+        logFail("PSRAM buffer allocation failed");
+        return ESP_ERR_NO_MEM;
+    }
+    allocateRegion("internal", MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT, internal_buffer_size_);
+    allocateRegion("dma", MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL, internal_buffer_size_);
+
+    for (const auto& region : regions_) {
+        addRegionBenchmarks(region);
+    }
+
+    const Region& psram = regions_[0];
+    for (const auto& region : regions_) {
+        if (&region != &psram) {
+            addCrossRegionBenchmarks(psram, region, region.size);
+            addCrossRegionBenchmarks(region, psram, region.size);
+        }
+    }
+
+    for (const auto& region : regions_) {
+        addLatencyBenchmark(region, region.size);
+    }
+    // Small enough for the data cache, then large enough to miss it
+    addLatencyBenchmark(psram, internal_buffer_size_);
+
+    addWorkaroundBenchmarks(psram);
+
+    // GDMA copies between internal DMA memory, and from PSRAM into it
+    for (const auto& region : regions_) {
+        if (strcmp(region.name, "dma") == 0) {
+            async_memcpy_config_t config = ASYNC_MEMCPY_DEFAULT_CONFIG();
+            config.psram_trans_align = MEMORY_BENCHMARK_ALIGN;
+            async_done_ = xSemaphoreCreateBinary();
+            if (async_done_ && esp_async_memcpy_install(&config, &async_memcpy_) == ESP_OK) {
+                addAsyncMemcpyBenchmark(region, region, region.size);
+                addAsyncMemcpyBenchmark(psram, region, region.size);
+            } else {
+                logError("Async memcpy unavailable, skipping GDMA benchmarks");
+                async_memcpy_ = nullptr;
+            }
+        }
+    }
+
+    logPass("Memory benchmark setup completed");
+    return ESP_OK;
+}
+
+esp_err_t MemoryBenchmarkTest::teardown()
+{
+    if (async_memcpy_) {
+        esp_async_memcpy_uninstall(async_memcpy_);
+        async_memcpy_ = nullptr;
+    }
+    if (async_done_) {
+        vSemaphoreDelete(async_done_);
+        async_done_ = nullptr;
+    }
+    freeRegions();
+    return ESP_OK;
+}
+
+esp_err_t MemoryBenchmarkTest::allocateRegion(const char* name, uint32_t caps, size_t size)
+{
+    uint8_t* buffer = (uint8_t*)heap_caps_aligned_alloc(MEMORY_BENCHMARK_ALIGN, size * 2, caps);
+    if (!buffer) {
+        logError("Cannot allocate 2 x %zu bytes of %s memory, skipping it", size, name);
+        return ESP_ERR_NO_MEM;
+    }
+    memset(buffer, 0x5A, size * 2);
+    regions_.push_back({name, caps, buffer, size});
+    logInfo("Region %s: 2 x %zu bytes at %p", name, size, buffer);
+    return ESP_OK;
+}
+
+void MemoryBenchmarkTest::freeRegions()
+{
+    for (auto& region : regions_) {
+        heap_caps_free(region.buffer);
+    }
+    regions_.clear();
+}
+
+void MemoryBenchmarkTest::addRegionBenchmarks(const Region& region)
+{
+    uint8_t* src = region.buffer;
+    uint8_t* dst = region.buffer + region.size;
+
+    for (size_t block : BLOCK_SIZES) {
+        if (block > region.size) {
+            break;
+        }
+        std::string suffix = std::string(region.name) + " " + sizeLabel(block);
+        BenchmarkConfig config = default_config_;
+        config.ops_per_call = block / 4;
+
+        addBenchmark("seq_read " + suffix, [src, block]() { sequentialRead(src, block); }, block);
+        addBenchmark("seq_write " + suffix, [dst, block]() { memset(dst, 0xA5, block); }, block);
+        addBenchmark("seq_copy " + suffix, [src, dst, block]() { memcpy(dst, src, block); }, block);
+        addBenchmark("rand_read " + suffix, [src, block]() { randomRead(src, block); }, block, config);
+        addBenchmark("rand_write " + suffix, [dst, block]() { randomWrite(dst, block); }, block, config);
+    }
+}
+
+void MemoryBenchmarkTest::addCrossRegionBenchmarks(const Region& from, const Region& to, size_t block_size)
+{
+    uint8_t* src = from.buffer;
+    uint8_t* dst = to.buffer + to.size;
+    std::string name = std::string("copy ") + from.name + "->" + to.name + " " + sizeLabel(block_size);
+    addBenchmark(name, [src, dst, block_size]() { memcpy(dst, src, block_size); }, block_size);
+}
+
+void MemoryBenchmarkTest::addLatencyBenchmark(const Region& region, size_t working_set)
+{
+    uint8_t* buffer = region.buffer;
+    uint32_t hops = working_set / MEMORY_BENCHMARK_CACHE_LINE;
+
+    BenchmarkConfig config = default_config_;
+    config.ops_per_call = hops;
+
+    // The chain is rebuilt right before the run since other benchmarks overwrite the buffer
+    std::string name = std::string("latency ") + region.name + " " + sizeLabel(working_set);
+    addBenchmark(name, [buffer, working_set]() { buildChaseChain(buffer, working_set); },
+                 [buffer, hops]() { chase(buffer, hops); }, 0, config);
+}
+
+void MemoryBenchmarkTest::addWorkaroundBenchmarks(const Region& psram)
+{
+#if defined(__XTENSA__)
+    // CONFIG_SPIRAM_CACHE_WORKAROUND (ESP32 only) makes the compiler add memw
+    // barriers around PSRAM accesses; the same loop with and without memw
+    // shows what the workaround would cost
+    uint32_t* words = (uint32_t*)psram.buffer;
+    size_t block = std::min<size_t>(psram.size, 262144);
+    size_t count = block / 4;
+
+    BenchmarkConfig config = default_config_;
+    config.ops_per_call = count;
+
+    addBenchmark("psram word_write " + sizeLabel(block), [words, count]() {
+        for (size_t i = 0; i < count; i++) {
+            words[i] = i;
+            __asm__ volatile("" ::: "memory");
+        }
+    }, block, config);
+    addBenchmark("psram word_write_memw " + sizeLabel(block), [words, count]() {
+        for (size_t i = 0; i < count; i++) {
+            words[i] = i;
+            __asm__ volatile("memw" ::: "memory");
+        }
+    }, block, config);
+    addBenchmark("psram word_read_memw " + sizeLabel(block), [words, count]() {
+        uint32_t sum = 0;
+        for (size_t i = 0; i < count; i++) {
+            __asm__ volatile("memw" ::: "memory");
+            sum += words[i];
+        }
+        sink = sum;
+    }, block, config);
+#else
+    (void)psram;
+#endif
+}
+
+void MemoryBenchmarkTest::addAsyncMemcpyBenchmark(const Region& from, const Region& to, size_t block_size)
+{
+    uint8_t* src = from.buffer;
+    uint8_t* dst = to.buffer + to.size;
+    std::string name = std::string("gdma_copy ") + from.name + "->" + to.name + " " + sizeLabel(block_size);
+
+    addBenchmark(name, [this, src, dst, block_size]() {
+        if (esp_async_memcpy(async_memcpy_, dst, src, block_size, asyncMemcpyDone, async_done_) == ESP_OK) {
+            xSemaphoreTake(async_done_, portMAX_DELAY);
+        }
+    }, block_size);
+}
+
+bool MemoryBenchmarkTest::asyncMemcpyDone(async_memcpy_t mcp_hdl, async_memcpy_event_t* event, void* cb_args)
+{
+    BaseType_t high_task_wakeup = pdFALSE;
+    xSemaphoreGiveFromISR((SemaphoreHandle_t)cb_args, &high_task_wakeup);
+    return high_task_wakeup == pdTRUE;
+}
+
+void MemoryBenchmarkTest::logMemoryConfig()
+{
+    logInfo("Data cache line: %d bytes", MEMORY_BENCHMARK_CACHE_LINE);
+#ifdef CONFIG_SPIRAM_SPEED
+    logInfo("PSRAM speed: %d MHz", CONFIG_SPIRAM_SPEED);
+#endif
+#ifdef CONFIG_SPIRAM_CACHE_WORKAROUND
+    logInfo("CONFIG_SPIRAM_CACHE_WORKAROUND: enabled");
+#else
+    logInfo("CONFIG_SPIRAM_CACHE_WORKAROUND: not enabled (not applicable to this target)");
+#endif
+    logInfo("Free internal: %zu bytes, free PSRAM: %zu bytes",
+            heap_caps_get_free_size(MALLOC_CAP_INTERNAL), heap_caps_get_free_size(MALLOC_CAP_SPIRAM));
+}
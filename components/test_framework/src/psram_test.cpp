@@ -1,4 +1,5 @@
 #include "psram_test.hpp"
+#include "benchmark_test.hpp"
 #include <cstring>
 #include <cstdlib>
 
@@ -13,6 +14,7 @@ PSRAMTest::PSRAMTest()
       internal_ram_total_(0),
       internal_ram_free_(0)
 {
+    addTag("hardware:psram");
 }
 
 esp_err_t PSRAMTest::setup()
@@ -164,35 +166,36 @@ esp_err_t PSRAMTest::measurePSRAMPerformance()
     
     TEST_ASSERT_NOT_NULL(test_buffer_, "Test buffer not allocated");
     
+    BenchmarkConfig config;
+    config.warmup_iterations = 1;
+    config.repetitions = 10;
+    
     // Measure write performance
-    uint32_t start_time = xTaskGetTickCount();
-    for (int i = 0; i < 10; i++) {
-        memset(test_buffer_, i & 0xFF, allocation_test_size_);
-    }
-    uint32_t write_time = (xTaskGetTickCount() - start_time) * portTICK_PERIOD_MS;
+    int fill = 0;
+    BenchmarkResult write = BenchmarkTest::measure("psram_memset", [this, &fill]() {
+        memset(test_buffer_, fill++ & 0xFF, allocation_test_size_);
+    }, allocation_test_size_, config);
     
-    // Measure read performance  
+    // Measure read performance
     volatile uint32_t checksum = 0;
-    start_time = xTaskGetTickCount();
-    for (int i = 0; i < 10; i++) {
-        uint8_t* ptr = (uint8_t*)test_buffer_;
+    BenchmarkResult read = BenchmarkTest::measure("psram_read_stride4", [this, &checksum]() {
+        const uint8_t* ptr = (const uint8_t*)test_buffer_;
+        uint32_t sum = 0;
         for (size_t j = 0; j < allocation_test_size_; j += 4) {
-            uint32_t value = *(uint32_t*)(ptr + j);
-            checksum = checksum + value;
+            sum += *(const uint32_t*)(ptr + j);
         }
-    }
-    uint32_t read_time = (xTaskGetTickCount() - start_time) * portTICK_PERIOD_MS;
-    
-    // Calculate throughput
-    size_t total_bytes = allocation_test_size_ * 10;
-    float write_mbps = (float)(total_bytes) / (write_time * 1000.0f);  // MB/s
-    float read_mbps = (float)(total_bytes) / (read_time * 1000.0f);    // MB/s
+        checksum = checksum + sum;
+    }, allocation_test_size_, config);
     
     logPass("PSRAM Performance Results:");
-    logPass("Write: %.2f MB/s (%lu ms for %zu bytes)", write_mbps, write_time, total_bytes);
-    logPass("Read: %.2f MB/s (%lu ms for %zu bytes)", read_mbps, read_time, total_bytes);
+    logPass("Write: %.2f MB/s (median %.1f us for %zu bytes)", write.throughput_mbps,
+            write.median_ns / 1000.0, allocation_test_size_);
+    logPass("Read: %.2f MB/s (median %.1f us for %zu bytes)", read.throughput_mbps,
+            read.median_ns / 1000.0, allocation_test_size_);
     logPass("Checksum: 0x%08lX", checksum);
     
+    // Not reported as benchmark records: this test shares the CPU and PSRAM with
+    // whatever runs in parallel. MemoryBench measures PSRAM exclusively.
     return ESP_OK;
 }
 
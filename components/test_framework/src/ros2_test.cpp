@@ -1,4 +1,5 @@
 #include "ros2_test.hpp"
+#include "esp_timer.h"
 #include <cstring>
 #include <algorithm>
 #include <cmath>
@@ -39,11 +40,28 @@ ROS2Test::ROS2Test()
     bno055_config_.scl_pin = GPIO_NUM_1;
     bno055_config_.i2c_freq = 100000;
     bno055_config_.i2c_addr = BNO055_I2C_ADDR;
+    updateResources();
+    addTag("hardware:wifi");
+    addTag("network");
+    addTag("slow");     // Communication stability phase
     
     // Set static instance for callbacks
     instance_ = this;
 }
 
+void ROS2Test::updateResources()
+{
+    // The i2c tag follows the resources, so selecting by tag agrees with scheduling
+    uint32_t resources = TEST_RESOURCE_WIFI;
+    if (enable_bno055_) {
+        resources |= i2cResource(bno055_config_.i2c_port);
+        addTag("hardware:i2c");
+    } else {
+        removeTag("hardware:i2c");
+    }
+    setResources(resources);
+}
+
 esp_err_t ROS2Test::setup()
 {
     logInfo("Setting up ROS2 test environment");
@@ -53,17 +71,21 @@ esp_err_t ROS2Test::setup()
     
     // Add test steps
     addStep("Initialize ROS2 manager", [this]() { return initializeROS2Manager(); });
-    addStep("Test ROS2 connection", [this]() { return testROS2Connection(); });
+    addStep("Test ROS2 connection", [this]() { return testROS2Connection(); }, connection_timeout_ms_ + 5000);
     
+    uint32_t publish_timeout = imu_reading_count_ * 1000 / publish_rate_hz_ + 5000;
     if (enable_bno055_) {
-        addStep("Initialize BNO055 sensor", [this]() { return initializeBNO055(); });
-        addStep("Test IMU publishing", [this]() { return testIMUPublishing(); });
+        addStep("Initialize BNO055 sensor", [this]() { return initializeBNO055(); }, 5000, true,
+                [this]() { bno055_deinit(bno055_config_.i2c_port); bno055_initialized_ = false; });
+        addStep("Test IMU publishing", [this]() { return testIMUPublishing(); }, publish_timeout);
     } else {
-        addStep("Test mock IMU publishing", [this]() { return testIMUPublishing(); });
+        addStep("Test mock IMU publishing", [this]() { return testIMUPublishing(); }, publish_timeout);
     }
     
-    addStep("Test image subscription", [this]() { return testImageSubscription(); });
-    addStep("Test communication stability", [this]() { return testCommunicationStability(); });
+    addStep("Test image subscription", [this]() { return testImageSubscription(); },
+            10000 + expected_image_count_ * 1000 + 5000);
+    addStep("Test communication stability", [this]() { return testCommunicationStability(); },
+            stability_test_duration_ + 5000);
     addStep("Test message throughput", [this]() { return testMessageThroughput(); });
     
     logPass("ROS2 test setup completed");
@@ -110,13 +132,20 @@ esp_err_t ROS2Test::teardown()
         ros2_manager_initialized_ = false;
     }
     
-    // Note: BNO055 deinit would be called here if available
-    bno055_initialized_ = false;
+    // Uninstall the BNO055 I2C driver, so the next run can install it again
+    if (bno055_initialized_) {
+        bno055_deinit(bno055_config_.i2c_port);
+        bno055_initialized_ = false;
+    }
     connection_established_ = false;
     
     // Clear static instance
     instance_ = nullptr;
     
+    // Release the timestamp histories; BaseTest checks the heap after teardown
+    std::vector<uint64_t>().swap(publish_timestamps_);
+    std::vector<uint64_t>().swap(receive_timestamps_);
+    
     logPass("ROS2 test cleanup completed");
     return ESP_OK;
 }
@@ -204,6 +233,10 @@ esp_err_t ROS2Test::testIMUPublishing()
     TEST_ASSERT(connection_established_, "Must be connected to ROS2");
     
     for (int i = 0; i < imu_reading_count_; i++) {
+        if (shouldAbort()) {
+            logError("IMU publishing stopped after %d messages", i);
+            return ESP_ERR_TIMEOUT;
+        }
         esp_err_t ret = publishIMUData();
         
         if (ret == ESP_OK) {
@@ -238,7 +271,7 @@ esp_err_t ROS2Test::testImageSubscription()
     
     // In mock mode, simulate receiving images
     if (mock_mode_) {
-        for (int i = 0; i < expected_image_count_; i++) {
+        for (int i = 0; i < expected_image_count_ && !shouldAbort(); i++) {
             ros2_compressed_image_msg_t mock_image;
             memset(&mock_image, 0, sizeof(mock_image));
             mock_image.seq = i + 1;
@@ -254,6 +287,9 @@ esp_err_t ROS2Test::testImageSubscription()
     
     // Wait for images to be received
     while (messages_received_ < expected_image_count_) {
+        if (shouldAbort()) {
+            return ESP_ERR_TIMEOUT;
+        }
         uint32_t current_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
         if ((current_time - start_time) > timeout) {
             logError("Timeout waiting for images: received %lu/%d", 
@@ -288,6 +324,10 @@ esp_err_t ROS2Test::testCommunicationStability()
     uint32_t last_received_count = messages_received_;
     
     while ((xTaskGetTickCount() * portTICK_PERIOD_MS - start_time) < stability_test_duration_) {
+        if (shouldAbort()) {
+            logError("Stability test stopped after %lu checks", stability_checks);
+            return ESP_ERR_TIMEOUT;
+        }
         stability_checks++;
         
         // Check connection status
@@ -297,7 +337,9 @@ esp_err_t ROS2Test::testCommunicationStability()
         } else {
             // Continue publishing during stability test
             if (enable_bno055_ && bno055_initialized_) {
+                int64_t publish_start_us = esp_timer_get_time();
                 publishIMUData();
+                recordLatency((uint32_t)(esp_timer_get_time() - publish_start_us));
             }
         }
         
@@ -416,7 +458,7 @@ esp_err_t ROS2Test::waitForConnection()
     
     while (!ros2_manager_is_connected()) {
         uint32_t current_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
-        if ((current_time - start_time) > connection_timeout_ms_) {
+        if (shouldAbort() || (current_time - start_time) > connection_timeout_ms_) {
             return ESP_ERR_TIMEOUT;
         }
         vTaskDelay(pdMS_TO_TICKS(100));
@@ -0,0 +1,382 @@
+#include "soak_recorder.hpp"
+#include "esp_log.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef ESP_PLATFORM
+#include "esp_heap_caps.h"
+#endif
+
+const char* SoakRecorder::TAG = "SoakRecorder";
+
+namespace {
+
+constexpr double MS_PER_HOUR = 3600.0 * 1000.0;
+
+// Least-squares line through the points; false with fewer than two distinct x
+bool fitLine(const std::vector<double>& x, const std::vector<double>& y, double& slope, double& intercept)
+{
+    size_t n = x.size();
+    if (n < 2) {
+        return false;
+    }
+    double mean_x = 0.0, mean_y = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        mean_x += x[i];
+        mean_y += y[i];
+    }
+    mean_x /= n;
+    mean_y /= n;
+
+    double sxy = 0.0, sxx = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        sxy += (x[i] - mean_x) * (y[i] - mean_y);
+        sxx += (x[i] - mean_x) * (x[i] - mean_x);
+    }
+    if (sxx <= 0.0) {
+        return false;
+    }
+    slope = sxy / sxx;
+    intercept = mean_y - slope * mean_x;
+    return true;
+}
+
+// Window midpoint in hours since the soak started
+double windowHours(uint32_t start_ms, uint32_t duration_ms)
+{
+    return (start_ms + duration_ms / 2.0) / MS_PER_HOUR;
+}
+
+std::string formatText(const char* fmt, ...) __attribute__((format(printf, 1, 2)));
+
+std::string formatText(const char* fmt, ...)
+{
+    char buffer[160];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(buffer, sizeof(buffer), fmt, args);
+    va_end(args);
+    return buffer;
+}
+
+} // namespace
+
+const char* SoakTrend::kindName(Kind kind)
+{
+    switch (kind) {
+        case Kind::LEAK:            return "leak";
+        case Kind::LATENCY_GROWTH:  return "latency_growth";
+        case Kind::STACK_LOW:       return "stack_low";
+        case Kind::FAILURES:        return "failures";
+        default:                    return "unknown";
+    }
+}
+
+SoakRecorder::~SoakRecorder()
+{
+    end();
+}
+
+esp_err_t SoakRecorder::begin(const std::vector<std::string>& test_names, const SoakConfig& config)
+{
+    end();
+    if (test_names.empty() || config.window_ms == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    size_t tests = test_names.size();
+    size_t capacity = std::max<size_t>(config.max_windows, 2 * MIN_TREND_WINDOWS) & ~(size_t)1;
+    size_t size = (capacity + 1) * tests * sizeof(SoakWindow) +
+                  capacity * sizeof(SoakHeapWindow) +
+                  tests * (SAMPLES_PER_WINDOW + 2) * sizeof(uint32_t);
+#ifdef ESP_PLATFORM
+    // Keep internal RAM for the tests
+    uint8_t* buffer = (uint8_t*)heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+    if (!buffer) {
+        buffer = (uint8_t*)heap_caps_malloc(size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    }
+#else
+    uint8_t* buffer = (uint8_t*)malloc(size);
+#endif
+    if (!buffer) {
+        ESP_LOGE(TAG, "Failed to allocate %u bytes for %u windows of %u tests",
+                 (unsigned)size, (unsigned)capacity, (unsigned)tests);
+        return ESP_ERR_NO_MEM;
+    }
+
+    config_ = config;
+    test_names_ = test_names;
+    buffer_ = buffer;
+    windows_ = (SoakWindow*)buffer;
+    heap_windows_ = (SoakHeapWindow*)(windows_ + (capacity + 1) * tests);
+    samples_ = (uint32_t*)(heap_windows_ + capacity);
+    sample_counts_ = samples_ + tests * SAMPLES_PER_WINDOW;
+    run_latencies_ = sample_counts_ + tests;
+    capacity_ = capacity;
+    rows_ = 0;
+    window_ms_ = config.window_ms;
+    window_start_ms_ = 0;
+
+    current_ = windows_ + capacity * tests;
+    for (size_t t = 0; t < tests; t++) {
+        current_[t] = SoakWindow();
+        sample_counts_[t] = 0;
+        run_latencies_[t] = 0;
+    }
+    current_heap_ = SoakHeapWindow();
+
+    ESP_LOGI(TAG, "Time series of %u windows for %u tests, %u bytes",
+             (unsigned)capacity, (unsigned)tests, (unsigned)size);
+    return ESP_OK;
+}
+
+void SoakRecorder::end()
+{
+    free(buffer_);
+    buffer_ = nullptr;
+    windows_ = nullptr;
+    heap_windows_ = nullptr;
+    samples_ = nullptr;
+    sample_counts_ = nullptr;
+    run_latencies_ = nullptr;
+    current_ = nullptr;
+    capacity_ = 0;
+    rows_ = 0;
+}
+
+void SoakRecorder::recordLatency(size_t test, uint32_t latency_us)
+{
+    if (!buffer_ || test >= test_names_.size()) {
+        return;
+    }
+    // The latest SAMPLES_PER_WINDOW samples give the percentiles
+    samples_[test * SAMPLES_PER_WINDOW + sample_counts_[test] % SAMPLES_PER_WINDOW] = latency_us;
+    sample_counts_[test]++;
+    run_latencies_[test]++;
+    current_[test].max_us = std::max(current_[test].max_us, latency_us);
+}
+
+void SoakRecorder::recordRun(size_t test, uint32_t run_us, bool passed, int32_t leaked_bytes, uint32_t stack_free)
+{
+    if (!buffer_ || test >= test_names_.size()) {
+        return;
+    }
+    if (run_latencies_[test] == 0) {
+        recordLatency(test, run_us);
+    }
+    run_latencies_[test] = 0;
+
+    SoakWindow& window = current_[test];
+    window.leaked_bytes += leaked_bytes;
+    window.stack_free_min = std::min(window.stack_free_min, stack_free);
+    if (window.runs < UINT16_MAX) {
+        window.runs++;
+    }
+    if (!passed && window.failures < UINT16_MAX) {
+        window.failures++;
+    }
+}
+
+void SoakRecorder::recordHeap(const HeapSnapshot& snapshot)
+{
+    const HeapRegionInfo& internal = snapshot.region(HeapRegion::INTERNAL);
+    const HeapRegionInfo& spiram = snapshot.region(HeapRegion::SPIRAM);
+    current_heap_.internal_free_min = internal.present ?
+        std::min<uint32_t>(current_heap_.internal_free_min, internal.free_bytes) : 0;
+    current_heap_.spiram_free_min = spiram.present ?
+        std::min<uint32_t>(current_heap_.spiram_free_min, spiram.free_bytes) : 0;
+}
+
+bool SoakRecorder::closeWindowIfDue(uint32_t elapsed_ms)
+{
+    if (!buffer_ || elapsed_ms - window_start_ms_ < window_ms_) {
+        return false;
+    }
+    return closeWindow(elapsed_ms);
+}
+
+bool SoakRecorder::closeWindow(uint32_t elapsed_ms)
+{
+    if (!buffer_) {
+        return false;
+    }
+    size_t tests = test_names_.size();
+    bool ran = false;
+    for (size_t t = 0; t < tests; t++) {
+        ran = ran || current_[t].runs > 0;
+    }
+    if (!ran) {
+        return false;
+    }
+    if (rows_ == capacity_) {
+        compact();
+    }
+
+    for (size_t t = 0; t < tests; t++) {
+        SoakWindow& window = current_[t];
+        window.start_ms = window_start_ms_;
+        window.duration_ms = elapsed_ms - window_start_ms_;
+
+        // Nearest-rank percentiles of the kept samples
+        size_t count = std::min<size_t>(sample_counts_[t], SAMPLES_PER_WINDOW);
+        sample_counts_[t] = 0;
+        if (count > 0) {
+            uint32_t* samples = samples_ + t * SAMPLES_PER_WINDOW;
+            std::sort(samples, samples + count);
+            size_t p95_rank = (size_t)std::ceil(0.95 * count);
+            window.p50_us = samples[(count - 1) / 2];
+            window.p95_us = samples[p95_rank > 0 ? p95_rank - 1 : 0];
+        }
+
+        windows_[rows_ * tests + t] = window;
+        window = SoakWindow();
+    }
+    heap_windows_[rows_] = current_heap_;
+    current_heap_ = SoakHeapWindow();
+
+    rows_++;
+    window_start_ms_ = elapsed_ms;
+    return true;
+}
+
+void SoakRecorder::compact()
+{
+    // Halve the resolution of what is kept, so a soak of any length fits
+    size_t tests = test_names_.size();
+    for (size_t row = 0; row < rows_ / 2; row++) {
+        for (size_t t = 0; t < tests; t++) {
+            SoakWindow merged = windows_[(2 * row) * tests + t];
+            merge(merged, windows_[(2 * row + 1) * tests + t]);
+            windows_[row * tests + t] = merged;
+        }
+        const SoakHeapWindow& first = heap_windows_[2 * row];
+        const SoakHeapWindow& second = heap_windows_[2 * row + 1];
+        SoakHeapWindow merged;
+        merged.internal_free_min = std::min(first.internal_free_min, second.internal_free_min);
+        merged.spiram_free_min = std::min(first.spiram_free_min, second.spiram_free_min);
+        heap_windows_[row] = merged;
+    }
+    rows_ /= 2;
+    window_ms_ *= 2;
+    ESP_LOGI(TAG, "Time series full, merged to %u windows of %lu s",
+             (unsigned)rows_, (unsigned long)(window_ms_ / 1000));
+}
+
+void SoakRecorder::merge(SoakWindow& into, const SoakWindow& next)
+{
+    // Percentiles of merged windows are run-weighted averages, an approximation
+    uint32_t runs = (uint32_t)into.runs + next.runs;
+    if (runs > 0) {
+        into.p50_us = (uint32_t)(((uint64_t)into.p50_us * into.runs + (uint64_t)next.p50_us * next.runs) / runs);
+        into.p95_us = (uint32_t)(((uint64_t)into.p95_us * into.runs + (uint64_t)next.p95_us * next.runs) / runs);
+    }
+    into.duration_ms = next.start_ms + next.duration_ms - into.start_ms;
+    into.runs = (uint16_t)std::min<uint32_t>(runs, UINT16_MAX);
+    into.failures = (uint16_t)std::min<uint32_t>((uint32_t)into.failures + next.failures, UINT16_MAX);
+    into.leaked_bytes += next.leaked_bytes;
+    into.max_us = std::max(into.max_us, next.max_us);
+    into.stack_free_min = std::min(into.stack_free_min, next.stack_free_min);
+}
+
+std::vector<SoakTrend> SoakRecorder::analyze() const
+{
+    std::vector<SoakTrend> trends;
+    if (!buffer_ || rows_ == 0) {
+        return trends;
+    }
+
+    size_t tests = test_names_.size();
+    std::vector<double> x, y;
+    double slope = 0.0, intercept = 0.0;
+
+    // Free heap falling window over window: a leak somewhere in the system
+    for (HeapRegion region : {HeapRegion::INTERNAL, HeapRegion::SPIRAM}) {
+        x.clear();
+        y.clear();
+        for (size_t row = 0; row < rows_; row++) {
+            const SoakHeapWindow& heap = heap_windows_[row];
+            uint32_t free_min = region == HeapRegion::INTERNAL ? heap.internal_free_min : heap.spiram_free_min;
+            if (free_min == 0 || free_min == UINT32_MAX) {
+                continue;
+            }
+            const SoakWindow& window = windows_[row * tests];
+            x.push_back(windowHours(window.start_ms, window.duration_ms));
+            y.push_back(free_min);
+        }
+        if (x.size() < MIN_TREND_WINDOWS || !fitLine(x, y, slope, intercept) ||
+            -slope <= (double)config_.leak_bytes_per_hour) {
+            continue;
+        }
+        trends.push_back({SoakTrend::Kind::LEAK, "", -slope,
+                          formatText("%s heap: free minimum falling %.0f bytes/h (%.0f -> %.0f bytes)",
+                                 HeapSnapshot::regionName(region), -slope,
+                                 intercept + slope * x.front(), intercept + slope * x.back())});
+    }
+
+    for (size_t t = 0; t < tests; t++) {
+        const std::string& name = test_names_[t];
+        uint32_t runs = 0, failures = 0, stack_free_min = UINT32_MAX;
+        int64_t leaked_bytes = 0;
+        uint32_t first_failure_ms = 0;
+        x.clear();
+        y.clear();
+
+        for (size_t row = 0; row < rows_; row++) {
+            const SoakWindow& window = windows_[row * tests + t];
+            if (window.failures > 0 && failures == 0) {
+                first_failure_ms = window.start_ms;
+            }
+            runs += window.runs;
+            failures += window.failures;
+            leaked_bytes += window.leaked_bytes;
+            stack_free_min = std::min(stack_free_min, window.stack_free_min);
+            if (window.runs > 0) {
+                x.push_back(windowHours(window.start_ms, window.duration_ms));
+                y.push_back(window.p95_us);
+            }
+        }
+        if (runs == 0) {
+            continue;
+        }
+
+        // Allocations the runs leave behind, over the time they took
+        const SoakWindow& last = windows_[(rows_ - 1) * tests + t];
+        double hours = (last.start_ms + last.duration_ms - windows_[t].start_ms) / MS_PER_HOUR;
+        double leak_rate = hours > 0.0 ? leaked_bytes / hours : 0.0;
+        if (rows_ >= MIN_TREND_WINDOWS && leaked_bytes > 0 && leak_rate > config_.leak_bytes_per_hour) {
+            trends.push_back({SoakTrend::Kind::LEAK, name, leak_rate,
+                              formatText("%s: leaves %.0f bytes/h allocated (%lld bytes over %lu runs)",
+                                     name.c_str(), leak_rate, (long long)leaked_bytes, (unsigned long)runs)});
+        }
+
+        // p95 latency from the start to the end of the fitted line
+        if (x.size() >= MIN_TREND_WINDOWS && fitLine(x, y, slope, intercept)) {
+            double start_us = intercept + slope * x.front();
+            double end_us = intercept + slope * x.back();
+            double growth = start_us > 0.0 ? (end_us - start_us) / start_us * 100.0 : 0.0;
+            if (growth > config_.latency_growth_percent) {
+                trends.push_back({SoakTrend::Kind::LATENCY_GROWTH, name, growth,
+                                  formatText("%s: p95 latency grew %.0f%% (%.0f -> %.0f us)",
+                                         name.c_str(), growth, start_us, end_us)});
+            }
+        }
+
+        if (stack_free_min != UINT32_MAX && stack_free_min < config_.stack_free_min_bytes) {
+            trends.push_back({SoakTrend::Kind::STACK_LOW, name, (double)stack_free_min,
+                              formatText("%s: only %lu bytes of step stack left free",
+                                     name.c_str(), (unsigned long)stack_free_min)});
+        }
+
+        if (failures > 0) {
+            trends.push_back({SoakTrend::Kind::FAILURES, name, (double)failures,
+                              formatText("%s: %lu of %lu runs failed, first in the window at %lu s",
+                                     name.c_str(), (unsigned long)failures, (unsigned long)runs,
+                                     (unsigned long)(first_failure_ms / 1000))});
+        }
+    }
+    return trends;
+}
@@ -0,0 +1,373 @@
+#include "test_filter.hpp"
+#include "esp_log.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+const char* TestFilter::TAG = "TestFilter";
+
+namespace {
+
+std::string toLower(std::string text)
+{
+    std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return (char)tolower(c); });
+    return text;
+}
+
+std::string trim(const std::string& text)
+{
+    size_t start = text.find_first_not_of(" \t");
+    if (start == std::string::npos) {
+        return "";
+    }
+    size_t end = text.find_last_not_of(" \t");
+    return text.substr(start, end - start + 1);
+}
+
+void skipSpace(const std::string& text, size_t& pos)
+{
+    while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t')) {
+        pos++;
+    }
+}
+
+bool isTagChar(char c)
+{
+    return isalnum((unsigned char)c) || c == ':' || c == '_' || c == '-' || c == '.' ||
+           c == '*' || c == '?' || c == '[' || c == ']';
+}
+
+// Closing bracket of the [set] at pattern, nullptr if unterminated (the '[' is then literal).
+// A ']' first in the set is a member.
+const char* setEnd(const char* pattern)
+{
+    const char* p = pattern + 1;
+    if (*p == '!' || *p == '^') {
+        p++;
+    }
+    return *p ? strchr(p + 1, ']') : nullptr;
+}
+
+// Tests that take most of a shard's time, dealt out first
+bool isHeavy(const BaseTest& test)
+{
+    return test.hasTag("slow") || test.hasTag("bench");
+}
+
+} // namespace
+
+esp_err_t TagExpression::parse(const std::string& expression)
+{
+    nodes_.clear();
+    root_ = -1;
+    if (trim(expression).empty()) {
+        return ESP_OK;
+    }
+
+    size_t pos = 0;
+    int root = parseOr(expression, pos);
+    skipSpace(expression, pos);
+    if (root < 0 || pos != expression.size()) {
+        ESP_LOGE("TagExpression", "Invalid tag expression '%s' at offset %u",
+                 expression.c_str(), (unsigned)pos);
+        nodes_.clear();
+        return ESP_ERR_INVALID_ARG;
+    }
+    root_ = root;
+    return ESP_OK;
+}
+
+bool TagExpression::matches(const std::vector<std::string>& tags) const
+{
+    return root_ < 0 || evaluate(root_, tags);
+}
+
+int TagExpression::parseOr(const std::string& text, size_t& pos)
+{
+    int left = parseAnd(text, pos);
+    skipSpace(text, pos);
+    while (left >= 0 && pos < text.size() && text[pos] == '|') {
+        pos++;
+        int right = parseAnd(text, pos);
+        left = right < 0 ? -1 : addNode(Op::OR, left, right);
+        skipSpace(text, pos);
+    }
+    return left;
+}
+
+int TagExpression::parseAnd(const std::string& text, size_t& pos)
+{
+    int left = parseUnary(text, pos);
+    skipSpace(text, pos);
+    while (left >= 0 && pos < text.size() && text[pos] == '&') {
+        pos++;
+        int right = parseUnary(text, pos);
+        left = right < 0 ? -1 : addNode(Op::AND, left, right);
+        skipSpace(text, pos);
+    }
+    return left;
+}
+
+int TagExpression::parseUnary(const std::string& text, size_t& pos)
+{
+    skipSpace(text, pos);
+    if (pos >= text.size()) {
+        return -1;
+    }
+    if (text[pos] == '!') {
+        pos++;
+        int operand = parseUnary(text, pos);
+        return operand < 0 ? -1 : addNode(Op::NOT, operand, -1);
+    }
+    if (text[pos] == '(') {
+        pos++;
+        int inner = parseOr(text, pos);
+        skipSpace(text, pos);
+        if (inner < 0 || pos >= text.size() || text[pos] != ')') {
+            return -1;
+        }
+        pos++;
+        return inner;
+    }
+
+    size_t start = pos;
+    while (pos < text.size() && isTagChar(text[pos])) {
+        pos++;
+    }
+    if (pos == start) {
+        return -1;
+    }
+    return addNode(Op::TAG, -1, -1, toLower(text.substr(start, pos - start)));
+}
+
+int TagExpression::addNode(Op op, int left, int right, const std::string& tag)
+{
+    nodes_.push_back(Node{op, left, right, tag});
+    return (int)nodes_.size() - 1;
+}
+
+bool TagExpression::evaluate(int node, const std::vector<std::string>& tags) const
+{
+    const Node& n = nodes_[node];
+    switch (n.op) {
+        case Op::NOT:   return !evaluate(n.left, tags);
+        case Op::AND:   return evaluate(n.left, tags) && evaluate(n.right, tags);
+        case Op::OR:    return evaluate(n.left, tags) || evaluate(n.right, tags);
+        case Op::TAG:
+        default:
+            for (const auto& tag : tags) {
+                if (TestFilter::globMatch(n.tag.c_str(), tag.c_str())) {
+                    return true;
+                }
+            }
+            return false;
+    }
+}
+
+esp_err_t TestFilter::parse(const std::string& spec)
+{
+    if (spec.find('=') == std::string::npos) {
+        return setNamePattern(trim(spec));
+    }
+
+    size_t start = 0;
+    while (start <= spec.size()) {
+        size_t end = spec.find(';', start);
+        std::string field = trim(spec.substr(start, end == std::string::npos ? std::string::npos : end - start));
+        start = end == std::string::npos ? spec.size() + 1 : end + 1;
+        if (field.empty()) {
+            continue;
+        }
+
+        size_t equals = field.find('=');
+        std::string key = equals == std::string::npos ? "" : toLower(trim(field.substr(0, equals)));
+        std::string value = equals == std::string::npos ? "" : trim(field.substr(equals + 1));
+        esp_err_t ret = ESP_ERR_INVALID_ARG;
+        if (key == "name") {
+            ret = setNamePattern(value);
+        } else if (key == "tags") {
+            ret = setTagExpression(value);
+        } else if (key == "shard") {
+            char* end_ptr = nullptr;
+            unsigned long shard = strtoul(value.c_str(), &end_ptr, 10);
+            if (end_ptr && *end_ptr == '/') {
+                const char* count_text = end_ptr + 1;
+                unsigned long count = strtoul(count_text, &end_ptr, 10);
+                if (end_ptr != count_text && *end_ptr == '\0') {
+                    ret = setShard(shard, count);
+                }
+            }
+        }
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Invalid selection field '%s'", field.c_str());
+            return ret;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t TestFilter::setNamePattern(const std::string& pattern)
+{
+    if (pattern.empty() || pattern == "*") {
+        name_mode_ = NameMode::ALL;
+        name_pattern_.clear();
+        return ESP_OK;
+    }
+
+    if (pattern.size() >= 2 && pattern.front() == '/' && pattern.back() == '/') {
+        try {
+            name_regex_ = std::regex(pattern.substr(1, pattern.size() - 2),
+                                     std::regex::ECMAScript | std::regex::icase | std::regex::nosubs);
+        } catch (const std::regex_error& e) {
+            ESP_LOGE(TAG, "Invalid name regex %s: %s", pattern.c_str(), e.what());
+            return ESP_ERR_INVALID_ARG;
+        }
+        name_mode_ = NameMode::REGEX;
+    } else if (pattern.find_first_of("*?[") != std::string::npos) {
+        name_mode_ = NameMode::GLOB;
+    } else {
+        name_mode_ = NameMode::SUBSTRING;
+    }
+    name_pattern_ = pattern;
+    return ESP_OK;
+}
+
+esp_err_t TestFilter::setTagExpression(const std::string& expression)
+{
+    esp_err_t ret = tags_.parse(expression);
+    tag_text_ = ret == ESP_OK ? trim(expression) : "";
+    return ret;
+}
+
+esp_err_t TestFilter::setShard(uint32_t shard, uint32_t shard_count)
+{
+    if (shard_count == 0 || shard == 0 || shard > shard_count) {
+        ESP_LOGE(TAG, "Invalid shard %lu of %lu", (unsigned long)shard, (unsigned long)shard_count);
+        return ESP_ERR_INVALID_ARG;
+    }
+    shard_ = shard;
+    shard_count_ = shard_count;
+    return ESP_OK;
+}
+
+bool TestFilter::matches(const BaseTest& test) const
+{
+    const std::string& name = test.getName();
+    bool name_matches = true;
+    switch (name_mode_) {
+        case NameMode::SUBSTRING:
+            name_matches = toLower(name).find(toLower(name_pattern_)) != std::string::npos;
+            break;
+        case NameMode::GLOB:
+            name_matches = globMatch(name_pattern_.c_str(), name.c_str());
+            break;
+        case NameMode::REGEX:
+            name_matches = std::regex_search(name, name_regex_);
+            break;
+        case NameMode::ALL:
+        default:
+            break;
+    }
+    return name_matches && tags_.matches(test.getTags());
+}
+
+std::vector<std::shared_ptr<BaseTest>> TestFilter::select(const std::vector<std::shared_ptr<BaseTest>>& tests) const
+{
+    std::vector<size_t> matched;
+    for (size_t i = 0; i < tests.size(); i++) {
+        if (matches(*tests[i])) {
+            matched.push_back(i);
+        }
+    }
+
+    // Deal slow tests and benchmarks out first, so every shard gets its share of them.
+    // Every board registers the same tests, so each computes the same split.
+    std::stable_partition(matched.begin(), matched.end(),
+                          [&tests](size_t i) { return isHeavy(*tests[i]); });
+    std::vector<bool> in_shard(tests.size(), false);
+    for (size_t k = 0; k < matched.size(); k++) {
+        if (k % shard_count_ == shard_ - 1) {
+            in_shard[matched[k]] = true;
+        }
+    }
+
+    std::vector<std::shared_ptr<BaseTest>> selected;
+    for (size_t i = 0; i < tests.size(); i++) {
+        if (in_shard[i]) {
+            selected.push_back(tests[i]);
+        }
+    }
+    return selected;
+}
+
+std::string TestFilter::describe() const
+{
+    std::string text;
+    if (name_mode_ != NameMode::ALL) {
+        text = "name '" + name_pattern_ + "'";
+    }
+    if (!tag_text_.empty()) {
+        text += (text.empty() ? "" : ", ") + std::string("tags '") + tag_text_ + "'";
+    }
+    if (shard_count_ > 1) {
+        text += (text.empty() ? "" : ", ") + std::string("shard ") + std::to_string(shard_) + "/" +
+                std::to_string(shard_count_);
+    }
+    return text.empty() ? "all tests" : text;
+}
+
+bool TestFilter::globMatch(const char* pattern, const char* text)
+{
+    // Iterative match, backtracking to the last '*' on a mismatch
+    const char* star = nullptr;
+    const char* resume = nullptr;
+    while (*text) {
+        const char* next = nullptr;
+        if (*pattern == '*') {
+            star = pattern++;
+            resume = text;
+            continue;
+        }
+        if (*pattern == '?') {
+            next = pattern + 1;
+        } else if (*pattern == '[' && setEnd(pattern)) {
+            const char* p = pattern + 1;
+            const char* end = setEnd(pattern);
+            bool negate = (*p == '!' || *p == '^');
+            if (negate) {
+                p++;
+            }
+            bool found = false;
+            char c = (char)tolower((unsigned char)*text);
+            for (; p < end; p++) {
+                char low = (char)tolower((unsigned char)*p);
+                char high = low;
+                if (p + 2 < end && p[1] == '-') {
+                    high = (char)tolower((unsigned char)p[2]);
+                    p += 2;
+                }
+                found = found || (c >= low && c <= high);
+            }
+            if (found != negate) {
+                next = end + 1;
+            }
+        } else if (*pattern && tolower((unsigned char)*pattern) == tolower((unsigned char)*text)) {
+            next = pattern + 1;
+        }
+
+        if (next) {
+            pattern = next;
+            text++;
+        } else if (star) {
+            pattern = star + 1;
+            text = ++resume;
+        } else {
+            return false;
+        }
+    }
+    while (*pattern == '*') {
+        pattern++;
+    }
+    return *pattern == '\0';
+}
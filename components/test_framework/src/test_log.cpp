@@ -0,0 +1,542 @@
+#include "test_log.hpp"
+#include "esp_log.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef ESP_PLATFORM
+#include "esp_heap_caps.h"
+#endif
+
+const char* TestLog::TAG = "TestLog";
+
+bool TestLog::deferred_ = false;
+uint8_t* TestLog::ring_ = nullptr;
+size_t TestLog::ring_size_ = 0;
+uint32_t TestLog::write_pos_ = 0;
+uint32_t TestLog::read_pos_ = 0;
+uint32_t TestLog::used_ = 0;
+uint32_t TestLog::dropped_ = 0;
+int TestLog::timed_sections_ = 0;
+portMUX_TYPE TestLog::lock_ = portMUX_INITIALIZER_UNLOCKED;
+SemaphoreHandle_t TestLog::drain_mutex_ = nullptr;
+SemaphoreHandle_t TestLog::wake_ = nullptr;
+TaskHandle_t TestLog::formatter_ = nullptr;
+
+namespace {
+
+constexpr uint32_t FORMATTER_STACK_SIZE = 6144;
+
+// Argument types a conversion consumes
+enum class ArgKind : uint8_t {
+    NONE,           // %%
+    INT,
+    LONG,
+    LONG_LONG,
+    SIZE,
+    INTMAX,
+    PTRDIFF,
+    DOUBLE,
+    STRING,
+    POINTER,
+    UNSUPPORTED     // %n, %*d, %Lf, wide strings: the record is formatted up front
+};
+
+size_t align8(size_t size)
+{
+    return (size + 7) & ~(size_t)7;
+}
+
+// format points at '%'; returns the character after the conversion
+const char* parseConversion(const char* format, ArgKind& kind)
+{
+    const char* p = format + 1;
+    if (*p == '%') {
+        kind = ArgKind::NONE;
+        return p + 1;
+    }
+    while (*p && strchr("-+ #0", *p)) {
+        p++;
+    }
+    if (*p == '*') {
+        kind = ArgKind::UNSUPPORTED;
+        return p + 1;
+    }
+    while (*p >= '0' && *p <= '9') {
+        p++;
+    }
+    if (*p == '.') {
+        p++;
+        if (*p == '*') {
+            kind = ArgKind::UNSUPPORTED;
+            return p + 1;
+        }
+        while (*p >= '0' && *p <= '9') {
+            p++;
+        }
+    }
+
+    ArgKind integer = ArgKind::INT;
+    bool long_double = false;
+    bool has_length = true;
+    switch (*p) {
+        case 'h':   p += (p[1] == 'h') ? 2 : 1; break;
+        case 'l':
+            if (p[1] == 'l') {
+                integer = ArgKind::LONG_LONG;
+                p += 2;
+            } else {
+                integer = ArgKind::LONG;
+                p++;
+            }
+            break;
+        case 'z':   integer = ArgKind::SIZE; p++; break;
+        case 'j':   integer = ArgKind::INTMAX; p++; break;
+        case 't':   integer = ArgKind::PTRDIFF; p++; break;
+        case 'L':   long_double = true; p++; break;
+        default:    has_length = false; break;
+    }
+
+    switch (*p) {
+        case 'd': case 'i': case 'u': case 'o': case 'x': case 'X': case 'c':
+            kind = integer;
+            break;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            kind = long_double ? ArgKind::UNSUPPORTED : ArgKind::DOUBLE;
+            break;
+        case 's':
+            kind = has_length ? ArgKind::UNSUPPORTED : ArgKind::STRING;
+            break;
+        case 'p':
+            kind = ArgKind::POINTER;
+            break;
+        default:
+            kind = ArgKind::UNSUPPORTED;
+            return *p ? p + 1 : p;
+    }
+    return p + 1;
+}
+
+// Number of arguments format consumes, or -1 if it cannot be recorded raw
+int countArgs(const char* format)
+{
+    int count = 0;
+    for (const char* p = format; *p; ) {
+        if (*p != '%') {
+            p++;
+            continue;
+        }
+        ArgKind kind;
+        p = parseConversion(p, kind);
+        if (kind == ArgKind::UNSUPPORTED) {
+            return -1;
+        }
+        if (kind != ArgKind::NONE) {
+            count++;
+        }
+    }
+    return count;
+}
+
+// Append one conversion with its argument; returns the new length
+size_t appendConversion(char* out, size_t size, size_t length, const char* spec, ArgKind kind,
+                        uint64_t value, const uint8_t* record)
+{
+    if (length + 1 >= size) {
+        return length;
+    }
+    char* dest = out + length;
+    size_t room = size - length;
+    int written = 0;
+    switch (kind) {
+        case ArgKind::INT:          written = snprintf(dest, room, spec, (int)value); break;
+        case ArgKind::LONG:         written = snprintf(dest, room, spec, (long)value); break;
+        case ArgKind::LONG_LONG:    written = snprintf(dest, room, spec, (long long)value); break;
+        case ArgKind::SIZE:         written = snprintf(dest, room, spec, (size_t)value); break;
+        case ArgKind::INTMAX:       written = snprintf(dest, room, spec, (intmax_t)value); break;
+        case ArgKind::PTRDIFF:      written = snprintf(dest, room, spec, (ptrdiff_t)value); break;
+        case ArgKind::POINTER:      written = snprintf(dest, room, spec, (void*)(uintptr_t)value); break;
+        case ArgKind::STRING:       written = snprintf(dest, room, spec, (const char*)(record + value)); break;
+        case ArgKind::DOUBLE: {
+            double number;
+            memcpy(&number, &value, sizeof(number));
+            written = snprintf(dest, room, spec, number);
+            break;
+        }
+        default:
+            break;
+    }
+    if (written < 0) {
+        return length;
+    }
+    return length + ((size_t)written < room ? (size_t)written : room - 1);
+}
+
+} // namespace
+
+esp_err_t TestLog::enableDeferred(size_t ring_size)
+{
+    if (ring_) {
+        deferred_ = true;
+        return ESP_OK;
+    }
+
+    ring_size = align8(ring_size < 2 * MAX_RECORD_SIZE ? 2 * MAX_RECORD_SIZE : ring_size);
+#ifdef ESP_PLATFORM
+    // Keep internal RAM for the tests
+    uint8_t* ring = (uint8_t*)heap_caps_malloc(ring_size, MALLOC_CAP_SPIRAM);
+    if (!ring) {
+        ring = (uint8_t*)heap_caps_malloc(ring_size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    }
+#else
+    uint8_t* ring = (uint8_t*)malloc(ring_size);
+#endif
+    drain_mutex_ = drain_mutex_ ? drain_mutex_ : xSemaphoreCreateMutex();
+    wake_ = wake_ ? wake_ : xSemaphoreCreateBinary();
+    if (!ring || !drain_mutex_ || !wake_) {
+        ESP_LOGE(TAG, "Failed to allocate a %u byte log ring", (unsigned)ring_size);
+        free(ring);
+        return ESP_ERR_NO_MEM;
+    }
+
+    // Lowest priority above idle: formats only when the tests leave the CPU
+    if (xTaskCreate(formatterTask, "test_log", FORMATTER_STACK_SIZE, nullptr,
+                    tskIDLE_PRIORITY + 1, &formatter_) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create formatter task");
+        free(ring);
+        return ESP_ERR_NO_MEM;
+    }
+
+    portENTER_CRITICAL(&lock_);
+    ring_ = ring;
+    ring_size_ = ring_size;
+    write_pos_ = read_pos_ = used_ = 0;
+    portEXIT_CRITICAL(&lock_);
+    deferred_ = true;
+
+    ESP_LOGI(TAG, "Deferred test logging, %u byte ring", (unsigned)ring_size);
+    return ESP_OK;
+}
+
+void TestLog::disableDeferred()
+{
+    deferred_ = false;
+    flush();
+}
+
+void TestLog::log(const char* tag, Level level, const char* test_name, const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    write(tag, level, test_name, format, args);
+    va_end(args);
+}
+
+void TestLog::write(const char* tag, Level level, const char* test_name, const char* format, va_list args)
+{
+    if (!deferred_) {
+        char buffer[MAX_RECORD_SIZE];
+        vsnprintf(buffer, sizeof(buffer), format, args);
+        writeImmediate(tag, level, test_name, buffer);
+        return;
+    }
+
+    alignas(8) uint8_t record[MAX_RECORD_SIZE];
+    size_t size = packRecord(record, tag, level, test_name, format, args);
+    if (push(record, size) && wake_) {
+        xSemaphoreGive(wake_);
+    }
+}
+
+void TestLog::writeRaw(const char* prefix, const char* text)
+{
+    size_t prefix_length = strlen(prefix);
+    size_t text_length = strlen(text);
+    size_t size = align8(sizeof(RecordHeader) + 1 + prefix_length + text_length + 1);
+
+    // One printf per line keeps lines whole when parallel tests write at once
+    if (!deferred_ || size > MAX_RECORD_SIZE) {
+        printf("%s%s\n", prefix, text);
+        return;
+    }
+
+    alignas(8) uint8_t record[MAX_RECORD_SIZE];
+    RecordHeader header = {};
+    header.size = (uint16_t)size;
+    header.level = Level::RAW;
+    header.time_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    memcpy(record, &header, sizeof(header));
+
+    char* payload = (char*)record + sizeof(RecordHeader);
+    payload[0] = '\0';      // No test name
+    memcpy(payload + 1, prefix, prefix_length);
+    memcpy(payload + 1 + prefix_length, text, text_length + 1);
+
+    if (push(record, size) && wake_) {
+        xSemaphoreGive(wake_);
+    }
+}
+
+size_t TestLog::packRecord(uint8_t* record, const char* tag, Level level, const char* test_name,
+                           const char* format, va_list args)
+{
+    RecordHeader header = {};
+    header.level = level;
+    header.time_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    header.tag = tag;
+
+    // Test name
+    size_t name_length = strnlen(test_name, sizeof(Entry::test_name) - 1);
+    size_t offset = sizeof(RecordHeader);
+    memcpy(record + offset, test_name, name_length);
+    record[offset + name_length] = '\0';
+    offset += name_length + 1;
+
+    int arg_count = countArgs(format);
+    if (arg_count < 0 || arg_count > (int)MAX_ARGS) {
+        // Not representable raw: format now, still without console I/O
+        vsnprintf((char*)record + offset, MAX_RECORD_SIZE - offset, format, args);
+        header.size = (uint16_t)align8(offset + strlen((char*)record + offset) + 1);
+        memcpy(record, &header, sizeof(header));
+        return header.size;
+    }
+
+    header.format = format;
+    header.arg_count = (uint8_t)arg_count;
+    offset = align8(offset);
+    uint64_t* values = (uint64_t*)(record + offset);
+    size_t strings = offset + arg_count * sizeof(uint64_t);
+
+    int index = 0;
+    for (const char* p = format; *p; ) {
+        if (*p != '%') {
+            p++;
+            continue;
+        }
+        ArgKind kind;
+        p = parseConversion(p, kind);
+        uint64_t value = 0;
+        switch (kind) {
+            case ArgKind::NONE:         continue;
+            case ArgKind::INT:          value = (uint64_t)(int64_t)va_arg(args, int); break;
+            case ArgKind::LONG:         value = (uint64_t)(int64_t)va_arg(args, long); break;
+            case ArgKind::LONG_LONG:    value = (uint64_t)va_arg(args, long long); break;
+            case ArgKind::SIZE:         value = (uint64_t)va_arg(args, size_t); break;
+            case ArgKind::INTMAX:       value = (uint64_t)va_arg(args, intmax_t); break;
+            case ArgKind::PTRDIFF:      value = (uint64_t)va_arg(args, ptrdiff_t); break;
+            case ArgKind::POINTER:      value = (uint64_t)(uintptr_t)va_arg(args, void*); break;
+            case ArgKind::DOUBLE: {
+                double number = va_arg(args, double);
+                memcpy(&value, &number, sizeof(value));
+                break;
+            }
+            case ArgKind::STRING: {
+                // Copied: the caller's string may be gone by the time it is formatted
+                const char* text = va_arg(args, const char*);
+                text = text ? text : "(null)";
+                size_t room = strings < MAX_RECORD_SIZE ? MAX_RECORD_SIZE - strings : 0;
+                if (room == 0) {
+                    value = strings - 1;    // Terminator of the previous string
+                    break;
+                }
+                size_t length = strnlen(text, room - 1);
+                memcpy(record + strings, text, length);
+                record[strings + length] = '\0';
+                value = strings;
+                strings += length + 1;
+                break;
+            }
+            default:
+                break;
+        }
+        values[index++] = value;
+    }
+
+    header.size = (uint16_t)align8(strings);
+    memcpy(record, &header, sizeof(header));
+    return header.size;
+}
+
+bool TestLog::push(const uint8_t* record, size_t size)
+{
+    bool idle = false;
+    bool pushed = false;
+
+    portENTER_CRITICAL(&lock_);
+    size_t to_end = ring_size_ - write_pos_;
+    size_t pad = to_end < size ? to_end : 0;
+    if (used_ + pad + size <= ring_size_) {
+        if (pad) {
+            // Zero size marks the rest of the ring as unused
+            *(uint16_t*)(ring_ + write_pos_) = 0;
+            write_pos_ = 0;
+            used_ += pad;
+        }
+        memcpy(ring_ + write_pos_, record, size);
+        write_pos_ = (write_pos_ + size) % ring_size_;
+        used_ += size;
+        pushed = true;
+    } else {
+        dropped_++;
+    }
+    idle = timed_sections_ == 0;
+    portEXIT_CRITICAL(&lock_);
+
+    return pushed && idle;
+}
+
+bool TestLog::pop(Entry& entry)
+{
+    if (!ring_) {
+        return false;
+    }
+
+    alignas(8) uint8_t record[MAX_RECORD_SIZE];
+    portENTER_CRITICAL(&lock_);
+    if (used_ > 0 && *(uint16_t*)(ring_ + read_pos_) == 0) {
+        used_ -= ring_size_ - read_pos_;
+        read_pos_ = 0;
+    }
+    if (used_ == 0) {
+        portEXIT_CRITICAL(&lock_);
+        return false;
+    }
+    uint16_t size = *(uint16_t*)(ring_ + read_pos_);
+    memcpy(record, ring_ + read_pos_, size);
+    read_pos_ = (read_pos_ + size) % ring_size_;
+    used_ -= size;
+    portEXIT_CRITICAL(&lock_);
+
+    RecordHeader header;
+    memcpy(&header, record, sizeof(header));
+    entry.level = header.level;
+    entry.tag = header.tag;
+    entry.time_ms = header.time_ms;
+    const char* name = (const char*)record + sizeof(RecordHeader);
+    snprintf(entry.test_name, sizeof(entry.test_name), "%s", name);
+    formatMessage(header, record, entry.message, sizeof(entry.message));
+    return true;
+}
+
+void TestLog::formatMessage(const RecordHeader& header, const uint8_t* record, char* out, size_t size)
+{
+    size_t offset = sizeof(RecordHeader);
+    offset += strlen((const char*)record + offset) + 1;
+
+    if (!header.format) {
+        snprintf(out, size, "%s", (const char*)record + offset);
+        return;
+    }
+
+    const uint64_t* values = (const uint64_t*)(record + align8(offset));
+    size_t length = 0;
+    int index = 0;
+    for (const char* p = header.format; *p && length + 1 < size; ) {
+        if (*p != '%') {
+            out[length++] = *p++;
+            continue;
+        }
+        ArgKind kind;
+        const char* end = parseConversion(p, kind);
+        if (kind == ArgKind::NONE) {
+            out[length++] = '%';
+        } else if (index < header.arg_count) {
+            char spec[24];
+            size_t spec_length = end - p;
+            if (spec_length < sizeof(spec)) {
+                memcpy(spec, p, spec_length);
+                spec[spec_length] = '\0';
+                length = appendConversion(out, size, length, spec, kind, values[index], record);
+            }
+            index++;
+        }
+        p = end;
+    }
+    out[length] = '\0';
+}
+
+void TestLog::beginTimedSection()
+{
+    portENTER_CRITICAL(&lock_);
+    timed_sections_++;
+    portEXIT_CRITICAL(&lock_);
+}
+
+void TestLog::endTimedSection()
+{
+    portENTER_CRITICAL(&lock_);
+    if (timed_sections_ > 0) {
+        timed_sections_--;
+    }
+    bool idle = timed_sections_ == 0;
+    portEXIT_CRITICAL(&lock_);
+
+    if (idle && wake_) {
+        xSemaphoreGive(wake_);
+    }
+}
+
+void TestLog::flush()
+{
+    if (ring_) {
+        drain();
+    }
+}
+
+void TestLog::drain()
+{
+    static uint32_t reported_drops = 0;
+    Entry entry;
+
+    xSemaphoreTake(drain_mutex_, portMAX_DELAY);
+    for (;;) {
+        portENTER_CRITICAL(&lock_);
+        bool idle = timed_sections_ == 0;
+        portEXIT_CRITICAL(&lock_);
+        if (!idle || !pop(entry)) {
+            break;
+        }
+        // Stamped with the time the record was logged
+        switch (entry.level) {
+            case Level::INFO:
+                ESP_LOGI(entry.tag, "[%s @%lu ms] %s", entry.test_name, (unsigned long)entry.time_ms, entry.message);
+                break;
+            case Level::ERROR:
+                ESP_LOGE(entry.tag, "[%s @%lu ms] %s", entry.test_name, (unsigned long)entry.time_ms, entry.message);
+                break;
+            case Level::PASS:
+                ESP_LOGI(entry.tag, "[%s @%lu ms] ✓ %s", entry.test_name, (unsigned long)entry.time_ms, entry.message);
+                break;
+            case Level::FAIL:
+                ESP_LOGE(entry.tag, "[%s @%lu ms] ✗ %s", entry.test_name, (unsigned long)entry.time_ms, entry.message);
+                break;
+            case Level::RAW:
+                printf("%s\n", entry.message);
+                break;
+        }
+    }
+    if (dropped_ != reported_drops) {
+        ESP_LOGW(TAG, "%lu test log records dropped, log ring full", (unsigned long)(dropped_ - reported_drops));
+        reported_drops = dropped_;
+    }
+    xSemaphoreGive(drain_mutex_);
+}
+
+void TestLog::writeImmediate(const char* tag, Level level, const char* test_name, const char* message)
+{
+    switch (level) {
+        case Level::INFO:   ESP_LOGI(tag, "[%s] %s", test_name, message); break;
+        case Level::ERROR:  ESP_LOGE(tag, "[%s] %s", test_name, message); break;
+        case Level::PASS:   ESP_LOGI(tag, "[%s] ✓ %s", test_name, message); break;
+        case Level::FAIL:   ESP_LOGE(tag, "[%s] ✗ %s", test_name, message); break;
+        case Level::RAW:    printf("%s\n", message); break;
+    }
+}
+
+void TestLog::formatterTask(void* arg)
+{
+    for (;;) {
+        xSemaphoreTake(wake_, portMAX_DELAY);
+        drain();
+    }
+}
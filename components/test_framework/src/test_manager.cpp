@@ -1,6 +1,10 @@
 #include "test_manager.hpp"
+#include "test_reporter.hpp"
+#include "test_log.hpp"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include <algorithm>
+#include <cstdio>
 #include <cstring>
 
 const char* TestManager::TAG = "TestManager";
@@ -8,6 +12,7 @@ const char* TestManager::TAG = "TestManager";
 TestManager::TestManager()
     : stop_on_first_failure_(false),
       parallel_execution_(false),
+      max_parallel_tests_(portNUM_PROCESSORS * 2),
       test_timeout_ms_(300000),  // 5 minutes default
       overall_result_(TestResult::NOT_RUN),
       execution_start_time_(0),
@@ -32,6 +37,20 @@ void TestManager::addTest(std::shared_ptr<BaseTest> test)
     }
 }
 
+void TestManager::setStructuredOutput(bool enabled)
+{
+    TestReporter::setEnabled(enabled);
+}
+
+esp_err_t TestManager::setDeferredLogging(bool enabled)
+{
+    if (!enabled) {
+        TestLog::disableDeferred();
+        return ESP_OK;
+    }
+    return TestLog::enableDeferred();
+}
+
 bool TestManager::runAllTests()
 {
     ESP_LOGI(TAG, "Starting test execution for %zu tests", tests_.size());
@@ -48,21 +67,7 @@ bool TestManager::runAllTests()
     execution_start_time_ = xTaskGetTickCount() * portTICK_PERIOD_MS;
     overall_result_ = TestResult::PASSED;  // Assume success until failure
     
-    bool all_passed = true;
-    
-    for (auto& test : tests_) {
-        bool test_passed = executeTest(test);
-        
-        if (!test_passed) {
-            all_passed = false;
-            updateOverallResult(test->getStatus().result);
-            
-            if (stop_on_first_failure_) {
-                ESP_LOGE(TAG, "Stopping test execution due to failure (stop_on_first_failure enabled)");
-                break;
-            }
-        }
-    }
+    bool all_passed = runTestList(tests_);
     
     execution_end_time_ = xTaskGetTickCount() * portTICK_PERIOD_MS;
     
@@ -91,7 +96,7 @@ bool TestManager::runTest(const std::string& test_name)
     }
     
     execution_start_time_ = xTaskGetTickCount() * portTICK_PERIOD_MS;
-    bool result = executeTest(*it);
+    bool result = runTestList({*it});
     execution_end_time_ = xTaskGetTickCount() * portTICK_PERIOD_MS;
     
     return result;
@@ -99,45 +104,175 @@ bool TestManager::runTest(const std::string& test_name)
 
 bool TestManager::runTestsMatching(const std::string& pattern)
 {
-    ESP_LOGI(TAG, "Running tests matching pattern: %s", pattern.c_str());
-    
-    std::vector<std::shared_ptr<BaseTest>> matching_tests;
-    
-    for (auto& test : tests_) {
-        if (matchesPattern(test->getName(), pattern)) {
-            matching_tests.push_back(test);
-        }
+    TestFilter filter;
+    if (filter.setNamePattern(pattern) != ESP_OK) {
+        return false;
     }
+    return runSelected(filter);
+}
+
+bool TestManager::runSelected(const TestFilter& filter)
+{
+    ESP_LOGI(TAG, "Running tests selected by %s", filter.describe().c_str());
+    
+    std::vector<std::shared_ptr<BaseTest>> matching_tests = filter.select(tests_);
     
     if (matching_tests.empty()) {
-        ESP_LOGW(TAG, "No tests match pattern '%s'", pattern.c_str());
+        ESP_LOGW(TAG, "No tests selected by %s", filter.describe().c_str());
         return true;
     }
     
-    ESP_LOGI(TAG, "Found %zu tests matching pattern", matching_tests.size());
+    ESP_LOGI(TAG, "Found %zu selected tests", matching_tests.size());
     
     execution_start_time_ = xTaskGetTickCount() * portTICK_PERIOD_MS;
     overall_result_ = TestResult::PASSED;
     
-    bool all_passed = true;
+    bool all_passed = runTestList(matching_tests);
     
-    for (auto& test : matching_tests) {
-        bool test_passed = executeTest(test);
-        
-        if (!test_passed) {
-            all_passed = false;
-            updateOverallResult(test->getStatus().result);
+    execution_end_time_ = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    
+    return all_passed;
+}
+
+bool TestManager::runSoak(const std::string& pattern, const SoakConfig& config)
+{
+    TestFilter filter;
+    if (filter.setNamePattern(pattern) != ESP_OK) {
+        return false;
+    }
+    return runSoak(filter, config);
+}
+
+bool TestManager::runSoak(const TestFilter& filter, const SoakConfig& config)
+{
+    std::vector<std::shared_ptr<BaseTest>> tests = filter.select(tests_);
+    std::vector<std::string> names;
+    for (auto& test : tests) {
+        names.push_back(test->getName());
+    }
+    
+    if (tests.empty()) {
+        ESP_LOGW(TAG, "No tests selected by %s", filter.describe().c_str());
+        return true;
+    }
+    if (soak_.begin(names, config) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start soak run");
+        return false;
+    }
+    
+    printSeparator('=', 80);
+    ESP_LOGI(TAG, "Soak run of %zu tests for %lu s, %lu s windows",
+             tests.size(), (unsigned long)(config.duration_ms / 1000), (unsigned long)(config.window_ms / 1000));
+    printSeparator('=', 80);
+    
+    // One test at a time, whatever setParallelExecution() says: latencies and
+    // heap figures of a window then belong to the test that produced them
+    for (size_t i = 0; i < tests.size(); i++) {
+        tests[i]->setSoakRecorder(&soak_, i);
+    }
+    TestReporter::runStart(tests.size(), false);
+    execution_start_time_ = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    overall_result_ = TestResult::PASSED;
+    
+    uint32_t runs = 0, passed = 0, failed = 0, timeout = 0;
+    uint32_t elapsed_ms = 0;
+    bool stop = false;
+    
+    while (!stop && elapsed_ms < config.duration_ms) {
+        for (size_t i = 0; i < tests.size() && !stop && elapsed_ms < config.duration_ms; i++) {
+            auto& test = tests[i];
+            uint32_t stack_free = DeadlineTask::STACK_UNKNOWN;
+            int64_t start_us = esp_timer_get_time();
+            TestResult result = runWithDeadline(test, &stack_free);
+            uint32_t run_us = (uint32_t)(esp_timer_get_time() - start_us);
             
-            if (stop_on_first_failure_) {
-                ESP_LOGE(TAG, "Stopping test execution due to failure");
-                break;
+            // An aborted run has no heap figures
+            int32_t leaked_bytes = 0;
+            if (result != TestResult::TIMEOUT && !test->isHeapUsageShared()) {
+                leaked_bytes = test->getHeapUsage(HeapRegion::INTERNAL).leaked_bytes +
+                               test->getHeapUsage(HeapRegion::SPIRAM).leaked_bytes;
+            }
+            soak_.recordRun(i, run_us, result == TestResult::PASSED, leaked_bytes, stack_free);
+            soak_.recordHeap(HeapSnapshot::capture());
+            runs++;
+            
+            if (result == TestResult::PASSED) {
+                passed++;
+            } else {
+                result == TestResult::TIMEOUT ? timeout++ : failed++;
+                updateOverallResult(result);
+                ESP_LOGW(TAG, "Soak run %lu: '%s' %s - %s", (unsigned long)runs, test->getName().c_str(),
+                         BaseTest::resultToString(result).c_str(), test->getStatus().message.c_str());
+                TestReporter::test(*test);
+                stop = config.stop_on_failure;
+            }
+            
+            if (config.pause_ms > 0) {
+                vTaskDelay(pdMS_TO_TICKS(config.pause_ms));
+            }
+            TestLog::flush();
+            
+            elapsed_ms = xTaskGetTickCount() * portTICK_PERIOD_MS - execution_start_time_;
+            if (soak_.closeWindowIfDue(elapsed_ms)) {
+                reportSoakWindow();
             }
         }
     }
     
-    execution_end_time_ = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    for (auto& test : tests) {
+        test->setSoakRecorder(nullptr, 0);
+    }
     
-    return all_passed;
+    // The partial last window still counts
+    elapsed_ms = xTaskGetTickCount() * portTICK_PERIOD_MS - execution_start_time_;
+    if (soak_.closeWindow(elapsed_ms)) {
+        reportSoakWindow();
+    }
+    execution_end_time_ = execution_start_time_ + elapsed_ms;
+    
+    std::vector<SoakTrend> trends = soak_.analyze();
+    bool degraded = false;
+    for (const auto& trend : trends) {
+        ESP_LOGW(TAG, "Soak %s: %s", SoakTrend::kindName(trend.kind), trend.message.c_str());
+        TestReporter::soakTrend(trend);
+        degraded = degraded || trend.kind != SoakTrend::Kind::FAILURES;
+    }
+    if (degraded && overall_result_ == TestResult::PASSED) {
+        overall_result_ = TestResult::FAILED;
+    }
+    
+    TestResult result = failed > 0 || degraded ? TestResult::FAILED :
+                        (timeout > 0 ? TestResult::TIMEOUT : TestResult::PASSED);
+    TestReporter::runEnd(result, runs, passed, failed, 0, timeout, elapsed_ms, elapsed_ms);
+    
+    printSeparator('=', 80);
+    ESP_LOGI(TAG, "Soak run completed: %lu runs in %lu s, %lu failed, %lu timed out, %zu trends flagged",
+             (unsigned long)runs, (unsigned long)(elapsed_ms / 1000), (unsigned long)failed,
+             (unsigned long)timeout, trends.size());
+    printSeparator('=', 80);
+    
+    return result == TestResult::PASSED;
+}
+
+void TestManager::reportSoakWindow()
+{
+    size_t row = soak_.getWindowCount() - 1;
+    const SoakHeapWindow& heap = soak_.getHeapWindow(row);
+    
+    for (size_t t = 0; t < soak_.getTestCount(); t++) {
+        const SoakWindow& window = soak_.getWindow(row, t);
+        if (window.runs == 0) {
+            continue;
+        }
+        ESP_LOGI(TAG, "Soak %4lu s %-20s %3u runs %2u failed, p50 %lu us, p95 %lu us, max %lu us, leaked %ld bytes",
+                 (unsigned long)(window.start_ms / 1000), soak_.getTestName(t).c_str(), window.runs, window.failures,
+                 (unsigned long)window.p50_us, (unsigned long)window.p95_us, (unsigned long)window.max_us,
+                 (long)window.leaked_bytes);
+        TestReporter::soakWindow(soak_.getTestName(t), window, heap);
+    }
+    ESP_LOGI(TAG, "Soak %4lu s heap free min: internal %lu bytes, spiram %lu bytes",
+             (unsigned long)(soak_.getWindow(row, 0).start_ms / 1000), (unsigned long)heap.internal_free_min,
+             (unsigned long)heap.spiram_free_min);
 }
 
 void TestManager::printTestResults()
@@ -154,7 +289,7 @@ void TestManager::printTestResults()
         ESP_LOGI(TAG, "%s%s %-20s %s (%lu ms) - %s\033[0m",
                  color, icon, test->getName().c_str(),
                  BaseTest::resultToString(status.result).c_str(),
-                 status.duration_ms,
+                 (unsigned long)status.duration_ms,
                  status.message.c_str());
     }
     
@@ -169,29 +304,29 @@ void TestManager::printTestSummary()
     ESP_LOGI(TAG, "                       TEST SUMMARY                          ");
     printSeparator('=', 80);
     
-    ESP_LOGI(TAG, "Total Tests:     %lu", stats.total_tests);
-    ESP_LOGI(TAG, "\033[32mPassed:          %lu\033[0m", stats.passed_tests);
+    ESP_LOGI(TAG, "Total Tests:     %lu", (unsigned long)stats.total_tests);
+    ESP_LOGI(TAG, "\033[32mPassed:          %lu\033[0m", (unsigned long)stats.passed_tests);
     
     if (stats.failed_tests > 0) {
-        ESP_LOGE(TAG, "\033[31mFailed:          %lu\033[0m", stats.failed_tests);
+        ESP_LOGE(TAG, "\033[31mFailed:          %lu\033[0m", (unsigned long)stats.failed_tests);
     } else {
-        ESP_LOGI(TAG, "Failed:          %lu", stats.failed_tests);
+        ESP_LOGI(TAG, "Failed:          %lu", (unsigned long)stats.failed_tests);
     }
     
     if (stats.skipped_tests > 0) {
-        ESP_LOGW(TAG, "\033[33mSkipped:         %lu\033[0m", stats.skipped_tests);
+        ESP_LOGW(TAG, "\033[33mSkipped:         %lu\033[0m", (unsigned long)stats.skipped_tests);
     } else {
-        ESP_LOGI(TAG, "Skipped:         %lu", stats.skipped_tests);
+        ESP_LOGI(TAG, "Skipped:         %lu", (unsigned long)stats.skipped_tests);
     }
     
     if (stats.timeout_tests > 0) {
-        ESP_LOGE(TAG, "\033[35mTimeout:         %lu\033[0m", stats.timeout_tests);
+        ESP_LOGE(TAG, "\033[35mTimeout:         %lu\033[0m", (unsigned long)stats.timeout_tests);
     } else {
-        ESP_LOGI(TAG, "Timeout:         %lu", stats.timeout_tests);
+        ESP_LOGI(TAG, "Timeout:         %lu", (unsigned long)stats.timeout_tests);
     }
     
     ESP_LOGI(TAG, "Success Rate:    %.1f%%", stats.success_rate);
-    ESP_LOGI(TAG, "Total Duration:  %lu ms (%.1f seconds)", stats.total_duration_ms, stats.total_duration_ms / 1000.0f);
+    ESP_LOGI(TAG, "Total Duration:  %lu ms (%.1f seconds)", (unsigned long)stats.total_duration_ms, stats.total_duration_ms / 1000.0f);
     
     TestResult overall = getOverallResult();
     const char* overall_color = getResultColorCode(overall);
@@ -253,6 +388,15 @@ std::vector<std::string> TestManager::getTestNames() const
     return names;
 }
 
+std::vector<std::string> TestManager::getTestNames(const TestFilter& filter) const
+{
+    std::vector<std::string> names;
+    for (const auto& test : filter.select(tests_)) {
+        names.push_back(test->getName());
+    }
+    return names;
+}
+
 BaseTest* TestManager::getTest(const std::string& name)
 {
     auto it = std::find_if(tests_.begin(), tests_.end(),
@@ -291,6 +435,8 @@ TestManager::TestStatistics TestManager::getStatistics() const
         }
     }
     
+    stats.elapsed_ms = execution_end_time_ - execution_start_time_;
+    
     if (stats.total_tests > 0) {
         stats.success_rate = (float)stats.passed_tests / stats.total_tests * 100.0f;
     }
@@ -298,6 +444,171 @@ TestManager::TestStatistics TestManager::getStatistics() const
     return stats;
 }
 
+bool TestManager::runTestList(const std::vector<std::shared_ptr<BaseTest>>& tests)
+{
+    bool parallel = parallel_execution_ && tests.size() > 1;
+    TestReporter::runStart(tests.size(), parallel);
+    uint32_t start_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    
+    bool all_passed = parallel ? runParallel(tests) : runSequential(tests);
+    TestLog::flush();
+    
+    reportRunEnd(tests, xTaskGetTickCount() * portTICK_PERIOD_MS - start_time);
+    return all_passed;
+}
+
+void TestManager::reportRunEnd(const std::vector<std::shared_ptr<BaseTest>>& tests, uint32_t elapsed_ms)
+{
+    uint32_t passed = 0, failed = 0, skipped = 0, timeout = 0, test_time_ms = 0;
+    
+    for (const auto& test : tests) {
+        const TestStatus& status = test->getStatus();
+        test_time_ms += status.duration_ms;
+        switch (status.result) {
+            case TestResult::PASSED:    passed++; break;
+            case TestResult::FAILED:    failed++; break;
+            case TestResult::TIMEOUT:   timeout++; break;
+            default:                    skipped++; break;  // SKIPPED, or NOT_RUN after a stop on failure
+        }
+    }
+    
+    TestResult result = TestResult::SKIPPED;
+    if (failed > 0) {
+        result = TestResult::FAILED;
+    } else if (timeout > 0) {
+        result = TestResult::TIMEOUT;
+    } else if (passed == tests.size()) {
+        result = TestResult::PASSED;
+    }
+    
+    TestReporter::runEnd(result, tests.size(), passed, failed, skipped, timeout, elapsed_ms, test_time_ms);
+}
+
+bool TestManager::runSequential(const std::vector<std::shared_ptr<BaseTest>>& tests)
+{
+    bool all_passed = true;
+    
+    for (auto& test : tests) {
+        bool test_passed = executeTest(test);
+        
+        if (!test_passed) {
+            all_passed = false;
+            updateOverallResult(test->getStatus().result);
+            
+            if (stop_on_first_failure_) {
+                ESP_LOGE(TAG, "Stopping test execution due to failure (stop_on_first_failure enabled)");
+                break;
+            }
+        }
+    }
+    
+    return all_passed;
+}
+
+bool TestManager::runParallel(const std::vector<std::shared_ptr<BaseTest>>& tests)
+{
+    QueueHandle_t done_queue = xQueueCreate(tests.size(), sizeof(WorkerContext*));
+    if (done_queue == nullptr) {
+        ESP_LOGE(TAG, "Failed to create completion queue, running tests sequentially");
+        return runSequential(tests);
+    }
+    
+    ESP_LOGI(TAG, "Running %zu tests in parallel (at most %lu at a time)", tests.size(), (unsigned long)max_parallel_tests_);
+    
+    // Workers run at the caller's priority so they preempt nothing the caller would not
+    UBaseType_t priority = uxTaskPriorityGet(nullptr);
+    std::vector<std::shared_ptr<BaseTest>> pending(tests);
+    uint32_t core_load[portNUM_PROCESSORS] = {};
+    uint32_t busy = TEST_RESOURCE_NONE;  // Resources held by running tests
+    uint32_t running = 0;
+    bool all_passed = true;
+    
+    while (!pending.empty() || running > 0) {
+        // Start pending tests in registration order. Resources of a test that has to
+        // wait are reserved, so a later test sharing them cannot overtake it.
+        uint32_t claimed = busy;
+        for (auto it = pending.begin(); it != pending.end() && running < max_parallel_tests_;) {
+            uint32_t resources = (*it)->getResources();
+            bool exclusive = (resources == TEST_RESOURCE_EXCLUSIVE);
+            
+            if (busy == TEST_RESOURCE_EXCLUSIVE || (exclusive && running > 0) || (claimed & resources) != 0) {
+                if (exclusive) {
+                    break;  // Let the running tests drain, then run it alone
+                }
+                claimed |= resources;
+                ++it;
+                continue;
+            }
+            
+            BaseType_t core = 0;
+            for (BaseType_t c = 1; c < portNUM_PROCESSORS; c++) {
+                if (core_load[c] < core_load[core]) {
+                    core = c;
+                }
+            }
+            
+            WorkerContext* ctx = new WorkerContext{this, *it, done_queue, core, false, nullptr};
+            char task_name[configMAX_TASK_NAME_LEN];
+            snprintf(task_name, sizeof(task_name), "test_%s", ctx->test->getName().c_str());
+            
+            busy |= resources;
+            claimed |= resources;
+            core_load[core]++;
+            running++;
+            it = pending.erase(it);
+            
+            if (xTaskCreatePinnedToCore(workerTask, task_name, WORKER_STACK_SIZE, ctx,
+                                        priority, &ctx->task, core) == pdPASS) {
+                ESP_LOGI(TAG, "Test '%s' started on core %d", ctx->test->getName().c_str(), core);
+            } else {
+                ESP_LOGE(TAG, "Failed to create worker for '%s', running it in place",
+                         ctx->test->getName().c_str());
+                ctx->task = nullptr;
+                ctx->passed = executeTest(ctx->test);
+                xQueueSend(done_queue, &ctx, portMAX_DELAY);
+            }
+        }
+        
+        WorkerContext* ctx = nullptr;
+        xQueueReceive(done_queue, &ctx, portMAX_DELAY);
+        if (ctx->task) {
+            vTaskDelete(ctx->task);
+        }
+        
+        busy &= ~ctx->test->getResources();
+        core_load[ctx->core]--;
+        running--;
+        
+        if (!ctx->passed) {
+            all_passed = false;
+            updateOverallResult(ctx->test->getStatus().result);
+            
+            if (stop_on_first_failure_ && !pending.empty()) {
+                ESP_LOGE(TAG, "Not starting %zu remaining tests due to failure (stop_on_first_failure enabled)",
+                         pending.size());
+                pending.clear();
+            }
+        }
+        delete ctx;
+    }
+    
+    vQueueDelete(done_queue);
+    return all_passed;
+}
+
+void TestManager::workerTask(void* arg)
+{
+    WorkerContext* ctx = static_cast<WorkerContext*>(arg);
+    
+    ctx->passed = ctx->manager->executeTest(ctx->test);
+    
+    xQueueSend(ctx->done_queue, &ctx, portMAX_DELAY);
+    
+    // Deleted by runParallel(): a task deleting itself is only freed later by the
+    // idle task, in the middle of the heap figures of whatever test runs next
+    vTaskSuspend(nullptr);
+}
+
 bool TestManager::executeTest(std::shared_ptr<BaseTest> test)
 {
     if (!test) {
@@ -307,22 +618,35 @@ bool TestManager::executeTest(std::shared_ptr<BaseTest> test)
     logTestStart(test->getName());
     
     uint32_t start_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
-    
-    // Run the test
-    TestResult result = test->run();
-    
+    TestResult result = runWithDeadline(test);
     uint32_t end_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
     uint32_t duration = end_time - start_time;
     
+    // The test's own log lines first, unless parallel tests are still running
+    TestLog::flush();
     logTestEnd(test->getName(), result, duration);
+    TestReporter::test(*test);
     
     return (result == TestResult::PASSED);
 }
 
-bool TestManager::checkTestTimeout(std::shared_ptr<BaseTest> test, uint32_t start_time)
+TestResult TestManager::runWithDeadline(std::shared_ptr<BaseTest> test, uint32_t* stack_free)
 {
-    uint32_t current_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
-    return (current_time - start_time) > test_timeout_ms_;
+    // Run the test in a worker with the per-test deadline
+    TestResult result = TestResult::FAILED;
+    DeadlineTask runner("run_" + test->getName());
+    runner.setCancel([&]() { test->requestAbort(); }, BaseTest::ABORT_GRACE_MS);
+    // A run that returned within the grace period reports its own timeout
+    if (runner.run([&]() { result = test->run(); return ESP_OK; }, test_timeout_ms_) ==
+        DeadlineTask::Outcome::TIMED_OUT) {
+        test->abort(runner.getElapsedMs());
+        result = TestResult::TIMEOUT;
+    }
+    
+    if (stack_free) {
+        *stack_free = std::min(runner.getStackHighWaterMark(), test->getStackHighWaterMark());
+    }
+    return result;
 }
 
 void TestManager::updateOverallResult(TestResult test_result)
@@ -349,7 +673,7 @@ void TestManager::logTestEnd(const std::string& test_name, TestResult result, ui
     ESP_LOGI(TAG, "%s%s Test '%s' %s in %lu ms\033[0m",
              color, icon, test_name.c_str(),
              BaseTest::resultToString(result).c_str(),
-             duration_ms);
+             (unsigned long)duration_ms);
 }
 
 void TestManager::logExecutionSummary()
@@ -358,26 +682,9 @@ void TestManager::logExecutionSummary()
     TestStatistics stats = getStatistics();
     
     ESP_LOGI(TAG, "Execution completed in %lu ms (%.1f seconds)", 
-             total_duration, total_duration / 1000.0f);
+             (unsigned long)total_duration, total_duration / 1000.0f);
     ESP_LOGI(TAG, "Tests: %lu total, %lu passed, %lu failed", 
-             stats.total_tests, stats.passed_tests, stats.failed_tests);
-}
-
-bool TestManager::matchesPattern(const std::string& text, const std::string& pattern)
-{
-    // Simple pattern matching - could be enhanced with regex
-    if (pattern == "*") {
-        return true;
-    }
-    
-    // Check if pattern is contained in text (case-insensitive)
-    std::string lower_text = text;
-    std::string lower_pattern = pattern;
-    
-    std::transform(lower_text.begin(), lower_text.end(), lower_text.begin(), ::tolower);
-    std::transform(lower_pattern.begin(), lower_pattern.end(), lower_pattern.begin(), ::tolower);
-    
-    return lower_text.find(lower_pattern) != std::string::npos;
+             (unsigned long)stats.total_tests, (unsigned long)stats.passed_tests, (unsigned long)stats.failed_tests);
 }
 
 const char* TestManager::getResultIcon(TestResult result)
@@ -0,0 +1,186 @@
+#include "test_reporter.hpp"
+#include "test_log.hpp"
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+bool TestReporter::enabled_ = true;
+
+void TestReporter::runStart(size_t test_count, bool parallel)
+{
+    char json[96];
+    snprintf(json, sizeof(json), "{\"type\":\"run_start\",\"tests\":%u,\"parallel\":%s}",
+             (unsigned)test_count, parallel ? "true" : "false");
+    emit(json);
+}
+
+void TestReporter::runEnd(TestResult result, uint32_t total, uint32_t passed, uint32_t failed,
+                          uint32_t skipped, uint32_t timeout, uint32_t elapsed_ms, uint32_t test_time_ms)
+{
+    char json[256];
+    snprintf(json, sizeof(json),
+             "{\"type\":\"run_end\",\"result\":\"%s\",\"total\":%lu,\"passed\":%lu,\"failed\":%lu,"
+             "\"skipped\":%lu,\"timeout\":%lu,\"elapsed_ms\":%lu,\"test_time_ms\":%lu}",
+             BaseTest::resultToString(result).c_str(), (unsigned long)total, (unsigned long)passed,
+             (unsigned long)failed, (unsigned long)skipped, (unsigned long)timeout,
+             (unsigned long)elapsed_ms, (unsigned long)test_time_ms);
+    emit(json);
+}
+
+void TestReporter::step(const std::string& test_name, const std::string& step_name, esp_err_t error,
+                        uint32_t duration_ms, bool timed_out)
+{
+    // Inside the test run: packed as a deferred record, nothing allocated or formatted here
+    char test[MAX_NAME_SIZE];
+    char step[MAX_NAME_SIZE];
+    escape(test_name.c_str(), test, sizeof(test));
+    escape(step_name.c_str(), step, sizeof(step));
+    const char* result = timed_out ? "TIMEOUT" : (error == ESP_OK ? "PASSED" : "FAILED");
+    emitFormat(TEST_REPORT_PREFIX "{\"type\":\"step\",\"test\":\"%s\",\"step\":\"%s\",\"result\":\"%s\","
+               "\"error\":\"%s\",\"error_code\":%d,\"duration_ms\":%lu}",
+               test, step, result, esp_err_to_name(error), (int)error, (unsigned long)duration_ms);
+}
+
+void TestReporter::test(const BaseTest& test)
+{
+    const TestStatus& status = test.getStatus();
+    std::string tags;
+    for (const auto& tag : test.getTags()) {
+        tags += (tags.empty() ? "" : ",") + tag;
+    }
+    std::string json = "{\"type\":\"test\",\"test\":\"" + escape(test.getName()) +
+                       "\",\"result\":\"" + BaseTest::resultToString(status.result) +
+                       "\",\"error_code\":" + std::to_string(status.error_code) +
+                       ",\"duration_ms\":" + std::to_string(status.duration_ms) +
+                       ",\"resources\":" + std::to_string(test.getResources()) +
+                       ",\"tags\":\"" + escape(tags) + "\"" +
+                       ",\"message\":\"" + escape(status.message) + "\"}";
+    emit(json.c_str());
+}
+
+void TestReporter::benchmark(const std::string& test_name, const BenchmarkResult& result)
+{
+    // Logged from the benchmark step, so packed like step records
+    char test[MAX_NAME_SIZE];
+    char name[MAX_NAME_SIZE];
+    escape(test_name.c_str(), test, sizeof(test));
+    escape(result.name.c_str(), name, sizeof(name));
+    emitFormat(TEST_REPORT_PREFIX "{\"type\":\"benchmark\",\"test\":\"%s\",\"benchmark\":\"%s\",\"repetitions\":%lu,"
+               "\"inner_iterations\":%lu,\"bytes_per_call\":%lu,\"min_ns\":%.1f,\"median_ns\":%.1f,\"p99_ns\":%.1f,"
+               "\"max_ns\":%.1f,\"mean_ns\":%.1f,\"stddev_ns\":%.1f,\"throughput_mbps\":%.2f,\"calls_per_sec\":%.1f,"
+               "\"ns_per_op\":%.2f}",
+               test, name, (unsigned long)result.repetitions, (unsigned long)result.inner_iterations,
+               (unsigned long)result.bytes_per_call, result.min_ns, result.median_ns, result.p99_ns,
+               result.max_ns, result.mean_ns, result.stddev_ns, result.throughput_mbps,
+               result.calls_per_sec, result.ns_per_op);
+}
+
+void TestReporter::heap(const std::string& test_name, HeapRegion region, const HeapRegionUsage& usage, bool shared)
+{
+    char json[192];
+    snprintf(json, sizeof(json),
+             ",\"region\":\"%s\",\"leaked_bytes\":%ld,\"allocation_change\":%ld,"
+             "\"largest_free_block\":%lu,\"largest_block_change\":%ld,\"shared\":%s}",
+             HeapSnapshot::regionName(region), (long)usage.leaked_bytes, (long)usage.allocation_change,
+             (unsigned long)usage.largest_free_block, (long)usage.largest_block_change,
+             shared ? "true" : "false");
+    std::string record = "{\"type\":\"heap\",\"test\":\"" + escape(test_name) + "\"" + json;
+    emit(record.c_str());
+}
+
+void TestReporter::soakWindow(const std::string& test_name, const SoakWindow& window,
+                              const SoakHeapWindow& heap)
+{
+    char json[320];
+    snprintf(json, sizeof(json),
+             ",\"start_ms\":%lu,\"duration_ms\":%lu,\"runs\":%u,\"failures\":%u,"
+             "\"runs_per_min\":%.2f,\"p50_us\":%lu,\"p95_us\":%lu,\"max_us\":%lu,\"leaked_bytes\":%ld,"
+             "\"stack_free_min\":%ld,\"internal_free_min\":%lu,\"spiram_free_min\":%lu}",
+             (unsigned long)window.start_ms, (unsigned long)window.duration_ms,
+             (unsigned)window.runs, (unsigned)window.failures,
+             window.duration_ms > 0 ? window.runs * 60000.0 / window.duration_ms : 0.0,
+             (unsigned long)window.p50_us, (unsigned long)window.p95_us, (unsigned long)window.max_us,
+             (long)window.leaked_bytes,
+             window.stack_free_min == UINT32_MAX ? -1L : (long)window.stack_free_min,
+             (unsigned long)heap.internal_free_min, (unsigned long)heap.spiram_free_min);
+    std::string record = "{\"type\":\"soak_window\",\"test\":\"" + escape(test_name) + "\"" + json;
+    emit(record.c_str());
+}
+
+void TestReporter::soakTrend(const SoakTrend& trend)
+{
+    char value[32];
+    snprintf(value, sizeof(value), "%.1f", trend.value);
+    std::string json = "{\"type\":\"soak_trend\",\"kind\":\"" + std::string(SoakTrend::kindName(trend.kind)) +
+                       "\",\"test\":\"" + escape(trend.test) + "\",\"value\":" + value +
+                       ",\"message\":\"" + escape(trend.message) + "\"}";
+    emit(json.c_str());
+}
+
+std::string TestReporter::escape(const std::string& text)
+{
+    std::string escaped;
+    escaped.reserve(text.size());
+    char code[8];
+    for (char c : text) {
+        escapeChar(c, code);
+        escaped += code;
+    }
+    return escaped;
+}
+
+void TestReporter::escape(const char* text, char* out, size_t size)
+{
+    size_t length = 0;
+    char code[8];
+    for (; *text; text++) {
+        escapeChar(*text, code);
+        size_t code_length = strlen(code);
+        if (length + code_length >= size) {
+            break;      // Cut before the character, never inside an escape
+        }
+        memcpy(out + length, code, code_length);
+        length += code_length;
+    }
+    out[length] = '\0';
+}
+
+void TestReporter::escapeChar(char c, char* code)
+{
+    switch (c) {
+        case '"':   strcpy(code, "\\\""); break;
+        case '\\':  strcpy(code, "\\\\"); break;
+        case '\n':  strcpy(code, "\\n"); break;
+        case '\r':  strcpy(code, "\\r"); break;
+        case '\t':  strcpy(code, "\\t"); break;
+        default:
+            if ((unsigned char)c < 0x20) {
+                snprintf(code, 8, "\\u%04x", c);
+            } else {
+                code[0] = c;
+                code[1] = '\0';
+            }
+            break;
+    }
+}
+
+void TestReporter::emit(const char* json)
+{
+    if (!enabled_) {
+        return;
+    }
+    // Queued with the test log in deferred mode
+    TestLog::writeRaw(TEST_REPORT_PREFIX, json);
+}
+
+void TestReporter::emitFormat(const char* format, ...)
+{
+    if (!enabled_) {
+        return;
+    }
+    // Raw arguments into the log ring in deferred mode, formatted when the run is over
+    va_list args;
+    va_start(args, format);
+    TestLog::write("TestReporter", TestLog::Level::RAW, "", format, args);
+    va_end(args);
+}
@@ -1,4 +1,5 @@
 #include "wifi_test.hpp"
+#include "esp_timer.h"
 #include <cstring>
 #include <cstdlib>
 
@@ -28,6 +29,10 @@ WiFiTest::WiFiTest()
     wifi_config_.max_retry = max_retries_;
     wifi_config_.timeout_ms = connection_timeout_;
     wifi_config_.auto_reconnect = auto_reconnect_;
+    setResources(TEST_RESOURCE_WIFI);
+    addTag("hardware:wifi");
+    addTag("network");
+    addTag("slow");     // Connection stability phase
     
     // Initialize connection info
     memset(&connection_info_, 0, sizeof(wifi_info_t));
@@ -45,11 +50,12 @@ esp_err_t WiFiTest::setup()
     
     // Add test steps
     addStep("Initialize WiFi manager", [this]() { return initializeWiFiManager(); });
-    addStep("Test WiFi connection", [this]() { return testWiFiConnection(); });
-    addStep("Test connection stability", [this]() { return testConnectionStability(); });
-    addStep("Test network scan", [this]() { return testNetworkScan(); });
-    addStep("Test reconnection", [this]() { return testReconnection(); });
-    addStep("Measure connection performance", [this]() { return measureConnectionPerformance(); });
+    addStep("Test WiFi connection", [this]() { return testWiFiConnection(); }, connection_timeout_ + 5000);
+    addStep("Test connection stability", [this]() { return testConnectionStability(); },
+            stability_test_duration_ + 5000);
+    addStep("Test network scan", [this]() { return testNetworkScan(); }, 15000);
+    addStep("Test reconnection", [this]() { return testReconnection(); }, connection_timeout_ + 10000);
+    addStep("Measure connection performance", [this]() { return measureConnectionPerformance(); }, 15000);
     
     logPass("WiFi test setup completed");
     return ESP_OK;
@@ -166,15 +172,22 @@ esp_err_t WiFiTest::testConnectionStability()
     uint32_t disconnect_count = 0;
     
     while ((xTaskGetTickCount() * portTICK_PERIOD_MS - start_time) < stability_test_duration_) {
+        if (shouldAbort()) {
+            logError("Stability test stopped after %lu checks", check_count);
+            return ESP_ERR_TIMEOUT;
+        }
         check_count++;
         
+        int64_t check_start_us = esp_timer_get_time();
         if (!wifi_manager_is_connected()) {
             disconnect_count++;
             logError("Unexpected disconnection detected (check %lu)", check_count);
         } else {
             // Get connection info
             wifi_info_t info;
-            if (wifi_manager_get_info(&info) == ESP_OK) {
+            esp_err_t info_ret = wifi_manager_get_info(&info);
+            recordLatency((uint32_t)(esp_timer_get_time() - check_start_us));
+            if (info_ret == ESP_OK) {
                 // Log RSSI occasionally
                 if (check_count % 10 == 0) {
                     logInfo("Stability check %lu: RSSI=%d dBm, IP=%s", 
@@ -210,8 +223,9 @@ esp_err_t WiFiTest::testNetworkScan()
     esp_err_t ret = wifi_manager_scan_start();
     TEST_ASSERT_OK(ret);
     
-    // Wait for scan to complete
-    vTaskDelay(pdMS_TO_TICKS(5000));
+    // Wait for the results to reach the scan table
+    ret = wifi_manager_scan_wait(5000);
+    TEST_ASSERT_OK(ret);
     
     // Get scan results
     uint16_t scan_count = wifi_manager_get_scan_count();
@@ -219,21 +233,22 @@ esp_err_t WiFiTest::testNetworkScan()
     
     TEST_ASSERT(scan_count > 0, "No WiFi networks found in scan");
     
-    // Look for our target network
+    // Look for our target network, strongest first
     bool target_found = false;
-    for (uint16_t i = 0; i < scan_count && i < 10; i++) {  // Limit to first 10
-        wifi_ap_record_t ap_info;
-        if (wifi_manager_get_scan_result(i, &ap_info) == ESP_OK) {
-            logInfo("Network %d: SSID=%s, RSSI=%d dBm, Channel=%d", 
-                    i + 1, (char*)ap_info.ssid, ap_info.rssi, ap_info.primary);
-            
-            if (strcmp((char*)ap_info.ssid, wifi_config_.ssid) == 0) {
-                target_found = true;
-                logPass("Target network '%s' found with RSSI=%d dBm", 
-                        wifi_config_.ssid, ap_info.rssi);
-            }
+    wifi_scan_iter_t iter;
+    TEST_ASSERT_OK(wifi_manager_scan_iter_begin(&iter, NULL));
+    const wifi_scan_entry_t *entry;
+    for (int i = 0; i < 10 && (entry = wifi_manager_scan_iter_next(&iter)) != NULL; i++) {  // Limit to first 10
+        logInfo("Network %d: SSID=%s, RSSI=%d dBm, Channel=%d", 
+                i + 1, entry->ssid, entry->rssi, entry->channel);
+        
+        if (strcmp(entry->ssid, wifi_config_.ssid) == 0) {
+            target_found = true;
+            logPass("Target network '%s' found with RSSI=%d dBm", 
+                    wifi_config_.ssid, entry->rssi);
         }
     }
+    wifi_manager_scan_iter_end(&iter);
     
     if (!target_found) {
         logError("Target network '%s' not found in scan results", wifi_config_.ssid);
@@ -259,6 +274,9 @@ esp_err_t WiFiTest::testReconnection()
     uint32_t disconnect_timeout = 5000;  // 5 seconds
     uint32_t disconnect_start = xTaskGetTickCount() * portTICK_PERIOD_MS;
     while (wifi_manager_is_connected()) {
+        if (shouldAbort()) {
+            return ESP_ERR_TIMEOUT;
+        }
         if ((xTaskGetTickCount() * portTICK_PERIOD_MS - disconnect_start) > disconnect_timeout) {
             logError("Timeout waiting for disconnection");
             break;
@@ -360,6 +378,10 @@ void WiFiTest::handleWiFiEvent(wifi_status_t status, wifi_info_t *info)
             logError("WiFi event: Connection timeout");
             break;
             
+        case WIFI_STATUS_ROAMING:
+            logInfo("WiFi event: Roaming to a stronger AP");
+            break;
+            
         default:
             logError("WiFi event: Unknown status %d", status);
             break;
@@ -372,7 +394,7 @@ esp_err_t WiFiTest::waitForConnection()
     uint32_t start_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
     
     while (!wifi_manager_is_connected()) {
-        if ((xTaskGetTickCount() * portTICK_PERIOD_MS - start_time) > timeout) {
+        if (shouldAbort() || (xTaskGetTickCount() * portTICK_PERIOD_MS - start_time) > timeout) {
             return ESP_ERR_TIMEOUT;
         }
         vTaskDelay(pdMS_TO_TICKS(100));
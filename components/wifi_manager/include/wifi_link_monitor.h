@@ -0,0 +1,104 @@
+#ifndef WIFI_LINK_MONITOR_H
+#define WIFI_LINK_MONITOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Link monitor configuration constants
+#define WIFI_LINK_MONITOR_HISTORY       60      // Samples kept, one per RSSI sample period
+#define WIFI_LINK_RSSI_FLOOR_DBM        (-90)   // Scores 0
+#define WIFI_LINK_RSSI_CEILING_DBM      (-50)   // Scores 100
+#define WIFI_LINK_RETRY_PENALTY         15      // Per association retry in a sample
+#define WIFI_LINK_BEACON_LOSS_PENALTY   30      // Per beacon timeout in a sample
+#define WIFI_LINK_HINT_HYSTERESIS       5       // Score margin needed to step a tier up
+#define WIFI_LINK_HINT_TIERS            3
+
+// One link quality sample
+typedef struct {
+    uint32_t timestamp_ms;
+    int8_t rssi;                // dBm
+    uint8_t retries;            // Association retries since the previous sample
+    uint8_t beacon_losses;      // Beacon timeouts since the previous sample
+    uint8_t quality;            // Smoothed score after this sample, 0-100
+    uint32_t rx_kbps;           // Application goodput received
+    uint32_t tx_kbps;           // Application goodput sent
+} wifi_link_sample_t;
+
+// Image stream settings recommended to the host
+typedef struct {
+    uint32_t bitrate_kbps;
+    uint16_t width;
+    uint16_t height;
+    uint8_t quality;            // Smoothed link score the hint is based on
+} wifi_stream_hint_t;
+
+// Link monitor state
+typedef struct {
+    wifi_link_sample_t samples[WIFI_LINK_MONITOR_HISTORY];
+    uint16_t head;              // Next slot to write
+    uint16_t count;
+    uint32_t quality_q8;        // Smoothed score, 8 fractional bits
+    uint8_t tier;               // Index into the hint table
+} wifi_link_monitor_t;
+
+// Function prototypes
+
+/**
+ * @brief Clear the history and start from the best tier
+ *
+ * @param monitor Link monitor
+ */
+void wifi_link_monitor_reset(wifi_link_monitor_t *monitor);
+
+/**
+ * @brief Score one sample without smoothing
+ *
+ * @param sample Link sample
+ * @return uint8_t Score, 0-100
+ */
+uint8_t wifi_link_monitor_score(const wifi_link_sample_t *sample);
+
+/**
+ * @brief Add a sample to the history
+ *
+ * Updates the smoothed score and stores it in the sample's quality field.
+ *
+ * @param monitor Link monitor
+ * @param sample Link sample
+ * @return uint8_t Smoothed score, 0-100
+ */
+uint8_t wifi_link_monitor_push(wifi_link_monitor_t *monitor, const wifi_link_sample_t *sample);
+
+/**
+ * @brief Copy the history, oldest sample first
+ *
+ * @param monitor Link monitor
+ * @param samples Output buffer
+ * @param max_samples Output buffer size
+ * @return size_t Number of samples copied
+ */
+size_t wifi_link_monitor_history(const wifi_link_monitor_t *monitor, wifi_link_sample_t *samples, size_t max_samples);
+
+/**
+ * @brief Get the recommended stream settings for the current score
+ *
+ * The tier drops as soon as the score falls below its threshold and only
+ * rises again once the score clears the next threshold by
+ * WIFI_LINK_HINT_HYSTERESIS.
+ *
+ * @param monitor Link monitor
+ * @param hint Pointer to store the recommendation
+ * @return true if the recommendation changed since the previous call
+ */
+bool wifi_link_monitor_hint(wifi_link_monitor_t *monitor, wifi_stream_hint_t *hint);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WIFI_LINK_MONITOR_H
@@ -6,6 +6,9 @@
 #include "esp_err.h"
 #include "esp_wifi.h"
 #include "esp_event.h"
+#include "wifi_link_monitor.h"
+#include "wifi_scan_table.h"
+#include "wifi_roam.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -16,6 +19,23 @@ extern "C" {
 #define WIFI_MANAGER_PASSWORD_MAX_LEN   64
 #define WIFI_MANAGER_MAX_RETRY          5
 #define WIFI_MANAGER_CONNECT_TIMEOUT_MS 10000
+#define WIFI_MANAGER_EVENT_QUEUE_LEN    8
+#define WIFI_MANAGER_DISPATCH_QUEUE_LEN 16
+#define WIFI_MANAGER_RSSI_SAMPLE_MS     1000
+#define WIFI_MANAGER_HINT_REPEAT_SAMPLES 10     // Re-send an unchanged stream hint this often
+#define WIFI_MANAGER_DISPATCH_TASK_NAME "wifi_dispatch"
+#define WIFI_MANAGER_WAIT_FOREVER       UINT32_MAX
+#define WIFI_MANAGER_CONNECT_HIST_BINS  6       // <250, <500, <1000, <2000, <4000, >=4000 ms
+#define WIFI_MANAGER_LOW_LATENCY_TX_POWER 78    // 0.25 dBm units, 19.5 dBm
+#define WIFI_MANAGER_RTT_PROBE_COUNT    20
+#define WIFI_MANAGER_RTT_PROBE_INTERVAL_MS 100
+#define WIFI_MANAGER_SCAN_MAX_RECORDS   32      // Records fetched from the driver per scan
+#define WIFI_MANAGER_BG_SCAN_INTERVAL_MS 15000  // Background scan period while the link is degraded
+#define WIFI_MANAGER_BG_SCAN_QUALITY    40      // Background scans run below this link score
+#define WIFI_MANAGER_BG_SCAN_DWELL_MS   40      // Active dwell per channel, bounds time off channel
+#define WIFI_MANAGER_MAX_NETWORKS       4       // Networks to roam to besides the primary one
+#define WIFI_MANAGER_ROAM_SCAN_INTERVAL_MS 5000 // Roam scan period while the RSSI is below the threshold
+#define WIFI_MANAGER_ROAM_HOLDOFF_MS    10000   // No new roam this soon after the last one
 
 // WiFi connection status
 typedef enum {
@@ -23,9 +43,34 @@ typedef enum {
     WIFI_STATUS_CONNECTING,
     WIFI_STATUS_CONNECTED,
     WIFI_STATUS_FAILED,
-    WIFI_STATUS_TIMEOUT
+    WIFI_STATUS_TIMEOUT,
+    WIFI_STATUS_ROAMING             // Moving to another AP; sessions should be kept
 } wifi_status_t;
 
+// Power save, TX power and bandwidth trade-off of the station
+typedef enum {
+    WIFI_LINK_PROFILE_BALANCED = 0,     // Modem sleep, driver TX power, HT20
+    WIFI_LINK_PROFILE_LOW_LATENCY,      // No power save, fixed TX power, HT40
+    WIFI_LINK_PROFILE_COUNT
+} wifi_link_profile_t;
+
+// Round-trip latency measured by wifi_manager_probe_rtt()
+typedef struct {
+    wifi_link_profile_t profile;        // Profile active during the probe
+    uint32_t sent;
+    uint32_t received;
+    uint32_t min_ms;
+    uint32_t avg_ms;
+    uint32_t max_ms;
+} wifi_rtt_stats_t;
+
+// Additional network to roam to
+typedef struct {
+    char ssid[WIFI_MANAGER_SSID_MAX_LEN];
+    char password[WIFI_MANAGER_PASSWORD_MAX_LEN];
+    uint8_t priority;           // Higher is preferred, compared with wifi_manager_config_t.priority
+} wifi_manager_network_t;
+
 // WiFi configuration structure
 typedef struct {
     char ssid[WIFI_MANAGER_SSID_MAX_LEN];
@@ -33,24 +78,51 @@ typedef struct {
     uint8_t max_retry;
     uint32_t timeout_ms;
     bool auto_reconnect;
+    bool fast_reconnect;        // Go straight to the BSSID and channel cached in NVS
+    bool use_static_ip;         // With fast_reconnect, reuse the cached IP lease instead of DHCP
+    wifi_link_profile_t link_profile;
+    uint32_t rssi_sample_ms;    // RSSI refresh period while connected, 0 for the default
+    uint32_t bg_scan_interval_ms;   // Background scan period on a degraded link, 0 for the default
+    uint8_t priority;           // Priority of ssid against networks[]
+    wifi_manager_network_t networks[WIFI_MANAGER_MAX_NETWORKS];  // Fallback and roaming networks
+    uint8_t network_count;
+    bool roaming;               // Move to a stronger AP of any configured network
+    int8_t roam_rssi;           // Roam below this RSSI, 0 for WIFI_ROAM_RSSI_THRESHOLD
 } wifi_manager_config_t;
 
 // WiFi connection information
 typedef struct {
     wifi_status_t status;
     char ssid[WIFI_MANAGER_SSID_MAX_LEN];
-    uint8_t rssi;
+    int8_t rssi;                        // dBm
     uint8_t channel;
+    uint8_t link_quality;               // Smoothed link score, 0-100
     char ip_addr[16];
     char gateway[16];
     char netmask[16];
     uint32_t connection_time_ms;
     uint8_t retry_count;
+    uint32_t last_connect_ms;           // Connect request or dropout to IP address
+    bool last_connect_cached;           // Last connect used the cached BSSID and channel
+    uint16_t connect_hist_cached[WIFI_MANAGER_CONNECT_HIST_BINS];  // Connect times via the cache
+    uint16_t connect_hist_scan[WIFI_MANAGER_CONNECT_HIST_BINS];    // Connect times via a full scan
+    wifi_roam_stats_t roam;             // Roams and their time without link
+    wifi_link_profile_t link_profile;
 } wifi_info_t;
 
+// Status change delivered through the event queue
+typedef struct {
+    wifi_status_t status;
+    uint8_t retry_count;
+    uint32_t elapsed_ms;        // Since the connect request
+} wifi_manager_event_t;
+
 // Event callback function type
 typedef void (*wifi_event_callback_t)(wifi_status_t status, wifi_info_t *info);
 
+// Stream hint callback function type
+typedef void (*wifi_stream_hint_callback_t)(const wifi_stream_hint_t *hint);
+
 // Function prototypes
 
 /**
@@ -70,11 +142,55 @@ esp_err_t wifi_manager_deinit(void);
 /**
  * @brief Connect to WiFi network
  * 
+ * Blocks until connected, failed or config->timeout_ms has passed.
+ * 
  * @param config WiFi configuration
  * @return esp_err_t ESP_OK on success
  */
 esp_err_t wifi_manager_connect(const wifi_manager_config_t *config);
 
+/**
+ * @brief Start connecting to a WiFi network without waiting
+ * 
+ * Returns as soon as the request is handed to the WiFi driver. Progress is
+ * reported through the callback and the event queue; the outcome can be
+ * awaited with wifi_manager_wait_connect(). The driver is started only once,
+ * later calls for the same network just reassociate.
+ * 
+ * @param config WiFi configuration
+ * @return esp_err_t ESP_OK if the connect request was started
+ */
+esp_err_t wifi_manager_connect_async(const wifi_manager_config_t *config);
+
+/**
+ * @brief Wait for the outcome of the last connect request
+ * 
+ * @param timeout_ms Maximum time to wait, WIFI_MANAGER_WAIT_FOREVER to wait for the outcome
+ * @return esp_err_t ESP_OK if connected, ESP_ERR_WIFI_CONN if the retries
+ *         were exhausted, ESP_ERR_TIMEOUT if the connect timed out or no
+ *         outcome arrived in time, ESP_ERR_INVALID_STATE if no connect was requested
+ */
+esp_err_t wifi_manager_wait_connect(uint32_t timeout_ms);
+
+/**
+ * @brief Receive the next status change
+ * 
+ * Events are queued for up to WIFI_MANAGER_EVENT_QUEUE_LEN changes; when the
+ * queue is full the oldest event is dropped.
+ * 
+ * @param event Pointer to store the event
+ * @param timeout_ms Maximum time to wait, 0 to poll
+ * @return esp_err_t ESP_OK if an event was received, ESP_ERR_TIMEOUT otherwise
+ */
+esp_err_t wifi_manager_get_event(wifi_manager_event_t *event, uint32_t timeout_ms);
+
+/**
+ * @brief Forget the BSSID, channel and IP lease cached in NVS
+ * 
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t wifi_manager_clear_link_cache(void);
+
 /**
  * @brief Disconnect from WiFi network
  * 
@@ -92,6 +208,10 @@ wifi_status_t wifi_manager_get_status(void);
 /**
  * @brief Get WiFi connection information
  * 
+ * Returns a consistent copy of a snapshot refreshed on status changes and
+ * every rssi_sample_ms while connected. Does not call into the WiFi driver
+ * and may be called from any task at any rate.
+ * 
  * @param info Pointer to store WiFi information
  * @return esp_err_t ESP_OK on success
  */
@@ -107,33 +227,180 @@ bool wifi_manager_is_connected(void);
 /**
  * @brief Set event callback function
  * 
+ * The callback runs in the WiFi manager dispatch task, not in the system
+ * event loop, so it may log or block briefly. The info snapshot is taken
+ * when the callback is dispatched.
+ * 
  * @param callback Callback function for WiFi events
  */
 void wifi_manager_set_callback(wifi_event_callback_t callback);
 
+/**
+ * @brief Switch the link profile at runtime
+ * 
+ * Power save and TX power take effect immediately; a bandwidth change
+ * applies from the next association.
+ * 
+ * @param profile Link profile
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t wifi_manager_set_link_profile(wifi_link_profile_t profile);
+
+/**
+ * @brief Get the active link profile
+ * 
+ * @return wifi_link_profile_t Active link profile
+ */
+wifi_link_profile_t wifi_manager_get_link_profile(void);
+
+/**
+ * @brief Get a printable name for a link profile
+ * 
+ * @param profile Link profile
+ * @return const char* Profile name
+ */
+const char *wifi_manager_link_profile_to_string(wifi_link_profile_t profile);
+
+/**
+ * @brief Measure the round-trip latency to a host with ICMP echo
+ * 
+ * Blocks for about count * WIFI_MANAGER_RTT_PROBE_INTERVAL_MS. The result is
+ * also kept as the latest measurement of the active link profile.
+ * 
+ * @param host IPv4 address of the host agent, NULL for the gateway
+ * @param count Number of echo requests
+ * @param stats Pointer to store the result (may be NULL)
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_STATE if not connected
+ */
+esp_err_t wifi_manager_probe_rtt(const char *host, uint16_t count, wifi_rtt_stats_t *stats);
+
+/**
+ * @brief Get the latest round-trip measurement taken with a link profile
+ * 
+ * @param profile Link profile
+ * @param stats Pointer to store the result
+ * @return esp_err_t ESP_OK on success, ESP_ERR_NOT_FOUND if never probed
+ */
+esp_err_t wifi_manager_get_rtt_stats(wifi_link_profile_t profile, wifi_rtt_stats_t *stats);
+
+/**
+ * @brief Count application payload for the goodput measurement
+ * 
+ * Call from the code that receives images and sends telemetry. Safe to call
+ * from any task.
+ * 
+ * @param rx_bytes Payload bytes received
+ * @param tx_bytes Payload bytes sent
+ */
+void wifi_manager_add_traffic(size_t rx_bytes, size_t tx_bytes);
+
+/**
+ * @brief Copy the link quality history, oldest sample first
+ * 
+ * One sample is taken every rssi_sample_ms while connected.
+ * 
+ * @param samples Output buffer
+ * @param max_samples Output buffer size, up to WIFI_LINK_MONITOR_HISTORY
+ * @return size_t Number of samples copied
+ */
+size_t wifi_manager_get_link_history(wifi_link_sample_t *samples, size_t max_samples);
+
+/**
+ * @brief Get the latest recommended image stream settings
+ * 
+ * @param hint Pointer to store the recommendation
+ * @return esp_err_t ESP_OK on success, ESP_ERR_NOT_FOUND before the first sample
+ */
+esp_err_t wifi_manager_get_stream_hint(wifi_stream_hint_t *hint);
+
+/**
+ * @brief Set the stream hint callback
+ * 
+ * Called from the dispatch task when the recommendation changes and every
+ * WIFI_MANAGER_HINT_REPEAT_SAMPLES samples otherwise, so a host that joins
+ * late still learns it.
+ * 
+ * @param callback Callback function for stream hints
+ */
+void wifi_manager_set_stream_hint_callback(wifi_stream_hint_callback_t callback);
+
 /**
  * @brief Start WiFi scan
  * 
+ * Returns immediately. The dispatch task merges the results into the scan
+ * table, which keeps each access point with the time it was last seen.
+ * 
  * @return esp_err_t ESP_OK on success
  */
 esp_err_t wifi_manager_scan_start(void);
 
+/**
+ * @brief Wait for the running scan to finish
+ * 
+ * @param timeout_ms Maximum wait, WIFI_MANAGER_WAIT_FOREVER for no limit
+ * @return esp_err_t ESP_OK once the results are in the table, ESP_ERR_TIMEOUT otherwise
+ */
+esp_err_t wifi_manager_scan_wait(uint32_t timeout_ms);
+
 /**
  * @brief Get scan results count
  * 
- * @return uint16_t Number of found networks
+ * @return uint16_t Number of access points in the scan table
  */
 uint16_t wifi_manager_get_scan_count(void);
 
 /**
  * @brief Get scan result
  * 
+ * Copies one table entry into a driver record, strongest first. Only ssid,
+ * bssid, rssi, primary and authmode are filled in; prefer the scan iterator.
+ * 
  * @param index Index of scan result
  * @param ap_info Pointer to store AP information
  * @return esp_err_t ESP_OK on success
  */
 esp_err_t wifi_manager_get_scan_result(uint16_t index, wifi_ap_record_t *ap_info);
 
+/**
+ * @brief Start a walk over the scan table, strongest access point first
+ * 
+ * Locks the table until wifi_manager_scan_iter_end(); keep the walk short,
+ * scan results are merged only after it ends.
+ * 
+ * @param iter Iterator to initialize
+ * @param ssid Only return this network, NULL for all
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t wifi_manager_scan_iter_begin(wifi_scan_iter_t *iter, const char *ssid);
+
+/**
+ * @brief Start a walk over the roaming candidates
+ * 
+ * Like wifi_manager_scan_iter_begin() for the SSID currently joined,
+ * skipping the access point the station is associated with.
+ * 
+ * @param iter Iterator to initialize
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t wifi_manager_roam_iter_begin(wifi_scan_iter_t *iter);
+
+/**
+ * @brief Get the next scan table entry
+ * 
+ * The entry is not copied and is only valid until wifi_manager_scan_iter_end().
+ * 
+ * @param iter Iterator
+ * @return const wifi_scan_entry_t* Next entry, NULL at the end
+ */
+const wifi_scan_entry_t *wifi_manager_scan_iter_next(wifi_scan_iter_t *iter);
+
+/**
+ * @brief End a walk over the scan table and unlock it
+ * 
+ * @param iter Iterator
+ */
+void wifi_manager_scan_iter_end(wifi_scan_iter_t *iter);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,120 @@
+#ifndef WIFI_ROAM_H
+#define WIFI_ROAM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "wifi_scan_table.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Roaming configuration constants
+#define WIFI_ROAM_RSSI_THRESHOLD    -70     // Look for a better AP below this RSSI
+#define WIFI_ROAM_HYSTERESIS_DB     8       // A candidate must beat the current AP by this much
+#define WIFI_ROAM_PRIORITY_DB       6       // RSSI credit per network priority step
+#define WIFI_ROAM_GAP_BINS          6       // <50, <100, <250, <500, <1000, >=1000 ms
+
+// When and where to roam
+typedef struct {
+    int8_t rssi_threshold;      // dBm
+    uint8_t hysteresis_db;
+    uint8_t priority_db;
+} wifi_roam_policy_t;
+
+// A network the station may join
+typedef struct {
+    char ssid[WIFI_SCAN_SSID_LEN];
+    uint8_t priority;           // Higher is preferred
+} wifi_roam_network_t;
+
+// Access point picked by wifi_roam_select()
+typedef struct {
+    const wifi_scan_entry_t *entry;     // Points into the scan table
+    int network;                        // Index into the network list
+    int16_t score;
+} wifi_roam_choice_t;
+
+// Completed roams and the time without link each one cost
+typedef struct {
+    uint16_t count;
+    uint16_t failed;                    // Target AP not joined, fell back to a reconnect
+    uint32_t last_gap_ms;               // Leaving the old AP to an IP address on the new one
+    uint32_t max_gap_ms;
+    uint16_t gap_hist[WIFI_ROAM_GAP_BINS];
+} wifi_roam_stats_t;
+
+// Function prototypes
+
+/**
+ * @brief Fill in the default policy
+ *
+ * @param policy Policy to initialize
+ */
+void wifi_roam_policy_default(wifi_roam_policy_t *policy);
+
+/**
+ * @brief Find a network by SSID
+ *
+ * @param networks Network list
+ * @param count Number of networks
+ * @param ssid SSID to look up
+ * @return int Index into the list, -1 if not configured
+ */
+int wifi_roam_find_network(const wifi_roam_network_t *networks, size_t count, const char *ssid);
+
+/**
+ * @brief Rate an access point: RSSI plus the priority credit of its network
+ *
+ * @param policy Roaming policy
+ * @param rssi RSSI in dBm
+ * @param priority Network priority
+ * @return int16_t Score, higher is better
+ */
+int16_t wifi_roam_score(const wifi_roam_policy_t *policy, int8_t rssi, uint8_t priority);
+
+/**
+ * @brief Pick the access point to move to
+ *
+ * Without a current network (current_network < 0) the best scoring AP of
+ * any configured network is picked. Otherwise an AP is only picked while
+ * current_rssi is below the threshold, and only if it beats the current AP
+ * by the hysteresis.
+ *
+ * @param policy Roaming policy
+ * @param networks Network list
+ * @param count Number of networks
+ * @param table Committed scan table
+ * @param current_network Index of the joined network, -1 if none
+ * @param current_rssi RSSI of the joined AP
+ * @param current_bssid BSSID of the joined AP, NULL if none
+ * @param choice Pointer to store the pick
+ * @return true if an access point was picked
+ */
+bool wifi_roam_select(const wifi_roam_policy_t *policy, const wifi_roam_network_t *networks, size_t count,
+                      const wifi_scan_table_t *table, int current_network, int8_t current_rssi,
+                      const uint8_t *current_bssid, wifi_roam_choice_t *choice);
+
+/**
+ * @brief Collect the channels of an 802.11k neighbor report
+ *
+ * @param report Neighbor report elements, as handed to the report callback
+ * @param len Length of the report
+ * @return uint16_t Bit n set for channel n (1-14)
+ */
+uint16_t wifi_roam_neighbor_channels(const uint8_t *report, size_t len);
+
+/**
+ * @brief Record a completed roam
+ *
+ * @param stats Roam statistics
+ * @param gap_ms Time without link
+ */
+void wifi_roam_stats_record(wifi_roam_stats_t *stats, uint32_t gap_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WIFI_ROAM_H
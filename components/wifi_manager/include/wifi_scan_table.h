@@ -0,0 +1,106 @@
+#ifndef WIFI_SCAN_TABLE_H
+#define WIFI_SCAN_TABLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Scan table configuration constants
+#define WIFI_SCAN_TABLE_SIZE        24      // Access points kept across scans
+#define WIFI_SCAN_SSID_LEN          33      // 32 characters and the terminator
+#define WIFI_SCAN_MAX_AGE_MS        60000   // Entries not seen for this long are dropped
+
+// One access point seen by a scan
+typedef struct {
+    uint8_t bssid[6];
+    char ssid[WIFI_SCAN_SSID_LEN];
+    int8_t rssi;                // dBm
+    uint8_t channel;
+    uint8_t authmode;           // wifi_auth_mode_t
+    uint32_t timestamp_ms;      // Last scan that saw this BSSID
+} wifi_scan_entry_t;
+
+// Scan table state
+typedef struct {
+    wifi_scan_entry_t entries[WIFI_SCAN_TABLE_SIZE];
+    uint8_t order[WIFI_SCAN_TABLE_SIZE];    // Entry indices, strongest first
+    uint16_t count;
+} wifi_scan_table_t;
+
+// Position and filter of a walk over the table, strongest entry first
+typedef struct {
+    uint16_t pos;
+    const char *ssid;                       // Only this network, NULL for all
+    const uint8_t *exclude_bssid;           // Skip this AP, NULL for none
+} wifi_scan_iter_t;
+
+// Function prototypes
+
+/**
+ * @brief Remove all entries
+ *
+ * @param table Scan table
+ */
+void wifi_scan_table_reset(wifi_scan_table_t *table);
+
+/**
+ * @brief Add or refresh one access point
+ *
+ * An entry with the same BSSID is overwritten. When the table is full the
+ * entry seen longest ago is replaced; if all entries are from the current
+ * scan, the weakest one is replaced by a stronger AP. Call
+ * wifi_scan_table_commit() after the last record of a scan.
+ *
+ * @param table Scan table
+ * @param entry Access point to store
+ * @return true if the entry was stored
+ */
+bool wifi_scan_table_update(wifi_scan_table_t *table, const wifi_scan_entry_t *entry);
+
+/**
+ * @brief Drop stale entries and restore the RSSI order
+ *
+ * @param table Scan table
+ * @param now_ms Current time
+ * @param max_age_ms Entries last seen longer ago are removed
+ */
+void wifi_scan_table_commit(wifi_scan_table_t *table, uint32_t now_ms, uint32_t max_age_ms);
+
+/**
+ * @brief Start a walk over the table
+ *
+ * @param iter Iterator to initialize
+ * @param ssid Only return this network, NULL for all
+ * @param exclude_bssid Skip this access point, NULL for none
+ */
+void wifi_scan_iter_init(wifi_scan_iter_t *iter, const char *ssid, const uint8_t *exclude_bssid);
+
+/**
+ * @brief Get the next entry of a walk, strongest first
+ *
+ * The entry points into the table and stays valid until the next update.
+ *
+ * @param table Scan table
+ * @param iter Iterator
+ * @return const wifi_scan_entry_t* Next entry, NULL at the end
+ */
+const wifi_scan_entry_t *wifi_scan_table_next(const wifi_scan_table_t *table, wifi_scan_iter_t *iter);
+
+/**
+ * @brief Get an entry by RSSI rank
+ *
+ * @param table Scan table
+ * @param rank 0 for the strongest entry
+ * @return const wifi_scan_entry_t* Entry, NULL if rank is out of range
+ */
+const wifi_scan_entry_t *wifi_scan_table_at(const wifi_scan_table_t *table, uint16_t rank);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WIFI_SCAN_TABLE_H
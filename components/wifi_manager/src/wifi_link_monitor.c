@@ -0,0 +1,95 @@
+#include "wifi_link_monitor.h"
+#include <string.h>
+
+// Smoothing: each sample moves the score a quarter of the way
+#define QUALITY_SMOOTHING_SHIFT 2
+
+// Stream settings per tier, worst link first; the top tier is the full frame
+static const wifi_stream_hint_t hint_tiers[WIFI_LINK_HINT_TIERS] = {
+    { .bitrate_kbps = 600,  .width = 160, .height = 80 },
+    { .bitrate_kbps = 1500, .width = 240, .height = 120 },
+    { .bitrate_kbps = 3000, .width = 320, .height = 160 },
+};
+
+// Lowest smoothed score at which each tier is used
+static const uint8_t tier_min_quality[WIFI_LINK_HINT_TIERS] = { 0, 40, 70 };
+
+void wifi_link_monitor_reset(wifi_link_monitor_t *monitor)
+{
+    memset(monitor, 0, sizeof(wifi_link_monitor_t));
+    monitor->tier = WIFI_LINK_HINT_TIERS - 1;
+}
+
+uint8_t wifi_link_monitor_score(const wifi_link_sample_t *sample)
+{
+    int32_t score;
+    if (sample->rssi <= WIFI_LINK_RSSI_FLOOR_DBM) {
+        score = 0;
+    } else if (sample->rssi >= WIFI_LINK_RSSI_CEILING_DBM) {
+        score = 100;
+    } else {
+        score = (sample->rssi - WIFI_LINK_RSSI_FLOOR_DBM) * 100 /
+                (WIFI_LINK_RSSI_CEILING_DBM - WIFI_LINK_RSSI_FLOOR_DBM);
+    }
+
+    score -= sample->retries * WIFI_LINK_RETRY_PENALTY;
+    score -= sample->beacon_losses * WIFI_LINK_BEACON_LOSS_PENALTY;
+    return score < 0 ? 0 : (uint8_t)score;
+}
+
+uint8_t wifi_link_monitor_push(wifi_link_monitor_t *monitor, const wifi_link_sample_t *sample)
+{
+    int32_t score_q8 = (int32_t)wifi_link_monitor_score(sample) << 8;
+
+    if (monitor->count == 0) {
+        monitor->quality_q8 = score_q8;
+    } else {
+        int32_t quality_q8 = (int32_t)monitor->quality_q8;
+        quality_q8 += (score_q8 - quality_q8) >> QUALITY_SMOOTHING_SHIFT;
+        monitor->quality_q8 = (uint32_t)quality_q8;
+    }
+
+    wifi_link_sample_t *slot = &monitor->samples[monitor->head];
+    *slot = *sample;
+    slot->quality = (uint8_t)((monitor->quality_q8 + 128) >> 8);
+
+    monitor->head = (monitor->head + 1) % WIFI_LINK_MONITOR_HISTORY;
+    if (monitor->count < WIFI_LINK_MONITOR_HISTORY) {
+        monitor->count++;
+    }
+
+    return slot->quality;
+}
+
+size_t wifi_link_monitor_history(const wifi_link_monitor_t *monitor, wifi_link_sample_t *samples, size_t max_samples)
+{
+    size_t count = monitor->count < max_samples ? monitor->count : max_samples;
+
+    // Newest `count` samples, oldest first
+    size_t start = (monitor->head + WIFI_LINK_MONITOR_HISTORY - count) % WIFI_LINK_MONITOR_HISTORY;
+    for (size_t i = 0; i < count; i++) {
+        samples[i] = monitor->samples[(start + i) % WIFI_LINK_MONITOR_HISTORY];
+    }
+    return count;
+}
+
+bool wifi_link_monitor_hint(wifi_link_monitor_t *monitor, wifi_stream_hint_t *hint)
+{
+    uint8_t quality = (uint8_t)((monitor->quality_q8 + 128) >> 8);
+    uint8_t tier = monitor->tier;
+
+    while (tier > 0 && quality < tier_min_quality[tier]) {
+        tier--;
+    }
+    while (tier < WIFI_LINK_HINT_TIERS - 1 &&
+           quality >= tier_min_quality[tier + 1] + WIFI_LINK_HINT_HYSTERESIS) {
+        tier++;
+    }
+
+    bool changed = tier != monitor->tier;
+    monitor->tier = tier;
+
+    *hint = hint_tiers[tier];
+    hint->quality = quality;
+    return changed;
+}
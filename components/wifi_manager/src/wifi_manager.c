@@ -3,10 +3,21 @@
 #include "esp_wifi.h"
 #include "esp_event.h"
 #include "esp_netif.h"
+#include "nvs.h"
+#include "task_topology.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/event_groups.h"
+#include "freertos/queue.h"
+#include "freertos/timers.h"
+#include "freertos/semphr.h"
 #include "lwip/ip4_addr.h"
+#include "lwip/ip_addr.h"
+#include "ping/ping_sock.h"
+#if CONFIG_WPA_11KV_SUPPORT
+#include "esp_rrm.h"
+#include "esp_wnm.h"
+#endif
 #include <string.h>
 
 static const char *TAG = "WIFI_MANAGER";
@@ -14,42 +25,459 @@ static const char *TAG = "WIFI_MANAGER";
 // WiFi event bits
 #define WIFI_CONNECTED_BIT BIT0
 #define WIFI_FAIL_BIT      BIT1
+#define WIFI_TIMEOUT_BIT   BIT2
+#define WIFI_SCAN_DONE_BIT BIT3
+#define WIFI_RESULT_BITS   (WIFI_CONNECTED_BIT | WIFI_FAIL_BIT | WIFI_TIMEOUT_BIT)
+
+// Link cache in NVS
+#define WIFI_CACHE_NAMESPACE "wifi_manager"
+#define WIFI_CACHE_KEY       "link"
+#define WIFI_CACHE_VERSION   1
+
+// Last successful link, enough to skip the scan and DHCP on the next connect
+typedef struct {
+    uint8_t version;
+    uint8_t channel;
+    uint8_t bssid[6];
+    char ssid[WIFI_MANAGER_SSID_MAX_LEN];
+    esp_netif_ip_info_t ip_info;
+} wifi_link_cache_t;
+
+// Upper bounds of the connect time histogram bins; the last bin is open
+static const uint32_t connect_hist_edges_ms[WIFI_MANAGER_CONNECT_HIST_BINS - 1] = {250, 500, 1000, 2000, 4000};
 
 // Global variables
 static bool wifi_manager_initialized = false;
 static wifi_status_t current_status = WIFI_STATUS_DISCONNECTED;
-static wifi_info_t current_info = {0};
 static wifi_manager_config_t current_config = {0};
 static wifi_event_callback_t event_callback = NULL;
 static EventGroupHandle_t wifi_event_group = NULL;
+static QueueHandle_t wifi_event_queue = NULL;
+static TimerHandle_t connect_timer = NULL;
+static TimerHandle_t rssi_timer = NULL;
+static QueueHandle_t dispatch_queue = NULL;
+static TaskHandle_t dispatch_task_handle = NULL;
+static SemaphoreHandle_t dispatch_exit = NULL;
+static uint32_t dispatch_dropped = 0;
 static uint8_t retry_count = 0;
 static uint32_t connection_start_time = 0;
+static bool wifi_started = false;
+static bool connect_requested = false;
+static esp_netif_t *sta_netif = NULL;
+static wifi_config_t sta_config = {0};
+
+// Fast reconnect state
+static wifi_link_cache_t link_cache = {0};
+static bool link_cache_valid = false;
+static bool using_cached_link = false;
+static uint32_t attempt_start_time = 0;
+static uint32_t last_connect_ms = 0;
+static bool last_connect_cached = false;
+static uint16_t connect_hist_cached[WIFI_MANAGER_CONNECT_HIST_BINS] = {0};
+static uint16_t connect_hist_scan[WIFI_MANAGER_CONNECT_HIST_BINS] = {0};
+
+// Work handed from the event loop to the dispatch task
+typedef enum {
+    DISPATCH_STATUS = 0,        // Refresh the info cache and run the user callback
+    DISPATCH_SAVE_LINK,         // Store the new link in NVS
+    DISPATCH_SAMPLE_LINK,       // Take a link monitor sample and refresh the RSSI
+    DISPATCH_REFRESH,           // Refresh the info cache without a status change
+    DISPATCH_SCAN_DONE,         // Merge the driver's scan records into the table
+    DISPATCH_ROAM_SCAN,         // Scan the channels of an 802.11k neighbor report
+    DISPATCH_EXIT
+} dispatch_type_t;
+
+typedef struct {
+    dispatch_type_t type;
+    wifi_manager_event_t event;
+    esp_netif_ip_info_t ip_info;    // DISPATCH_SAVE_LINK only
+    uint16_t channels;              // DISPATCH_ROAM_SCAN only, bit n for channel n
+} dispatch_msg_t;
+
+// Callbacks may log and block, so they never run in the system event loop
+static const task_topology_entry_t dispatch_task_defaults = {
+    .name = WIFI_MANAGER_DISPATCH_TASK_NAME,
+    .core = 0,
+    .priority = 2,
+    .stack_size = 3072,
+    .stack = TASK_STACK_INTERNAL
+};
+
+// Info snapshot, written only by the dispatch task and read lock-free.
+// An odd sequence number means an update is in progress.
+static wifi_info_t info_cache = {0};
+static volatile uint32_t info_seq = 0;
+static portMUX_TYPE info_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Link monitor: history and hint written by the dispatch task, copied out under link_lock
+static wifi_link_monitor_t link_monitor;
+static wifi_stream_hint_t stream_hint = {0};
+static bool stream_hint_valid = false;
+static uint32_t samples_since_hint = 0;
+static wifi_stream_hint_callback_t stream_hint_callback = NULL;
+static portMUX_TYPE link_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Link events counted in the event loop, turned into per-sample deltas
+static uint32_t link_retries = 0;
+static uint32_t beacon_losses = 0;
+static uint32_t sampled_retries = 0;
+static uint32_t sampled_beacon_losses = 0;
+
+// Application payload counters, updated from any task
+static uint32_t traffic_rx_bytes = 0;
+static uint32_t traffic_tx_bytes = 0;
+static uint32_t last_sample_time = 0;
+
+// Link profile and round-trip measurements
+static wifi_link_profile_t link_profile = WIFI_LINK_PROFILE_BALANCED;
+static int8_t default_tx_power = 0;
+static wifi_rtt_stats_t rtt_stats[WIFI_LINK_PROFILE_COUNT] = {0};
+static bool rtt_stats_valid[WIFI_LINK_PROFILE_COUNT] = {false};
+
+// Accumulates one ICMP probe run in the ping task
+typedef struct {
+    SemaphoreHandle_t done;
+    uint32_t received;
+    uint32_t sum_ms;
+    uint32_t min_ms;
+    uint32_t max_ms;
+} rtt_probe_t;
+
+// Scan table, merged by the dispatch task and walked under scan_mutex.
+// Driver records land in a fixed buffer, so scans never touch the heap.
+static wifi_scan_table_t scan_table;
+static wifi_ap_record_t scan_records[WIFI_MANAGER_SCAN_MAX_RECORDS];
+static SemaphoreHandle_t scan_mutex = NULL;
+static bool scan_in_progress = false;
+static uint32_t last_scan_time = 0;
+static uint8_t associated_bssid[6] = {0};
+
+// Roam progress, advanced by the dispatch task and the event loop
+typedef enum {
+    ROAM_IDLE = 0,
+    ROAM_LEAVING,               // Disconnect from the old AP requested
+    ROAM_JOINING                // Associating with the new AP
+} roam_state_t;
 
-// WiFi scan results
-static wifi_ap_record_t *scan_results = NULL;
-static uint16_t scan_count = 0;
+// Configured networks, highest priority first; passwords and roam view side by side
+static wifi_manager_network_t networks[1 + WIFI_MANAGER_MAX_NETWORKS];
+static wifi_roam_network_t roam_networks[1 + WIFI_MANAGER_MAX_NETWORKS];
+static uint8_t network_count = 0;
+static uint8_t active_network = 0;
+static wifi_roam_policy_t roam_policy;
+static volatile roam_state_t roam_state = ROAM_IDLE;
+static uint8_t roam_from_network = 0;
+static uint32_t roam_start_time = 0;
+static uint32_t last_roam_time = 0;
+static int8_t last_rssi = 0;
+static uint16_t roam_scan_channels = 0;     // Neighbor report channels not scanned yet
+static bool btm_query_sent = false;
+static wifi_roam_stats_t roam_stats = {0};
 
 // Forward declarations
 static void wifi_event_handler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data);
-static void update_wifi_info(void);
+static void read_info_cache(wifi_info_t *info);
 static void notify_status_change(wifi_status_t new_status);
+static bool post_dispatch(const dispatch_msg_t *msg);
+static void connect_timeout_callback(TimerHandle_t timer);
+static esp_err_t apply_link(bool cached);
+static void record_connect(const esp_netif_ip_info_t *ip_info);
+static esp_err_t start_scan(bool background, uint8_t channel);
+
+static esp_err_t apply_link_profile(void)
+{
+    esp_err_t ret;
+    
+    if (link_profile == WIFI_LINK_PROFILE_LOW_LATENCY) {
+        // Modem sleep holds inbound frames until the next DTIM wakeup
+        ret = esp_wifi_set_ps(WIFI_PS_NONE);
+        if (ret == ESP_OK) {
+            ret = esp_wifi_set_max_tx_power(WIFI_MANAGER_LOW_LATENCY_TX_POWER);
+        }
+        if (ret == ESP_OK) {
+            ret = esp_wifi_set_bandwidth(WIFI_IF_STA, WIFI_BW_HT40);
+        }
+    } else {
+        ret = esp_wifi_set_ps(WIFI_PS_MIN_MODEM);
+        if (ret == ESP_OK && default_tx_power) {
+            ret = esp_wifi_set_max_tx_power(default_tx_power);
+        }
+        if (ret == ESP_OK) {
+            ret = esp_wifi_set_bandwidth(WIFI_IF_STA, WIFI_BW_HT20);
+        }
+    }
+    
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to apply %s link profile: %s",
+                 wifi_manager_link_profile_to_string(link_profile), esp_err_to_name(ret));
+        return ret;
+    }
+    
+    ESP_LOGI(TAG, "Link profile: %s", wifi_manager_link_profile_to_string(link_profile));
+    return ESP_OK;
+}
+
+static const char *active_ssid(void)
+{
+    return roam_networks[active_network].ssid;
+}
+
+static void add_network(const char *ssid, const char *password, uint8_t priority)
+{
+    if (!ssid[0] || network_count >= sizeof(networks) / sizeof(networks[0])) {
+        return;
+    }
+    
+    // Keep the list sorted by priority; earlier entries win a tie
+    int pos = network_count;
+    while (pos > 0 && networks[pos - 1].priority < priority) {
+        networks[pos] = networks[pos - 1];
+        roam_networks[pos] = roam_networks[pos - 1];
+        pos--;
+    }
+    
+    memset(&networks[pos], 0, sizeof(networks[pos]));
+    memset(&roam_networks[pos], 0, sizeof(roam_networks[pos]));
+    strncpy(networks[pos].ssid, ssid, sizeof(networks[pos].ssid));
+    strncpy(networks[pos].password, password, sizeof(networks[pos].password));
+    networks[pos].priority = priority;
+    strncpy(roam_networks[pos].ssid, ssid, sizeof(networks[pos].ssid));
+    roam_networks[pos].priority = priority;
+    network_count++;
+}
+
+static void build_networks(const wifi_manager_config_t *config)
+{
+    network_count = 0;
+    add_network(config->ssid, config->password, config->priority);
+    for (int i = 0; i < config->network_count && i < WIFI_MANAGER_MAX_NETWORKS; i++) {
+        add_network(config->networks[i].ssid, config->networks[i].password, config->networks[i].priority);
+    }
+}
+
+static void select_network(uint8_t index)
+{
+    active_network = index;
+    memset(sta_config.sta.ssid, 0, sizeof(sta_config.sta.ssid));
+    memset(sta_config.sta.password, 0, sizeof(sta_config.sta.password));
+    memcpy(sta_config.sta.ssid, networks[index].ssid, sizeof(networks[index].ssid));
+    memcpy(sta_config.sta.password, networks[index].password, sizeof(networks[index].password));
+}
+
+// Best network seen by a recent scan, else the highest priority one
+static uint8_t choose_network(void)
+{
+    wifi_roam_choice_t choice;
+    uint8_t index = 0;
+    
+    xSemaphoreTake(scan_mutex, portMAX_DELAY);
+    if (wifi_roam_select(&roam_policy, roam_networks, network_count, &scan_table, -1, 0, NULL, &choice)) {
+        index = choice.network;
+    }
+    xSemaphoreGive(scan_mutex);
+    return index;
+}
+
+static void load_link_cache(void)
+{
+    // Nothing from before a deinit survives if the entry is gone
+    link_cache_valid = false;
+    
+    nvs_handle_t handle;
+    if (nvs_open(WIFI_CACHE_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return;
+    }
+    
+    size_t size = sizeof(link_cache);
+    esp_err_t ret = nvs_get_blob(handle, WIFI_CACHE_KEY, &link_cache, &size);
+    nvs_close(handle);
+    
+    link_cache_valid = ret == ESP_OK && size == sizeof(link_cache) && link_cache.version == WIFI_CACHE_VERSION;
+    if (link_cache_valid) {
+        ESP_LOGI(TAG, "Cached link: %s on channel %d", link_cache.ssid, link_cache.channel);
+    }
+}
+
+static void save_link_cache(const wifi_link_cache_t *cache)
+{
+    // Only write when something changed, to spare the flash
+    if (link_cache_valid && memcmp(&link_cache, cache, sizeof(link_cache)) == 0) {
+        return;
+    }
+    
+    nvs_handle_t handle;
+    esp_err_t ret = nvs_open(WIFI_CACHE_NAMESPACE, NVS_READWRITE, &handle);
+    if (ret == ESP_OK) {
+        ret = nvs_set_blob(handle, WIFI_CACHE_KEY, cache, sizeof(*cache));
+        if (ret == ESP_OK) {
+            ret = nvs_commit(handle);
+        }
+        nvs_close(handle);
+    }
+    
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to save link cache: %s", esp_err_to_name(ret));
+        return;
+    }
+    
+    memcpy(&link_cache, cache, sizeof(link_cache));
+    link_cache_valid = true;
+}
+
+static bool can_use_link_cache(void)
+{
+    return current_config.fast_reconnect && link_cache_valid &&
+           strcmp(link_cache.ssid, active_ssid()) == 0;
+}
+
+static esp_err_t apply_link(bool cached)
+{
+    if (cached) {
+        // Associate with the known AP directly, no full channel scan
+        sta_config.sta.bssid_set = true;
+        memcpy(sta_config.sta.bssid, link_cache.bssid, sizeof(sta_config.sta.bssid));
+        sta_config.sta.channel = link_cache.channel;
+        sta_config.sta.scan_method = WIFI_FAST_SCAN;
+    } else {
+        sta_config.sta.bssid_set = false;
+        sta_config.sta.channel = 0;
+        sta_config.sta.scan_method = WIFI_ALL_CHANNEL_SCAN;
+    }
+    
+    if (cached && current_config.use_static_ip) {
+        esp_netif_dhcpc_stop(sta_netif);
+        esp_netif_set_ip_info(sta_netif, &link_cache.ip_info);
+    } else {
+        // Already running is fine
+        esp_netif_dhcpc_start(sta_netif);
+    }
+    
+    using_cached_link = cached;
+    return esp_wifi_set_config(WIFI_IF_STA, &sta_config);
+}
+
+static void record_connect(const esp_netif_ip_info_t *ip_info)
+{
+    uint32_t now = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    
+    if (roam_state == ROAM_JOINING) {
+        // A roam is timed from leaving the old AP, and kept out of the connect histograms
+        roam_state = ROAM_IDLE;
+        last_roam_time = now;
+        wifi_roam_stats_record(&roam_stats, now - roam_start_time);
+        ESP_LOGI(TAG, "Roamed to %s: %lu ms without link", active_ssid(), (unsigned long)(now - roam_start_time));
+    } else {
+        uint32_t elapsed = now - attempt_start_time;
+        int bin = 0;
+        while (bin < WIFI_MANAGER_CONNECT_HIST_BINS - 1 && elapsed >= connect_hist_edges_ms[bin]) {
+            bin++;
+        }
+        
+        uint16_t *hist = using_cached_link ? connect_hist_cached : connect_hist_scan;
+        if (hist[bin] < UINT16_MAX) {
+            hist[bin]++;
+        }
+        last_connect_ms = elapsed;
+        last_connect_cached = using_cached_link;
+        ESP_LOGI(TAG, "Connected in %lu ms (%s)", (unsigned long)elapsed, using_cached_link ? "cached link" : "full scan");
+    }
+    
+    // The AP query and NVS write happen in the dispatch task
+    dispatch_msg_t msg = {
+        .type = DISPATCH_SAVE_LINK,
+        .ip_info = *ip_info
+    };
+    post_dispatch(&msg);
+}
+
+static void save_current_link(const esp_netif_ip_info_t *ip_info)
+{
+    wifi_ap_record_t ap_info;
+    if (esp_wifi_sta_get_ap_info(&ap_info) != ESP_OK) {
+        return;
+    }
+    
+    wifi_link_cache_t cache = {
+        .version = WIFI_CACHE_VERSION,
+        .channel = ap_info.primary,
+        .ip_info = *ip_info
+    };
+    memcpy(cache.bssid, ap_info.bssid, sizeof(cache.bssid));
+    strncpy(cache.ssid, active_ssid(), sizeof(cache.ssid) - 1);
+    save_link_cache(&cache);
+}
 
 static void wifi_event_handler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data)
 {
     if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START) {
         ESP_LOGI(TAG, "WiFi station started");
-        esp_wifi_connect();
+        
+        // Power save, TX power and bandwidth can only be set once the station runs
+        if (!default_tx_power) {
+            esp_wifi_get_max_tx_power(&default_tx_power);
+        }
+        apply_link_profile();
+        
+        if (connect_requested) {
+            esp_wifi_connect();
+        }
         
     } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
         wifi_event_sta_disconnected_t* disconnected = (wifi_event_sta_disconnected_t*) event_data;
         ESP_LOGI(TAG, "WiFi disconnected, reason: %d", disconnected->reason);
         
+        if (disconnected->reason == WIFI_REASON_BEACON_TIMEOUT) {
+            beacon_losses++;
+        }
+        
+        if (!connect_requested) {
+            // Requested by wifi_manager_disconnect(), nothing to retry
+            return;
+        }
+        
+        if (roam_state == ROAM_LEAVING) {
+            // Our own disconnect from the old AP: join the new one
+            roam_state = ROAM_JOINING;
+            esp_wifi_connect();
+            return;
+        }
+        
+        if (roam_state == ROAM_JOINING) {
+            // The new AP did not take us: recover like after a dropout on the old network
+            roam_state = ROAM_IDLE;
+            roam_stats.failed++;
+            ESP_LOGW(TAG, "Roam to %s failed, reason: %d", active_ssid(), disconnected->reason);
+            select_network(roam_from_network);
+            attempt_start_time = roam_start_time;
+            apply_link(can_use_link_cache());
+        } else if (current_status == WIFI_STATUS_CONNECTED) {
+            // Dropout: time the reconnect from here and try the cached link first
+            attempt_start_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
+            apply_link(can_use_link_cache());
+        } else if (using_cached_link) {
+            // The AP moved or is gone: forget the shortcut for this attempt and scan
+            ESP_LOGW(TAG, "Cached link failed, falling back to full scan");
+            apply_link(false);
+            esp_wifi_connect();
+            notify_status_change(WIFI_STATUS_CONNECTING);
+            return;
+        }
+        
+        xEventGroupClearBits(wifi_event_group, WIFI_CONNECTED_BIT);
         if (retry_count < current_config.max_retry) {
+            if (disconnected->reason == WIFI_REASON_NO_AP_FOUND && network_count > 1) {
+                // Out of range of this network: try the next one
+                select_network((active_network + 1) % network_count);
+                apply_link(can_use_link_cache());
+                ESP_LOGI(TAG, "Trying network %s", active_ssid());
+            }
             esp_wifi_connect();
             retry_count++;
+            link_retries++;
             ESP_LOGI(TAG, "Retry connecting to WiFi (%d/%d)", retry_count, current_config.max_retry);
             notify_status_change(WIFI_STATUS_CONNECTING);
         } else {
+            xTimerStop(connect_timer, 0);
             xEventGroupSetBits(wifi_event_group, WIFI_FAIL_BIT);
             ESP_LOGE(TAG, "Failed to connect to WiFi after %d retries", current_config.max_retry);
             notify_status_change(WIFI_STATUS_FAILED);
@@ -60,66 +488,483 @@ static void wifi_event_handler(void* arg, esp_event_base_t event_base, int32_t e
         ESP_LOGI(TAG, "Got IP address: " IPSTR, IP2STR(&event->ip_info.ip));
         
         retry_count = 0;
+        xTimerStop(connect_timer, 0);
+        record_connect(&event->ip_info);
         xEventGroupSetBits(wifi_event_group, WIFI_CONNECTED_BIT);
         notify_status_change(WIFI_STATUS_CONNECTED);
         
     } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_SCAN_DONE) {
-        ESP_LOGI(TAG, "WiFi scan completed");
-        
-        // Get scan results
-        esp_wifi_scan_get_ap_num(&scan_count);
-        if (scan_count > 0) {
-            if (scan_results) {
-                free(scan_results);
-            }
-            scan_results = malloc(sizeof(wifi_ap_record_t) * scan_count);
-            if (scan_results) {
-                esp_wifi_scan_get_ap_records(&scan_count, scan_results);
-                ESP_LOGI(TAG, "Found %d WiFi networks", scan_count);
-            }
+        // Fetching and merging the records happens in the dispatch task
+        dispatch_msg_t msg = { .type = DISPATCH_SCAN_DONE };
+        if (!post_dispatch(&msg)) {
+            scan_in_progress = false;
+            xEventGroupSetBits(wifi_event_group, WIFI_SCAN_DONE_BIT);
         }
     }
 }
 
-static void update_wifi_info(void)
+static void publish_info_cache(const wifi_info_t *info)
+{
+    // The critical section keeps a reader on this core from spinning on a
+    // preempted writer; readers on the other core retry on a sequence change
+    portENTER_CRITICAL(&info_lock);
+    __atomic_store_n(&info_seq, info_seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(&info_cache, info, sizeof(wifi_info_t));
+    __atomic_store_n(&info_seq, info_seq + 1, __ATOMIC_RELEASE);
+    portEXIT_CRITICAL(&info_lock);
+}
+
+static void read_info_cache(wifi_info_t *info)
 {
-    memset(&current_info, 0, sizeof(wifi_info_t));
-    current_info.status = current_status;
-    current_info.retry_count = retry_count;
+    uint32_t seq;
+    do {
+        seq = __atomic_load_n(&info_seq, __ATOMIC_ACQUIRE);
+        if (seq & 1) {
+            continue;
+        }
+        memcpy(info, &info_cache, sizeof(wifi_info_t));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while ((seq & 1) || seq != __atomic_load_n(&info_seq, __ATOMIC_RELAXED));
+}
+
+// Dispatch task only: the single writer of the info cache
+static void refresh_info_cache(bool query_driver)
+{
+    wifi_info_t info;
+    read_info_cache(&info);
     
-    if (current_status == WIFI_STATUS_CONNECTED) {
+    info.status = current_status;
+    info.retry_count = retry_count;
+    info.last_connect_ms = last_connect_ms;
+    info.last_connect_cached = last_connect_cached;
+    info.link_profile = link_profile;
+    memcpy(info.connect_hist_cached, connect_hist_cached, sizeof(connect_hist_cached));
+    memcpy(info.connect_hist_scan, connect_hist_scan, sizeof(connect_hist_scan));
+    info.roam = roam_stats;
+    
+    if (current_status != WIFI_STATUS_CONNECTED) {
+        memset(info.ssid, 0, sizeof(info.ssid));
+        memset(info.ip_addr, 0, sizeof(info.ip_addr));
+        memset(info.gateway, 0, sizeof(info.gateway));
+        memset(info.netmask, 0, sizeof(info.netmask));
+        info.rssi = 0;
+        info.channel = 0;
+    } else if (query_driver) {
         // Get WiFi info
         wifi_ap_record_t ap_info;
         if (esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK) {
-            strncpy(current_info.ssid, (char*)ap_info.ssid, sizeof(current_info.ssid) - 1);
-            current_info.rssi = ap_info.rssi;
-            current_info.channel = ap_info.primary;
+            memcpy(associated_bssid, ap_info.bssid, sizeof(associated_bssid));
+            strncpy(info.ssid, (char*)ap_info.ssid, sizeof(info.ssid) - 1);
+            info.rssi = ap_info.rssi;
+            info.channel = ap_info.primary;
         }
         
         // Get IP info
         esp_netif_ip_info_t ip_info;
-        esp_netif_t *netif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
-        if (netif && esp_netif_get_ip_info(netif, &ip_info) == ESP_OK) {
-            snprintf(current_info.ip_addr, sizeof(current_info.ip_addr), 
+        if (sta_netif && esp_netif_get_ip_info(sta_netif, &ip_info) == ESP_OK) {
+            snprintf(info.ip_addr, sizeof(info.ip_addr), 
                     IPSTR, IP2STR(&ip_info.ip));
-            snprintf(current_info.gateway, sizeof(current_info.gateway), 
+            snprintf(info.gateway, sizeof(info.gateway), 
                     IPSTR, IP2STR(&ip_info.gw));
-            snprintf(current_info.netmask, sizeof(current_info.netmask), 
+            snprintf(info.netmask, sizeof(info.netmask), 
                     IPSTR, IP2STR(&ip_info.netmask));
         }
-        
-        current_info.connection_time_ms = xTaskGetTickCount() * portTICK_PERIOD_MS - connection_start_time;
     }
+    
+    publish_info_cache(&info);
+}
+
+static esp_err_t start_scan(bool background, uint8_t channel)
+{
+    wifi_scan_config_t scan_config = {
+        .ssid = NULL,
+        .bssid = NULL,
+        .channel = channel,
+        .show_hidden = true
+    };
+    
+    if (background) {
+        // Only roaming candidates, with short dwells to keep the stream flowing.
+        // With several networks the SSID filter would hide all but one.
+        if (network_count <= 1) {
+            scan_config.ssid = (uint8_t *)active_ssid();
+        }
+        scan_config.show_hidden = false;
+        scan_config.scan_time.active.min = WIFI_MANAGER_BG_SCAN_DWELL_MS / 2;
+        scan_config.scan_time.active.max = WIFI_MANAGER_BG_SCAN_DWELL_MS;
+    }
+    
+    xEventGroupClearBits(wifi_event_group, WIFI_SCAN_DONE_BIT);
+    scan_in_progress = true;
+    last_scan_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    
+    esp_err_t ret = esp_wifi_scan_start(&scan_config, false);
+    if (ret != ESP_OK) {
+        scan_in_progress = false;
+        xEventGroupSetBits(wifi_event_group, WIFI_SCAN_DONE_BIT);
+    }
+    return ret;
+}
+
+// Dispatch task only: leave the current AP for a better one
+static void start_roam(const wifi_scan_entry_t *target, uint8_t network)
+{
+    ESP_LOGI(TAG, "Roaming from %d dBm on %s to %02x:%02x:%02x:%02x:%02x:%02x (%s, channel %d, %d dBm)",
+             last_rssi, active_ssid(), target->bssid[0], target->bssid[1], target->bssid[2],
+             target->bssid[3], target->bssid[4], target->bssid[5], target->ssid, target->channel, target->rssi);
+    
+    roam_from_network = active_network;
+    roam_start_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    select_network(network);
+    sta_config.sta.bssid_set = true;
+    memcpy(sta_config.sta.bssid, target->bssid, sizeof(sta_config.sta.bssid));
+    sta_config.sta.channel = target->channel;
+    sta_config.sta.scan_method = WIFI_FAST_SCAN;
+    
+    // Within one network, keep the address so sessions bound to it survive
+    esp_netif_ip_info_t ip_info;
+    if (current_config.use_static_ip && network == roam_from_network &&
+        esp_netif_get_ip_info(sta_netif, &ip_info) == ESP_OK) {
+        esp_netif_dhcpc_stop(sta_netif);
+        esp_netif_set_ip_info(sta_netif, &ip_info);
+    } else {
+        esp_netif_dhcpc_start(sta_netif);
+    }
+    using_cached_link = false;
+    
+    xEventGroupClearBits(wifi_event_group, WIFI_CONNECTED_BIT);
+    xTimerChangePeriod(connect_timer, pdMS_TO_TICKS(current_config.timeout_ms), 0);
+    roam_state = ROAM_LEAVING;
+    notify_status_change(WIFI_STATUS_ROAMING);
+    
+    // The disconnect event joins the new AP
+    esp_err_t ret = esp_wifi_set_config(WIFI_IF_STA, &sta_config);
+    if (ret == ESP_OK) {
+        ret = esp_wifi_disconnect();
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Roam not started: %s", esp_err_to_name(ret));
+        roam_state = ROAM_JOINING;
+        esp_wifi_connect();
+    }
+}
+
+// Dispatch task only: roam if the scan table holds a clearly better AP
+static void evaluate_roam(void)
+{
+    if (!current_config.roaming || current_status != WIFI_STATUS_CONNECTED || roam_state != ROAM_IDLE) {
+        return;
+    }
+    
+    wifi_roam_choice_t choice;
+    wifi_scan_entry_t target;
+    xSemaphoreTake(scan_mutex, portMAX_DELAY);
+    bool found = wifi_roam_select(&roam_policy, roam_networks, network_count, &scan_table,
+                                  active_network, last_rssi, associated_bssid, &choice);
+    if (found) {
+        target = *choice.entry;
+    }
+    xSemaphoreGive(scan_mutex);
+    
+    if (found) {
+        start_roam(&target, choice.network);
+    }
+}
+
+// Dispatch task only: scan the next neighbor report channel
+static void scan_next_roam_channel(void)
+{
+    uint8_t channel = __builtin_ctz(roam_scan_channels);
+    roam_scan_channels &= ~(1u << channel);
+    if (start_scan(true, channel) != ESP_OK) {
+        roam_scan_channels = 0;
+    }
+}
+
+#if CONFIG_WPA_11KV_SUPPORT
+// Runs in the supplicant task: hand the channels to the dispatch task
+static void neighbor_report_callback(void *ctx, const uint8_t *report, size_t report_len)
+{
+    dispatch_msg_t msg = {
+        .type = DISPATCH_ROAM_SCAN,
+        .channels = report ? wifi_roam_neighbor_channels(report, report_len) : 0
+    };
+    post_dispatch(&msg);
+}
+#endif
+
+// Dispatch task only: look for a better AP while the current one is weak
+static void schedule_roam_scan(int8_t rssi, uint32_t now)
+{
+    last_rssi = rssi;
+    if (!current_config.roaming || rssi >= roam_policy.rssi_threshold ||
+        scan_in_progress || roam_state != ROAM_IDLE) {
+        return;
+    }
+    if ((roam_stats.count && now - last_roam_time < WIFI_MANAGER_ROAM_HOLDOFF_MS) ||
+        now - last_scan_time < WIFI_MANAGER_ROAM_SCAN_INTERVAL_MS) {
+        return;
+    }
+    
+#if CONFIG_WPA_11KV_SUPPORT
+    // 802.11v: let the AP steer us first; scan ourselves next time if it does not
+    if (!btm_query_sent && esp_wnm_is_btm_supported_connection()) {
+        btm_query_sent = esp_wnm_send_bss_transition_mgmt_query(REASON_RSSI, NULL, 0) == 0;
+        if (btm_query_sent) {
+            last_scan_time = now;
+            ESP_LOGI(TAG, "RSSI %d dBm, asked the AP for a transition", rssi);
+            return;
+        }
+    }
+    
+    // 802.11k: only scan the channels the AP reports neighbors on
+    if (esp_rrm_is_rrm_supported_connection() &&
+        esp_rrm_send_neighbor_rep_request(neighbor_report_callback, NULL) == 0) {
+        last_scan_time = now;
+        return;
+    }
+#endif
+    
+    if (start_scan(true, 0) == ESP_OK) {
+        ESP_LOGI(TAG, "RSSI %d dBm, roam scan for %d networks", rssi, network_count);
+    }
+}
+
+static void merge_scan_results(void)
+{
+    uint16_t count = WIFI_MANAGER_SCAN_MAX_RECORDS;
+    
+    // Also releases the driver's list when it holds more than fits
+    if (esp_wifi_scan_get_ap_records(&count, scan_records) != ESP_OK) {
+        count = 0;
+    }
+    
+    uint32_t now = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    xSemaphoreTake(scan_mutex, portMAX_DELAY);
+    for (uint16_t i = 0; i < count; i++) {
+        wifi_scan_entry_t entry = {
+            .rssi = scan_records[i].rssi,
+            .channel = scan_records[i].primary,
+            .authmode = scan_records[i].authmode,
+            .timestamp_ms = now
+        };
+        memcpy(entry.bssid, scan_records[i].bssid, sizeof(entry.bssid));
+        strncpy(entry.ssid, (char *)scan_records[i].ssid, sizeof(entry.ssid) - 1);
+        wifi_scan_table_update(&scan_table, &entry);
+    }
+    wifi_scan_table_commit(&scan_table, now, WIFI_SCAN_MAX_AGE_MS);
+    uint16_t table_count = scan_table.count;
+    xSemaphoreGive(scan_mutex);
+    
+    scan_in_progress = false;
+    xEventGroupSetBits(wifi_event_group, WIFI_SCAN_DONE_BIT);
+    ESP_LOGI(TAG, "WiFi scan completed: %d records, %d in table", count, table_count);
+    
+    if (roam_scan_channels) {
+        scan_next_roam_channel();
+    } else {
+        evaluate_roam();
+    }
+}
+
+// Dispatch task only: scan in the background while the link is degraded
+static void schedule_background_scan(uint8_t quality, uint32_t now)
+{
+    if (quality >= WIFI_MANAGER_BG_SCAN_QUALITY || scan_in_progress) {
+        return;
+    }
+    if (now - last_scan_time < current_config.bg_scan_interval_ms) {
+        return;
+    }
+    
+    esp_err_t ret = start_scan(true, 0);
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "Link quality %u, background scan for %s", quality, active_ssid());
+    } else {
+        ESP_LOGD(TAG, "Background scan not started: %s", esp_err_to_name(ret));
+    }
+}
+
+static void sample_link(void)
+{
+    if (current_status != WIFI_STATUS_CONNECTED) {
+        return;
+    }
+    
+    wifi_ap_record_t ap_info;
+    if (esp_wifi_sta_get_ap_info(&ap_info) != ESP_OK) {
+        return;
+    }
+    
+    uint32_t now = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    uint32_t elapsed_ms = now - last_sample_time;
+    uint32_t rx_bytes = __atomic_exchange_n(&traffic_rx_bytes, 0, __ATOMIC_RELAXED);
+    uint32_t tx_bytes = __atomic_exchange_n(&traffic_tx_bytes, 0, __ATOMIC_RELAXED);
+    uint32_t retries = link_retries - sampled_retries;
+    uint32_t losses = beacon_losses - sampled_beacon_losses;
+    sampled_retries += retries;
+    sampled_beacon_losses += losses;
+    last_sample_time = now;
+    
+    wifi_link_sample_t sample = {
+        .timestamp_ms = now,
+        .rssi = ap_info.rssi,
+        .retries = retries > UINT8_MAX ? UINT8_MAX : retries,
+        .beacon_losses = losses > UINT8_MAX ? UINT8_MAX : losses,
+        // bytes * 8 / ms is kbit/s
+        .rx_kbps = elapsed_ms ? (uint32_t)((uint64_t)rx_bytes * 8 / elapsed_ms) : 0,
+        .tx_kbps = elapsed_ms ? (uint32_t)((uint64_t)tx_bytes * 8 / elapsed_ms) : 0
+    };
+    
+    wifi_stream_hint_t hint;
+    portENTER_CRITICAL(&link_lock);
+    uint8_t quality = wifi_link_monitor_push(&link_monitor, &sample);
+    bool changed = wifi_link_monitor_hint(&link_monitor, &hint) || !stream_hint_valid;
+    stream_hint = hint;
+    stream_hint_valid = true;
+    portEXIT_CRITICAL(&link_lock);
+    
+    wifi_info_t info;
+    read_info_cache(&info);
+    info.rssi = ap_info.rssi;
+    info.link_quality = quality;
+    publish_info_cache(&info);
+    
+    if (changed) {
+        ESP_LOGI(TAG, "Link quality %u: recommend %lu kbps at %ux%u",
+                 quality, (unsigned long)hint.bitrate_kbps, hint.width, hint.height);
+    }
+    
+    schedule_background_scan(quality, now);
+    schedule_roam_scan(ap_info.rssi, now);
+    
+    wifi_stream_hint_callback_t callback = stream_hint_callback;
+    if (callback && (changed || ++samples_since_hint >= WIFI_MANAGER_HINT_REPEAT_SAMPLES)) {
+        samples_since_hint = 0;
+        callback(&hint);
+    }
+}
+
+static void rssi_timer_callback(TimerHandle_t timer)
+{
+    dispatch_msg_t msg = { .type = DISPATCH_SAMPLE_LINK };
+    post_dispatch(&msg);
+}
+
+static bool post_dispatch(const dispatch_msg_t *msg)
+{
+    if (!dispatch_queue) {
+        return false;
+    }
+    if (xQueueSend(dispatch_queue, msg, 0) != pdTRUE) {
+        dispatch_dropped++;
+        return false;
+    }
+    return true;
 }
 
+// Runs in the event loop, timer or dispatch task: only record the change and queue it
 static void notify_status_change(wifi_status_t new_status)
 {
     current_status = new_status;
-    update_wifi_info();
     
-    if (event_callback) {
-        event_callback(new_status, &current_info);
+    wifi_manager_event_t event = {
+        .status = new_status,
+        .retry_count = retry_count,
+        .elapsed_ms = xTaskGetTickCount() * portTICK_PERIOD_MS - connection_start_time
+    };
+    if (xQueueSend(wifi_event_queue, &event, 0) != pdTRUE) {
+        // Keep the newest events; the oldest is the least useful to a late reader
+        wifi_manager_event_t dropped;
+        xQueueReceive(wifi_event_queue, &dropped, 0);
+        xQueueSend(wifi_event_queue, &event, 0);
+    }
+    
+    dispatch_msg_t msg = {
+        .type = DISPATCH_STATUS,
+        .event = event
+    };
+    post_dispatch(&msg);
+}
+
+static void dispatch_task(void *pvParameters)
+{
+    dispatch_msg_t msg;
+    wifi_info_t info;
+    
+    while (xQueueReceive(dispatch_queue, &msg, portMAX_DELAY) == pdTRUE) {
+        if (msg.type == DISPATCH_EXIT) {
+            break;
+        }
+        
+        switch (msg.type) {
+            case DISPATCH_SAVE_LINK:
+                save_current_link(&msg.ip_info);
+                continue;
+            case DISPATCH_SAMPLE_LINK:
+                sample_link();
+                continue;
+            case DISPATCH_REFRESH:
+                refresh_info_cache(false);
+                continue;
+            case DISPATCH_SCAN_DONE:
+                merge_scan_results();
+                continue;
+            case DISPATCH_ROAM_SCAN:
+                // An empty report leaves it to a full scan; a running scan picks the channels up when done
+                roam_scan_channels = msg.channels;
+                if (scan_in_progress) {
+                    continue;
+                }
+                if (roam_scan_channels) {
+                    scan_next_roam_channel();
+                } else {
+                    start_scan(true, 0);
+                }
+                continue;
+            default:
+                break;
+        }
+        
+        // Driver queries happen once per status change, not per reader
+        refresh_info_cache(true);
+        if (msg.event.status == WIFI_STATUS_CONNECTED) {
+            btm_query_sent = false;
+            last_sample_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
+            xTimerChangePeriod(rssi_timer, pdMS_TO_TICKS(current_config.rssi_sample_ms), 0);
+        } else {
+            xTimerStop(rssi_timer, 0);
+        }
+        
+        // Report the status the event was raised with
+        wifi_event_callback_t callback = event_callback;
+        if (callback) {
+            read_info_cache(&info);
+            info.status = msg.event.status;
+            info.retry_count = msg.event.retry_count;
+            callback(msg.event.status, &info);
+        }
     }
+    
+    xSemaphoreGive(dispatch_exit);
+    vTaskDelete(NULL);
+}
+
+static void connect_timeout_callback(TimerHandle_t timer)
+{
+    if (xEventGroupGetBits(wifi_event_group) & WIFI_RESULT_BITS) {
+        return;
+    }
+    
+    if (roam_state != ROAM_IDLE) {
+        roam_state = ROAM_IDLE;
+        roam_stats.failed++;
+    }
+    
+    ESP_LOGE(TAG, "Connection timeout for WiFi SSID: %s", active_ssid());
+    xEventGroupSetBits(wifi_event_group, WIFI_TIMEOUT_BIT);
+    notify_status_change(WIFI_STATUS_TIMEOUT);
 }
 
 esp_err_t wifi_manager_init(void)
@@ -145,7 +990,7 @@ esp_err_t wifi_manager_init(void)
     }
     
     // Create default WiFi station
-    esp_netif_create_default_wifi_sta();
+    sta_netif = esp_netif_create_default_wifi_sta();
     
     // Initialize WiFi
     wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
@@ -162,6 +1007,32 @@ esp_err_t wifi_manager_init(void)
         return ESP_ERR_NO_MEM;
     }
     
+    // Create event queue and connect timeout timer (period is set per connect)
+    wifi_event_queue = xQueueCreate(WIFI_MANAGER_EVENT_QUEUE_LEN, sizeof(wifi_manager_event_t));
+    connect_timer = xTimerCreate("wifi_connect", pdMS_TO_TICKS(WIFI_MANAGER_CONNECT_TIMEOUT_MS),
+                                 pdFALSE, NULL, connect_timeout_callback);
+    rssi_timer = xTimerCreate("wifi_rssi", pdMS_TO_TICKS(WIFI_MANAGER_RSSI_SAMPLE_MS),
+                              pdTRUE, NULL, rssi_timer_callback);
+    if (!wifi_event_queue || !connect_timer || !rssi_timer) {
+        ESP_LOGE(TAG, "Failed to create event queue or timers");
+        return ESP_ERR_NO_MEM;
+    }
+    
+    // Dispatch task for user callbacks, NVS writes and scan results
+    dispatch_queue = xQueueCreate(WIFI_MANAGER_DISPATCH_QUEUE_LEN, sizeof(dispatch_msg_t));
+    dispatch_exit = xSemaphoreCreateBinary();
+    scan_mutex = xSemaphoreCreateMutex();
+    if (!dispatch_queue || !dispatch_exit || !scan_mutex) {
+        ESP_LOGE(TAG, "Failed to create dispatch queue");
+        return ESP_ERR_NO_MEM;
+    }
+    
+    ret = task_topology_create_default(&dispatch_task_defaults, dispatch_task, NULL, &dispatch_task_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create dispatch task");
+        return ret;
+    }
+    
     // Register event handlers
     ret = esp_event_handler_register(WIFI_EVENT, ESP_EVENT_ANY_ID, &wifi_event_handler, NULL);
     if (ret != ESP_OK) {
@@ -182,6 +1053,11 @@ esp_err_t wifi_manager_init(void)
         return ret;
     }
     
+    // NVS must already be initialized by the application
+    load_link_cache();
+    wifi_link_monitor_reset(&link_monitor);
+    wifi_scan_table_reset(&scan_table);
+    
     wifi_manager_initialized = true;
     current_status = WIFI_STATUS_DISCONNECTED;
     
@@ -198,25 +1074,63 @@ esp_err_t wifi_manager_deinit(void)
     ESP_LOGI(TAG, "Deinitializing WiFi manager...");
     
     // Stop WiFi
+    connect_requested = false;
     esp_wifi_stop();
     esp_wifi_deinit();
+    wifi_started = false;
     
     // Unregister event handlers
     esp_event_handler_unregister(WIFI_EVENT, ESP_EVENT_ANY_ID, &wifi_event_handler);
     esp_event_handler_unregister(IP_EVENT, IP_EVENT_STA_GOT_IP, &wifi_event_handler);
     
-    // Delete event group
+    // The timer callbacks post to the dispatch queue and read the event
+    // group: stop them before either goes away
+    if (connect_timer) {
+        xTimerStop(connect_timer, portMAX_DELAY);
+        xTimerDelete(connect_timer, portMAX_DELAY);
+        connect_timer = NULL;
+    }
+    
+    if (rssi_timer) {
+        xTimerStop(rssi_timer, portMAX_DELAY);
+        xTimerDelete(rssi_timer, portMAX_DELAY);
+        rssi_timer = NULL;
+    }
+    
+    // Let the dispatch task finish the callback it is running
+    if (dispatch_task_handle) {
+        dispatch_msg_t msg = { .type = DISPATCH_EXIT };
+        xQueueSend(dispatch_queue, &msg, portMAX_DELAY);
+        xSemaphoreTake(dispatch_exit, portMAX_DELAY);
+        dispatch_task_handle = NULL;
+    }
+    
+    if (dispatch_queue) {
+        vQueueDelete(dispatch_queue);
+        dispatch_queue = NULL;
+    }
+    
+    if (dispatch_exit) {
+        vSemaphoreDelete(dispatch_exit);
+        dispatch_exit = NULL;
+    }
+    
+    // Delete event group and queue
+    if (wifi_event_queue) {
+        vQueueDelete(wifi_event_queue);
+        wifi_event_queue = NULL;
+    }
+    
     if (wifi_event_group) {
         vEventGroupDelete(wifi_event_group);
         wifi_event_group = NULL;
     }
     
-    // Free scan results
-    if (scan_results) {
-        free(scan_results);
-        scan_results = NULL;
-        scan_count = 0;
+    if (scan_mutex) {
+        vSemaphoreDelete(scan_mutex);
+        scan_mutex = NULL;
     }
+    scan_in_progress = false;
     
     wifi_manager_initialized = false;
     current_status = WIFI_STATUS_DISCONNECTED;
@@ -225,7 +1139,7 @@ esp_err_t wifi_manager_deinit(void)
     return ESP_OK;
 }
 
-esp_err_t wifi_manager_connect(const wifi_manager_config_t *config)
+esp_err_t wifi_manager_connect_async(const wifi_manager_config_t *config)
 {
     if (!wifi_manager_initialized || !config) {
         return ESP_ERR_INVALID_ARG;
@@ -233,58 +1147,163 @@ esp_err_t wifi_manager_connect(const wifi_manager_config_t *config)
     
     ESP_LOGI(TAG, "Connecting to WiFi SSID: %s", config->ssid);
     
+    bool same_network = wifi_started &&
+                        strcmp(current_config.ssid, config->ssid) == 0 &&
+                        strcmp(current_config.password, config->password) == 0 &&
+                        current_config.network_count == config->network_count &&
+                        memcmp(current_config.networks, config->networks, sizeof(config->networks)) == 0;
+    
+    if (same_network && current_status == WIFI_STATUS_CONNECTED) {
+        ESP_LOGI(TAG, "Already connected to WiFi SSID: %s", config->ssid);
+        xEventGroupSetBits(wifi_event_group, WIFI_CONNECTED_BIT);
+        return ESP_OK;
+    }
+    
     // Store configuration
     memcpy(&current_config, config, sizeof(wifi_manager_config_t));
+    if (!current_config.rssi_sample_ms) {
+        current_config.rssi_sample_ms = WIFI_MANAGER_RSSI_SAMPLE_MS;
+    }
+    if (!current_config.bg_scan_interval_ms) {
+        current_config.bg_scan_interval_ms = WIFI_MANAGER_BG_SCAN_INTERVAL_MS;
+    }
+    wifi_roam_policy_default(&roam_policy);
+    if (current_config.roam_rssi) {
+        roam_policy.rssi_threshold = current_config.roam_rssi;
+    }
     retry_count = 0;
+    roam_state = ROAM_IDLE;
+    roam_scan_channels = 0;
     connection_start_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    xEventGroupClearBits(wifi_event_group, WIFI_RESULT_BITS);
     
-    // Configure WiFi
-    wifi_config_t wifi_config = {
-        .sta = {
-            .threshold.authmode = WIFI_AUTH_WPA2_PSK,
-            .pmf_cfg = {
-                .capable = true,
-                .required = false
-            },
-        },
-    };
+    if (!same_network && current_status == WIFI_STATUS_CONNECTED) {
+        connect_requested = false;
+        esp_wifi_disconnect();
+    }
     
-    strncpy((char*)wifi_config.sta.ssid, config->ssid, sizeof(wifi_config.sta.ssid) - 1);
-    strncpy((char*)wifi_config.sta.password, config->password, sizeof(wifi_config.sta.password) - 1);
+    // Configure WiFi
+    memset(&sta_config, 0, sizeof(sta_config));
+    sta_config.sta.threshold.authmode = WIFI_AUTH_WPA2_PSK;
+    sta_config.sta.pmf_cfg.capable = true;
+    sta_config.sta.pmf_cfg.required = false;
+#if CONFIG_WPA_11KV_SUPPORT
+    sta_config.sta.rm_enabled = current_config.roaming;
+    sta_config.sta.btm_enabled = current_config.roaming;
+#endif
+    build_networks(&current_config);
+    select_network(choose_network());
     
-    esp_err_t ret = esp_wifi_set_config(WIFI_IF_STA, &wifi_config);
+    attempt_start_time = connection_start_time;
+    esp_err_t ret = apply_link(can_use_link_cache());
+    if (ret == ESP_OK && config->link_profile != link_profile) {
+        ret = wifi_manager_set_link_profile(config->link_profile);
+    }
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to set WiFi config: %s", esp_err_to_name(ret));
         return ret;
     }
     
-    // Start WiFi
-    ret = esp_wifi_start();
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to start WiFi: %s", esp_err_to_name(ret));
-        return ret;
+    uint32_t timeout_ms = config->timeout_ms ? config->timeout_ms : WIFI_MANAGER_CONNECT_TIMEOUT_MS;
+    xTimerChangePeriod(connect_timer, pdMS_TO_TICKS(timeout_ms), 0);
+    connect_requested = true;
+    notify_status_change(WIFI_STATUS_CONNECTING);
+    
+    if (!wifi_started) {
+        // The STA_START event issues the first esp_wifi_connect()
+        ret = esp_wifi_start();
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to start WiFi: %s", esp_err_to_name(ret));
+            connect_requested = false;
+            xTimerStop(connect_timer, 0);
+            return ret;
+        }
+        wifi_started = true;
+    } else {
+        ret = esp_wifi_connect();
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to start association: %s", esp_err_to_name(ret));
+            connect_requested = false;
+            xTimerStop(connect_timer, 0);
+            return ret;
+        }
     }
     
-    notify_status_change(WIFI_STATUS_CONNECTING);
+    return ESP_OK;
+}
+
+esp_err_t wifi_manager_wait_connect(uint32_t timeout_ms)
+{
+    if (!wifi_manager_initialized || !connect_requested) {
+        return ESP_ERR_INVALID_STATE;
+    }
     
-    // Wait for connection
+    TickType_t ticks = timeout_ms == WIFI_MANAGER_WAIT_FOREVER ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
     EventBits_t bits = xEventGroupWaitBits(wifi_event_group,
-                                          WIFI_CONNECTED_BIT | WIFI_FAIL_BIT,
+                                          WIFI_RESULT_BITS,
                                           pdFALSE,
                                           pdFALSE,
-                                          pdMS_TO_TICKS(config->timeout_ms));
+                                          ticks);
     
     if (bits & WIFI_CONNECTED_BIT) {
-        ESP_LOGI(TAG, "Connected to WiFi SSID: %s", config->ssid);
         return ESP_OK;
     } else if (bits & WIFI_FAIL_BIT) {
-        ESP_LOGE(TAG, "Failed to connect to WiFi SSID: %s", config->ssid);
         return ESP_ERR_WIFI_CONN;
-    } else {
-        ESP_LOGE(TAG, "Connection timeout for WiFi SSID: %s", config->ssid);
-        notify_status_change(WIFI_STATUS_TIMEOUT);
+    }
+    return ESP_ERR_TIMEOUT;
+}
+
+esp_err_t wifi_manager_get_event(wifi_manager_event_t *event, uint32_t timeout_ms)
+{
+    if (!event) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!wifi_manager_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    if (xQueueReceive(wifi_event_queue, event, pdMS_TO_TICKS(timeout_ms)) != pdTRUE) {
         return ESP_ERR_TIMEOUT;
     }
+    return ESP_OK;
+}
+
+esp_err_t wifi_manager_connect(const wifi_manager_config_t *config)
+{
+    esp_err_t ret = wifi_manager_connect_async(config);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    // The connect timer resolves the request after config->timeout_ms
+    ret = wifi_manager_wait_connect(WIFI_MANAGER_WAIT_FOREVER);
+    
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "Connected to WiFi SSID: %s", config->ssid);
+    } else if (ret == ESP_ERR_WIFI_CONN) {
+        ESP_LOGE(TAG, "Failed to connect to WiFi SSID: %s", config->ssid);
+    }
+    return ret;
+}
+
+esp_err_t wifi_manager_clear_link_cache(void)
+{
+    nvs_handle_t handle;
+    esp_err_t ret = nvs_open(WIFI_CACHE_NAMESPACE, NVS_READWRITE, &handle);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    ret = nvs_erase_key(handle, WIFI_CACHE_KEY);
+    if (ret == ESP_OK) {
+        ret = nvs_commit(handle);
+    } else if (ret == ESP_ERR_NVS_NOT_FOUND) {
+        ret = ESP_OK;
+    }
+    nvs_close(handle);
+    
+    link_cache_valid = false;
+    return ret;
 }
 
 esp_err_t wifi_manager_disconnect(void)
@@ -295,6 +1314,8 @@ esp_err_t wifi_manager_disconnect(void)
     
     ESP_LOGI(TAG, "Disconnecting from WiFi");
     
+    connect_requested = false;
+    xTimerStop(connect_timer, 0);
     esp_err_t ret = esp_wifi_disconnect();
     if (ret == ESP_OK) {
         notify_status_change(WIFI_STATUS_DISCONNECTED);
@@ -314,8 +1335,11 @@ esp_err_t wifi_manager_get_info(wifi_info_t *info)
         return ESP_ERR_INVALID_ARG;
     }
     
-    update_wifi_info();
-    memcpy(info, &current_info, sizeof(wifi_info_t));
+    // Lock-free copy of the cache; no driver calls
+    read_info_cache(info);
+    if (info->status == WIFI_STATUS_CONNECTED) {
+        info->connection_time_ms = xTaskGetTickCount() * portTICK_PERIOD_MS - connection_start_time;
+    }
     return ESP_OK;
 }
 
@@ -329,35 +1353,272 @@ void wifi_manager_set_callback(wifi_event_callback_t callback)
     event_callback = callback;
 }
 
+esp_err_t wifi_manager_set_link_profile(wifi_link_profile_t profile)
+{
+    if (profile >= WIFI_LINK_PROFILE_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    link_profile = profile;
+    current_config.link_profile = profile;
+    
+    dispatch_msg_t msg = { .type = DISPATCH_REFRESH };
+    post_dispatch(&msg);
+    
+    // Before the station starts, the STA_START handler applies it
+    return wifi_started ? apply_link_profile() : ESP_OK;
+}
+
+wifi_link_profile_t wifi_manager_get_link_profile(void)
+{
+    return link_profile;
+}
+
+const char *wifi_manager_link_profile_to_string(wifi_link_profile_t profile)
+{
+    switch (profile) {
+        case WIFI_LINK_PROFILE_BALANCED: return "balanced";
+        case WIFI_LINK_PROFILE_LOW_LATENCY: return "low-latency";
+        default: return "unknown";
+    }
+}
+
+static void rtt_probe_success(esp_ping_handle_t hdl, void *args)
+{
+    rtt_probe_t *probe = (rtt_probe_t *)args;
+    uint32_t elapsed_ms = 0;
+    esp_ping_get_profile(hdl, ESP_PING_PROF_TIMEGAP, &elapsed_ms, sizeof(elapsed_ms));
+    
+    probe->received++;
+    probe->sum_ms += elapsed_ms;
+    if (elapsed_ms < probe->min_ms) {
+        probe->min_ms = elapsed_ms;
+    }
+    if (elapsed_ms > probe->max_ms) {
+        probe->max_ms = elapsed_ms;
+    }
+}
+
+static void rtt_probe_end(esp_ping_handle_t hdl, void *args)
+{
+    rtt_probe_t *probe = (rtt_probe_t *)args;
+    xSemaphoreGive(probe->done);
+}
+
+esp_err_t wifi_manager_probe_rtt(const char *host, uint16_t count, wifi_rtt_stats_t *stats)
+{
+    if (count == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!wifi_manager_initialized || current_status != WIFI_STATUS_CONNECTED) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    ip_addr_t target;
+    if (host) {
+        if (!ipaddr_aton(host, &target)) {
+            ESP_LOGE(TAG, "Invalid probe host: %s", host);
+            return ESP_ERR_INVALID_ARG;
+        }
+    } else {
+        esp_netif_ip_info_t ip_info;
+        esp_err_t ret = esp_netif_get_ip_info(sta_netif, &ip_info);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        ip_addr_set_ip4_u32(&target, ip_info.gw.addr);
+    }
+    
+    rtt_probe_t probe = {
+        .done = xSemaphoreCreateBinary(),
+        .min_ms = UINT32_MAX
+    };
+    if (!probe.done) {
+        return ESP_ERR_NO_MEM;
+    }
+    
+    esp_ping_config_t ping_config = ESP_PING_DEFAULT_CONFIG();
+    ping_config.target_addr = target;
+    ping_config.count = count;
+    ping_config.interval_ms = WIFI_MANAGER_RTT_PROBE_INTERVAL_MS;
+    
+    esp_ping_callbacks_t callbacks = {
+        .cb_args = &probe,
+        .on_ping_success = rtt_probe_success,
+        .on_ping_timeout = NULL,
+        .on_ping_end = rtt_probe_end
+    };
+    
+    esp_ping_handle_t ping;
+    esp_err_t ret = esp_ping_new_session(&ping_config, &callbacks, &ping);
+    if (ret != ESP_OK) {
+        vSemaphoreDelete(probe.done);
+        ESP_LOGE(TAG, "Failed to create ping session: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    
+    // on_ping_end always follows the last request or timeout
+    esp_ping_start(ping);
+    xSemaphoreTake(probe.done, portMAX_DELAY);
+    esp_ping_delete_session(ping);
+    vSemaphoreDelete(probe.done);
+    
+    wifi_rtt_stats_t result = {
+        .profile = link_profile,
+        .sent = count,
+        .received = probe.received,
+        .min_ms = probe.received ? probe.min_ms : 0,
+        .avg_ms = probe.received ? probe.sum_ms / probe.received : 0,
+        .max_ms = probe.max_ms
+    };
+    rtt_stats[link_profile] = result;
+    rtt_stats_valid[link_profile] = true;
+    
+    ESP_LOGI(TAG, "RTT (%s): %lu/%lu replies, min %lu ms, avg %lu ms, max %lu ms",
+             wifi_manager_link_profile_to_string(link_profile), (unsigned long)result.received,
+             (unsigned long)result.sent, (unsigned long)result.min_ms, (unsigned long)result.avg_ms,
+             (unsigned long)result.max_ms);
+    
+    if (stats) {
+        memcpy(stats, &result, sizeof(wifi_rtt_stats_t));
+    }
+    return ESP_OK;
+}
+
+esp_err_t wifi_manager_get_rtt_stats(wifi_link_profile_t profile, wifi_rtt_stats_t *stats)
+{
+    if (!stats || profile >= WIFI_LINK_PROFILE_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!rtt_stats_valid[profile]) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    
+    memcpy(stats, &rtt_stats[profile], sizeof(wifi_rtt_stats_t));
+    return ESP_OK;
+}
+
+void wifi_manager_add_traffic(size_t rx_bytes, size_t tx_bytes)
+{
+    __atomic_fetch_add(&traffic_rx_bytes, (uint32_t)rx_bytes, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&traffic_tx_bytes, (uint32_t)tx_bytes, __ATOMIC_RELAXED);
+}
+
+size_t wifi_manager_get_link_history(wifi_link_sample_t *samples, size_t max_samples)
+{
+    if (!samples) {
+        return 0;
+    }
+    
+    portENTER_CRITICAL(&link_lock);
+    size_t count = wifi_link_monitor_history(&link_monitor, samples, max_samples);
+    portEXIT_CRITICAL(&link_lock);
+    return count;
+}
+
+esp_err_t wifi_manager_get_stream_hint(wifi_stream_hint_t *hint)
+{
+    if (!hint) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    portENTER_CRITICAL(&link_lock);
+    bool valid = stream_hint_valid;
+    *hint = stream_hint;
+    portEXIT_CRITICAL(&link_lock);
+    
+    return valid ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+void wifi_manager_set_stream_hint_callback(wifi_stream_hint_callback_t callback)
+{
+    stream_hint_callback = callback;
+}
+
 esp_err_t wifi_manager_scan_start(void)
 {
     if (!wifi_manager_initialized) {
         return ESP_ERR_INVALID_STATE;
     }
+    if (scan_in_progress) {
+        return ESP_ERR_WIFI_STATE;
+    }
     
     ESP_LOGI(TAG, "Starting WiFi scan");
+    return start_scan(false, 0);
+}
+
+esp_err_t wifi_manager_scan_wait(uint32_t timeout_ms)
+{
+    if (!wifi_manager_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
     
-    wifi_scan_config_t scan_config = {
-        .ssid = NULL,
-        .bssid = NULL,
-        .channel = 0,
-        .show_hidden = true
-    };
-    
-    return esp_wifi_scan_start(&scan_config, false);
+    TickType_t ticks = timeout_ms == WIFI_MANAGER_WAIT_FOREVER ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+    EventBits_t bits = xEventGroupWaitBits(wifi_event_group, WIFI_SCAN_DONE_BIT, pdFALSE, pdFALSE, ticks);
+    return (bits & WIFI_SCAN_DONE_BIT) ? ESP_OK : ESP_ERR_TIMEOUT;
 }
 
 uint16_t wifi_manager_get_scan_count(void)
 {
-    return scan_count;
+    return scan_table.count;
 }
 
 esp_err_t wifi_manager_get_scan_result(uint16_t index, wifi_ap_record_t *ap_info)
 {
-    if (!ap_info || index >= scan_count || !scan_results) {
+    if (!ap_info || !wifi_manager_initialized) {
         return ESP_ERR_INVALID_ARG;
     }
     
-    memcpy(ap_info, &scan_results[index], sizeof(wifi_ap_record_t));
+    xSemaphoreTake(scan_mutex, portMAX_DELAY);
+    const wifi_scan_entry_t *entry = wifi_scan_table_at(&scan_table, index);
+    if (entry) {
+        memset(ap_info, 0, sizeof(wifi_ap_record_t));
+        memcpy(ap_info->bssid, entry->bssid, sizeof(ap_info->bssid));
+        memcpy(ap_info->ssid, entry->ssid, sizeof(entry->ssid));
+        ap_info->rssi = entry->rssi;
+        ap_info->primary = entry->channel;
+        ap_info->authmode = (wifi_auth_mode_t)entry->authmode;
+    }
+    xSemaphoreGive(scan_mutex);
+    
+    return entry ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t wifi_manager_scan_iter_begin(wifi_scan_iter_t *iter, const char *ssid)
+{
+    if (!iter) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!wifi_manager_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    xSemaphoreTake(scan_mutex, portMAX_DELAY);
+    wifi_scan_iter_init(iter, ssid, NULL);
     return ESP_OK;
-}
\ No newline at end of file
+}
+
+esp_err_t wifi_manager_roam_iter_begin(wifi_scan_iter_t *iter)
+{
+    esp_err_t ret = wifi_manager_scan_iter_begin(iter, active_ssid());
+    if (ret == ESP_OK && current_status == WIFI_STATUS_CONNECTED) {
+        iter->exclude_bssid = associated_bssid;
+    }
+    return ret;
+}
+
+const wifi_scan_entry_t *wifi_manager_scan_iter_next(wifi_scan_iter_t *iter)
+{
+    if (!iter) {
+        return NULL;
+    }
+    return wifi_scan_table_next(&scan_table, iter);
+}
+
+void wifi_manager_scan_iter_end(wifi_scan_iter_t *iter)
+{
+    if (iter) {
+        xSemaphoreGive(scan_mutex);
+    }
+}
@@ -0,0 +1,105 @@
+#include "wifi_roam.h"
+#include <string.h>
+
+// 802.11k neighbor report element: BSSID, BSSID info, operating class, channel, PHY type
+#define NEIGHBOR_REPORT_EID         52
+#define NEIGHBOR_REPORT_MIN_LEN     13
+#define NEIGHBOR_REPORT_CHANNEL_POS 11
+
+// Upper bounds of the roam gap histogram bins; the last bin is open
+static const uint32_t gap_hist_edges_ms[WIFI_ROAM_GAP_BINS - 1] = {50, 100, 250, 500, 1000};
+
+void wifi_roam_policy_default(wifi_roam_policy_t *policy)
+{
+    policy->rssi_threshold = WIFI_ROAM_RSSI_THRESHOLD;
+    policy->hysteresis_db = WIFI_ROAM_HYSTERESIS_DB;
+    policy->priority_db = WIFI_ROAM_PRIORITY_DB;
+}
+
+int wifi_roam_find_network(const wifi_roam_network_t *networks, size_t count, const char *ssid)
+{
+    for (size_t i = 0; i < count; i++) {
+        if (strncmp(networks[i].ssid, ssid, WIFI_SCAN_SSID_LEN) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+int16_t wifi_roam_score(const wifi_roam_policy_t *policy, int8_t rssi, uint8_t priority)
+{
+    return (int16_t)(rssi + priority * policy->priority_db);
+}
+
+bool wifi_roam_select(const wifi_roam_policy_t *policy, const wifi_roam_network_t *networks, size_t count,
+                      const wifi_scan_table_t *table, int current_network, int8_t current_rssi,
+                      const uint8_t *current_bssid, wifi_roam_choice_t *choice)
+{
+    int16_t floor = INT16_MIN;
+    if (current_network >= 0) {
+        if (current_rssi >= policy->rssi_threshold) {
+            return false;
+        }
+        floor = wifi_roam_score(policy, current_rssi, networks[current_network].priority) + policy->hysteresis_db;
+    }
+
+    bool found = false;
+    wifi_scan_iter_t iter;
+    wifi_scan_iter_init(&iter, NULL, current_bssid);
+    const wifi_scan_entry_t *entry;
+    while ((entry = wifi_scan_table_next(table, &iter)) != NULL) {
+        int network = wifi_roam_find_network(networks, count, entry->ssid);
+        if (network < 0) {
+            continue;
+        }
+        int16_t score = wifi_roam_score(policy, entry->rssi, networks[network].priority);
+        if (score >= floor && (!found || score > choice->score)) {
+            choice->entry = entry;
+            choice->network = network;
+            choice->score = score;
+            found = true;
+        }
+    }
+    return found;
+}
+
+uint16_t wifi_roam_neighbor_channels(const uint8_t *report, size_t len)
+{
+    uint16_t channels = 0;
+    size_t pos = 0;
+
+    while (pos + 2 <= len) {
+        uint8_t id = report[pos];
+        uint8_t element_len = report[pos + 1];
+        pos += 2;
+        if (element_len > len - pos) {
+            break;
+        }
+        if (id == NEIGHBOR_REPORT_EID && element_len >= NEIGHBOR_REPORT_MIN_LEN) {
+            uint8_t channel = report[pos + NEIGHBOR_REPORT_CHANNEL_POS];
+            if (channel >= 1 && channel <= 14) {
+                channels |= 1u << channel;
+            }
+        }
+        pos += element_len;
+    }
+    return channels;
+}
+
+void wifi_roam_stats_record(wifi_roam_stats_t *stats, uint32_t gap_ms)
+{
+    int bin = 0;
+    while (bin < WIFI_ROAM_GAP_BINS - 1 && gap_ms >= gap_hist_edges_ms[bin]) {
+        bin++;
+    }
+    if (stats->gap_hist[bin] < UINT16_MAX) {
+        stats->gap_hist[bin]++;
+    }
+    if (stats->count < UINT16_MAX) {
+        stats->count++;
+    }
+    stats->last_gap_ms = gap_ms;
+    if (gap_ms > stats->max_gap_ms) {
+        stats->max_gap_ms = gap_ms;
+    }
+}
@@ -0,0 +1,109 @@
+#include "wifi_scan_table.h"
+#include <string.h>
+
+void wifi_scan_table_reset(wifi_scan_table_t *table)
+{
+    memset(table, 0, sizeof(wifi_scan_table_t));
+}
+
+static int find_bssid(const wifi_scan_table_t *table, const uint8_t *bssid)
+{
+    for (int i = 0; i < table->count; i++) {
+        if (memcmp(table->entries[i].bssid, bssid, sizeof(table->entries[i].bssid)) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static int find_victim(const wifi_scan_table_t *table)
+{
+    int victim = 0;
+    for (int i = 1; i < table->count; i++) {
+        const wifi_scan_entry_t *entry = &table->entries[i];
+        const wifi_scan_entry_t *best = &table->entries[victim];
+        // Wrap-safe: larger age means seen longer ago
+        int32_t newer = (int32_t)(entry->timestamp_ms - best->timestamp_ms);
+        if (newer < 0 || (newer == 0 && entry->rssi < best->rssi)) {
+            victim = i;
+        }
+    }
+    return victim;
+}
+
+bool wifi_scan_table_update(wifi_scan_table_t *table, const wifi_scan_entry_t *entry)
+{
+    int index = find_bssid(table, entry->bssid);
+
+    if (index < 0 && table->count < WIFI_SCAN_TABLE_SIZE) {
+        index = table->count;
+        table->order[index] = index;
+        table->count++;
+    } else if (index < 0) {
+        index = find_victim(table);
+        const wifi_scan_entry_t *victim = &table->entries[index];
+        if (victim->timestamp_ms == entry->timestamp_ms && victim->rssi >= entry->rssi) {
+            return false;
+        }
+    }
+
+    table->entries[index] = *entry;
+    table->entries[index].ssid[WIFI_SCAN_SSID_LEN - 1] = '\0';
+    return true;
+}
+
+void wifi_scan_table_commit(wifi_scan_table_t *table, uint32_t now_ms, uint32_t max_age_ms)
+{
+    // Compact the live entries in place
+    uint16_t count = 0;
+    for (uint16_t i = 0; i < table->count; i++) {
+        if (now_ms - table->entries[i].timestamp_ms <= max_age_ms) {
+            if (count != i) {
+                table->entries[count] = table->entries[i];
+            }
+            count++;
+        }
+    }
+    table->count = count;
+
+    // Insertion sort of the indices; the table is small and mostly sorted
+    for (uint16_t i = 0; i < count; i++) {
+        uint8_t index = i;
+        int j = i - 1;
+        while (j >= 0 && table->entries[table->order[j]].rssi < table->entries[index].rssi) {
+            table->order[j + 1] = table->order[j];
+            j--;
+        }
+        table->order[j + 1] = index;
+    }
+}
+
+void wifi_scan_iter_init(wifi_scan_iter_t *iter, const char *ssid, const uint8_t *exclude_bssid)
+{
+    iter->pos = 0;
+    iter->ssid = ssid;
+    iter->exclude_bssid = exclude_bssid;
+}
+
+const wifi_scan_entry_t *wifi_scan_table_next(const wifi_scan_table_t *table, wifi_scan_iter_t *iter)
+{
+    while (iter->pos < table->count) {
+        const wifi_scan_entry_t *entry = &table->entries[table->order[iter->pos++]];
+        if (iter->ssid && strcmp(entry->ssid, iter->ssid) != 0) {
+            continue;
+        }
+        if (iter->exclude_bssid && memcmp(entry->bssid, iter->exclude_bssid, sizeof(entry->bssid)) == 0) {
+            continue;
+        }
+        return entry;
+    }
+    return NULL;
+}
+
+const wifi_scan_entry_t *wifi_scan_table_at(const wifi_scan_table_t *table, uint16_t rank)
+{
+    if (rank >= table->count) {
+        return NULL;
+    }
+    return &table->entries[table->order[rank]];
+}
@@ -0,0 +1,116 @@
+#include "unity.h"
+#include "wifi_link_monitor.h"
+#include <string.h>
+
+static wifi_link_monitor_t monitor;
+
+static wifi_link_sample_t make_sample(uint32_t timestamp_ms, int8_t rssi)
+{
+    wifi_link_sample_t sample = { .timestamp_ms = timestamp_ms, .rssi = rssi };
+    return sample;
+}
+
+void setUp(void) {
+    wifi_link_monitor_reset(&monitor);
+}
+
+void tearDown(void) {
+}
+
+void test_score_maps_rssi_range() {
+    wifi_link_sample_t sample = make_sample(0, -50);
+    TEST_ASSERT_EQUAL_UINT8(100, wifi_link_monitor_score(&sample));
+
+    sample.rssi = -90;
+    TEST_ASSERT_EQUAL_UINT8(0, wifi_link_monitor_score(&sample));
+
+    sample.rssi = -70;
+    TEST_ASSERT_EQUAL_UINT8(50, wifi_link_monitor_score(&sample));
+
+    // Negative dBm well below the floor must not wrap around
+    sample.rssi = -127;
+    TEST_ASSERT_EQUAL_UINT8(0, wifi_link_monitor_score(&sample));
+}
+
+void test_score_penalizes_retries_and_beacon_loss() {
+    wifi_link_sample_t sample = make_sample(0, -50);
+    sample.retries = 1;
+    TEST_ASSERT_EQUAL_UINT8(100 - WIFI_LINK_RETRY_PENALTY, wifi_link_monitor_score(&sample));
+
+    sample.retries = 0;
+    sample.beacon_losses = 4;
+    TEST_ASSERT_EQUAL_UINT8(0, wifi_link_monitor_score(&sample));
+}
+
+void test_push_smooths_score() {
+    wifi_link_sample_t good = make_sample(0, -50);
+    wifi_link_sample_t bad = make_sample(1000, -90);
+
+    TEST_ASSERT_EQUAL_UINT8(100, wifi_link_monitor_push(&monitor, &good));
+
+    // One bad sample moves the score a quarter of the way
+    TEST_ASSERT_EQUAL_UINT8(75, wifi_link_monitor_push(&monitor, &bad));
+}
+
+void test_history_is_oldest_first_and_bounded() {
+    for (int i = 0; i < WIFI_LINK_MONITOR_HISTORY + 5; i++) {
+        wifi_link_sample_t sample = make_sample(i * 1000, -60);
+        wifi_link_monitor_push(&monitor, &sample);
+    }
+
+    wifi_link_sample_t history[WIFI_LINK_MONITOR_HISTORY];
+    size_t count = wifi_link_monitor_history(&monitor, history, WIFI_LINK_MONITOR_HISTORY);
+    TEST_ASSERT_EQUAL(WIFI_LINK_MONITOR_HISTORY, count);
+    TEST_ASSERT_EQUAL_UINT32(5 * 1000, history[0].timestamp_ms);
+    TEST_ASSERT_EQUAL_UINT32((WIFI_LINK_MONITOR_HISTORY + 4) * 1000, history[count - 1].timestamp_ms);
+
+    // A short buffer gets the newest samples
+    count = wifi_link_monitor_history(&monitor, history, 3);
+    TEST_ASSERT_EQUAL(3, count);
+    TEST_ASSERT_EQUAL_UINT32((WIFI_LINK_MONITOR_HISTORY + 4) * 1000, history[2].timestamp_ms);
+}
+
+void test_hint_steps_down_and_up_with_hysteresis() {
+    wifi_stream_hint_t hint;
+    wifi_link_sample_t sample = make_sample(0, -50);
+    wifi_link_monitor_push(&monitor, &sample);
+    TEST_ASSERT_FALSE(wifi_link_monitor_hint(&monitor, &hint));
+    TEST_ASSERT_EQUAL_UINT16(320, hint.width);
+
+    // Drive the score down to the lowest tier
+    sample.rssi = -90;
+    for (int i = 0; i < 20; i++) {
+        wifi_link_monitor_push(&monitor, &sample);
+    }
+    TEST_ASSERT_TRUE(wifi_link_monitor_hint(&monitor, &hint));
+    TEST_ASSERT_EQUAL_UINT16(160, hint.width);
+    TEST_ASSERT_LESS_THAN_UINT32(1500, hint.bitrate_kbps);
+
+    // Settle exactly on the middle threshold: not enough to step up
+    wifi_link_monitor_reset(&monitor);
+    monitor.tier = 0;
+    sample.rssi = -74;  // Scores 40
+    wifi_link_monitor_push(&monitor, &sample);
+    TEST_ASSERT_FALSE(wifi_link_monitor_hint(&monitor, &hint));
+
+    // Clearing the threshold by the hysteresis margin steps up
+    wifi_link_monitor_reset(&monitor);
+    monitor.tier = 0;
+    sample.rssi = -72;  // Scores 45
+    wifi_link_monitor_push(&monitor, &sample);
+    TEST_ASSERT_TRUE(wifi_link_monitor_hint(&monitor, &hint));
+    TEST_ASSERT_EQUAL_UINT16(240, hint.width);
+}
+
+// Unity テストランナー関数
+void app_main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_score_maps_rssi_range);
+    RUN_TEST(test_score_penalizes_retries_and_beacon_loss);
+    RUN_TEST(test_push_smooths_score);
+    RUN_TEST(test_history_is_oldest_first_and_bounded);
+    RUN_TEST(test_hint_steps_down_and_up_with_hysteresis);
+
+    UNITY_END();
+}
@@ -0,0 +1,117 @@
+#include "unity.h"
+#include "wifi_roam.h"
+#include <string.h>
+
+static wifi_scan_table_t table;
+static wifi_roam_policy_t policy;
+
+static const wifi_roam_network_t networks[] = {
+    { .ssid = "sphere", .priority = 1 },
+    { .ssid = "sphere-backup", .priority = 0 },
+};
+
+static void add_entry(uint8_t id, const char *ssid, int8_t rssi)
+{
+    wifi_scan_entry_t entry = { .bssid = {0x24, 0x0a, 0xc4, 0, 0, id}, .rssi = rssi, .channel = id };
+    strncpy(entry.ssid, ssid, sizeof(entry.ssid) - 1);
+    wifi_scan_table_update(&table, &entry);
+}
+
+void setUp(void) {
+    wifi_scan_table_reset(&table);
+    wifi_roam_policy_default(&policy);
+}
+
+void tearDown(void) {
+}
+
+void test_initial_pick_prefers_priority() {
+    add_entry(1, "sphere", -60);
+    add_entry(2, "sphere-backup", -58);
+    add_entry(3, "other", -30);
+    wifi_scan_table_commit(&table, 0, WIFI_SCAN_MAX_AGE_MS);
+
+    // 2 dB of RSSI do not outweigh one priority step
+    wifi_roam_choice_t choice;
+    TEST_ASSERT_TRUE(wifi_roam_select(&policy, networks, 2, &table, -1, 0, NULL, &choice));
+    TEST_ASSERT_EQUAL(0, choice.network);
+    TEST_ASSERT_EQUAL_UINT8(1, choice.entry->bssid[5]);
+    TEST_ASSERT_EQUAL_INT16(-60 + WIFI_ROAM_PRIORITY_DB, choice.score);
+}
+
+void test_no_roam_above_threshold() {
+    add_entry(2, "sphere", -40);
+    wifi_scan_table_commit(&table, 0, WIFI_SCAN_MAX_AGE_MS);
+
+    uint8_t current[6] = {0x24, 0x0a, 0xc4, 0, 0, 1};
+    wifi_roam_choice_t choice;
+    TEST_ASSERT_FALSE(wifi_roam_select(&policy, networks, 2, &table, 0, WIFI_ROAM_RSSI_THRESHOLD, current, &choice));
+}
+
+void test_roam_needs_hysteresis() {
+    add_entry(1, "sphere", -75);
+    add_entry(2, "sphere", -75 + WIFI_ROAM_HYSTERESIS_DB - 1);
+    wifi_scan_table_commit(&table, 0, WIFI_SCAN_MAX_AGE_MS);
+
+    uint8_t current[6] = {0x24, 0x0a, 0xc4, 0, 0, 1};
+    wifi_roam_choice_t choice;
+    TEST_ASSERT_FALSE(wifi_roam_select(&policy, networks, 2, &table, 0, -75, current, &choice));
+
+    add_entry(2, "sphere", -75 + WIFI_ROAM_HYSTERESIS_DB);
+    wifi_scan_table_commit(&table, 0, WIFI_SCAN_MAX_AGE_MS);
+    TEST_ASSERT_TRUE(wifi_roam_select(&policy, networks, 2, &table, 0, -75, current, &choice));
+    TEST_ASSERT_EQUAL_UINT8(2, choice.entry->bssid[5]);
+}
+
+void test_roam_to_lower_priority_network() {
+    // The current AP is the strongest in the table but is excluded
+    add_entry(1, "sphere", -72);
+    add_entry(2, "sphere-backup", -50);
+    wifi_scan_table_commit(&table, 0, WIFI_SCAN_MAX_AGE_MS);
+
+    uint8_t current[6] = {0x24, 0x0a, 0xc4, 0, 0, 1};
+    wifi_roam_choice_t choice;
+    TEST_ASSERT_TRUE(wifi_roam_select(&policy, networks, 2, &table, 0, -80, current, &choice));
+    TEST_ASSERT_EQUAL(1, choice.network);
+    TEST_ASSERT_EQUAL_UINT8(2, choice.entry->bssid[5]);
+}
+
+void test_neighbor_report_channels() {
+    // Two neighbor report elements on channels 6 and 11, an unrelated element, a truncated one
+    const uint8_t report[] = {
+        52, 13, 1, 2, 3, 4, 5, 6, 0, 0, 0, 0, 81, 6, 7,
+        221, 2, 0xaa, 0xbb,
+        52, 13, 1, 2, 3, 4, 5, 7, 0, 0, 0, 0, 81, 11, 7,
+        52, 13, 1, 2, 3
+    };
+    TEST_ASSERT_EQUAL_HEX16((1u << 6) | (1u << 11), wifi_roam_neighbor_channels(report, sizeof(report)));
+    TEST_ASSERT_EQUAL_HEX16(0, wifi_roam_neighbor_channels(report, 10));
+}
+
+void test_stats_histogram() {
+    wifi_roam_stats_t stats = {0};
+    wifi_roam_stats_record(&stats, 40);
+    wifi_roam_stats_record(&stats, 520);
+    wifi_roam_stats_record(&stats, 3000);
+
+    TEST_ASSERT_EQUAL_UINT16(3, stats.count);
+    TEST_ASSERT_EQUAL_UINT32(3000, stats.last_gap_ms);
+    TEST_ASSERT_EQUAL_UINT32(3000, stats.max_gap_ms);
+    TEST_ASSERT_EQUAL_UINT16(1, stats.gap_hist[0]);
+    TEST_ASSERT_EQUAL_UINT16(1, stats.gap_hist[4]);
+    TEST_ASSERT_EQUAL_UINT16(1, stats.gap_hist[WIFI_ROAM_GAP_BINS - 1]);
+}
+
+// Unity テストランナー関数
+void app_main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_initial_pick_prefers_priority);
+    RUN_TEST(test_no_roam_above_threshold);
+    RUN_TEST(test_roam_needs_hysteresis);
+    RUN_TEST(test_roam_to_lower_priority_network);
+    RUN_TEST(test_neighbor_report_channels);
+    RUN_TEST(test_stats_histogram);
+
+    UNITY_END();
+}
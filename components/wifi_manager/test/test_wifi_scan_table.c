@@ -0,0 +1,121 @@
+#include "unity.h"
+#include "wifi_scan_table.h"
+#include <string.h>
+
+static wifi_scan_table_t table;
+
+static wifi_scan_entry_t make_entry(uint8_t id, const char *ssid, int8_t rssi, uint32_t timestamp_ms)
+{
+    wifi_scan_entry_t entry = { .bssid = {0x24, 0x0a, 0xc4, 0, 0, id}, .rssi = rssi, .channel = 1,
+                                .timestamp_ms = timestamp_ms };
+    strncpy(entry.ssid, ssid, sizeof(entry.ssid) - 1);
+    return entry;
+}
+
+void setUp(void) {
+    wifi_scan_table_reset(&table);
+}
+
+void tearDown(void) {
+}
+
+void test_commit_orders_strongest_first() {
+    wifi_scan_entry_t a = make_entry(1, "sphere", -70, 0);
+    wifi_scan_entry_t b = make_entry(2, "sphere", -40, 0);
+    wifi_scan_entry_t c = make_entry(3, "other", -55, 0);
+    wifi_scan_table_update(&table, &a);
+    wifi_scan_table_update(&table, &b);
+    wifi_scan_table_update(&table, &c);
+    wifi_scan_table_commit(&table, 0, WIFI_SCAN_MAX_AGE_MS);
+
+    TEST_ASSERT_EQUAL(3, table.count);
+    TEST_ASSERT_EQUAL_INT8(-40, wifi_scan_table_at(&table, 0)->rssi);
+    TEST_ASSERT_EQUAL_INT8(-55, wifi_scan_table_at(&table, 1)->rssi);
+    TEST_ASSERT_EQUAL_INT8(-70, wifi_scan_table_at(&table, 2)->rssi);
+    TEST_ASSERT_NULL(wifi_scan_table_at(&table, 3));
+}
+
+void test_update_refreshes_same_bssid() {
+    wifi_scan_entry_t entry = make_entry(1, "sphere", -70, 0);
+    wifi_scan_table_update(&table, &entry);
+
+    entry.rssi = -50;
+    entry.timestamp_ms = 1000;
+    wifi_scan_table_update(&table, &entry);
+    wifi_scan_table_commit(&table, 1000, WIFI_SCAN_MAX_AGE_MS);
+
+    TEST_ASSERT_EQUAL(1, table.count);
+    TEST_ASSERT_EQUAL_INT8(-50, wifi_scan_table_at(&table, 0)->rssi);
+    TEST_ASSERT_EQUAL_UINT32(1000, wifi_scan_table_at(&table, 0)->timestamp_ms);
+}
+
+void test_commit_expires_stale_entries() {
+    wifi_scan_entry_t old = make_entry(1, "sphere", -40, 0);
+    wifi_scan_entry_t fresh = make_entry(2, "sphere", -60, 5000);
+    wifi_scan_table_update(&table, &old);
+    wifi_scan_table_update(&table, &fresh);
+    wifi_scan_table_commit(&table, 5000, 4000);
+
+    TEST_ASSERT_EQUAL(1, table.count);
+    TEST_ASSERT_EQUAL_UINT8(2, wifi_scan_table_at(&table, 0)->bssid[5]);
+}
+
+void test_full_table_replaces_oldest_then_weakest() {
+    for (int i = 0; i < WIFI_SCAN_TABLE_SIZE; i++) {
+        wifi_scan_entry_t entry = make_entry(i, "sphere", -60, i == 0 ? 0 : 1000);
+        TEST_ASSERT_TRUE(wifi_scan_table_update(&table, &entry));
+    }
+
+    // The entry from the earlier scan goes first
+    wifi_scan_entry_t newer = make_entry(100, "sphere", -80, 1000);
+    TEST_ASSERT_TRUE(wifi_scan_table_update(&table, &newer));
+    TEST_ASSERT_EQUAL(WIFI_SCAN_TABLE_SIZE, table.count);
+
+    // Within one scan, a weaker AP does not displace the weakest kept one
+    wifi_scan_entry_t weaker = make_entry(101, "sphere", -90, 1000);
+    TEST_ASSERT_FALSE(wifi_scan_table_update(&table, &weaker));
+
+    wifi_scan_entry_t stronger = make_entry(102, "sphere", -30, 1000);
+    TEST_ASSERT_TRUE(wifi_scan_table_update(&table, &stronger));
+    wifi_scan_table_commit(&table, 1000, WIFI_SCAN_MAX_AGE_MS);
+
+    TEST_ASSERT_EQUAL_UINT8(102, wifi_scan_table_at(&table, 0)->bssid[5]);
+    TEST_ASSERT_EQUAL_INT8(-60, wifi_scan_table_at(&table, WIFI_SCAN_TABLE_SIZE - 1)->rssi);
+}
+
+void test_iterator_filters_ssid_and_current_bssid() {
+    wifi_scan_entry_t current = make_entry(1, "sphere", -45, 0);
+    wifi_scan_entry_t candidate = make_entry(2, "sphere", -65, 0);
+    wifi_scan_entry_t foreign = make_entry(3, "other", -30, 0);
+    wifi_scan_table_update(&table, &current);
+    wifi_scan_table_update(&table, &candidate);
+    wifi_scan_table_update(&table, &foreign);
+    wifi_scan_table_commit(&table, 0, WIFI_SCAN_MAX_AGE_MS);
+
+    wifi_scan_iter_t iter;
+    wifi_scan_iter_init(&iter, NULL, NULL);
+    int count = 0;
+    while (wifi_scan_table_next(&table, &iter)) {
+        count++;
+    }
+    TEST_ASSERT_EQUAL(3, count);
+
+    wifi_scan_iter_init(&iter, "sphere", current.bssid);
+    const wifi_scan_entry_t *entry = wifi_scan_table_next(&table, &iter);
+    TEST_ASSERT_NOT_NULL(entry);
+    TEST_ASSERT_EQUAL_UINT8(2, entry->bssid[5]);
+    TEST_ASSERT_NULL(wifi_scan_table_next(&table, &iter));
+}
+
+// Unity テストランナー関数
+void app_main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_commit_orders_strongest_first);
+    RUN_TEST(test_update_refreshes_same_bssid);
+    RUN_TEST(test_commit_expires_stale_entries);
+    RUN_TEST(test_full_table_replaces_oldest_then_weakest);
+    RUN_TEST(test_iterator_filters_ssid_and_current_bssid);
+
+    UNITY_END();
+}
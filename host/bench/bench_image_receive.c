@@ -0,0 +1,246 @@
+#include "unity.h"
+#include "image_reassembler.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Image fragments into a frame buffer: socket-style receive (datagram copied
+// into a user buffer, then into the frame) against the pbuf path (payload
+// copied from the driver buffers straight into the frame). Host nanoseconds
+// only compare the two paths; image_stream_get_stats() reports the on-target
+// cycles per MB.
+
+#define BENCH_FRAMES        200
+#define BENCH_ROUNDS        5
+#define BENCH_FRAME_SIZE    32768   // ROS2_MANAGER_FRAME_BUFFER_SIZE, a typical JPEG
+#define BENCH_SEED          0x5eed1234u
+#define BENCH_DUP_PERCENT   2
+#define BENCH_LOSS_PERCENT  1       // Lost fragments leave their frame incomplete
+#define BENCH_MTU_PAYLOAD   1472    // UDP payload of a 1500-byte frame
+
+#define BENCH_FRAGMENTS     ((BENCH_FRAME_SIZE + IMAGE_FRAGMENT_DEFAULT_PAYLOAD - 1) / IMAGE_FRAGMENT_DEFAULT_PAYLOAD)
+#define BENCH_MAX_DATAGRAMS (BENCH_FRAMES * BENCH_FRAGMENTS * 2)
+
+// Stand-in for a pbuf chain: the driver hands over a datagram in one or two segments
+typedef struct segment {
+    const uint8_t *payload;
+    uint16_t len;
+    const struct segment *next;
+} segment_t;
+
+typedef struct {
+    segment_t first;
+    segment_t second;
+    uint16_t tot_len;
+} datagram_t;
+
+static uint8_t *frames;             // Source images, BENCH_FRAMES of them
+static uint8_t *wire;               // Datagram bytes as the driver holds them
+static datagram_t *datagrams;
+static uint32_t datagram_count;
+static uint32_t lcg_state;
+
+static uint32_t lcg_next(uint32_t range)
+{
+    lcg_state = lcg_state * 1664525u + 1013904223u;
+    return (lcg_state >> 8) % range;
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void add_datagram(uint16_t frame, uint16_t index)
+{
+    image_fragment_header_t header = {
+        .frame_id = frame,
+        .frame_size = BENCH_FRAME_SIZE,
+        .index = index,
+        .count = BENCH_FRAGMENTS,
+        .payload_size = IMAGE_FRAGMENT_DEFAULT_PAYLOAD
+    };
+    uint32_t offset = (uint32_t)index * IMAGE_FRAGMENT_DEFAULT_PAYLOAD;
+    uint16_t len = index == BENCH_FRAGMENTS - 1 ? BENCH_FRAME_SIZE - offset : IMAGE_FRAGMENT_DEFAULT_PAYLOAD;
+
+    uint8_t *data = wire + (size_t)datagram_count * BENCH_MTU_PAYLOAD;
+    image_fragment_write(&header, data);
+    memcpy(data + IMAGE_FRAGMENT_HEADER_SIZE, frames + (size_t)frame * BENCH_FRAME_SIZE + offset, len);
+
+    // Every eighth datagram arrives split, like an IP-reassembled one
+    datagram_t *d = &datagrams[datagram_count++];
+    d->tot_len = IMAGE_FRAGMENT_HEADER_SIZE + len;
+    d->first.payload = data;
+    d->first.len = d->tot_len;
+    d->first.next = NULL;
+    if (datagram_count % 8 == 0) {
+        d->first.len = d->tot_len / 2;
+        d->second.payload = data + d->first.len;
+        d->second.len = d->tot_len - d->first.len;
+        d->second.next = NULL;
+        d->first.next = &d->second;
+    }
+}
+
+// Frames in order, fragments lightly shuffled, some duplicated, a few lost
+static void build_stream(uint32_t *expected_complete)
+{
+    lcg_state = BENCH_SEED;
+    datagram_count = 0;
+    *expected_complete = 0;
+
+    for (uint16_t frame = 0; frame < BENCH_FRAMES; frame++) {
+        uint8_t *image = frames + (size_t)frame * BENCH_FRAME_SIZE;
+        for (int i = 0; i < BENCH_FRAME_SIZE; i++) {
+            image[i] = (uint8_t)lcg_next(256);
+        }
+
+        uint16_t order[BENCH_FRAGMENTS];
+        for (uint16_t i = 0; i < BENCH_FRAGMENTS; i++) {
+            order[i] = i;
+        }
+        for (uint16_t i = 0; i + 1 < BENCH_FRAGMENTS; i++) {
+            if (lcg_next(4) == 0) {
+                uint16_t t = order[i];
+                order[i] = order[i + 1];
+                order[i + 1] = t;
+            }
+        }
+
+        bool lost = false;
+        for (uint16_t i = 0; i < BENCH_FRAGMENTS; i++) {
+            if (lcg_next(100) < BENCH_LOSS_PERCENT) {
+                lost = true;
+                continue;
+            }
+            add_datagram(frame, order[i]);
+            if (lcg_next(100) < BENCH_DUP_PERCENT) {
+                add_datagram(frame, order[i]);
+            }
+        }
+        *expected_complete += !lost;
+    }
+}
+
+static size_t copy_chain(const segment_t *s, size_t skip, uint8_t *dst, size_t len)
+{
+    size_t copied = 0;
+    for (; s && copied < len; s = s->next) {
+        if (skip >= s->len) {
+            skip -= s->len;
+            continue;
+        }
+        size_t n = s->len - skip;
+        if (n > len - copied) {
+            n = len - copied;
+        }
+        memcpy(dst + copied, s->payload + skip, n);
+        copied += n;
+        skip = 0;
+    }
+    return copied;
+}
+
+typedef struct {
+    uint64_t ns;
+    uint64_t bytes;
+    uint32_t completed;
+    uint32_t mismatched;
+} bench_result_t;
+
+// Completed frames are checked against the source, outside the timed part
+static void run(bool zero_copy, bench_result_t *result)
+{
+    image_reassembler_t r;
+    uint8_t *frame = malloc(BENCH_FRAME_SIZE);
+    uint8_t datagram[BENCH_MTU_PAYLOAD];
+    memset(result, 0, sizeof(*result));
+
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        image_reassembler_reset(&r, BENCH_FRAME_SIZE);
+        for (uint32_t i = 0; i < datagram_count; i++) {
+            const datagram_t *d = &datagrams[i];
+            uint64_t start = now_ns();
+
+            const uint8_t *header_data;
+            if (zero_copy) {
+                header_data = d->first.payload;
+            } else {
+                // recvfrom(): the whole datagram lands in a user buffer first
+                copy_chain(&d->first, 0, datagram, d->tot_len);
+                header_data = datagram;
+            }
+
+            image_fragment_header_t header;
+            uint32_t offset;
+            size_t len = d->tot_len - IMAGE_FRAGMENT_HEADER_SIZE;
+            image_fragment_parse(header_data, d->tot_len, &header);
+            image_fragment_result_t res = image_reassembler_add(&r, &header, len, &offset);
+            if (res == IMAGE_FRAGMENT_ACCEPT || res == IMAGE_FRAGMENT_COMPLETE) {
+                if (zero_copy) {
+                    copy_chain(&d->first, IMAGE_FRAGMENT_HEADER_SIZE, frame + offset, len);
+                } else {
+                    memcpy(frame + offset, datagram + IMAGE_FRAGMENT_HEADER_SIZE, len);
+                }
+                result->bytes += len;
+            }
+            result->ns += now_ns() - start;
+
+            if (res == IMAGE_FRAGMENT_COMPLETE) {
+                result->completed++;
+                const uint8_t *source = frames + (size_t)header.frame_id * BENCH_FRAME_SIZE;
+                result->mismatched += memcmp(frame, source, BENCH_FRAME_SIZE) != 0;
+            }
+        }
+    }
+    free(frame);
+}
+
+static void report(const char *name, const bench_result_t *result)
+{
+    double mb = (double)result->bytes / (1 << 20);
+    printf("  %-10s %7.1f MB  %8.0f ns/MB  %u frames\n", name, mb, result->ns / mb, result->completed);
+}
+
+void setUp(void) {
+    frames = malloc((size_t)BENCH_FRAMES * BENCH_FRAME_SIZE);
+    wire = malloc((size_t)BENCH_MAX_DATAGRAMS * BENCH_MTU_PAYLOAD);
+    datagrams = malloc(sizeof(datagram_t) * BENCH_MAX_DATAGRAMS);
+}
+
+void tearDown(void) {
+    free(frames);
+    free(wire);
+    free(datagrams);
+}
+
+void bench_receive_paths() {
+    uint32_t expected_complete;
+    build_stream(&expected_complete);
+
+    bench_result_t socket_copy, zero_copy;
+    run(false, &socket_copy);
+    run(true, &zero_copy);
+
+    printf("\n%u frames of %d bytes, %u datagrams, %d rounds\n",
+           BENCH_FRAMES, BENCH_FRAME_SIZE, datagram_count, BENCH_ROUNDS);
+    report("socket", &socket_copy);
+    report("zero-copy", &zero_copy);
+
+    TEST_ASSERT_EQUAL_UINT32(expected_complete * BENCH_ROUNDS, zero_copy.completed);
+    TEST_ASSERT_EQUAL_UINT32(zero_copy.completed, socket_copy.completed);
+    TEST_ASSERT_EQUAL_UINT32(0, zero_copy.mismatched);
+    TEST_ASSERT_EQUAL_UINT32(0, socket_copy.mismatched);
+}
+
+// Unity テストランナー関数
+void app_main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(bench_receive_paths);
+
+    UNITY_END();
+}
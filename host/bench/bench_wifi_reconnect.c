@@ -0,0 +1,166 @@
+#include "unity.h"
+#include "wifi_manager.h"
+#include "mock_wifi.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Reconnect latency after injected dropouts, cached link against full scan.
+// Times are simulated, so the numbers are identical on every host and a
+// change in them comes from wifi_manager or the script.
+
+#define BENCH_CYCLES        200
+#define BENCH_SEED          0x5eed1234u
+#define BENCH_FAIL_PERCENT  10      // First reconnect attempt fails this often
+
+static const mock_wifi_ap_t bench_ap = {
+    .ssid = "sphere", .bssid = {0x24, 0x0a, 0xc4, 0x00, 0x00, 0x01}, .channel = 6, .rssi = -50
+};
+
+static const uint8_t dropout_reasons[] = {
+    WIFI_REASON_BEACON_TIMEOUT, WIFI_REASON_AUTH_EXPIRE, WIFI_REASON_UNSPECIFIED
+};
+
+typedef struct {
+    uint32_t samples[BENCH_CYCLES];
+    uint32_t count;
+    uint32_t retries;           // Highest retry count seen per reconnect, summed
+    uint32_t scan_fallbacks;    // Reconnects that left the cached link for a full scan
+    uint16_t hist[WIFI_MANAGER_CONNECT_HIST_BINS];
+} bench_result_t;
+
+// Same bins as wifi_info_t.connect_hist_*, which also count the initial connect
+static const uint32_t hist_edges_ms[WIFI_MANAGER_CONNECT_HIST_BINS - 1] = {250, 500, 1000, 2000, 4000};
+
+static uint32_t lcg_state;
+
+static uint32_t lcg_next(uint32_t range)
+{
+    lcg_state = lcg_state * 1664525u + 1013904223u;
+    return (lcg_state >> 8) % range;
+}
+
+static int compare_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static uint32_t percentile(const bench_result_t *result, uint32_t percent)
+{
+    return result->samples[(result->count - 1) * percent / 100];
+}
+
+static void run_cycles(bool fast_reconnect, bench_result_t *result)
+{
+    memset(result, 0, sizeof(*result));
+    lcg_state = BENCH_SEED;
+
+    wifi_manager_config_t config = {
+        .ssid = "sphere",
+        .password = "password",
+        .max_retry = 5,
+        .timeout_ms = 30000,
+        .auto_reconnect = true,
+        .fast_reconnect = fast_reconnect
+    };
+    TEST_ASSERT_EQUAL(ESP_OK, wifi_manager_connect(&config));
+    // Let the connected event land before draining the queue
+    mock_wifi_run_for(1);
+
+    wifi_manager_event_t event;
+    for (int cycle = 0; cycle < BENCH_CYCLES; cycle++) {
+        while (wifi_manager_get_event(&event, 0) == ESP_OK) {
+        }
+
+        if (lcg_next(100) < BENCH_FAIL_PERCENT) {
+            mock_wifi_attempt_t failed = { .fail_reason = WIFI_REASON_AUTH_FAIL, .assoc_ms = 100 };
+            mock_wifi_script_attempt(&failed);
+        }
+        mock_wifi_attempt_t attempt = { .assoc_ms = 80 + lcg_next(120), .dhcp_ms = 100 + lcg_next(700) };
+        mock_wifi_script_attempt(&attempt);
+
+        uint8_t reason = dropout_reasons[lcg_next(sizeof(dropout_reasons))];
+        mock_wifi_inject_disconnect(reason, 500 + lcg_next(2500));
+
+        uint8_t retries = 0;
+        do {
+            TEST_ASSERT_EQUAL(ESP_OK, wifi_manager_get_event(&event, 60000));
+            TEST_ASSERT_TRUE(event.status == WIFI_STATUS_CONNECTING || event.status == WIFI_STATUS_CONNECTED);
+            if (event.retry_count > retries) {
+                retries = event.retry_count;
+            }
+        } while (event.status != WIFI_STATUS_CONNECTED);
+
+        wifi_info_t info;
+        mock_wifi_run_for(1);
+        wifi_manager_get_info(&info);
+        result->samples[result->count++] = info.last_connect_ms;
+        int bin = 0;
+        while (bin < WIFI_MANAGER_CONNECT_HIST_BINS - 1 && info.last_connect_ms >= hist_edges_ms[bin]) {
+            bin++;
+        }
+        result->hist[bin]++;
+        result->retries += retries;
+        if (fast_reconnect && !info.last_connect_cached) {
+            result->scan_fallbacks++;
+        }
+    }
+
+    qsort(result->samples, result->count, sizeof(result->samples[0]), compare_u32);
+}
+
+static void print_result(const char *name, const bench_result_t *result)
+{
+    printf("%-8s cycles=%lu retries=%lu fallbacks=%lu p50=%lu ms p95=%lu ms max=%lu ms "
+           "hist=[%u %u %u %u %u %u]\n",
+           name, (unsigned long)result->count, (unsigned long)result->retries,
+           (unsigned long)result->scan_fallbacks,
+           (unsigned long)percentile(result, 50), (unsigned long)percentile(result, 95),
+           (unsigned long)result->samples[result->count - 1],
+           result->hist[0], result->hist[1], result->hist[2],
+           result->hist[3], result->hist[4], result->hist[5]);
+}
+
+static bench_result_t cached_result;
+static bench_result_t scan_result;
+
+void setUp(void) {
+    mock_wifi_reset();
+    mock_wifi_add_ap(&bench_ap);
+    TEST_ASSERT_EQUAL(ESP_OK, wifi_manager_init());
+}
+
+void tearDown(void) {
+    wifi_manager_deinit();
+}
+
+void bench_reconnect_cached_link() {
+    run_cycles(true, &cached_result);
+    print_result("cached", &cached_result);
+    TEST_ASSERT_EQUAL_UINT32(BENCH_CYCLES, cached_result.count);
+}
+
+void bench_reconnect_full_scan() {
+    run_cycles(false, &scan_result);
+    print_result("scan", &scan_result);
+    TEST_ASSERT_EQUAL_UINT32(BENCH_CYCLES, scan_result.count);
+}
+
+void bench_cached_link_beats_full_scan() {
+    // Both runs saw the same dropouts and attempt timings
+    TEST_ASSERT_LESS_THAN_UINT32(percentile(&scan_result, 50), percentile(&cached_result, 50));
+    TEST_ASSERT_LESS_THAN_UINT32(percentile(&scan_result, 95), percentile(&cached_result, 95));
+}
+
+// Unity テストランナー関数
+void app_main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(bench_reconnect_cached_link);
+    RUN_TEST(bench_reconnect_full_scan);
+    RUN_TEST(bench_cached_link_beats_full_scan);
+
+    UNITY_END();
+}
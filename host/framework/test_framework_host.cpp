@@ -0,0 +1,35 @@
+#include "test_manager.hpp"
+#include "kernel_benchmark_test.hpp"
+#include <stdlib.h>
+
+// test_framework on the host: the suites that need no peripherals, run by
+// the same TestManager as on the target. An optional argument selects tests,
+// a name pattern or "name=...;tags=...;shard=N/M" (see TestFilter).
+// MOCK_LOG_LEVEL overrides the info log level.
+
+int main(int argc, char** argv)
+{
+    if (!getenv("MOCK_LOG_LEVEL")) {
+        esp_log_level_set("*", ESP_LOG_INFO);
+    }
+
+    TestManager test_manager;
+    test_manager.setStopOnFirstFailure(false);
+    test_manager.setParallelExecution(true);
+
+    test_manager.addTest(std::unique_ptr<BaseTest>(std::make_unique<KernelBenchmarkTest>()));
+
+    bool passed;
+    if (argc > 1) {
+        TestFilter filter;
+        if (filter.parse(argv[1]) != ESP_OK) {
+            return 2;
+        }
+        passed = test_manager.runSelected(filter);
+        test_manager.printTestSummary();
+    } else {
+        passed = test_manager.runAllTests();    // Prints its own summary
+    }
+
+    return passed ? 0 : 1;
+}
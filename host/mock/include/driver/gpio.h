@@ -0,0 +1,19 @@
+#ifndef MOCK_DRIVER_GPIO_H
+#define MOCK_DRIVER_GPIO_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Host stand-in for driver/gpio.h: pin numbers only, for headers that carry them in configs
+typedef enum {
+    GPIO_NUM_NC = -1,
+    GPIO_NUM_0 = 0,
+    GPIO_NUM_MAX = 49,      // ESP32-S3
+} gpio_num_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MOCK_DRIVER_GPIO_H
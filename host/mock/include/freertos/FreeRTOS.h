@@ -0,0 +1,60 @@
+#ifndef MOCK_FREERTOS_H
+#define MOCK_FREERTOS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Host stand-in for FreeRTOS. Tasks are threads; time is simulated and
+// only advances while every task is blocked (see mock_freertos.c).
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint8_t StackType_t;
+
+#define pdFALSE             0
+#define pdTRUE              1
+#define pdPASS              pdTRUE
+#define pdFAIL              pdFALSE
+#define portMAX_DELAY       ((TickType_t)0xffffffffUL)
+#define configTICK_RATE_HZ  1000        // Matches CONFIG_FREERTOS_HZ
+#define portTICK_PERIOD_MS  (1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms)   ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000))
+#define tskNO_AFFINITY      0x7fffffff
+#define portNUM_PROCESSORS  2           // ESP32-S3
+#define configMAX_TASK_NAME_LEN 16
+#define configMAX_PRIORITIES    25          // ESP-IDF default
+#define BIT0                0x00000001
+#define BIT1                0x00000002
+#define BIT2                0x00000004
+#define BIT3                0x00000008
+#define BIT4                0x00000010
+#define BIT5                0x00000020
+
+// Critical sections serialize on one host lock; the spinlock word is unused
+typedef struct {
+    uint32_t owner;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED { .owner = 0 }
+
+void mock_enter_critical(portMUX_TYPE *mux);
+void mock_exit_critical(portMUX_TYPE *mux);
+
+// Core a task was pinned to, 0 for unpinned tasks; nothing runs truly per core
+BaseType_t xPortGetCoreID(void);
+
+#define portENTER_CRITICAL(mux)     mock_enter_critical(mux)
+#define portEXIT_CRITICAL(mux)      mock_exit_critical(mux)
+#define portENTER_CRITICAL_ISR(mux) mock_enter_critical(mux)
+#define portEXIT_CRITICAL_ISR(mux)  mock_exit_critical(mux)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MOCK_FREERTOS_H
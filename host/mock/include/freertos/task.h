@@ -0,0 +1,56 @@
+#ifndef MOCK_FREERTOS_TASK_H
+#define MOCK_FREERTOS_TASK_H
+
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct mock_task *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *arg);
+
+#define tskIDLE_PRIORITY    0
+
+// Only the TCB size matters to callers of static task creation
+typedef struct {
+    uint8_t reserved[64];
+} StaticTask_t;
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char *name, uint32_t stack_size,
+                                   void *arg, UBaseType_t priority, TaskHandle_t *handle, BaseType_t core);
+BaseType_t xTaskCreate(TaskFunction_t function, const char *name, uint32_t stack_size,
+                       void *arg, UBaseType_t priority, TaskHandle_t *handle);
+// The caller's stack and TCB go unused; the task runs on a host thread
+TaskHandle_t xTaskCreateStaticPinnedToCore(TaskFunction_t function, const char *name, uint32_t stack_size,
+                                           void *arg, UBaseType_t priority, StackType_t *stack,
+                                           StaticTask_t *tcb, BaseType_t core);
+// Deleting another task ends its thread at the next point it blocks and
+// frees its handle. The thread unwinds through pthread_exit(), so C++
+// destructors on its stack run, unlike on the target.
+void vTaskDelete(TaskHandle_t task);
+void vTaskSuspend(TaskHandle_t task);      // Only the calling task, until deleted
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task);
+// Host threads have no measurable stack: the whole stack counts as free
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+const char *pcTaskGetName(TaskHandle_t task);
+
+// Tasks are not enumerated on the host: uxTaskGetSystemState() reports none
+typedef struct {
+    TaskHandle_t xHandle;
+    const char *pcTaskName;
+    UBaseType_t uxCurrentPriority;
+    uint32_t usStackHighWaterMark;
+} TaskStatus_t;
+
+UBaseType_t uxTaskGetNumberOfTasks(void);
+UBaseType_t uxTaskGetSystemState(TaskStatus_t *status, UBaseType_t count, uint32_t *total_run_time);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MOCK_FREERTOS_TASK_H
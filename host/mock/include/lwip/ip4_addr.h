@@ -0,0 +1,19 @@
+#ifndef MOCK_LWIP_IP4_ADDR_H
+#define MOCK_LWIP_IP4_ADDR_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Network byte order, as in lwIP
+typedef struct {
+    uint32_t addr;
+} ip4_addr_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MOCK_LWIP_IP4_ADDR_H
@@ -0,0 +1,28 @@
+#ifndef MOCK_LWIP_IP_ADDR_H
+#define MOCK_LWIP_IP_ADDR_H
+
+#include "lwip/ip4_addr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IPADDR_TYPE_V4 0U
+
+typedef struct {
+    union {
+        ip4_addr_t ip4;
+    } u_addr;
+    uint8_t type;
+} ip_addr_t;
+
+int ipaddr_aton(const char *cp, ip_addr_t *addr);
+
+#define ip_addr_set_ip4_u32(ipaddr, val) \
+    do { (ipaddr)->u_addr.ip4.addr = (val); (ipaddr)->type = IPADDR_TYPE_V4; } while (0)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MOCK_LWIP_IP_ADDR_H
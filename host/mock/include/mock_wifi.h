@@ -0,0 +1,151 @@
+#ifndef MOCK_WIFI_H
+#define MOCK_WIFI_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_wifi.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Scripted stand-in for the WiFi driver, esp_netif and NVS on the host
+#define MOCK_WIFI_MAX_APS           8
+#define MOCK_WIFI_MAX_SCRIPT        32
+#define MOCK_WIFI_DHCP_STALL        UINT32_MAX      // The DHCP server never answers
+#define MOCK_WIFI_SCAN_CHANNELS     13
+
+// Default radio timings, roughly an ESP32-S3 against a consumer AP
+#define MOCK_WIFI_DEFAULT_START_MS      20
+#define MOCK_WIFI_DEFAULT_FULL_SCAN_MS  1560    // 13 channels at 120 ms active dwell
+#define MOCK_WIFI_DEFAULT_FAST_SCAN_MS  120     // Probe on the given channel only
+#define MOCK_WIFI_DEFAULT_ASSOC_MS      150     // Authentication, association and 4-way handshake
+#define MOCK_WIFI_DEFAULT_DHCP_MS       400
+
+// A simulated access point
+typedef struct {
+    char ssid[33];
+    uint8_t bssid[6];
+    uint8_t channel;
+    int8_t rssi;
+} mock_wifi_ap_t;
+
+// Outcome of one association attempt
+typedef struct {
+    uint8_t fail_reason;        // 0 to associate, otherwise the reported disconnect reason
+    uint32_t assoc_ms;          // After the AP was found
+    uint32_t dhcp_ms;           // Association to IP address, MOCK_WIFI_DHCP_STALL for never
+} mock_wifi_attempt_t;
+
+// Radio timings
+typedef struct {
+    uint32_t start_ms;          // esp_wifi_start() to WIFI_EVENT_STA_START
+    uint32_t full_scan_ms;      // Finding the AP without a BSSID and channel
+    uint32_t fast_scan_ms;      // Finding the AP with a BSSID and channel
+    mock_wifi_attempt_t attempt;    // Used when no attempt is scripted
+} mock_wifi_timing_t;
+
+// Driver calls and radio settings seen so far
+typedef struct {
+    uint32_t connect_calls;
+    uint32_t full_scans;        // Connects that searched all channels
+    uint32_t fast_scans;        // Connects that went to a given BSSID and channel
+    uint32_t dhcp_requests;
+    uint32_t static_ip_connects;
+    uint32_t scan_requests;     // esp_wifi_scan_start()
+    uint32_t nvs_writes;
+    bool associated;
+    wifi_ps_type_t ps;
+    int8_t tx_power;
+    wifi_bandwidth_t bandwidth;
+} mock_wifi_stats_t;
+
+// Function prototypes
+
+/**
+ * @brief Restore the default timings and clear APs, scripts, NVS and stats
+ *
+ * Call only while wifi_manager is deinitialized. The simulated clock keeps
+ * running.
+ */
+void mock_wifi_reset(void);
+
+/**
+ * @brief Set the radio timings
+ *
+ * @param timing Timings
+ */
+void mock_wifi_set_timing(const mock_wifi_timing_t *timing);
+
+/**
+ * @brief Get the radio timings
+ *
+ * @param timing Pointer to store the timings
+ */
+void mock_wifi_get_timing(mock_wifi_timing_t *timing);
+
+/**
+ * @brief Add an access point, or update the one with the same BSSID
+ *
+ * Without a BSSID in the station config the strongest AP with the SSID is
+ * joined.
+ *
+ * @param ap Access point
+ */
+void mock_wifi_add_ap(const mock_wifi_ap_t *ap);
+
+/**
+ * @brief Remove an access point
+ *
+ * The station stays associated until a disconnect is injected; an
+ * association in progress fails with WIFI_REASON_NO_AP_FOUND.
+ *
+ * @param bssid BSSID of the AP
+ */
+void mock_wifi_remove_ap(const uint8_t *bssid);
+
+/**
+ * @brief Queue the outcome of the next association attempt
+ *
+ * Attempts are used in order; afterwards the default attempt applies.
+ *
+ * @param attempt Attempt outcome
+ */
+void mock_wifi_script_attempt(const mock_wifi_attempt_t *attempt);
+
+/**
+ * @brief Drop the association after a delay
+ *
+ * Ignored if the station is not associated by then.
+ *
+ * @param reason Disconnect reason reported to the event handler
+ * @param delay_ms Simulated delay
+ */
+void mock_wifi_inject_disconnect(uint8_t reason, uint32_t delay_ms);
+
+/**
+ * @brief Get driver statistics
+ *
+ * @param stats Pointer to store statistics
+ */
+void mock_wifi_get_stats(mock_wifi_stats_t *stats);
+
+/**
+ * @brief Current simulated time
+ *
+ * @return uint32_t Milliseconds
+ */
+uint32_t mock_wifi_now_ms(void);
+
+/**
+ * @brief Let simulated time pass for the calling task
+ *
+ * @param ms Milliseconds
+ */
+void mock_wifi_run_for(uint32_t ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MOCK_WIFI_H
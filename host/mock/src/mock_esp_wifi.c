@@ -0,0 +1,870 @@
+#include "mock_wifi.h"
+#include "mock_sim.h"
+#include "esp_wifi.h"
+#include "esp_event.h"
+#include "esp_netif.h"
+#include "nvs.h"
+#include "lwip/ip_addr.h"
+#include "ping/ping_sock.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdio.h>
+#include <string.h>
+
+#define MAX_HANDLERS        8
+#define NVS_MAX_ENTRIES     16
+#define NVS_MAX_NAMESPACES  8
+#define NVS_MAX_BLOB        512
+
+esp_event_base_t const WIFI_EVENT = "WIFI_EVENT";
+esp_event_base_t const IP_EVENT = "IP_EVENT";
+
+struct esp_netif_obj {
+    int unused;
+};
+
+typedef struct {
+    esp_event_base_t base;
+    int32_t id;
+    esp_event_handler_t handler;
+    void *arg;
+} handler_entry_t;
+
+typedef struct {
+    char name[16];
+} nvs_namespace_t;
+
+typedef struct {
+    bool used;
+    uint32_t ns;
+    char key[16];
+    uint8_t data[NVS_MAX_BLOB];
+    size_t length;
+} nvs_entry_t;
+
+// Payload of the scheduled driver actions
+typedef struct {
+    uint32_t gen;
+    int ap;
+    uint8_t reason;
+    uint32_t dhcp_ms;
+} connect_action_t;
+
+// Driver state, guarded by the simulation lock
+static struct {
+    mock_wifi_timing_t timing;
+    mock_wifi_ap_t aps[MOCK_WIFI_MAX_APS];
+    bool ap_gone[MOCK_WIFI_MAX_APS];    // Removed, dropped at the next association change
+    int ap_count;
+    mock_wifi_attempt_t script[MOCK_WIFI_MAX_SCRIPT];
+    int script_head;
+    int script_count;
+    bool initialized;
+    bool started;
+    bool scanning;
+    wifi_scan_config_t scan_config;
+    uint8_t scan_ssid[33];
+    wifi_ap_record_t scan_records[MOCK_WIFI_MAX_APS];
+    uint16_t scan_count;
+    wifi_config_t config;
+    uint32_t gen;               // Bumped to drop pending actions of an abandoned attempt
+    int associated;             // AP index, -1 when not associated
+    bool has_ip;
+    bool dhcp_running;
+    esp_netif_ip_info_t static_ip;
+    esp_netif_ip_info_t ip;
+    mock_wifi_stats_t stats;
+    handler_entry_t handlers[MAX_HANDLERS];
+    int handler_count;
+    nvs_namespace_t namespaces[NVS_MAX_NAMESPACES];
+    int namespace_count;
+    nvs_entry_t nvs[NVS_MAX_ENTRIES];
+} drv = {
+    .timing = {
+        .start_ms = MOCK_WIFI_DEFAULT_START_MS,
+        .full_scan_ms = MOCK_WIFI_DEFAULT_FULL_SCAN_MS,
+        .fast_scan_ms = MOCK_WIFI_DEFAULT_FAST_SCAN_MS,
+        .attempt = { .assoc_ms = MOCK_WIFI_DEFAULT_ASSOC_MS, .dhcp_ms = MOCK_WIFI_DEFAULT_DHCP_MS }
+    },
+    .associated = -1,
+    .dhcp_running = true
+};
+
+static struct esp_netif_obj sta_netif;
+
+static uint32_t make_ip(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+{
+    // Network byte order in memory
+    return (uint32_t)a | ((uint32_t)b << 8) | ((uint32_t)c << 16) | ((uint32_t)d << 24);
+}
+
+// Forget removed APs once nothing refers to them; lock held
+static void drop_association(void)
+{
+    drv.associated = -1;
+    drv.stats.associated = false;
+    drv.has_ip = false;
+
+    int count = 0;
+    for (int i = 0; i < drv.ap_count; i++) {
+        if (!drv.ap_gone[i]) {
+            drv.aps[count] = drv.aps[i];
+            drv.ap_gone[count] = false;
+            count++;
+        }
+    }
+    drv.ap_count = count;
+}
+
+// Events: handlers run without the lock, like the default event loop task
+
+static void post_event(esp_event_base_t base, int32_t id, void *data)
+{
+    handler_entry_t handlers[MAX_HANDLERS];
+    int count = 0;
+
+    mock_sim_lock();
+    for (int i = 0; i < drv.handler_count; i++) {
+        const handler_entry_t *entry = &drv.handlers[i];
+        if (entry->base == base && (entry->id == ESP_EVENT_ANY_ID || entry->id == id)) {
+            handlers[count++] = *entry;
+        }
+    }
+    mock_sim_unlock();
+
+    for (int i = 0; i < count; i++) {
+        handlers[i].handler(handlers[i].arg, base, id, data);
+    }
+}
+
+esp_err_t esp_event_loop_create_default(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_event_handler_register(esp_event_base_t event_base, int32_t event_id,
+                                     esp_event_handler_t event_handler, void *event_handler_arg)
+{
+    mock_sim_lock();
+    esp_err_t ret = ESP_ERR_NO_MEM;
+    if (drv.handler_count < MAX_HANDLERS) {
+        drv.handlers[drv.handler_count++] = (handler_entry_t) {
+            .base = event_base, .id = event_id, .handler = event_handler, .arg = event_handler_arg
+        };
+        ret = ESP_OK;
+    }
+    mock_sim_unlock();
+    return ret;
+}
+
+esp_err_t esp_event_handler_unregister(esp_event_base_t event_base, int32_t event_id,
+                                       esp_event_handler_t event_handler)
+{
+    mock_sim_lock();
+    for (int i = 0; i < drv.handler_count; i++) {
+        handler_entry_t *entry = &drv.handlers[i];
+        if (entry->base == event_base && entry->id == event_id && entry->handler == event_handler) {
+            memmove(entry, entry + 1, (drv.handler_count - i - 1) * sizeof(handler_entry_t));
+            drv.handler_count--;
+            break;
+        }
+    }
+    mock_sim_unlock();
+    return ESP_OK;
+}
+
+// Driver actions
+
+static void post_disconnected(uint8_t reason)
+{
+    wifi_event_sta_disconnected_t event = { .reason = reason, .rssi = -127 };
+    memcpy(event.ssid, drv.config.sta.ssid, sizeof(event.ssid));
+    post_event(WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, &event);
+}
+
+static void sta_start_action(void *data)
+{
+    post_event(WIFI_EVENT, WIFI_EVENT_STA_START, NULL);
+}
+
+static void got_ip_action(void *data)
+{
+    const connect_action_t *action = data;
+
+    mock_sim_lock();
+    bool current = action->gen == drv.gen && drv.associated >= 0;
+    ip_event_got_ip_t event = { .esp_netif = &sta_netif };
+    if (current) {
+        drv.has_ip = true;
+        event.ip_info = drv.ip;
+    }
+    mock_sim_unlock();
+
+    if (current) {
+        post_event(IP_EVENT, IP_EVENT_STA_GOT_IP, &event);
+    }
+}
+
+static void connect_action(void *data)
+{
+    const connect_action_t *action = data;
+
+    mock_sim_lock();
+    if (action->gen != drv.gen) {
+        mock_sim_unlock();
+        return;
+    }
+
+    if (action->reason || drv.ap_gone[action->ap]) {
+        mock_sim_unlock();
+        post_disconnected(action->reason ? action->reason : WIFI_REASON_NO_AP_FOUND);
+        return;
+    }
+
+    drv.associated = action->ap;
+    drv.stats.associated = true;
+    wifi_event_sta_connected_t connected = { .channel = drv.aps[action->ap].channel };
+    memcpy(connected.bssid, drv.aps[action->ap].bssid, sizeof(connected.bssid));
+
+    bool static_ip = !drv.dhcp_running && drv.static_ip.ip.addr;
+    if (static_ip) {
+        drv.ip = drv.static_ip;
+        drv.stats.static_ip_connects++;
+    } else {
+        drv.ip.ip.addr = make_ip(192, 168, 4, 2);
+        drv.ip.gw.addr = make_ip(192, 168, 4, 1);
+        drv.ip.netmask.addr = make_ip(255, 255, 255, 0);
+        drv.stats.dhcp_requests++;
+    }
+    connect_action_t ip_action = *action;
+    mock_sim_unlock();
+
+    post_event(WIFI_EVENT, WIFI_EVENT_STA_CONNECTED, &connected);
+
+    if (static_ip) {
+        got_ip_action(&ip_action);
+    } else if (action->dhcp_ms != MOCK_WIFI_DHCP_STALL) {
+        mock_sim_lock();
+        mock_sim_schedule(action->dhcp_ms, got_ip_action, &ip_action, sizeof(ip_action));
+        mock_sim_unlock();
+    }
+}
+
+static void inject_disconnect_action(void *data)
+{
+    uint8_t reason = *(const uint8_t *)data;
+
+    mock_sim_lock();
+    bool associated = drv.associated >= 0;
+    if (associated) {
+        drv.gen++;
+        drop_association();
+    }
+    mock_sim_unlock();
+
+    if (associated) {
+        post_disconnected(reason);
+    }
+}
+
+static void disconnect_action(void *data)
+{
+    post_disconnected(*(const uint8_t *)data);
+}
+
+static bool ssid_matches(const mock_wifi_ap_t *ap, const uint8_t *ssid)
+{
+    return strncmp(ap->ssid, (const char *)ssid, 32) == 0;
+}
+
+static void scan_done_action(void *data)
+{
+    mock_sim_lock();
+    drv.scan_count = 0;
+    for (int i = 0; i < drv.ap_count; i++) {
+        const mock_wifi_ap_t *ap = &drv.aps[i];
+        if (drv.ap_gone[i] || (drv.scan_config.ssid && !ssid_matches(ap, drv.scan_ssid)) ||
+            (drv.scan_config.channel && drv.scan_config.channel != ap->channel)) {
+            continue;
+        }
+        wifi_ap_record_t *record = &drv.scan_records[drv.scan_count++];
+        memset(record, 0, sizeof(*record));
+        memcpy(record->bssid, ap->bssid, sizeof(record->bssid));
+        strncpy((char *)record->ssid, ap->ssid, sizeof(record->ssid) - 1);
+        record->primary = ap->channel;
+        record->rssi = ap->rssi;
+        record->authmode = WIFI_AUTH_WPA2_PSK;
+    }
+    drv.scanning = false;
+    wifi_event_sta_scan_done_t event = { .status = 0, .number = drv.scan_count };
+    mock_sim_unlock();
+
+    post_event(WIFI_EVENT, WIFI_EVENT_SCAN_DONE, &event);
+}
+
+// esp_wifi
+
+esp_err_t esp_wifi_init(const wifi_init_config_t *config)
+{
+    mock_sim_lock();
+    drv.initialized = true;
+    mock_sim_unlock();
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_deinit(void)
+{
+    mock_sim_lock();
+    drv.initialized = false;
+    mock_sim_unlock();
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_mode(wifi_mode_t mode)
+{
+    return drv.initialized ? ESP_OK : ESP_ERR_WIFI_NOT_INIT;
+}
+
+esp_err_t esp_wifi_start(void)
+{
+    mock_sim_lock();
+    esp_err_t ret = ESP_OK;
+    if (!drv.initialized) {
+        ret = ESP_ERR_WIFI_NOT_INIT;
+    } else if (!drv.started) {
+        drv.started = true;
+        mock_sim_schedule(drv.timing.start_ms, sta_start_action, NULL, 0);
+    }
+    mock_sim_unlock();
+    return ret;
+}
+
+esp_err_t esp_wifi_stop(void)
+{
+    mock_sim_lock();
+    drv.started = false;
+    drv.scanning = false;
+    drv.gen++;
+    drop_association();
+    mock_sim_unlock();
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_connect(void)
+{
+    mock_sim_lock();
+    if (!drv.started) {
+        mock_sim_unlock();
+        return ESP_ERR_WIFI_NOT_STARTED;
+    }
+
+    drv.gen++;
+    drop_association();
+    drv.stats.connect_calls++;
+
+    const wifi_sta_config_t *sta = &drv.config.sta;
+    int ap = -1;
+    uint32_t search_ms;
+    if (sta->bssid_set) {
+        search_ms = drv.timing.fast_scan_ms;
+        drv.stats.fast_scans++;
+        for (int i = 0; i < drv.ap_count; i++) {
+            const mock_wifi_ap_t *candidate = &drv.aps[i];
+            if (!drv.ap_gone[i] && memcmp(candidate->bssid, sta->bssid, sizeof(sta->bssid)) == 0 &&
+                (sta->channel == 0 || sta->channel == candidate->channel) &&
+                ssid_matches(candidate, sta->ssid)) {
+                ap = i;
+            }
+        }
+    } else {
+        search_ms = drv.timing.full_scan_ms;
+        drv.stats.full_scans++;
+        for (int i = 0; i < drv.ap_count; i++) {
+            if (!drv.ap_gone[i] && ssid_matches(&drv.aps[i], sta->ssid) &&
+                (ap < 0 || drv.aps[i].rssi > drv.aps[ap].rssi)) {
+                ap = i;
+            }
+        }
+    }
+
+    connect_action_t action = { .gen = drv.gen, .ap = ap };
+    if (ap < 0) {
+        action.reason = WIFI_REASON_NO_AP_FOUND;
+        mock_sim_schedule(search_ms, connect_action, &action, sizeof(action));
+    } else {
+        mock_wifi_attempt_t attempt = drv.timing.attempt;
+        if (drv.script_count > 0) {
+            attempt = drv.script[drv.script_head];
+            drv.script_head = (drv.script_head + 1) % MOCK_WIFI_MAX_SCRIPT;
+            drv.script_count--;
+        }
+        action.reason = attempt.fail_reason;
+        action.dhcp_ms = attempt.dhcp_ms;
+        mock_sim_schedule(search_ms + attempt.assoc_ms, connect_action, &action, sizeof(action));
+    }
+
+    mock_sim_unlock();
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_disconnect(void)
+{
+    mock_sim_lock();
+    if (!drv.started) {
+        mock_sim_unlock();
+        return ESP_ERR_WIFI_NOT_STARTED;
+    }
+
+    // Like the driver, report the disconnect even without an association
+    drv.gen++;
+    drop_association();
+    uint8_t reason = WIFI_REASON_ASSOC_LEAVE;
+    mock_sim_schedule(0, disconnect_action, &reason, sizeof(reason));
+    mock_sim_unlock();
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_config(wifi_interface_t interface, wifi_config_t *conf)
+{
+    if (interface != WIFI_IF_STA || !conf) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    mock_sim_lock();
+    drv.config = *conf;
+    mock_sim_unlock();
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_get_config(wifi_interface_t interface, wifi_config_t *conf)
+{
+    if (interface != WIFI_IF_STA || !conf) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    mock_sim_lock();
+    *conf = drv.config;
+    mock_sim_unlock();
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_sta_get_ap_info(wifi_ap_record_t *ap_info)
+{
+    mock_sim_lock();
+    esp_err_t ret = ESP_ERR_WIFI_CONN;
+    if (drv.associated >= 0) {
+        const mock_wifi_ap_t *ap = &drv.aps[drv.associated];
+        memset(ap_info, 0, sizeof(*ap_info));
+        memcpy(ap_info->bssid, ap->bssid, sizeof(ap_info->bssid));
+        strncpy((char *)ap_info->ssid, ap->ssid, sizeof(ap_info->ssid) - 1);
+        ap_info->primary = ap->channel;
+        ap_info->rssi = ap->rssi;
+        ap_info->authmode = WIFI_AUTH_WPA2_PSK;
+        ret = ESP_OK;
+    }
+    mock_sim_unlock();
+    return ret;
+}
+
+esp_err_t esp_wifi_scan_start(const wifi_scan_config_t *config, bool block)
+{
+    mock_sim_lock();
+    esp_err_t ret = ESP_OK;
+    if (!drv.started) {
+        ret = ESP_ERR_WIFI_NOT_STARTED;
+    } else if (drv.scanning || block) {
+        ret = ESP_ERR_WIFI_STATE;
+    } else {
+        drv.scanning = true;
+        drv.stats.scan_requests++;
+        memset(&drv.scan_config, 0, sizeof(drv.scan_config));
+        if (config) {
+            drv.scan_config = *config;
+        }
+        if (drv.scan_config.ssid) {
+            strncpy((char *)drv.scan_ssid, (const char *)drv.scan_config.ssid, sizeof(drv.scan_ssid) - 1);
+        }
+
+        // A single channel scan dwells once
+        uint32_t channels = drv.scan_config.channel ? 1 : MOCK_WIFI_SCAN_CHANNELS;
+        uint32_t duration_ms = drv.scan_config.scan_time.active.max ?
+                               drv.scan_config.scan_time.active.max * channels :
+                               drv.scan_config.channel ? drv.timing.fast_scan_ms : drv.timing.full_scan_ms;
+        mock_sim_schedule(duration_ms, scan_done_action, NULL, 0);
+    }
+    mock_sim_unlock();
+    return ret;
+}
+
+esp_err_t esp_wifi_scan_stop(void)
+{
+    mock_sim_lock();
+    drv.scanning = false;
+    mock_sim_unlock();
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_scan_get_ap_num(uint16_t *number)
+{
+    mock_sim_lock();
+    *number = drv.scan_count;
+    mock_sim_unlock();
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_scan_get_ap_records(uint16_t *number, wifi_ap_record_t *ap_records)
+{
+    mock_sim_lock();
+    uint16_t count = *number < drv.scan_count ? *number : drv.scan_count;
+    memcpy(ap_records, drv.scan_records, count * sizeof(wifi_ap_record_t));
+    *number = count;
+    // The driver releases its list once the records are read
+    drv.scan_count = 0;
+    mock_sim_unlock();
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_ps(wifi_ps_type_t type)
+{
+    drv.stats.ps = type;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_get_ps(wifi_ps_type_t *type)
+{
+    *type = drv.stats.ps;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_max_tx_power(int8_t power)
+{
+    drv.stats.tx_power = power;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_get_max_tx_power(int8_t *power)
+{
+    *power = drv.stats.tx_power ? drv.stats.tx_power : 80;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_bandwidth(wifi_interface_t interface, wifi_bandwidth_t bw)
+{
+    drv.stats.bandwidth = bw;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_get_bandwidth(wifi_interface_t interface, wifi_bandwidth_t *bw)
+{
+    *bw = drv.stats.bandwidth ? drv.stats.bandwidth : WIFI_BW_HT20;
+    return ESP_OK;
+}
+
+// esp_netif
+
+esp_err_t esp_netif_init(void)
+{
+    return ESP_OK;
+}
+
+esp_netif_t *esp_netif_create_default_wifi_sta(void)
+{
+    return &sta_netif;
+}
+
+esp_err_t esp_netif_get_ip_info(esp_netif_t *esp_netif, esp_netif_ip_info_t *ip_info)
+{
+    mock_sim_lock();
+    if (drv.has_ip) {
+        *ip_info = drv.ip;
+    } else {
+        memset(ip_info, 0, sizeof(*ip_info));
+    }
+    mock_sim_unlock();
+    return ESP_OK;
+}
+
+esp_err_t esp_netif_set_ip_info(esp_netif_t *esp_netif, const esp_netif_ip_info_t *ip_info)
+{
+    mock_sim_lock();
+    drv.static_ip = *ip_info;
+    mock_sim_unlock();
+    return ESP_OK;
+}
+
+esp_err_t esp_netif_dhcpc_start(esp_netif_t *esp_netif)
+{
+    mock_sim_lock();
+    drv.dhcp_running = true;
+    mock_sim_unlock();
+    return ESP_OK;
+}
+
+esp_err_t esp_netif_dhcpc_stop(esp_netif_t *esp_netif)
+{
+    mock_sim_lock();
+    drv.dhcp_running = false;
+    mock_sim_unlock();
+    return ESP_OK;
+}
+
+// NVS
+
+esp_err_t nvs_open(const char *name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle)
+{
+    mock_sim_lock();
+    int index = -1;
+    for (int i = 0; i < drv.namespace_count; i++) {
+        if (strcmp(drv.namespaces[i].name, name) == 0) {
+            index = i;
+        }
+    }
+
+    esp_err_t ret = ESP_OK;
+    if (index < 0 && open_mode == NVS_READONLY) {
+        ret = ESP_ERR_NVS_NOT_FOUND;
+    } else if (index < 0 && drv.namespace_count == NVS_MAX_NAMESPACES) {
+        ret = ESP_ERR_NO_MEM;
+    } else if (index < 0) {
+        index = drv.namespace_count++;
+        strncpy(drv.namespaces[index].name, name, sizeof(drv.namespaces[index].name) - 1);
+    }
+    if (ret == ESP_OK) {
+        *out_handle = index + 1;
+    }
+    mock_sim_unlock();
+    return ret;
+}
+
+void nvs_close(nvs_handle_t handle)
+{
+}
+
+static nvs_entry_t *nvs_find(nvs_handle_t handle, const char *key)
+{
+    for (int i = 0; i < NVS_MAX_ENTRIES; i++) {
+        nvs_entry_t *entry = &drv.nvs[i];
+        if (entry->used && entry->ns == handle && strcmp(entry->key, key) == 0) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length)
+{
+    mock_sim_lock();
+    esp_err_t ret = ESP_OK;
+    nvs_entry_t *entry = nvs_find(handle, key);
+    if (!entry) {
+        ret = ESP_ERR_NVS_NOT_FOUND;
+    } else if (!out_value) {
+        *length = entry->length;
+    } else if (*length < entry->length) {
+        ret = ESP_ERR_NVS_INVALID_LENGTH;
+    } else {
+        memcpy(out_value, entry->data, entry->length);
+        *length = entry->length;
+    }
+    mock_sim_unlock();
+    return ret;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length)
+{
+    if (length > NVS_MAX_BLOB) {
+        return ESP_ERR_NVS_INVALID_LENGTH;
+    }
+
+    mock_sim_lock();
+    nvs_entry_t *entry = nvs_find(handle, key);
+    for (int i = 0; !entry && i < NVS_MAX_ENTRIES; i++) {
+        if (!drv.nvs[i].used) {
+            entry = &drv.nvs[i];
+            entry->used = true;
+            entry->ns = handle;
+            strncpy(entry->key, key, sizeof(entry->key) - 1);
+        }
+    }
+    if (entry) {
+        memcpy(entry->data, value, length);
+        entry->length = length;
+        drv.stats.nvs_writes++;
+    }
+    mock_sim_unlock();
+    return entry ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key)
+{
+    mock_sim_lock();
+    nvs_entry_t *entry = nvs_find(handle, key);
+    if (entry) {
+        memset(entry, 0, sizeof(*entry));
+    }
+    mock_sim_unlock();
+    return entry ? ESP_OK : ESP_ERR_NVS_NOT_FOUND;
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle)
+{
+    return ESP_OK;
+}
+
+// esp_ping and lwIP: the host has no ICMP
+
+esp_err_t esp_ping_new_session(const esp_ping_config_t *config, const esp_ping_callbacks_t *cbs,
+                               esp_ping_handle_t *hdl_out)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t esp_ping_delete_session(esp_ping_handle_t hdl)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t esp_ping_start(esp_ping_handle_t hdl)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t esp_ping_stop(esp_ping_handle_t hdl)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t esp_ping_get_profile(esp_ping_handle_t hdl, esp_ping_profile_t profile, void *data, uint32_t size)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+int ipaddr_aton(const char *cp, ip_addr_t *addr)
+{
+    unsigned int a, b, c, d;
+    if (sscanf(cp, "%u.%u.%u.%u", &a, &b, &c, &d) != 4 || a > 255 || b > 255 || c > 255 || d > 255) {
+        return 0;
+    }
+    ip_addr_set_ip4_u32(addr, make_ip(a, b, c, d));
+    return 1;
+}
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    switch (code) {
+        case ESP_OK: return "ESP_OK";
+        case ESP_FAIL: return "ESP_FAIL";
+        case ESP_ERR_NO_MEM: return "ESP_ERR_NO_MEM";
+        case ESP_ERR_INVALID_ARG: return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_INVALID_SIZE: return "ESP_ERR_INVALID_SIZE";
+        case ESP_ERR_NOT_FOUND: return "ESP_ERR_NOT_FOUND";
+        case ESP_ERR_NOT_SUPPORTED: return "ESP_ERR_NOT_SUPPORTED";
+        case ESP_ERR_TIMEOUT: return "ESP_ERR_TIMEOUT";
+        case ESP_ERR_WIFI_NOT_INIT: return "ESP_ERR_WIFI_NOT_INIT";
+        case ESP_ERR_WIFI_NOT_STARTED: return "ESP_ERR_WIFI_NOT_STARTED";
+        case ESP_ERR_WIFI_STATE: return "ESP_ERR_WIFI_STATE";
+        case ESP_ERR_WIFI_CONN: return "ESP_ERR_WIFI_CONN";
+        case ESP_ERR_NVS_NOT_FOUND: return "ESP_ERR_NVS_NOT_FOUND";
+        case ESP_ERR_NVS_INVALID_LENGTH: return "ESP_ERR_NVS_INVALID_LENGTH";
+        default: return "UNKNOWN ERROR";
+    }
+}
+
+// Scripting
+
+void mock_wifi_reset(void)
+{
+    mock_sim_lock();
+    mock_sim_cancel_actions();
+    mock_wifi_timing_t timing = {
+        .start_ms = MOCK_WIFI_DEFAULT_START_MS,
+        .full_scan_ms = MOCK_WIFI_DEFAULT_FULL_SCAN_MS,
+        .fast_scan_ms = MOCK_WIFI_DEFAULT_FAST_SCAN_MS,
+        .attempt = { .assoc_ms = MOCK_WIFI_DEFAULT_ASSOC_MS, .dhcp_ms = MOCK_WIFI_DEFAULT_DHCP_MS }
+    };
+    uint32_t gen = drv.gen + 1;
+    memset(&drv, 0, sizeof(drv));
+    drv.timing = timing;
+    drv.gen = gen;
+    drv.associated = -1;
+    drv.dhcp_running = true;
+    mock_sim_unlock();
+}
+
+void mock_wifi_set_timing(const mock_wifi_timing_t *timing)
+{
+    mock_sim_lock();
+    drv.timing = *timing;
+    mock_sim_unlock();
+}
+
+void mock_wifi_get_timing(mock_wifi_timing_t *timing)
+{
+    mock_sim_lock();
+    *timing = drv.timing;
+    mock_sim_unlock();
+}
+
+void mock_wifi_add_ap(const mock_wifi_ap_t *ap)
+{
+    mock_sim_lock();
+    int index = -1;
+    for (int i = 0; i < drv.ap_count; i++) {
+        if (memcmp(drv.aps[i].bssid, ap->bssid, sizeof(ap->bssid)) == 0) {
+            index = i;
+        }
+    }
+    if (index < 0 && drv.ap_count < MOCK_WIFI_MAX_APS) {
+        index = drv.ap_count++;
+    }
+    if (index >= 0) {
+        drv.aps[index] = *ap;
+        drv.ap_gone[index] = false;
+    }
+    mock_sim_unlock();
+}
+
+void mock_wifi_remove_ap(const uint8_t *bssid)
+{
+    mock_sim_lock();
+    for (int i = 0; i < drv.ap_count; i++) {
+        if (memcmp(drv.aps[i].bssid, bssid, sizeof(drv.aps[i].bssid)) == 0) {
+            drv.ap_gone[i] = true;
+        }
+    }
+    mock_sim_unlock();
+}
+
+void mock_wifi_script_attempt(const mock_wifi_attempt_t *attempt)
+{
+    mock_sim_lock();
+    if (drv.script_count < MOCK_WIFI_MAX_SCRIPT) {
+        int tail = (drv.script_head + drv.script_count) % MOCK_WIFI_MAX_SCRIPT;
+        drv.script[tail] = *attempt;
+        drv.script_count++;
+    }
+    mock_sim_unlock();
+}
+
+void mock_wifi_inject_disconnect(uint8_t reason, uint32_t delay_ms)
+{
+    mock_sim_lock();
+    mock_sim_schedule(delay_ms, inject_disconnect_action, &reason, sizeof(reason));
+    mock_sim_unlock();
+}
+
+void mock_wifi_get_stats(mock_wifi_stats_t *stats)
+{
+    mock_sim_lock();
+    *stats = drv.stats;
+    mock_sim_unlock();
+}
+
+uint32_t mock_wifi_now_ms(void)
+{
+    return (uint32_t)mock_sim_now();
+}
+
+void mock_wifi_run_for(uint32_t ms)
+{
+    vTaskDelay(pdMS_TO_TICKS(ms));
+}
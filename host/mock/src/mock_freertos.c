@@ -0,0 +1,784 @@
+#include "mock_sim.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+#include "freertos/timers.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Simulation state, all guarded by sim_mutex
+typedef struct waiter {
+    struct mock_task *task;
+    mock_sim_ready_fn_t ready;
+    void *ctx;
+    uint64_t deadline;
+    bool woken;
+    struct waiter *next;
+} waiter_t;
+
+typedef struct action {
+    uint64_t due;
+    uint64_t order;
+    mock_sim_action_fn_t fn;
+    uint8_t data[MOCK_SIM_ACTION_DATA_SIZE];
+    struct action *next;
+} action_t;
+
+struct mock_timer {
+    const char *name;
+    TickType_t period;
+    bool auto_reload;
+    void *id;
+    TimerCallbackFunction_t callback;
+    bool active;
+    bool deleted;           // Never freed: a callback may still hold it
+    uint64_t expiry;
+    uint64_t order;
+    struct mock_timer *next;
+};
+
+struct mock_task {
+    char name[configMAX_TASK_NAME_LEN];
+    TaskFunction_t function;
+    void *arg;
+    UBaseType_t priority;
+    BaseType_t core;
+    uint32_t stack_size;
+    bool deleted;           // By another task, which joins the thread and frees it
+    pthread_t thread;
+};
+
+struct mock_queue {
+    uint8_t *storage;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t head;
+    UBaseType_t count;
+};
+
+struct mock_semaphore {
+    UBaseType_t count;
+    UBaseType_t max;
+};
+
+struct mock_event_group {
+    EventBits_t bits;
+};
+
+static pthread_mutex_t sim_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t sim_cond = PTHREAD_COND_INITIALIZER;
+static uint64_t sim_now = 0;
+static uint64_t sim_order = 0;
+static int runnable = 1;                // The main thread runs app_main()
+static waiter_t *waiters = NULL;
+static action_t *actions = NULL;
+static struct mock_timer *timers = NULL;
+
+static struct mock_task main_task = { .name = "main", .priority = 1 };
+static __thread struct mock_task *current_task = NULL;
+
+// Critical sections are one host lock, separate from the simulation lock
+static pthread_mutex_t critical_mutex;
+static pthread_once_t critical_once = PTHREAD_ONCE_INIT;
+
+static esp_log_level_t log_level = ESP_LOG_WARN;
+static bool log_level_read = false;
+
+void mock_sim_lock(void)
+{
+    pthread_mutex_lock(&sim_mutex);
+}
+
+void mock_sim_unlock(void)
+{
+    pthread_mutex_unlock(&sim_mutex);
+}
+
+uint64_t mock_sim_now(void)
+{
+    return __atomic_load_n(&sim_now, __ATOMIC_RELAXED);
+}
+
+static struct mock_task *self_task(void)
+{
+    return current_task ? current_task : &main_task;
+}
+
+// A deleted task ends here, with the lock held and no longer waiting
+static void reap(void)
+{
+    struct mock_task *self = self_task();
+    if (!self->deleted && self != &main_task) {
+        pthread_detach(self->thread);
+        free(self);
+    }
+    runnable--;
+    pthread_cond_broadcast(&sim_cond);
+    mock_sim_unlock();
+    pthread_exit(NULL);
+}
+
+void mock_sim_notify(void)
+{
+    bool woke = false;
+    for (waiter_t *w = waiters; w; w = w->next) {
+        if (!w->woken && (w->ready(w->ctx) || w->deadline <= sim_now)) {
+            // Counted as runnable now, so the clock cannot move before it runs
+            w->woken = true;
+            runnable++;
+            woke = true;
+        }
+    }
+    if (woke) {
+        pthread_cond_broadcast(&sim_cond);
+    }
+}
+
+void mock_sim_schedule(uint32_t delay_ms, mock_sim_action_fn_t fn, const void *data, size_t size)
+{
+    action_t *action = calloc(1, sizeof(action_t));
+    if (!action || size > sizeof(action->data)) {
+        fprintf(stderr, "mock: cannot schedule action\n");
+        abort();
+    }
+    action->due = sim_now + delay_ms;
+    action->order = ++sim_order;
+    action->fn = fn;
+    if (data) {
+        memcpy(action->data, data, size);
+    }
+
+    action_t **link = &actions;
+    while (*link && ((*link)->due < action->due ||
+                     ((*link)->due == action->due && (*link)->order < action->order))) {
+        link = &(*link)->next;
+    }
+    action->next = *link;
+    *link = action;
+}
+
+void mock_sim_cancel_actions(void)
+{
+    while (actions) {
+        action_t *next = actions->next;
+        free(actions);
+        actions = next;
+    }
+}
+
+static struct mock_timer *next_timer(void)
+{
+    struct mock_timer *best = NULL;
+    for (struct mock_timer *t = timers; t; t = t->next) {
+        if (t->active && (!best || t->expiry < best->expiry ||
+                          (t->expiry == best->expiry && t->order < best->order))) {
+            best = t;
+        }
+    }
+    return best;
+}
+
+// Called by the last task to block: move the clock and run one due item
+static void advance(void)
+{
+    uint64_t next = UINT64_MAX;
+    for (waiter_t *w = waiters; w; w = w->next) {
+        if (!w->woken && w->deadline < next) {
+            next = w->deadline;
+        }
+    }
+    struct mock_timer *timer = next_timer();
+    if (timer && timer->expiry < next) {
+        next = timer->expiry;
+    }
+    if (actions && actions->due < next) {
+        next = actions->due;
+    }
+
+    if (next == UINT64_MAX) {
+        fprintf(stderr, "mock: all tasks blocked forever at %llu ms\n", (unsigned long long)sim_now);
+        abort();
+    }
+    if (next > sim_now) {
+        __atomic_store_n(&sim_now, next, __ATOMIC_RELAXED);
+    }
+
+    // Timers and actions due now, earliest scheduled first
+    bool run_timer = timer && timer->expiry <= sim_now &&
+                     (!actions || actions->due > sim_now || timer->order < actions->order);
+    bool run_action = !run_timer && actions && actions->due <= sim_now;
+
+    if (run_timer) {
+        if (timer->auto_reload) {
+            timer->expiry = sim_now + timer->period;
+            timer->order = ++sim_order;
+        } else {
+            timer->active = false;
+        }
+        runnable++;
+        mock_sim_unlock();
+        timer->callback(timer);
+        mock_sim_lock();
+        runnable--;
+    } else if (run_action) {
+        action_t *action = actions;
+        actions = action->next;
+        runnable++;
+        mock_sim_unlock();
+        action->fn(action->data);
+        free(action);
+        mock_sim_lock();
+        runnable--;
+    }
+
+    mock_sim_notify();
+}
+
+bool mock_sim_wait(mock_sim_ready_fn_t ready, void *ctx, TickType_t ticks)
+{
+    uint64_t deadline = ticks == portMAX_DELAY ? UINT64_MAX : sim_now + ticks;
+    struct mock_task *self = self_task();
+
+    for (;;) {
+        if (self->deleted) {
+            reap();
+        }
+        if (ready && ready(ctx)) {
+            return true;
+        }
+        if (sim_now >= deadline) {
+            return false;
+        }
+
+        waiter_t waiter = { .task = self, .ready = ready, .ctx = ctx, .deadline = deadline };
+        waiter.next = waiters;
+        waiters = &waiter;
+        runnable--;
+
+        while (!waiter.woken) {
+            if (runnable == 0) {
+                advance();
+            } else {
+                pthread_cond_wait(&sim_cond, &sim_mutex);
+            }
+        }
+
+        waiter_t **link = &waiters;
+        while (*link != &waiter) {
+            link = &(*link)->next;
+        }
+        *link = waiter.next;
+    }
+}
+
+static bool never_ready(void *ctx)
+{
+    return false;
+}
+
+// Tasks
+
+static void *task_entry(void *arg)
+{
+    struct mock_task *task = arg;
+    current_task = task;
+
+    task->function(task->arg);
+
+    // Returning from a task function is an error in FreeRTOS; treat it as a delete
+    vTaskDelete(NULL);
+    return NULL;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char *name, uint32_t stack_size,
+                                   void *arg, UBaseType_t priority, TaskHandle_t *handle, BaseType_t core)
+{
+    struct mock_task *task = calloc(1, sizeof(struct mock_task));
+    if (!task) {
+        return pdFAIL;
+    }
+    strncpy(task->name, name, sizeof(task->name) - 1);
+    task->function = function;
+    task->arg = arg;
+    task->priority = priority;
+    task->stack_size = stack_size;
+    task->core = core == tskNO_AFFINITY ? 0 : core;
+
+    mock_sim_lock();
+    runnable++;
+    mock_sim_unlock();
+
+    if (pthread_create(&task->thread, NULL, task_entry, task) != 0) {
+        mock_sim_lock();
+        runnable--;
+        mock_sim_unlock();
+        free(task);
+        return pdFAIL;
+    }
+
+    if (handle) {
+        *handle = task;
+    }
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t function, const char *name, uint32_t stack_size,
+                       void *arg, UBaseType_t priority, TaskHandle_t *handle)
+{
+    return xTaskCreatePinnedToCore(function, name, stack_size, arg, priority, handle, tskNO_AFFINITY);
+}
+
+TaskHandle_t xTaskCreateStaticPinnedToCore(TaskFunction_t function, const char *name, uint32_t stack_size,
+                                           void *arg, UBaseType_t priority, StackType_t *stack,
+                                           StaticTask_t *tcb, BaseType_t core)
+{
+    if (!stack || !tcb) {
+        return NULL;
+    }
+    TaskHandle_t handle = NULL;
+    xTaskCreatePinnedToCore(function, name, stack_size, arg, priority, &handle, core);
+    return handle;
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    if (task && task != self_task()) {
+        // A blocked task is woken to exit, a running one exits when it next blocks.
+        // Joined, so what its thread held is released before this returns.
+        mock_sim_lock();
+        task->deleted = true;
+        for (waiter_t *w = waiters; w; w = w->next) {
+            if (w->task == task && !w->woken) {
+                w->woken = true;
+                runnable++;
+            }
+        }
+        pthread_cond_broadcast(&sim_cond);
+        mock_sim_unlock();
+        pthread_join(task->thread, NULL);
+        free(task);
+        return;
+    }
+
+    mock_sim_lock();
+    reap();
+}
+
+void vTaskSuspend(TaskHandle_t task)
+{
+    if (task && task != self_task()) {
+        ESP_LOGW("mock", "vTaskSuspend() of another task is not supported");
+        return;
+    }
+    mock_sim_lock();
+    mock_sim_wait(never_ready, NULL, portMAX_DELAY);
+    mock_sim_unlock();
+}
+
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task)
+{
+    return (task ? task : self_task())->priority;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task)
+{
+    return (task ? task : self_task())->stack_size;
+}
+
+BaseType_t xPortGetCoreID(void)
+{
+    return self_task()->core;
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    mock_sim_lock();
+    mock_sim_wait(never_ready, NULL, ticks);
+    mock_sim_unlock();
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)mock_sim_now();
+}
+
+int64_t esp_timer_get_time(void)
+{
+    return (int64_t)mock_sim_now() * 1000;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return self_task();
+}
+
+const char *pcTaskGetName(TaskHandle_t task)
+{
+    task = task ? task : xTaskGetCurrentTaskHandle();
+    return task->name;
+}
+
+UBaseType_t uxTaskGetNumberOfTasks(void)
+{
+    return 0;
+}
+
+UBaseType_t uxTaskGetSystemState(TaskStatus_t *status, UBaseType_t count, uint32_t *total_run_time)
+{
+    if (total_run_time) {
+        *total_run_time = 0;
+    }
+    return 0;
+}
+
+// Critical sections
+
+static void critical_init(void)
+{
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&critical_mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+void mock_enter_critical(portMUX_TYPE *mux)
+{
+    pthread_once(&critical_once, critical_init);
+    pthread_mutex_lock(&critical_mutex);
+}
+
+void mock_exit_critical(portMUX_TYPE *mux)
+{
+    pthread_mutex_unlock(&critical_mutex);
+}
+
+// Queues
+
+static bool queue_can_receive(void *ctx)
+{
+    return ((struct mock_queue *)ctx)->count > 0;
+}
+
+static bool queue_can_send(void *ctx)
+{
+    struct mock_queue *queue = ctx;
+    return queue->count < queue->length;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    struct mock_queue *queue = calloc(1, sizeof(struct mock_queue));
+    if (!queue) {
+        return NULL;
+    }
+    queue->storage = calloc(length, item_size ? item_size : 1);
+    if (!queue->storage) {
+        free(queue);
+        return NULL;
+    }
+    queue->length = length;
+    queue->item_size = item_size;
+    return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue)
+{
+    free(queue->storage);
+    free(queue);
+}
+
+static void queue_push(struct mock_queue *queue, const void *item)
+{
+    UBaseType_t tail = (queue->head + queue->count) % queue->length;
+    memcpy(queue->storage + tail * queue->item_size, item, queue->item_size);
+    queue->count++;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks)
+{
+    mock_sim_lock();
+    bool ready = mock_sim_wait(queue_can_send, queue, ticks);
+    if (ready) {
+        queue_push(queue, item);
+        mock_sim_notify();
+    }
+    mock_sim_unlock();
+    return ready ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t queue, const void *item)
+{
+    mock_sim_lock();
+    if (queue->count == queue->length) {
+        queue->head = (queue->head + 1) % queue->length;
+        queue->count--;
+    }
+    queue_push(queue, item);
+    mock_sim_notify();
+    mock_sim_unlock();
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks)
+{
+    mock_sim_lock();
+    bool ready = mock_sim_wait(queue_can_receive, queue, ticks);
+    if (ready) {
+        memcpy(item, queue->storage + queue->head * queue->item_size, queue->item_size);
+        queue->head = (queue->head + 1) % queue->length;
+        queue->count--;
+        mock_sim_notify();
+    }
+    mock_sim_unlock();
+    return ready ? pdTRUE : pdFALSE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+    mock_sim_lock();
+    UBaseType_t count = queue->count;
+    mock_sim_unlock();
+    return count;
+}
+
+// Semaphores
+
+static bool semaphore_available(void *ctx)
+{
+    return ((struct mock_semaphore *)ctx)->count > 0;
+}
+
+static SemaphoreHandle_t semaphore_create(UBaseType_t count)
+{
+    struct mock_semaphore *semaphore = calloc(1, sizeof(struct mock_semaphore));
+    if (semaphore) {
+        semaphore->count = count;
+        semaphore->max = 1;
+    }
+    return semaphore;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return semaphore_create(0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return semaphore_create(1);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore)
+{
+    free(semaphore);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks)
+{
+    mock_sim_lock();
+    bool ready = mock_sim_wait(semaphore_available, semaphore, ticks);
+    if (ready) {
+        semaphore->count--;
+    }
+    mock_sim_unlock();
+    return ready ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore)
+{
+    mock_sim_lock();
+    bool given = semaphore->count < semaphore->max;
+    if (given) {
+        semaphore->count++;
+        mock_sim_notify();
+    }
+    mock_sim_unlock();
+    return given ? pdTRUE : pdFALSE;
+}
+
+// Event groups
+
+typedef struct {
+    struct mock_event_group *group;
+    EventBits_t bits;
+    bool wait_for_all;
+} bits_wait_t;
+
+static bool bits_set(void *ctx)
+{
+    bits_wait_t *wait = ctx;
+    EventBits_t set = wait->group->bits & wait->bits;
+    return wait->wait_for_all ? set == wait->bits : set != 0;
+}
+
+EventGroupHandle_t xEventGroupCreate(void)
+{
+    return calloc(1, sizeof(struct mock_event_group));
+}
+
+void vEventGroupDelete(EventGroupHandle_t group)
+{
+    free(group);
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits)
+{
+    mock_sim_lock();
+    group->bits |= bits;
+    EventBits_t result = group->bits;
+    mock_sim_notify();
+    mock_sim_unlock();
+    return result;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits)
+{
+    mock_sim_lock();
+    EventBits_t previous = group->bits;
+    group->bits &= ~bits;
+    mock_sim_unlock();
+    return previous;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group)
+{
+    mock_sim_lock();
+    EventBits_t bits = group->bits;
+    mock_sim_unlock();
+    return bits;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits, BaseType_t clear_on_exit,
+                                BaseType_t wait_for_all, TickType_t ticks)
+{
+    bits_wait_t wait = { .group = group, .bits = bits, .wait_for_all = wait_for_all };
+
+    mock_sim_lock();
+    bool ready = mock_sim_wait(bits_set, &wait, ticks);
+    EventBits_t result = group->bits;
+    if (ready && clear_on_exit) {
+        group->bits &= ~bits;
+    }
+    mock_sim_unlock();
+    return result;
+}
+
+// Software timers
+
+TimerHandle_t xTimerCreate(const char *name, TickType_t period, UBaseType_t auto_reload,
+                           void *timer_id, TimerCallbackFunction_t callback)
+{
+    struct mock_timer *timer = calloc(1, sizeof(struct mock_timer));
+    if (!timer) {
+        return NULL;
+    }
+    timer->name = name;
+    timer->period = period;
+    timer->auto_reload = auto_reload;
+    timer->id = timer_id;
+    timer->callback = callback;
+
+    mock_sim_lock();
+    timer->next = timers;
+    timers = timer;
+    mock_sim_unlock();
+    return timer;
+}
+
+static void timer_arm(struct mock_timer *timer)
+{
+    timer->active = !timer->deleted;
+    timer->expiry = sim_now + timer->period;
+    timer->order = ++sim_order;
+}
+
+BaseType_t xTimerStart(TimerHandle_t timer, TickType_t ticks)
+{
+    mock_sim_lock();
+    timer_arm(timer);
+    mock_sim_unlock();
+    return pdPASS;
+}
+
+BaseType_t xTimerReset(TimerHandle_t timer, TickType_t ticks)
+{
+    return xTimerStart(timer, ticks);
+}
+
+BaseType_t xTimerStop(TimerHandle_t timer, TickType_t ticks)
+{
+    mock_sim_lock();
+    timer->active = false;
+    mock_sim_unlock();
+    return pdPASS;
+}
+
+BaseType_t xTimerChangePeriod(TimerHandle_t timer, TickType_t period, TickType_t ticks)
+{
+    mock_sim_lock();
+    timer->period = period;
+    timer_arm(timer);
+    mock_sim_unlock();
+    return pdPASS;
+}
+
+BaseType_t xTimerDelete(TimerHandle_t timer, TickType_t ticks)
+{
+    mock_sim_lock();
+    timer->active = false;
+    timer->deleted = true;
+    mock_sim_unlock();
+    return pdPASS;
+}
+
+BaseType_t xTimerIsTimerActive(TimerHandle_t timer)
+{
+    mock_sim_lock();
+    bool active = timer->active;
+    mock_sim_unlock();
+    return active ? pdTRUE : pdFALSE;
+}
+
+void *pvTimerGetTimerID(TimerHandle_t timer)
+{
+    return timer->id;
+}
+
+// Logging
+
+void esp_log_level_set(const char *tag, esp_log_level_t level)
+{
+    log_level = level;
+    log_level_read = true;
+}
+
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...)
+{
+    if (!log_level_read) {
+        // MOCK_LOG_LEVEL=0..5 matches esp_log_level_t, e.g. 3 for info
+        const char *env = getenv("MOCK_LOG_LEVEL");
+        if (env) {
+            log_level = (esp_log_level_t)atoi(env);
+        }
+        log_level_read = true;
+    }
+    if (level > log_level) {
+        return;
+    }
+
+    static const char letters[] = "NEWIDV";
+    char line[256];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    printf("%c (%llu) %s: %s\n", letters[level], (unsigned long long)mock_sim_now(), tag, line);
+}
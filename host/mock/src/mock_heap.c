@@ -0,0 +1,145 @@
+#include "esp_heap_caps.h"
+#include <errno.h>
+#include <malloc.h>
+#include <stdatomic.h>
+
+// Host stand-in for the heap_caps_get_info() figures: the glibc allocation
+// functions are replaced by counting wrappers around glibc's own. The counts
+// only change when the program allocates or frees, not when glibc moves
+// chunks between its per-thread caches, arenas and the system.
+
+#define MOCK_HEAP_SIZE  (256u * 1024 * 1024)
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void *__libc_memalign(size_t alignment, size_t size);
+extern void *__libc_valloc(size_t size);
+extern void *__libc_pvalloc(size_t size);
+extern void __libc_free(void *ptr);
+
+static atomic_size_t allocated_bytes;
+static atomic_size_t allocated_blocks;
+static atomic_size_t peak_bytes;
+
+static void *count_alloc(void *ptr)
+{
+    if (ptr) {
+        size_t size = malloc_usable_size(ptr);
+        size_t bytes = atomic_fetch_add(&allocated_bytes, size) + size;
+        atomic_fetch_add(&allocated_blocks, 1);
+        size_t peak = atomic_load(&peak_bytes);
+        while (bytes > peak && !atomic_compare_exchange_weak(&peak_bytes, &peak, bytes)) {
+        }
+    }
+    return ptr;
+}
+
+static void count_free(void *ptr)
+{
+    if (ptr) {
+        atomic_fetch_sub(&allocated_bytes, malloc_usable_size(ptr));
+        atomic_fetch_sub(&allocated_blocks, 1);
+    }
+}
+
+void *malloc(size_t size)
+{
+    return count_alloc(__libc_malloc(size));
+}
+
+void *calloc(size_t count, size_t size)
+{
+    return count_alloc(__libc_calloc(count, size));
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    if (!ptr) {
+        return malloc(size);
+    }
+    if (size == 0) {
+        free(ptr);
+        return NULL;
+    }
+    size_t old_size = malloc_usable_size(ptr);
+    void *moved = __libc_realloc(ptr, size);
+    if (moved) {
+        atomic_fetch_sub(&allocated_bytes, old_size);
+        atomic_fetch_sub(&allocated_blocks, 1);
+        count_alloc(moved);
+    }
+    return moved;
+}
+
+void *reallocarray(void *ptr, size_t count, size_t size)
+{
+    size_t bytes;
+    if (__builtin_mul_overflow(count, size, &bytes)) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    return realloc(ptr, bytes);
+}
+
+void *memalign(size_t alignment, size_t size)
+{
+    return count_alloc(__libc_memalign(alignment, size));
+}
+
+void *aligned_alloc(size_t alignment, size_t size)
+{
+    return memalign(alignment, size);
+}
+
+int posix_memalign(void **out, size_t alignment, size_t size)
+{
+    if (alignment % sizeof(void *) != 0 || (alignment & (alignment - 1)) != 0) {
+        return EINVAL;
+    }
+    void *ptr = memalign(alignment, size);
+    if (!ptr) {
+        return ENOMEM;
+    }
+    *out = ptr;
+    return 0;
+}
+
+void *valloc(size_t size)
+{
+    return count_alloc(__libc_valloc(size));
+}
+
+void *pvalloc(size_t size)
+{
+    return count_alloc(__libc_pvalloc(size));
+}
+
+void free(void *ptr)
+{
+    count_free(ptr);
+    __libc_free(ptr);
+}
+
+// One heap of MOCK_HEAP_SIZE bytes; the capabilities are ignored
+size_t heap_caps_get_total_size(uint32_t caps)
+{
+    (void)caps;
+    return MOCK_HEAP_SIZE;
+}
+
+void heap_caps_get_info(multi_heap_info_t *info, uint32_t caps)
+{
+    (void)caps;
+    size_t bytes = atomic_load(&allocated_bytes);
+    size_t free_bytes = bytes < MOCK_HEAP_SIZE ? MOCK_HEAP_SIZE - bytes : 0;
+    size_t peak = atomic_load(&peak_bytes);
+
+    *info = (multi_heap_info_t){
+        .total_free_bytes = free_bytes,
+        .total_allocated_bytes = bytes,
+        .largest_free_block = free_bytes,
+        .minimum_free_bytes = peak < MOCK_HEAP_SIZE ? MOCK_HEAP_SIZE - peak : 0,
+        .allocated_blocks = atomic_load(&allocated_blocks),
+    };
+}
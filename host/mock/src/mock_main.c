@@ -0,0 +1,10 @@
+#include "unity.h"
+
+void app_main(void);
+
+// Test runners keep the on-target app_main() entry point
+int main(void)
+{
+    app_main();
+    return Unity.TestFailures ? 1 : 0;
+}
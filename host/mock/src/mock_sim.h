@@ -0,0 +1,63 @@
+#ifndef MOCK_SIM_H
+#define MOCK_SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Simulated time core shared by the FreeRTOS and driver stand-ins.
+//
+// Every task is a host thread. Simulated time only moves when no task can
+// run: the last task to block advances the clock to the next timer,
+// scheduled action or wait deadline and runs it. Runs are therefore
+// reproducible, and timings measured with xTaskGetTickCount() depend only
+// on the script, not on the host.
+
+#define MOCK_SIM_ACTION_DATA_SIZE 96
+
+typedef bool (*mock_sim_ready_fn_t)(void *ctx);
+typedef void (*mock_sim_action_fn_t)(void *data);
+
+// All functions below except mock_sim_lock() expect the lock to be held
+void mock_sim_lock(void);
+void mock_sim_unlock(void);
+
+/**
+ * @brief Block the calling task until ready(ctx) holds or the ticks pass
+ *
+ * The lock is released while blocked. ready must not change state; the
+ * caller consumes whatever it waited for after a true return.
+ *
+ * @return true if ready, false on timeout
+ */
+bool mock_sim_wait(mock_sim_ready_fn_t ready, void *ctx, TickType_t ticks);
+
+/**
+ * @brief Re-check blocked tasks after a state change
+ */
+void mock_sim_notify(void);
+
+/**
+ * @brief Run fn(data) delay_ms from now, without the lock held
+ *
+ * Actions due at the same time run in the order they were scheduled.
+ */
+void mock_sim_schedule(uint32_t delay_ms, mock_sim_action_fn_t fn, const void *data, size_t size);
+
+/**
+ * @brief Drop all scheduled actions
+ */
+void mock_sim_cancel_actions(void);
+
+uint64_t mock_sim_now(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MOCK_SIM_H
@@ -0,0 +1,19 @@
+#include "task_topology.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// Placement has no meaning on the host: every component task is a plain thread
+
+esp_err_t task_topology_create_default(const task_topology_entry_t *defaults, TaskFunction_t function,
+                                       void *arg, TaskHandle_t *handle)
+{
+    if (!defaults || !function) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (xTaskCreatePinnedToCore(function, defaults->name, defaults->stack_size, arg,
+                                defaults->priority, handle, defaults->core) != pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,161 @@
+#include "test_manager.hpp"
+#include "test_filter.hpp"
+#include "test_reporter.hpp"
+
+// base_test.hpp has its own TEST_ASSERT macros for test steps; Unity's win here
+#undef TEST_ASSERT
+#undef TEST_ASSERT_NOT_NULL
+#undef TEST_ASSERT_EQUAL
+#include "unity.h"
+
+// Test selection by name pattern, tag expression and shard
+
+class TaggedTest : public BaseTest {
+public:
+    TaggedTest(const std::string& name, std::initializer_list<const char*> tags)
+        : BaseTest(name, "tagged")
+    {
+        for (const char* tag : tags) {
+            addTag(tag);
+        }
+    }
+
+    esp_err_t setup() override { return ESP_OK; }
+    esp_err_t execute() override { return ESP_OK; }
+    esp_err_t teardown() override { return ESP_OK; }
+};
+
+static std::vector<std::shared_ptr<BaseTest>> rack_tests()
+{
+    return {
+        std::make_shared<TaggedTest>("PSRAM", std::initializer_list<const char*>{"hardware:psram"}),
+        std::make_shared<TaggedTest>("BNO055", std::initializer_list<const char*>{"hardware:i2c", "slow"}),
+        std::make_shared<TaggedTest>("Kernels", std::initializer_list<const char*>{"bench"}),
+        std::make_shared<TaggedTest>("MemoryBench", std::initializer_list<const char*>{"bench", "hardware:psram"}),
+        std::make_shared<TaggedTest>("WiFi", std::initializer_list<const char*>{"hardware:wifi", "network", "slow"}),
+        std::make_shared<TaggedTest>("ROS2", std::initializer_list<const char*>{"network", "slow"}),
+    };
+}
+
+static std::string names(const std::vector<std::shared_ptr<BaseTest>>& tests)
+{
+    std::string text;
+    for (const auto& test : tests) {
+        text += (text.empty() ? "" : ",") + test->getName();
+    }
+    return text;
+}
+
+static std::string select(const char* spec)
+{
+    TestFilter filter;
+    if (filter.parse(spec) != ESP_OK) {
+        return "<invalid>";
+    }
+    return names(filter.select(rack_tests()));
+}
+
+extern "C" void setUp(void)
+{
+    TestReporter::setEnabled(false);
+}
+
+extern "C" void tearDown(void) {}
+
+void test_glob_match(void)
+{
+    TEST_ASSERT_TRUE(TestFilter::globMatch("*", ""));
+    TEST_ASSERT_TRUE(TestFilter::globMatch("bno*", "BNO055"));
+    TEST_ASSERT_TRUE(TestFilter::globMatch("*bench", "MemoryBench"));
+    TEST_ASSERT_TRUE(TestFilter::globMatch("r?s2", "ROS2"));
+    TEST_ASSERT_TRUE(TestFilter::globMatch("hardware:*", "hardware:i2c"));
+    TEST_ASSERT_TRUE(TestFilter::globMatch("[a-c]*", "BNO055"));
+    TEST_ASSERT_TRUE(TestFilter::globMatch("[!a-c]*", "PSRAM"));
+    TEST_ASSERT_TRUE(TestFilter::globMatch("a[", "a["));
+    TEST_ASSERT_FALSE(TestFilter::globMatch("bno", "BNO055"));
+    TEST_ASSERT_FALSE(TestFilter::globMatch("*x*", "BNO055"));
+    TEST_ASSERT_FALSE(TestFilter::globMatch("[!a-c]*", "BNO055"));
+}
+
+void test_name_patterns(void)
+{
+    TEST_ASSERT_EQUAL_STRING("PSRAM,BNO055,Kernels,MemoryBench,WiFi,ROS2", select("*").c_str());
+    TEST_ASSERT_EQUAL_STRING("PSRAM,BNO055,Kernels,MemoryBench,WiFi,ROS2", select("").c_str());
+    TEST_ASSERT_EQUAL_STRING("MemoryBench", select("bench").c_str());            // Substring
+    TEST_ASSERT_EQUAL_STRING("Kernels,MemoryBench", select("[km]*").c_str());    // Glob
+    TEST_ASSERT_EQUAL_STRING("PSRAM,ROS2", select("/^(psram|ros\\d)$/").c_str());
+
+    TestFilter filter;
+    TEST_ASSERT_EQUAL_INT(ESP_ERR_INVALID_ARG, filter.setNamePattern("/(unclosed/"));
+}
+
+void test_tag_expressions(void)
+{
+    TEST_ASSERT_EQUAL_STRING("Kernels,MemoryBench", select("tags=bench").c_str());
+    TEST_ASSERT_EQUAL_STRING("PSRAM,BNO055,MemoryBench,WiFi", select("tags=hardware:*").c_str());
+    TEST_ASSERT_EQUAL_STRING("PSRAM,MemoryBench", select("tags=hardware:* & !slow").c_str());
+    TEST_ASSERT_EQUAL_STRING("BNO055,Kernels,MemoryBench", select("tags=hardware:i2c | bench").c_str());
+    TEST_ASSERT_EQUAL_STRING("Kernels", select("tags=bench & !(hardware:psram | slow)").c_str());
+    TEST_ASSERT_EQUAL_STRING("WiFi", select("name=*i*;tags=network").c_str());
+
+    // Tags follow a test's configuration
+    TaggedTest ros2("ROS2", {"network", "hardware:i2c"});
+    TagExpression no_i2c;
+    TEST_ASSERT_EQUAL_INT(ESP_OK, no_i2c.parse("!hardware:i2c"));
+    TEST_ASSERT_FALSE(no_i2c.matches(ros2.getTags()));
+    ros2.removeTag("Hardware:I2C");
+    TEST_ASSERT_TRUE(no_i2c.matches(ros2.getTags()));
+    TEST_ASSERT_TRUE(ros2.hasTag("network"));
+
+    TagExpression expression;
+    TEST_ASSERT_EQUAL_INT(ESP_ERR_INVALID_ARG, expression.parse("bench &"));
+    TEST_ASSERT_EQUAL_INT(ESP_ERR_INVALID_ARG, expression.parse("(bench"));
+    TEST_ASSERT_EQUAL_INT(ESP_ERR_INVALID_ARG, expression.parse("bench slow"));
+}
+
+void test_shards_split_heavy_tests_evenly(void)
+{
+    // Heavy tests (slow, bench) in registration order: BNO055, Kernels, MemoryBench, WiFi, ROS2; then PSRAM
+    TEST_ASSERT_EQUAL_STRING("BNO055,MemoryBench,ROS2", select("shard=1/2").c_str());
+    TEST_ASSERT_EQUAL_STRING("PSRAM,Kernels,WiFi", select("shard=2/2").c_str());
+    TEST_ASSERT_EQUAL_STRING("BNO055,WiFi", select("shard=1/3").c_str());
+    TEST_ASSERT_EQUAL_STRING("Kernels,ROS2", select("shard=2/3").c_str());
+    TEST_ASSERT_EQUAL_STRING("PSRAM,MemoryBench", select("shard=3/3").c_str());
+    TEST_ASSERT_EQUAL_STRING("MemoryBench", select("tags=bench;shard=2/2").c_str());
+
+    TestFilter filter;
+    TEST_ASSERT_EQUAL_INT(ESP_ERR_INVALID_ARG, filter.parse("shard=3/2"));
+    TEST_ASSERT_EQUAL_INT(ESP_ERR_INVALID_ARG, filter.parse("shard=0/2"));
+    TEST_ASSERT_EQUAL_INT(ESP_ERR_INVALID_ARG, filter.parse("shard=2"));
+    TEST_ASSERT_EQUAL_INT(ESP_ERR_INVALID_ARG, filter.parse("color=red"));
+}
+
+void test_manager_runs_selection(void)
+{
+    TestManager manager;
+    for (auto& test : rack_tests()) {
+        manager.addTest(test);
+    }
+
+    TestFilter filter;
+    TEST_ASSERT_EQUAL_INT(ESP_OK, filter.parse("tags=network;shard=2/2"));
+    TEST_ASSERT_EQUAL_INT(1, manager.getTestNames(filter).size());
+    TEST_ASSERT_TRUE(manager.runSelected(filter));
+
+    TEST_ASSERT_EQUAL_INT((int)TestResult::PASSED, (int)manager.getTest("ROS2")->getStatus().result);
+    TEST_ASSERT_EQUAL_INT((int)TestResult::NOT_RUN, (int)manager.getTest("WiFi")->getStatus().result);
+    TEST_ASSERT_EQUAL_INT((int)TestResult::NOT_RUN, (int)manager.getTest("PSRAM")->getStatus().result);
+}
+
+extern "C" void app_main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_glob_match);
+    RUN_TEST(test_name_patterns);
+    RUN_TEST(test_tag_expressions);
+    RUN_TEST(test_shards_split_heavy_tests_evenly);
+    RUN_TEST(test_manager_runs_selection);
+
+    UNITY_END();
+}
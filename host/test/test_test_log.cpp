@@ -0,0 +1,147 @@
+#include "test_log.hpp"
+#include "test_reporter.hpp"
+#include <string.h>
+
+// base_test.hpp has its own TEST_ASSERT macros for test steps; Unity's win here
+#undef TEST_ASSERT
+#undef TEST_ASSERT_NOT_NULL
+#undef TEST_ASSERT_EQUAL
+#include "unity.h"
+
+// Deferred test logging: records hold raw arguments and are formatted on pop
+
+static const char* TAG = "test";
+
+extern "C" void setUp(void)
+{
+    TEST_ASSERT_EQUAL_INT(ESP_OK, TestLog::enableDeferred(4096));
+    TestLog::beginTimedSection();
+}
+
+extern "C" void tearDown(void)
+{
+    TestLog::Entry entry;
+    while (TestLog::pop(entry)) {
+    }
+    TestLog::endTimedSection();
+}
+
+void test_formats_raw_arguments_later(void)
+{
+    char step[16] = "encode";
+    TestLog::log(TAG, TestLog::Level::PASS, "Kernels", "%s took %lu ms, %.2f MB/s, %d%%, %zu, %04x, %-4s|",
+                 step, 42UL, 3.14159, -5, (size_t)7, 255u, "ab");
+    strcpy(step, "changed");
+
+    TestLog::Entry entry;
+    TEST_ASSERT_TRUE(TestLog::pop(entry));
+    TEST_ASSERT_EQUAL_INT((int)TestLog::Level::PASS, (int)entry.level);
+    TEST_ASSERT_EQUAL_STRING("test", entry.tag);
+    TEST_ASSERT_EQUAL_STRING("Kernels", entry.test_name);
+    TEST_ASSERT_EQUAL_STRING("encode took 42 ms, 3.14 MB/s, -5%, 7, 00ff, ab  |", entry.message);
+    TEST_ASSERT_FALSE(TestLog::pop(entry));
+}
+
+void test_unsupported_conversions_are_formatted_up_front(void)
+{
+    TestLog::log(TAG, TestLog::Level::INFO, "t", "[%*d]", 5, 42);
+
+    TestLog::Entry entry;
+    TEST_ASSERT_TRUE(TestLog::pop(entry));
+    TEST_ASSERT_EQUAL_STRING("[   42]", entry.message);
+}
+
+void test_raw_lines_keep_their_prefix(void)
+{
+    TestLog::writeRaw("@TR ", "{\"type\":\"run_start\"}");
+
+    TestLog::Entry entry;
+    TEST_ASSERT_TRUE(TestLog::pop(entry));
+    TEST_ASSERT_EQUAL_INT((int)TestLog::Level::RAW, (int)entry.level);
+    TEST_ASSERT_EQUAL_STRING("@TR {\"type\":\"run_start\"}", entry.message);
+}
+
+void test_reporter_records_are_packed_raw(void)
+{
+    TestReporter::step("Sen\"sor", "read", ESP_ERR_TIMEOUT, 5000, true);
+    BenchmarkResult result;
+    result.name = "encode";
+    result.repetitions = 10;
+    result.median_ns = 1100.0;
+    TestReporter::benchmark("Kernels", result);
+
+    TestLog::Entry entry;
+    TEST_ASSERT_TRUE(TestLog::pop(entry));
+    TEST_ASSERT_EQUAL_INT((int)TestLog::Level::RAW, (int)entry.level);
+    TEST_ASSERT_EQUAL_STRING("@TR {\"type\":\"step\",\"test\":\"Sen\\\"sor\",\"step\":\"read\",\"result\":\"TIMEOUT\","
+                             "\"error\":\"ESP_ERR_TIMEOUT\",\"error_code\":263,\"duration_ms\":5000}", entry.message);
+    TEST_ASSERT_TRUE(TestLog::pop(entry));
+    TEST_ASSERT_NOT_NULL(strstr(entry.message, "@TR {\"type\":\"benchmark\",\"test\":\"Kernels\",\"benchmark\":\"encode\","
+                                               "\"repetitions\":10,"));
+    TEST_ASSERT_NOT_NULL(strstr(entry.message, "\"median_ns\":1100.0,"));
+
+    char escaped[8];
+    TestReporter::escape("a\"bcdef", escaped, sizeof(escaped));
+    TEST_ASSERT_EQUAL_STRING("a\\\"bcde", escaped);
+}
+
+void test_records_wait_for_the_end_of_the_run(void)
+{
+    TestLog::log(TAG, TestLog::Level::INFO, "t", "held");
+    vTaskDelay(pdMS_TO_TICKS(50));      // The formatter task may run now, it must not drain
+
+    TestLog::Entry entry;
+    TEST_ASSERT_TRUE(TestLog::pop(entry));
+    TEST_ASSERT_EQUAL_STRING("held", entry.message);
+
+    TestLog::log(TAG, TestLog::Level::INFO, "t", "drained");
+    TestLog::endTimedSection();
+    vTaskDelay(pdMS_TO_TICKS(50));
+    TEST_ASSERT_FALSE(TestLog::pop(entry));
+    TestLog::beginTimedSection();
+}
+
+void test_full_ring_drops_and_wraps(void)
+{
+    uint32_t dropped = TestLog::getDroppedCount();
+    int logged = 0;
+    while (TestLog::getDroppedCount() == dropped) {
+        TestLog::log(TAG, TestLog::Level::INFO, "t", "record %d %s", logged, "padding padding padding");
+        logged++;
+    }
+    TEST_ASSERT_EQUAL_UINT32(dropped + 1, TestLog::getDroppedCount());
+
+    // Every kept record comes back in order, across the wrap
+    TestLog::Entry entry;
+    char expected[64];
+    for (int i = 0; i < logged - 1; i++) {
+        TEST_ASSERT_TRUE(TestLog::pop(entry));
+        snprintf(expected, sizeof(expected), "record %d padding padding padding", i);
+        TEST_ASSERT_EQUAL_STRING(expected, entry.message);
+
+        // Refill so the writer wraps around the end of the ring
+        if (i < 8) {
+            TestLog::log(TAG, TestLog::Level::INFO, "t", "record %d %s", logged - 1 + i, "padding padding padding");
+        }
+    }
+    for (int i = 0; i < 8; i++) {
+        TEST_ASSERT_TRUE(TestLog::pop(entry));
+        snprintf(expected, sizeof(expected), "record %d padding padding padding", logged - 1 + i);
+        TEST_ASSERT_EQUAL_STRING(expected, entry.message);
+    }
+    TEST_ASSERT_FALSE(TestLog::pop(entry));
+}
+
+extern "C" void app_main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_formats_raw_arguments_later);
+    RUN_TEST(test_unsupported_conversions_are_formatted_up_front);
+    RUN_TEST(test_raw_lines_keep_their_prefix);
+    RUN_TEST(test_reporter_records_are_packed_raw);
+    RUN_TEST(test_records_wait_for_the_end_of_the_run);
+    RUN_TEST(test_full_ring_drops_and_wraps);
+
+    UNITY_END();
+}
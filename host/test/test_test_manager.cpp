@@ -0,0 +1,510 @@
+#include "test_manager.hpp"
+#include "benchmark_test.hpp"
+#include "test_reporter.hpp"
+#include <stdlib.h>
+#include <string.h>
+
+// base_test.hpp has its own TEST_ASSERT macros for test steps; Unity's win here
+#undef TEST_ASSERT
+#undef TEST_ASSERT_NOT_NULL
+#undef TEST_ASSERT_EQUAL
+#include "unity.h"
+
+// TestManager, BaseTest and DeadlineTask on simulated time: a step that
+// blocks for N ms takes exactly N ms unless a deadline ends it first
+
+// One step that blocks for step_ms and returns step_result; a cooperative
+// step polls shouldAbort() every 10 ms instead of blocking through
+class ScriptedTest : public BaseTest {
+public:
+    ScriptedTest(const std::string& name, uint32_t resources, uint32_t step_ms,
+                 esp_err_t step_result = ESP_OK, uint32_t step_timeout_ms = 5000)
+        : BaseTest(name, "scripted"), step_ms_(step_ms), step_result_(step_result),
+          step_timeout_ms_(step_timeout_ms)
+    {
+        setResources(resources);
+    }
+
+    esp_err_t setup() override
+    {
+        addStep("block", [this]() {
+            if (!cooperative) {
+                vTaskDelay(pdMS_TO_TICKS(step_ms_));
+                return step_result_;
+            }
+            for (uint32_t waited = 0; waited < step_ms_; waited += 10) {
+                if (shouldAbort()) {
+                    return ESP_ERR_TIMEOUT;
+                }
+                vTaskDelay(pdMS_TO_TICKS(10));
+            }
+            return step_result_;
+        }, step_timeout_ms_, true, [this]() { cleanups++; });
+        return ESP_OK;
+    }
+
+    esp_err_t execute() override { return runSteps(); }
+
+    esp_err_t teardown() override
+    {
+        teardowns++;
+        return ESP_OK;
+    }
+
+    bool cooperative = false;
+    int cleanups = 0;
+    int teardowns = 0;
+
+private:
+    uint32_t step_ms_;
+    esp_err_t step_result_;
+    uint32_t step_timeout_ms_;
+};
+
+// Keeps leak_bytes allocated past teardown
+class LeakyTest : public ScriptedTest {
+public:
+    LeakyTest(const std::string& name, size_t leak_bytes)
+        : ScriptedTest(name, TEST_RESOURCE_NONE, 10), leak_bytes_(leak_bytes) {}
+
+    esp_err_t setup() override
+    {
+        leaked_ = malloc(leak_bytes_);
+        memset(leaked_, 0x5a, leak_bytes_);
+        return ScriptedTest::setup();
+    }
+
+    void release() { free(leaked_); }
+
+private:
+    size_t leak_bytes_;
+    void* leaked_ = nullptr;
+};
+
+// Slower by slowdown_ms every run, and keeps leak_bytes per run until released
+class DegradingTest : public BaseTest {
+public:
+    DegradingTest(const std::string& name, uint32_t step_ms, uint32_t slowdown_ms, size_t leak_bytes)
+        : BaseTest(name, "degrading"), step_ms_(step_ms), slowdown_ms_(slowdown_ms), leak_bytes_(leak_bytes)
+    {
+        leaked_.reserve(1024);
+    }
+
+    esp_err_t setup() override
+    {
+        addStep("block", [this]() {
+            vTaskDelay(pdMS_TO_TICKS(step_ms_ + slowdown_ms_ * runs_++));
+            if (leak_bytes_ > 0 && leaked_.size() < leaked_.capacity()) {
+                leaked_.push_back(malloc(leak_bytes_));
+                memset(leaked_.back(), 0x5a, leak_bytes_);
+            }
+            return ESP_OK;
+        });
+        return ESP_OK;
+    }
+
+    esp_err_t execute() override { return runSteps(); }
+    esp_err_t teardown() override { return ESP_OK; }
+
+    void release()
+    {
+        for (void* block : leaked_) {
+            free(block);
+        }
+        leaked_.clear();
+    }
+
+private:
+    uint32_t step_ms_;
+    uint32_t slowdown_ms_;
+    size_t leak_bytes_;
+    uint32_t runs_ = 0;
+    std::vector<void*> leaked_;
+};
+
+// Ten 10 ms operations per run, recorded as 1000..10000 us latencies
+class LatencyTest : public BaseTest {
+public:
+    explicit LatencyTest(const std::string& name) : BaseTest(name, "latency") {}
+
+    esp_err_t setup() override
+    {
+        addStep("loop", [this]() {
+            for (uint32_t i = 1; i <= 10; i++) {
+                vTaskDelay(pdMS_TO_TICKS(10));
+                recordLatency(i * 1000);
+            }
+            return ESP_OK;
+        });
+        return ESP_OK;
+    }
+
+    esp_err_t execute() override { return runSteps(); }
+    esp_err_t teardown() override { return ESP_OK; }
+};
+
+// Installs a driver in setup like i2c_driver_install, which refuses a port
+// that is still installed, and uninstalls it in teardown when releases is set
+class DriverTest : public BaseTest {
+public:
+    DriverTest(const std::string& name, bool releases) : BaseTest(name, "driver"), releases_(releases) {}
+
+    esp_err_t setup() override
+    {
+        if (installed) {
+            return ESP_ERR_INVALID_STATE;
+        }
+        installed = true;
+        addStep("use", []() {
+            vTaskDelay(pdMS_TO_TICKS(100));
+            return ESP_OK;
+        });
+        return ESP_OK;
+    }
+
+    esp_err_t execute() override { return runSteps(); }
+
+    esp_err_t teardown() override
+    {
+        if (releases_) {
+            installed = false;
+        }
+        return ESP_OK;
+    }
+
+    bool installed = false;
+
+private:
+    bool releases_;
+};
+
+static bool has_trend(const std::vector<SoakTrend>& trends, SoakTrend::Kind kind, const std::string& test)
+{
+    for (const auto& trend : trends) {
+        if (trend.kind == kind && trend.test == test) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static std::shared_ptr<ScriptedTest> add_test(TestManager& manager, const std::string& name, uint32_t resources,
+                                              uint32_t step_ms, esp_err_t step_result = ESP_OK,
+                                              uint32_t step_timeout_ms = 5000)
+{
+    auto test = std::make_shared<ScriptedTest>(name, resources, step_ms, step_result, step_timeout_ms);
+    manager.addTest(std::shared_ptr<BaseTest>(test));
+    return test;
+}
+
+extern "C" void setUp(void)
+{
+    TestReporter::setEnabled(false);
+}
+
+extern "C" void tearDown(void) {}
+
+void test_sequential_run_counts_results(void)
+{
+    TestManager manager;
+    add_test(manager, "pass", TEST_RESOURCE_NONE, 100);
+    add_test(manager, "fail", TEST_RESOURCE_NONE, 200, ESP_FAIL);
+
+    TEST_ASSERT_FALSE(manager.runAllTests());
+
+    TestManager::TestStatistics stats = manager.getStatistics();
+    TEST_ASSERT_EQUAL_UINT32(2, stats.total_tests);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.passed_tests);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.failed_tests);
+    TEST_ASSERT_UINT32_WITHIN(5, 300, stats.elapsed_ms);
+    TEST_ASSERT_EQUAL_INT((int)TestResult::FAILED, (int)manager.getOverallResult());
+}
+
+void test_step_deadline_times_out_test(void)
+{
+    TestManager manager;
+    auto test = add_test(manager, "hang", TEST_RESOURCE_NONE, 10000, ESP_OK, 100);
+
+    TEST_ASSERT_FALSE(manager.runAllTests());
+
+    const TestStatus& status = test->getStatus();
+    TEST_ASSERT_EQUAL_INT((int)TestResult::TIMEOUT, (int)status.result);
+    TEST_ASSERT_EQUAL_UINT32(ESP_ERR_TIMEOUT, status.error_code);
+    TEST_ASSERT_TRUE(strstr(status.message.c_str(), "Step 'block' timed out") != nullptr);
+    TEST_ASSERT_UINT32_WITHIN(5, 100 + BaseTest::ABORT_GRACE_MS, status.duration_ms);   // Deleted after the grace period
+    TEST_ASSERT_EQUAL_INT(1, test->cleanups);
+    TEST_ASSERT_EQUAL_INT(1, test->teardowns);
+}
+
+void test_step_deadline_stops_cooperative_step(void)
+{
+    TestManager manager;
+    auto test = add_test(manager, "poll", TEST_RESOURCE_NONE, 10000, ESP_OK, 100);
+    test->cooperative = true;
+
+    TEST_ASSERT_FALSE(manager.runAllTests());
+
+    const TestStatus& status = test->getStatus();
+    TEST_ASSERT_EQUAL_INT((int)TestResult::TIMEOUT, (int)status.result);
+    TEST_ASSERT_TRUE(strstr(status.message.c_str(), "Step 'block' timed out") != nullptr);
+    TEST_ASSERT_UINT32_WITHIN(15, 110, status.duration_ms);
+    TEST_ASSERT_EQUAL_INT(0, test->cleanups);       // Returned by itself
+    TEST_ASSERT_EQUAL_INT(1, test->teardowns);
+}
+
+void test_test_deadline_aborts_run(void)
+{
+    TestManager manager;
+    manager.setTestTimeout(500);
+    auto test = add_test(manager, "slow", TEST_RESOURCE_NONE, 10000, ESP_OK, 20000);
+
+    TEST_ASSERT_FALSE(manager.runAllTests());
+
+    const TestStatus& status = test->getStatus();
+    TEST_ASSERT_EQUAL_INT((int)TestResult::TIMEOUT, (int)status.result);
+    TEST_ASSERT_TRUE(strstr(status.message.c_str(), "Test timed out") != nullptr);
+    TEST_ASSERT_EQUAL_INT(1, test->teardowns);      // onAbort()
+    TEST_ASSERT_UINT32_WITHIN(5, 500 + BaseTest::ABORT_GRACE_MS, manager.getStatistics().elapsed_ms);
+    TEST_ASSERT_FALSE(test->getHeapUsage(HeapRegion::INTERNAL).present);
+}
+
+void test_test_deadline_stops_cooperative_run(void)
+{
+    TestManager manager;
+    manager.setTestTimeout(500);
+    auto test = add_test(manager, "poll", TEST_RESOURCE_NONE, 10000, ESP_OK, 20000);
+    test->cooperative = true;
+
+    TEST_ASSERT_FALSE(manager.runAllTests());
+
+    const TestStatus& status = test->getStatus();
+    TEST_ASSERT_EQUAL_INT((int)TestResult::TIMEOUT, (int)status.result);
+    TEST_ASSERT_TRUE(strstr(status.message.c_str(), "Test timed out") != nullptr);
+    TEST_ASSERT_EQUAL_INT(1, test->teardowns);      // Its own teardown, not onAbort()
+    TEST_ASSERT_EQUAL_INT(0, test->cleanups);
+    TEST_ASSERT_UINT32_WITHIN(15, 510, manager.getStatistics().elapsed_ms);
+    TEST_ASSERT_TRUE(test->getHeapUsage(HeapRegion::INTERNAL).present);
+}
+
+void test_parallel_runs_disjoint_resources_together(void)
+{
+    TestManager manager;
+    manager.setParallelExecution(true);
+    add_test(manager, "i2c", TEST_RESOURCE_I2C0, 1000);
+    add_test(manager, "wifi", TEST_RESOURCE_WIFI, 1000);
+    add_test(manager, "free", TEST_RESOURCE_NONE, 1000);
+
+    TEST_ASSERT_TRUE(manager.runAllTests());
+
+    TestManager::TestStatistics stats = manager.getStatistics();
+    TEST_ASSERT_EQUAL_UINT32(3, stats.passed_tests);
+    TEST_ASSERT_UINT32_WITHIN(10, 1000, stats.elapsed_ms);
+    TEST_ASSERT_UINT32_WITHIN(10, 3000, stats.total_duration_ms);
+}
+
+void test_parallel_serializes_shared_resources(void)
+{
+    TestManager manager;
+    manager.setParallelExecution(true);
+    add_test(manager, "imu", TEST_RESOURCE_I2C0, 1000);
+    add_test(manager, "imu_again", TEST_RESOURCE_I2C0, 1000);
+    add_test(manager, "alone", TEST_RESOURCE_EXCLUSIVE, 500);
+
+    TEST_ASSERT_TRUE(manager.runAllTests());
+    TEST_ASSERT_UINT32_WITHIN(10, 2500, manager.getStatistics().elapsed_ms);
+}
+
+void test_heap_leak_over_limit_fails_test(void)
+{
+    TestManager manager;
+    auto leaky = std::make_shared<LeakyTest>("leaky", 64 * 1024);
+    leaky->setHeapLeakLimit(16 * 1024);
+    manager.addTest(std::shared_ptr<BaseTest>(leaky));
+    auto clean = add_test(manager, "clean", TEST_RESOURCE_NONE, 10);
+    clean->setHeapLeakLimit(4096);
+
+    TEST_ASSERT_FALSE(manager.runAllTests());
+
+    TEST_ASSERT_EQUAL_INT((int)TestResult::FAILED, (int)leaky->getStatus().result);
+    TEST_ASSERT_TRUE(strstr(leaky->getStatus().message.c_str(), "of internal heap") != nullptr);
+    TEST_ASSERT_GREATER_OR_EQUAL(64 * 1024, leaky->getHeapUsage(HeapRegion::INTERNAL).leaked_bytes);
+    TEST_ASSERT_FALSE(leaky->isHeapUsageShared());
+    TEST_ASSERT_EQUAL_INT((int)TestResult::PASSED, (int)clean->getStatus().result);
+    leaky->release();
+}
+
+void test_heap_leak_limit_not_enforced_when_shared(void)
+{
+    TestManager manager;
+    manager.setParallelExecution(true);
+    auto leaky = std::make_shared<LeakyTest>("leaky", 64 * 1024);
+    leaky->setHeapLeakLimit(16 * 1024);
+    manager.addTest(std::shared_ptr<BaseTest>(leaky));
+    add_test(manager, "neighbour", TEST_RESOURCE_NONE, 1000);
+
+    TEST_ASSERT_TRUE(manager.runAllTests());
+    TEST_ASSERT_TRUE(leaky->isHeapUsageShared());
+    leaky->release();
+}
+
+void test_benchmark_statistics(void)
+{
+    std::vector<double> samples;
+    for (int i = 100; i >= 1; i--) {
+        samples.push_back(i);
+    }
+    BenchmarkResult result;
+    result.bytes_per_call = 1000;
+    BenchmarkTest::computeStatistics(samples, result);
+
+    TEST_ASSERT_EQUAL_UINT32(100, result.repetitions);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6, 1.0, result.min_ns);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6, 100.0, result.max_ns);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6, 50.5, result.median_ns);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6, 99.0, result.p99_ns);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6, 50.5, result.mean_ns);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 19801.98, result.throughput_mbps);
+}
+
+void test_soak_steady_tests_pass(void)
+{
+    TestManager manager;
+    add_test(manager, "steady", TEST_RESOURCE_NONE, 100);
+    add_test(manager, "other", TEST_RESOURCE_NONE, 400);
+
+    SoakConfig config;
+    config.duration_ms = 30000;
+    config.window_ms = 5000;
+    TEST_ASSERT_TRUE(manager.runSoak("*", config));
+
+    const SoakRecorder& soak = manager.getSoakRecorder();
+    TEST_ASSERT_EQUAL_UINT32(2, soak.getTestCount());
+    TEST_ASSERT_EQUAL_UINT32(6, soak.getWindowCount());
+    uint32_t runs = 0;
+    for (size_t row = 0; row < soak.getWindowCount(); row++) {
+        const SoakWindow& window = soak.getWindow(row, 0);
+        TEST_ASSERT_EQUAL_UINT32(row * 5000, window.start_ms);
+        TEST_ASSERT_EQUAL_UINT32(0, window.failures);
+        TEST_ASSERT_UINT32_WITHIN(1000, 100000, window.p95_us);
+        TEST_ASSERT_TRUE(window.stack_free_min != UINT32_MAX);
+        runs += window.runs;
+    }
+    TEST_ASSERT_EQUAL_UINT32(60, runs);     // One 500 ms round per run of "steady"
+    TEST_ASSERT_EQUAL_UINT32(0, soak.analyze().size());
+}
+
+void test_soak_flags_leak_and_latency_growth(void)
+{
+    TestManager manager;
+    add_test(manager, "steady", TEST_RESOURCE_NONE, 100);
+    auto degrading = std::make_shared<DegradingTest>("degrading", 100, 5, 16 * 1024);
+    manager.addTest(std::shared_ptr<BaseTest>(degrading));
+
+    SoakConfig config;
+    config.duration_ms = 60000;
+    config.window_ms = 5000;
+    config.max_windows = 8;                     // 12 windows do not fit: merged once
+    TEST_ASSERT_FALSE(manager.runSoak("*", config));
+
+    const SoakRecorder& soak = manager.getSoakRecorder();
+    TEST_ASSERT_EQUAL_UINT32(10000, soak.getWindowMs());
+    TEST_ASSERT_LESS_OR_EQUAL(8, soak.getWindowCount());
+    TEST_ASSERT_EQUAL_UINT32(0, soak.getWindow(0, 0).start_ms);
+    TEST_ASSERT_UINT32_WITHIN(1000, 10000, soak.getWindow(1, 0).start_ms);  // Windows close after a run
+
+    std::vector<SoakTrend> trends = soak.analyze();
+    TEST_ASSERT_TRUE(has_trend(trends, SoakTrend::Kind::LEAK, "degrading"));
+    TEST_ASSERT_TRUE(has_trend(trends, SoakTrend::Kind::LATENCY_GROWTH, "degrading"));
+    TEST_ASSERT_FALSE(has_trend(trends, SoakTrend::Kind::LATENCY_GROWTH, "steady"));
+    TEST_ASSERT_FALSE(has_trend(trends, SoakTrend::Kind::LEAK, "steady"));
+    degrading->release();
+}
+
+void test_soak_percentiles_use_recorded_latency(void)
+{
+    TestManager manager;
+    auto latency = std::make_shared<LatencyTest>("latency");
+    manager.addTest(std::shared_ptr<BaseTest>(latency));
+    add_test(manager, "steady", TEST_RESOURCE_NONE, 100);
+
+    SoakConfig config;
+    config.duration_ms = 2000;
+    config.window_ms = 5000;
+    TEST_ASSERT_TRUE(manager.runSoak("*", config));
+
+    // The 100 operations of the window, not the 100 ms runs
+    const SoakWindow& window = manager.getSoakRecorder().getWindow(0, 0);
+    TEST_ASSERT_EQUAL_UINT32(10, window.runs);
+    TEST_ASSERT_EQUAL_UINT32(5000, window.p50_us);
+    TEST_ASSERT_EQUAL_UINT32(10000, window.p95_us);
+    TEST_ASSERT_EQUAL_UINT32(10000, window.max_us);
+
+    // A test recording none still has its run time
+    TEST_ASSERT_UINT32_WITHIN(1000, 100000, manager.getSoakRecorder().getWindow(0, 1).p50_us);
+
+    // Outside a soak, recorded latencies go nowhere
+    TEST_ASSERT_EQUAL_INT((int)TestResult::PASSED, (int)latency->run());
+}
+
+void test_soak_reruns_test_that_releases_in_teardown(void)
+{
+    TestManager manager;
+    auto releasing = std::make_shared<DriverTest>("releasing", true);
+    manager.addTest(std::shared_ptr<BaseTest>(releasing));
+
+    SoakConfig config;
+    config.duration_ms = 2000;
+    TEST_ASSERT_TRUE(manager.runSoak("*", config));
+    TEST_ASSERT_EQUAL_UINT32(20, manager.getSoakRecorder().getWindow(0, 0).runs);
+    TEST_ASSERT_EQUAL_UINT32(0, manager.getSoakRecorder().getWindow(0, 0).failures);
+    TEST_ASSERT_FALSE(releasing->installed);
+
+    // Keeping the driver past teardown fails the second run
+    TestManager holding_manager;
+    auto holding = std::make_shared<DriverTest>("holding", false);
+    holding_manager.addTest(std::shared_ptr<BaseTest>(holding));
+    config.stop_on_failure = true;
+    TEST_ASSERT_FALSE(holding_manager.runSoak("*", config));
+    TEST_ASSERT_EQUAL_UINT32(2, holding_manager.getSoakRecorder().getWindow(0, 0).runs);
+    TEST_ASSERT_EQUAL_UINT32(1, holding_manager.getSoakRecorder().getWindow(0, 0).failures);
+}
+
+void test_soak_stops_on_failure(void)
+{
+    TestManager manager;
+    add_test(manager, "flaky", TEST_RESOURCE_NONE, 100, ESP_FAIL);
+
+    SoakConfig config;
+    config.duration_ms = 60000;
+    config.stop_on_failure = true;
+    TEST_ASSERT_FALSE(manager.runSoak("flaky", config));
+
+    const SoakRecorder& soak = manager.getSoakRecorder();
+    TEST_ASSERT_EQUAL_UINT32(1, soak.getWindowCount());
+    TEST_ASSERT_EQUAL_UINT32(1, soak.getWindow(0, 0).runs);
+    TEST_ASSERT_EQUAL_UINT32(1, soak.getWindow(0, 0).failures);
+    TEST_ASSERT_TRUE(has_trend(soak.analyze(), SoakTrend::Kind::FAILURES, "flaky"));
+}
+
+extern "C" void app_main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_sequential_run_counts_results);
+    RUN_TEST(test_step_deadline_times_out_test);
+    RUN_TEST(test_step_deadline_stops_cooperative_step);
+    RUN_TEST(test_test_deadline_aborts_run);
+    RUN_TEST(test_test_deadline_stops_cooperative_run);
+    RUN_TEST(test_parallel_runs_disjoint_resources_together);
+    RUN_TEST(test_parallel_serializes_shared_resources);
+    RUN_TEST(test_heap_leak_over_limit_fails_test);
+    RUN_TEST(test_heap_leak_limit_not_enforced_when_shared);
+    RUN_TEST(test_benchmark_statistics);
+    RUN_TEST(test_soak_steady_tests_pass);
+    RUN_TEST(test_soak_flags_leak_and_latency_growth);
+    RUN_TEST(test_soak_percentiles_use_recorded_latency);
+    RUN_TEST(test_soak_reruns_test_that_releases_in_teardown);
+    RUN_TEST(test_soak_stops_on_failure);
+
+    UNITY_END();
+}
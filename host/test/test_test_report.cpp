@@ -0,0 +1,133 @@
+#include "unity.h"
+#include "test_report.hpp"
+#include <sstream>
+
+// Collector side of the TestReporter stream
+
+extern "C" void setUp(void) {}
+extern "C" void tearDown(void) {}
+
+static std::vector<test_report::Record> parse(const char* log)
+{
+    std::istringstream stream(log);
+    return test_report::parseLog(stream);
+}
+
+static bool contains(const std::string& text, const char* part)
+{
+    return text.find(part) != std::string::npos;
+}
+
+static const char* run_log =
+    "I (1200) TestManager: Starting test: Sensor\n"
+    "@TR {\"type\":\"run_start\",\"tests\":2,\"parallel\":true}\n"
+    "@TR {\"type\":\"step\",\"test\":\"Sensor\",\"step\":\"init\",\"result\":\"PASSED\",\"error\":\"ESP_OK\",\"error_code\":0,\"duration_ms\":12}\n"
+    "\x1b[0;32mI (1300) Sensor: noise\x1b[0m\n"
+    "@TR {\"type\":\"step\",\"test\":\"Sensor\",\"step\":\"read\",\"result\":\"TIMEOUT\",\"error\":\"ESP_ERR_TIMEOUT\",\"error_code\":263,\"duration_ms\":5000}\n"
+    "@TR {\"type\":\"heap\",\"test\":\"Sensor\",\"region\":\"internal\",\"leaked_bytes\":128,\"allocation_change\":1,\"largest_free_block\":90000,\"largest_block_change\":-64,\"shared\":false}\n"
+    "@TR {\"type\":\"test\",\"test\":\"Sensor\",\"result\":\"TIMEOUT\",\"error_code\":263,\"duration_ms\":5012,\"resources\":1,\"tags\":\"hardware:i2c,slow\",\"message\":\"Step 'read' timed out\"}\n"
+    "@TR {\"type\":\"test\",\"test\":\"Net\",\"result\":\"FAILED\",\"error_code\":-1,\"duration_ms\":40,\"resources\":4,\"message\":\"Setup failed: \\\"no <ap>\\\"\"}\n"
+    "@TR {\"type\":\"run_end\",\"result\":\"FAILED\",\"total\":2,\"passed\":0,\"failed\":1,\"skipped\":0,\"timeout\":1,\"elapsed_ms\":5100,\"test_time_ms\":5052}\n";
+
+static const char* bench_log =
+    "@TR {\"type\":\"benchmark\",\"test\":\"Kernels\",\"benchmark\":\"encode\",\"median_ns\":1100.0,\"p99_ns\":1300.0}\n"
+    "@TR {\"type\":\"benchmark\",\"test\":\"Kernels\",\"benchmark\":\"lookup\",\"median_ns\":500.0,\"p99_ns\":520.0}\n"
+    "@TR {\"type\":\"benchmark\",\"test\":\"Kernels\",\"benchmark\":\"new\",\"median_ns\":10.0,\"p99_ns\":12.0}\n";
+
+static const char* baseline_log =
+    "@TR {\"type\":\"benchmark\",\"test\":\"Kernels\",\"benchmark\":\"encode\",\"median_ns\":1000.0}\n"
+    "@TR {\"type\":\"benchmark\",\"test\":\"Kernels\",\"benchmark\":\"lookup\",\"median_ns\":510.0}\n";
+
+void test_parses_records_between_log_lines(void)
+{
+    auto records = parse(run_log);
+    TEST_ASSERT_EQUAL_UINT32(7, records.size());
+    TEST_ASSERT_EQUAL_STRING("run_start", records[0].type().c_str());
+    TEST_ASSERT_EQUAL_STRING("true", records[0].get("parallel").c_str());
+    TEST_ASSERT_EQUAL_STRING("read", records[2].get("step").c_str());
+    TEST_ASSERT_EQUAL_INT(263, (int)records[2].number("error_code"));
+    TEST_ASSERT_EQUAL_STRING("Setup failed: \"no <ap>\"", records[5].get("message").c_str());
+}
+
+void test_rejects_malformed_records(void)
+{
+    test_report::Record record;
+    TEST_ASSERT_FALSE(test_report::parseLine("I (10) main: no record here", record));
+    TEST_ASSERT_FALSE(test_report::parseLine("@TR {\"type\":\"step\",\"test\":\"cut off", record));
+    TEST_ASSERT_FALSE(test_report::parseLine("@TR {\"type\" \"step\"}", record));
+    TEST_ASSERT_TRUE(test_report::parseLine("@TR {}", record));
+}
+
+void test_junit_reports_step_and_test_failures(void)
+{
+    std::string xml = test_report::toJUnit(parse(run_log));
+
+    TEST_ASSERT_TRUE(contains(xml, "<testsuite name=\"Sensor\" tests=\"2\" failures=\"1\" skipped=\"0\" time=\"5.012\">"));
+    TEST_ASSERT_TRUE(contains(xml, "name=\"init\" time=\"0.012\"/>"));
+    TEST_ASSERT_TRUE(contains(xml, "<failure type=\"TIMEOUT\" message=\"timed out\"/>"));
+    TEST_ASSERT_TRUE(contains(xml, "<property name=\"heap.internal.leaked_bytes\" value=\"128\"/>"));
+    TEST_ASSERT_TRUE(contains(xml, "<property name=\"tags\" value=\"hardware:i2c,slow\"/>"));
+
+    // Failed before any step ran: one testcase named after the test
+    TEST_ASSERT_TRUE(contains(xml, "<testsuite name=\"Net\" tests=\"1\" failures=\"1\""));
+    TEST_ASSERT_TRUE(contains(xml, "message=\"Setup failed: &quot;no &lt;ap&gt;&quot;\""));
+}
+
+void test_run_status_covers_every_run(void)
+{
+    const std::string passed_run =
+        "@TR {\"type\":\"run_start\",\"tests\":1,\"parallel\":false}\n"
+        "@TR {\"type\":\"run_end\",\"result\":\"PASSED\",\"total\":1,\"passed\":1,\"failed\":0}\n";
+    using test_report::RunStatus;
+
+    TEST_ASSERT_TRUE(test_report::runStatus(parse(passed_run.c_str())) == RunStatus::PASSED);
+    TEST_ASSERT_TRUE(test_report::runStatus(parse((passed_run + passed_run).c_str())) == RunStatus::PASSED);
+
+    // A failed run is not hidden by the runs around it
+    TEST_ASSERT_TRUE(test_report::runStatus(parse((passed_run + run_log).c_str())) == RunStatus::FAILED);
+    TEST_ASSERT_TRUE(test_report::runStatus(parse((run_log + passed_run).c_str())) == RunStatus::FAILED);
+
+    // The last run stopped before its run_end, e.g. on a reset
+    TEST_ASSERT_TRUE(test_report::runStatus(parse("")) == RunStatus::UNFINISHED);
+    TEST_ASSERT_TRUE(test_report::runStatus(parse((passed_run + "@TR {\"type\":\"run_start\",\"tests\":1}\n").c_str())) ==
+                     RunStatus::UNFINISHED);
+}
+
+void test_diff_flags_regressions_over_threshold(void)
+{
+    auto comparisons = test_report::compareBenchmarks(parse(bench_log), parse(baseline_log), 5.0);
+
+    // "new" has no baseline and is left out
+    TEST_ASSERT_EQUAL_UINT32(2, comparisons.size());
+    TEST_ASSERT_EQUAL_STRING("encode", comparisons[0].benchmark.c_str());
+    TEST_ASSERT_TRUE(comparisons[0].regressed);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 10.0, comparisons[0].change_pct);
+    TEST_ASSERT_FALSE(comparisons[1].regressed);
+    TEST_ASSERT_TRUE(comparisons[1].change_pct < 0.0);
+}
+
+void test_baseline_round_trips(void)
+{
+    auto baseline = parse(test_report::toBaseline(parse(bench_log)).c_str());
+    TEST_ASSERT_EQUAL_UINT32(3, baseline.size());
+
+    auto comparisons = test_report::compareBenchmarks(parse(bench_log), baseline, 0.0);
+    TEST_ASSERT_EQUAL_UINT32(3, comparisons.size());
+    for (const auto& comparison : comparisons) {
+        TEST_ASSERT_FALSE(comparison.regressed);
+    }
+}
+
+extern "C" void app_main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_parses_records_between_log_lines);
+    RUN_TEST(test_rejects_malformed_records);
+    RUN_TEST(test_junit_reports_step_and_test_failures);
+    RUN_TEST(test_run_status_covers_every_run);
+    RUN_TEST(test_diff_flags_regressions_over_threshold);
+    RUN_TEST(test_baseline_round_trips);
+
+    UNITY_END();
+}
@@ -0,0 +1,369 @@
+#include "unity.h"
+#include "wifi_manager.h"
+#include "mock_wifi.h"
+#include <string.h>
+
+// wifi_manager against the scripted driver; all times are simulated
+
+static const mock_wifi_ap_t ap_main = {
+    .ssid = "sphere", .bssid = {0x24, 0x0a, 0xc4, 0x00, 0x00, 0x01}, .channel = 6, .rssi = -50
+};
+static const mock_wifi_ap_t ap_spare = {
+    .ssid = "sphere", .bssid = {0x24, 0x0a, 0xc4, 0x00, 0x00, 0x02}, .channel = 11, .rssi = -60
+};
+
+static const mock_wifi_timing_t timing = {
+    .start_ms = 50,
+    .full_scan_ms = 1200,
+    .fast_scan_ms = 120,
+    .attempt = { .assoc_ms = 100, .dhcp_ms = 300 }
+};
+
+static wifi_manager_config_t make_config(bool fast_reconnect)
+{
+    wifi_manager_config_t config = {
+        .ssid = "sphere",
+        .password = "password",
+        .max_retry = 3,
+        .timeout_ms = 10000,
+        .auto_reconnect = true,
+        .fast_reconnect = fast_reconnect
+    };
+    return config;
+}
+
+static void script_failures(uint8_t reason, int count)
+{
+    mock_wifi_attempt_t attempt = timing.attempt;
+    attempt.fail_reason = reason;
+    for (int i = 0; i < count; i++) {
+        mock_wifi_script_attempt(&attempt);
+    }
+}
+
+// Histograms live for the whole boot, so tests look at what they added
+static void get_hist_deltas(const wifi_info_t *before, const wifi_info_t *after,
+                            uint16_t *cached, uint16_t *scan)
+{
+    for (int bin = 0; bin < WIFI_MANAGER_CONNECT_HIST_BINS; bin++) {
+        cached[bin] = after->connect_hist_cached[bin] - before->connect_hist_cached[bin];
+        scan[bin] = after->connect_hist_scan[bin] - before->connect_hist_scan[bin];
+    }
+}
+
+// Let the dispatch task publish the latest status before reading info
+static void get_settled_info(wifi_info_t *info)
+{
+    mock_wifi_run_for(1);
+    TEST_ASSERT_EQUAL(ESP_OK, wifi_manager_get_info(info));
+}
+
+// Connect once to leave a link cache in NVS, then start over like after a reboot
+static void connect_and_restart(const wifi_manager_config_t *config)
+{
+    TEST_ASSERT_EQUAL(ESP_OK, wifi_manager_connect(config));
+    mock_wifi_run_for(1);
+    TEST_ASSERT_EQUAL(ESP_OK, wifi_manager_deinit());
+    TEST_ASSERT_EQUAL(ESP_OK, wifi_manager_init());
+}
+
+void setUp(void) {
+    mock_wifi_reset();
+    mock_wifi_set_timing(&timing);
+    mock_wifi_add_ap(&ap_main);
+    TEST_ASSERT_EQUAL(ESP_OK, wifi_manager_init());
+}
+
+void tearDown(void) {
+    wifi_manager_deinit();
+}
+
+void test_connect_via_full_scan_latency() {
+    wifi_manager_config_t config = make_config(false);
+    wifi_info_t before;
+    get_settled_info(&before);
+    uint32_t start = mock_wifi_now_ms();
+
+    TEST_ASSERT_EQUAL(ESP_OK, wifi_manager_connect(&config));
+    TEST_ASSERT_EQUAL_UINT32(50 + 1200 + 100 + 300, mock_wifi_now_ms() - start);
+
+    wifi_info_t info;
+    uint16_t cached[WIFI_MANAGER_CONNECT_HIST_BINS];
+    uint16_t scan[WIFI_MANAGER_CONNECT_HIST_BINS];
+    get_settled_info(&info);
+    get_hist_deltas(&before, &info, cached, scan);
+    TEST_ASSERT_EQUAL(WIFI_STATUS_CONNECTED, info.status);
+    TEST_ASSERT_EQUAL_UINT32(1650, info.last_connect_ms);
+    TEST_ASSERT_FALSE(info.last_connect_cached);
+    TEST_ASSERT_EQUAL_UINT16(1, scan[3]);
+    TEST_ASSERT_EQUAL_UINT16(0, cached[3]);
+    TEST_ASSERT_EQUAL_STRING("192.168.4.2", info.ip_addr);
+    TEST_ASSERT_EQUAL_UINT8(6, info.channel);
+
+    mock_wifi_stats_t stats;
+    mock_wifi_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.connect_calls);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.full_scans);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.nvs_writes);
+}
+
+void test_retries_are_counted_in_events() {
+    wifi_manager_config_t config = make_config(false);
+    script_failures(WIFI_REASON_AUTH_FAIL, 2);
+
+    TEST_ASSERT_EQUAL(ESP_OK, wifi_manager_connect(&config));
+
+    wifi_manager_event_t event;
+    uint8_t expected_retry[] = {0, 1, 2};
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL(ESP_OK, wifi_manager_get_event(&event, 0));
+        TEST_ASSERT_EQUAL(WIFI_STATUS_CONNECTING, event.status);
+        TEST_ASSERT_EQUAL_UINT8(expected_retry[i], event.retry_count);
+    }
+    // The connected bit is set just before the event is queued
+    TEST_ASSERT_EQUAL(ESP_OK, wifi_manager_get_event(&event, 10));
+    TEST_ASSERT_EQUAL(WIFI_STATUS_CONNECTED, event.status);
+    TEST_ASSERT_EQUAL_UINT32(50 + 3 * (1200 + 100) + 300, event.elapsed_ms);
+    TEST_ASSERT_EQUAL(ESP_ERR_TIMEOUT, wifi_manager_get_event(&event, 0));
+
+    mock_wifi_stats_t stats;
+    mock_wifi_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(3, stats.connect_calls);
+}
+
+void test_gives_up_after_max_retry() {
+    wifi_manager_config_t config = make_config(false);
+    config.max_retry = 2;
+    script_failures(WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT, 3);
+
+    TEST_ASSERT_EQUAL(ESP_ERR_WIFI_CONN, wifi_manager_connect(&config));
+
+    wifi_info_t info;
+    get_settled_info(&info);
+    TEST_ASSERT_EQUAL(WIFI_STATUS_FAILED, info.status);
+
+    mock_wifi_stats_t stats;
+    mock_wifi_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(3, stats.connect_calls);
+    TEST_ASSERT_FALSE(stats.associated);
+}
+
+void test_dhcp_stall_times_out() {
+    wifi_manager_config_t config = make_config(false);
+    config.timeout_ms = 5000;
+    mock_wifi_attempt_t stall = { .assoc_ms = 100, .dhcp_ms = MOCK_WIFI_DHCP_STALL };
+    mock_wifi_script_attempt(&stall);
+    uint32_t start = mock_wifi_now_ms();
+
+    TEST_ASSERT_EQUAL(ESP_ERR_TIMEOUT, wifi_manager_connect(&config));
+    TEST_ASSERT_EQUAL_UINT32(5000, mock_wifi_now_ms() - start);
+
+    wifi_info_t info;
+    get_settled_info(&info);
+    TEST_ASSERT_EQUAL(WIFI_STATUS_TIMEOUT, info.status);
+
+    mock_wifi_stats_t stats;
+    mock_wifi_get_stats(&stats);
+    TEST_ASSERT_TRUE(stats.associated);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.dhcp_requests);
+}
+
+void test_fast_reconnect_uses_cached_link() {
+    wifi_manager_config_t config = make_config(true);
+    connect_and_restart(&config);
+
+    wifi_info_t before;
+    get_settled_info(&before);
+    uint32_t start = mock_wifi_now_ms();
+    TEST_ASSERT_EQUAL(ESP_OK, wifi_manager_connect(&config));
+    TEST_ASSERT_EQUAL_UINT32(50 + 120 + 100 + 300, mock_wifi_now_ms() - start);
+
+    wifi_info_t info;
+    uint16_t cached[WIFI_MANAGER_CONNECT_HIST_BINS];
+    uint16_t scan[WIFI_MANAGER_CONNECT_HIST_BINS];
+    get_settled_info(&info);
+    get_hist_deltas(&before, &info, cached, scan);
+    TEST_ASSERT_TRUE(info.last_connect_cached);
+    TEST_ASSERT_EQUAL_UINT16(1, cached[2]);
+
+    mock_wifi_stats_t stats;
+    mock_wifi_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.fast_scans);
+    // The unchanged link is not written again
+    TEST_ASSERT_EQUAL_UINT32(1, stats.nvs_writes);
+}
+
+void test_fast_reconnect_with_static_ip_skips_dhcp() {
+    wifi_manager_config_t config = make_config(true);
+    config.use_static_ip = true;
+    connect_and_restart(&config);
+
+    uint32_t start = mock_wifi_now_ms();
+    TEST_ASSERT_EQUAL(ESP_OK, wifi_manager_connect(&config));
+    TEST_ASSERT_EQUAL_UINT32(50 + 120 + 100, mock_wifi_now_ms() - start);
+
+    wifi_info_t info;
+    get_settled_info(&info);
+    TEST_ASSERT_EQUAL_STRING("192.168.4.2", info.ip_addr);
+
+    mock_wifi_stats_t stats;
+    mock_wifi_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.static_ip_connects);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.dhcp_requests);
+}
+
+void test_dropout_reconnects_through_cache() {
+    wifi_manager_config_t config = make_config(true);
+    TEST_ASSERT_EQUAL(ESP_OK, wifi_manager_connect(&config));
+    mock_wifi_run_for(1);
+
+    wifi_manager_event_t event;
+    while (wifi_manager_get_event(&event, 0) == ESP_OK) {
+    }
+    wifi_info_t before;
+    get_settled_info(&before);
+
+    mock_wifi_inject_disconnect(WIFI_REASON_BEACON_TIMEOUT, 2000);
+    TEST_ASSERT_EQUAL(ESP_OK, wifi_manager_get_event(&event, 5000));
+    TEST_ASSERT_EQUAL(WIFI_STATUS_CONNECTING, event.status);
+    TEST_ASSERT_EQUAL(ESP_OK, wifi_manager_get_event(&event, 5000));
+    TEST_ASSERT_EQUAL(WIFI_STATUS_CONNECTED, event.status);
+
+    wifi_info_t info;
+    get_settled_info(&info);
+    TEST_ASSERT_TRUE(info.last_connect_cached);
+    TEST_ASSERT_EQUAL_UINT32(120 + 100 + 300, info.last_connect_ms);
+    uint16_t cached[WIFI_MANAGER_CONNECT_HIST_BINS];
+    uint16_t scan[WIFI_MANAGER_CONNECT_HIST_BINS];
+    get_hist_deltas(&before, &info, cached, scan);
+    TEST_ASSERT_EQUAL_UINT16(1, cached[2]);
+    TEST_ASSERT_EQUAL_UINT16(0, scan[2]);
+}
+
+void test_stale_cache_falls_back_to_full_scan() {
+    wifi_manager_config_t config = make_config(true);
+    connect_and_restart(&config);
+
+    // The AP was replaced while the station was off
+    mock_wifi_remove_ap(ap_main.bssid);
+    mock_wifi_add_ap(&ap_spare);
+    uint32_t start = mock_wifi_now_ms();
+
+    TEST_ASSERT_EQUAL(ESP_OK, wifi_manager_connect(&config));
+    TEST_ASSERT_EQUAL_UINT32(50 + 120 + 1200 + 100 + 300, mock_wifi_now_ms() - start);
+
+    wifi_info_t info;
+    get_settled_info(&info);
+    TEST_ASSERT_FALSE(info.last_connect_cached);
+    TEST_ASSERT_EQUAL_UINT8(11, info.channel);
+
+    // A failed shortcut is not a retry
+    TEST_ASSERT_EQUAL_UINT8(0, info.retry_count);
+
+    mock_wifi_stats_t stats;
+    mock_wifi_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.nvs_writes);
+}
+
+// Drain the queue, weaken the joined AP and wait for the roam to play out
+static void roam_away_from_main(wifi_manager_event_t *roaming, wifi_manager_event_t *connected)
+{
+    wifi_manager_event_t event;
+    while (wifi_manager_get_event(&event, 0) == ESP_OK) {
+    }
+    
+    mock_wifi_ap_t weak = ap_main;
+    weak.rssi = -80;
+    mock_wifi_add_ap(&weak);
+    TEST_ASSERT_EQUAL(ESP_OK, wifi_manager_get_event(roaming, 30000));
+    TEST_ASSERT_EQUAL(ESP_OK, wifi_manager_get_event(connected, 5000));
+}
+
+void test_roams_to_stronger_ap() {
+    wifi_manager_config_t config = make_config(true);
+    config.roaming = true;
+    mock_wifi_add_ap(&ap_spare);
+    TEST_ASSERT_EQUAL(ESP_OK, wifi_manager_connect(&config));
+    mock_wifi_run_for(1);
+    
+    wifi_manager_event_t roaming, connected;
+    roam_away_from_main(&roaming, &connected);
+    TEST_ASSERT_EQUAL(WIFI_STATUS_ROAMING, roaming.status);
+    TEST_ASSERT_EQUAL(WIFI_STATUS_CONNECTED, connected.status);
+    
+    wifi_info_t info;
+    get_settled_info(&info);
+    TEST_ASSERT_EQUAL_UINT8(11, info.channel);
+    TEST_ASSERT_EQUAL_UINT16(1, info.roam.count);
+    TEST_ASSERT_EQUAL_UINT16(0, info.roam.failed);
+    TEST_ASSERT_EQUAL_UINT32(120 + 100 + 300, info.roam.last_gap_ms);
+    TEST_ASSERT_EQUAL_UINT16(1, info.roam.gap_hist[4]);
+    
+    // No further roam while the new AP is strong
+    mock_wifi_run_for(20000);
+    get_settled_info(&info);
+    TEST_ASSERT_EQUAL_UINT16(1, info.roam.count);
+}
+
+void test_roam_with_static_ip_skips_dhcp() {
+    wifi_manager_config_t config = make_config(true);
+    config.roaming = true;
+    config.use_static_ip = true;
+    mock_wifi_add_ap(&ap_spare);
+    TEST_ASSERT_EQUAL(ESP_OK, wifi_manager_connect(&config));
+    mock_wifi_run_for(1);
+    
+    wifi_manager_event_t roaming, connected;
+    roam_away_from_main(&roaming, &connected);
+    TEST_ASSERT_EQUAL(WIFI_STATUS_CONNECTED, connected.status);
+    
+    wifi_info_t info;
+    get_settled_info(&info);
+    TEST_ASSERT_EQUAL_UINT32(120 + 100, info.roam.last_gap_ms);
+    TEST_ASSERT_EQUAL_STRING("192.168.4.2", info.ip_addr);
+}
+
+void test_fails_over_to_second_network() {
+    static const mock_wifi_ap_t ap_backup = {
+        .ssid = "sphere-backup", .bssid = {0x24, 0x0a, 0xc4, 0x00, 0x00, 0x03}, .channel = 1, .rssi = -55
+    };
+    wifi_manager_config_t config = make_config(false);
+    config.priority = 1;
+    strcpy(config.networks[0].ssid, "sphere-backup");
+    strcpy(config.networks[0].password, "password");
+    config.network_count = 1;
+    mock_wifi_remove_ap(ap_main.bssid);
+    mock_wifi_add_ap(&ap_backup);
+    uint32_t start = mock_wifi_now_ms();
+    
+    TEST_ASSERT_EQUAL(ESP_OK, wifi_manager_connect(&config));
+    TEST_ASSERT_EQUAL_UINT32(50 + 1200 + 1200 + 100 + 300, mock_wifi_now_ms() - start);
+    
+    wifi_info_t info;
+    get_settled_info(&info);
+    TEST_ASSERT_EQUAL_STRING("sphere-backup", info.ssid);
+    
+    mock_wifi_stats_t stats;
+    mock_wifi_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.connect_calls);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.full_scans);
+}
+
+// Unity テストランナー関数
+void app_main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_connect_via_full_scan_latency);
+    RUN_TEST(test_retries_are_counted_in_events);
+    RUN_TEST(test_gives_up_after_max_retry);
+    RUN_TEST(test_dhcp_stall_times_out);
+    RUN_TEST(test_fast_reconnect_uses_cached_link);
+    RUN_TEST(test_fast_reconnect_with_static_ip_skips_dhcp);
+    RUN_TEST(test_dropout_reconnects_through_cache);
+    RUN_TEST(test_stale_cache_falls_back_to_full_scan);
+    RUN_TEST(test_roams_to_stronger_ap);
+    RUN_TEST(test_roam_with_static_ip_skips_dhcp);
+    RUN_TEST(test_fails_over_to_second_network);
+
+    UNITY_END();
+}
@@ -0,0 +1,119 @@
+#include "test_report.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+// Collector for captured serial logs (monitor-loop.sh output):
+//
+//   test_report junit <log> [-o report.xml]
+//   test_report baseline <log> [-o baseline.log]
+//   test_report diff <log> <baseline> [--threshold PCT]
+//
+// diff exits with 1 when any benchmark median got slower than the threshold
+// (default 10 %), junit when any test of any run in the log failed or the
+// last run did not finish.
+
+static int usage()
+{
+    fprintf(stderr,
+            "usage: test_report junit <log> [-o out.xml]\n"
+            "       test_report baseline <log> [-o out.log]\n"
+            "       test_report diff <log> <baseline> [--threshold PCT]\n");
+    return 2;
+}
+
+static bool readRecords(const char* path, std::vector<test_report::Record>& records)
+{
+    std::ifstream file(path);
+    if (!file) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return false;
+    }
+    records = test_report::parseLog(file);
+    return true;
+}
+
+static bool writeOutput(const char* path, const std::string& text)
+{
+    if (!path) {
+        std::cout << text;
+        return true;
+    }
+    std::ofstream file(path);
+    if (!file) {
+        fprintf(stderr, "cannot write %s\n", path);
+        return false;
+    }
+    file << text;
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3) {
+        return usage();
+    }
+    const char* command = argv[1];
+    const char* output = nullptr;
+    const char* baseline_path = nullptr;
+    double threshold_pct = 10.0;
+
+    for (int i = 3; i < argc; i++) {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            output = argv[++i];
+        } else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            threshold_pct = atof(argv[++i]);
+        } else if (!baseline_path) {
+            baseline_path = argv[i];
+        } else {
+            return usage();
+        }
+    }
+
+    std::vector<test_report::Record> records;
+    if (!readRecords(argv[2], records)) {
+        return 2;
+    }
+
+    if (strcmp(command, "junit") == 0) {
+        if (!writeOutput(output, test_report::toJUnit(records))) {
+            return 2;
+        }
+        switch (test_report::runStatus(records)) {
+            case test_report::RunStatus::PASSED:
+                return 0;
+            case test_report::RunStatus::FAILED:
+                return 1;
+            default:
+                fprintf(stderr, "no run_end record, the last run did not finish\n");
+                return 1;
+        }
+    }
+
+    if (strcmp(command, "baseline") == 0) {
+        return writeOutput(output, test_report::toBaseline(records)) ? 0 : 2;
+    }
+
+    if (strcmp(command, "diff") == 0 && baseline_path) {
+        std::vector<test_report::Record> baseline;
+        if (!readRecords(baseline_path, baseline)) {
+            return 2;
+        }
+        int regressions = 0;
+        for (const auto& comparison : test_report::compareBenchmarks(records, baseline, threshold_pct)) {
+            printf("%-4s %s/%s: %.1f -> %.1f ns (%+.1f %%)\n",
+                   comparison.regressed ? "FAIL" : "ok",
+                   comparison.test.c_str(), comparison.benchmark.c_str(),
+                   comparison.baseline_ns, comparison.current_ns, comparison.change_pct);
+            if (comparison.regressed) {
+                regressions++;
+            }
+        }
+        printf("%d regression(s) over %.1f %%\n", regressions, threshold_pct);
+        return regressions > 0 ? 1 : 0;
+    }
+
+    return usage();
+}
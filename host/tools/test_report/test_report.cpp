@@ -0,0 +1,368 @@
+#include "test_report.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+namespace test_report {
+
+std::string Record::get(const std::string& key, const std::string& fallback) const
+{
+    auto it = fields.find(key);
+    return it != fields.end() ? it->second : fallback;
+}
+
+double Record::number(const std::string& key, double fallback) const
+{
+    auto it = fields.find(key);
+    if (it == fields.end()) {
+        return fallback;
+    }
+    char* end = nullptr;
+    double value = strtod(it->second.c_str(), &end);
+    return end != it->second.c_str() ? value : fallback;
+}
+
+namespace {
+
+void skipSpace(const std::string& text, size_t& pos)
+{
+    while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t')) {
+        pos++;
+    }
+}
+
+bool parseString(const std::string& text, size_t& pos, std::string& out)
+{
+    if (pos >= text.size() || text[pos] != '"') {
+        return false;
+    }
+    pos++;
+    out.clear();
+    while (pos < text.size()) {
+        char c = text[pos++];
+        if (c == '"') {
+            return true;
+        }
+        if (c != '\\') {
+            out += c;
+            continue;
+        }
+        if (pos >= text.size()) {
+            return false;
+        }
+        char escaped = text[pos++];
+        switch (escaped) {
+            case 'n':   out += '\n'; break;
+            case 'r':   out += '\r'; break;
+            case 't':   out += '\t'; break;
+            case 'u':
+                // TestReporter only escapes control characters this way
+                if (pos + 4 > text.size()) {
+                    return false;
+                }
+                out += (char)strtol(text.substr(pos, 4).c_str(), nullptr, 16);
+                pos += 4;
+                break;
+            default:    out += escaped; break;
+        }
+    }
+    return false;
+}
+
+// Numbers, true, false and null, kept as their text
+bool parseScalar(const std::string& text, size_t& pos, std::string& out)
+{
+    size_t start = pos;
+    while (pos < text.size() && text[pos] != ',' && text[pos] != '}' && text[pos] != ' ') {
+        pos++;
+    }
+    out = text.substr(start, pos - start);
+    return !out.empty();
+}
+
+std::string xmlEscape(const std::string& text)
+{
+    std::string escaped;
+    for (char c : text) {
+        switch (c) {
+            case '&':   escaped += "&amp;"; break;
+            case '<':   escaped += "&lt;"; break;
+            case '>':   escaped += "&gt;"; break;
+            case '"':   escaped += "&quot;"; break;
+            default:
+                if ((unsigned char)c >= 0x20 || c == '\n' || c == '\t') {
+                    escaped += c;
+                }
+                break;
+        }
+    }
+    return escaped;
+}
+
+std::string jsonEscape(const std::string& text)
+{
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+std::string seconds(double ms)
+{
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.3f", ms / 1000.0);
+    return buffer;
+}
+
+bool isFailure(const std::string& result)
+{
+    return result == "FAILED" || result == "TIMEOUT";
+}
+
+struct Suite {
+    std::string name;
+    std::vector<const Record*> steps;
+    std::vector<const Record*> benchmarks;
+    std::vector<const Record*> heaps;
+    const Record* test = nullptr;
+};
+
+} // namespace
+
+bool parseLine(const std::string& line, Record& record)
+{
+    size_t pos = line.find(RECORD_PREFIX);
+    if (pos == std::string::npos) {
+        return false;
+    }
+    pos += strlen(RECORD_PREFIX);
+    skipSpace(line, pos);
+    if (pos >= line.size() || line[pos] != '{') {
+        return false;
+    }
+    pos++;
+
+    record.fields.clear();
+    skipSpace(line, pos);
+    if (pos < line.size() && line[pos] == '}') {
+        return true;
+    }
+    while (pos < line.size()) {
+        std::string key, value;
+        skipSpace(line, pos);
+        if (!parseString(line, pos, key)) {
+            return false;
+        }
+        skipSpace(line, pos);
+        if (pos >= line.size() || line[pos++] != ':') {
+            return false;
+        }
+        skipSpace(line, pos);
+        bool ok = (pos < line.size() && line[pos] == '"') ? parseString(line, pos, value)
+                                                          : parseScalar(line, pos, value);
+        if (!ok) {
+            return false;
+        }
+        record.fields[key] = value;
+        skipSpace(line, pos);
+        if (pos >= line.size()) {
+            return false;
+        }
+        char separator = line[pos++];
+        if (separator == '}') {
+            return true;
+        }
+        if (separator != ',') {
+            return false;
+        }
+    }
+    return false;
+}
+
+std::vector<Record> parseLog(std::istream& log)
+{
+    std::vector<Record> records;
+    std::string line;
+    Record record;
+    while (std::getline(log, line)) {
+        if (parseLine(line, record)) {
+            records.push_back(record);
+        }
+    }
+    return records;
+}
+
+std::string toJUnit(const std::vector<Record>& records)
+{
+    // Suites in order of first appearance; parallel runs interleave records
+    std::vector<Suite> suites;
+    auto suiteFor = [&suites](const std::string& name) -> Suite& {
+        for (Suite& suite : suites) {
+            if (suite.name == name) {
+                return suite;
+            }
+        }
+        suites.push_back(Suite{name, {}, {}, {}, nullptr});
+        return suites.back();
+    };
+
+    for (const Record& record : records) {
+        std::string type = record.type();
+        if (type == "step") {
+            suiteFor(record.get("test")).steps.push_back(&record);
+        } else if (type == "benchmark") {
+            suiteFor(record.get("test")).benchmarks.push_back(&record);
+        } else if (type == "heap") {
+            suiteFor(record.get("test")).heaps.push_back(&record);
+        } else if (type == "test") {
+            suiteFor(record.get("test")).test = &record;
+        }
+    }
+
+    std::ostringstream xml;
+    xml << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<testsuites>\n";
+    for (const Suite& suite : suites) {
+        std::string test_result = suite.test ? suite.test->get("result") : "NOT_RUN";
+        bool step_failed = false;
+        int failures = 0;
+        for (const Record* step : suite.steps) {
+            if (isFailure(step->get("result"))) {
+                step_failed = true;
+                failures++;
+            }
+        }
+        // The test failed outside its steps, or never reported at all
+        bool extra_case = suite.steps.empty() || (isFailure(test_result) && !step_failed) ||
+                          test_result == "SKIPPED" || test_result == "NOT_RUN";
+        bool extra_failure = extra_case && test_result != "PASSED" && test_result != "SKIPPED";
+        bool extra_skipped = extra_case && test_result == "SKIPPED";
+        if (extra_failure) {
+            failures++;
+        }
+
+        size_t cases = suite.steps.size() + (extra_case ? 1 : 0);
+        double duration_ms = suite.test ? suite.test->number("duration_ms") : 0.0;
+        xml << "  <testsuite name=\"" << xmlEscape(suite.name) << "\" tests=\"" << cases
+            << "\" failures=\"" << failures << "\" skipped=\"" << (extra_skipped ? 1 : 0)
+            << "\" time=\"" << seconds(duration_ms) << "\">\n";
+
+        std::string tags = suite.test ? suite.test->get("tags") : "";
+        if (!suite.benchmarks.empty() || !suite.heaps.empty() || !tags.empty()) {
+            xml << "    <properties>\n";
+            if (!tags.empty()) {
+                xml << "      <property name=\"tags\" value=\"" << xmlEscape(tags) << "\"/>\n";
+            }
+            for (const Record* bench : suite.benchmarks) {
+                xml << "      <property name=\"" << xmlEscape(bench->get("benchmark"))
+                    << ".median_ns\" value=\"" << xmlEscape(bench->get("median_ns")) << "\"/>\n";
+            }
+            for (const Record* heap : suite.heaps) {
+                xml << "      <property name=\"heap." << xmlEscape(heap->get("region"))
+                    << ".leaked_bytes\" value=\"" << xmlEscape(heap->get("leaked_bytes")) << "\"/>\n";
+            }
+            xml << "    </properties>\n";
+        }
+
+        for (const Record* step : suite.steps) {
+            std::string result = step->get("result");
+            xml << "    <testcase classname=\"" << xmlEscape(suite.name) << "\" name=\""
+                << xmlEscape(step->get("step")) << "\" time=\"" << seconds(step->number("duration_ms")) << "\"";
+            if (isFailure(result)) {
+                std::string message = result == "TIMEOUT" ? "timed out" : step->get("error");
+                xml << ">\n      <failure type=\"" << result << "\" message=\"" << xmlEscape(message)
+                    << "\"/>\n    </testcase>\n";
+            } else {
+                xml << "/>\n";
+            }
+        }
+
+        if (extra_case) {
+            xml << "    <testcase classname=\"" << xmlEscape(suite.name) << "\" name=\""
+                << xmlEscape(suite.name) << "\" time=\"" << seconds(duration_ms) << "\"";
+            if (extra_failure) {
+                std::string message = suite.test ? suite.test->get("message") : "no test record";
+                xml << ">\n      <failure type=\"" << test_result << "\" message=\"" << xmlEscape(message)
+                    << "\"/>\n    </testcase>\n";
+            } else if (extra_skipped) {
+                xml << ">\n      <skipped/>\n    </testcase>\n";
+            } else {
+                xml << "/>\n";
+            }
+        }
+        xml << "  </testsuite>\n";
+    }
+    xml << "</testsuites>\n";
+    return xml.str();
+}
+
+RunStatus runStatus(const std::vector<Record>& records)
+{
+    bool failed = false;
+    bool finished = false;
+    for (const Record& record : records) {
+        if (record.type() == "run_start") {
+            finished = false;
+        } else if (record.type() == "run_end") {
+            finished = true;
+            failed = failed || record.get("result") != "PASSED";
+        }
+    }
+    if (failed) {
+        return RunStatus::FAILED;
+    }
+    return finished ? RunStatus::PASSED : RunStatus::UNFINISHED;
+}
+
+std::string toBaseline(const std::vector<Record>& records)
+{
+    std::ostringstream out;
+    for (const Record& record : records) {
+        if (record.type() != "benchmark") {
+            continue;
+        }
+        out << RECORD_PREFIX << "{\"type\":\"benchmark\",\"test\":\"" << jsonEscape(record.get("test"))
+            << "\",\"benchmark\":\"" << jsonEscape(record.get("benchmark"))
+            << "\",\"median_ns\":" << record.get("median_ns", "0")
+            << ",\"p99_ns\":" << record.get("p99_ns", "0") << "}\n";
+    }
+    return out.str();
+}
+
+std::vector<Comparison> compareBenchmarks(const std::vector<Record>& current,
+                                          const std::vector<Record>& baseline,
+                                          double threshold_pct)
+{
+    std::map<std::string, double> baseline_medians;
+    for (const Record& record : baseline) {
+        if (record.type() == "benchmark") {
+            baseline_medians[record.get("test") + "/" + record.get("benchmark")] = record.number("median_ns");
+        }
+    }
+
+    std::vector<Comparison> comparisons;
+    for (const Record& record : current) {
+        if (record.type() != "benchmark") {
+            continue;
+        }
+        auto it = baseline_medians.find(record.get("test") + "/" + record.get("benchmark"));
+        if (it == baseline_medians.end() || it->second <= 0.0) {
+            continue;
+        }
+        Comparison comparison;
+        comparison.test = record.get("test");
+        comparison.benchmark = record.get("benchmark");
+        comparison.baseline_ns = it->second;
+        comparison.current_ns = record.number("median_ns");
+        comparison.change_pct = (comparison.current_ns - comparison.baseline_ns) * 100.0 / comparison.baseline_ns;
+        comparison.regressed = comparison.change_pct > threshold_pct;
+        comparisons.push_back(comparison);
+    }
+    return comparisons;
+}
+
+} // namespace test_report
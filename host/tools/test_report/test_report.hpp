@@ -0,0 +1,61 @@
+#ifndef TEST_REPORT_HPP
+#define TEST_REPORT_HPP
+
+#include <istream>
+#include <map>
+#include <string>
+#include <vector>
+
+// Host side of TestReporter: collects the "@TR " JSON records from a
+// captured serial log and turns them into JUnit XML or a benchmark
+// comparison against a stored baseline.
+namespace test_report {
+
+// Line prefix the firmware puts in front of every record (TEST_REPORT_PREFIX)
+constexpr const char* RECORD_PREFIX = "@TR ";
+
+// One flat JSON object; values kept as text, strings unescaped
+struct Record {
+    std::map<std::string, std::string> fields;
+
+    std::string type() const { return get("type"); }
+    std::string get(const std::string& key, const std::string& fallback = "") const;
+    double number(const std::string& key, double fallback = 0.0) const;
+};
+
+// Parse the record in one log line; false for lines without one or with malformed JSON
+bool parseLine(const std::string& line, Record& record);
+std::vector<Record> parseLog(std::istream& log);
+
+// One testsuite per test with a testcase per step; failures outside any
+// step (setup, deadlines) become a testcase named after the test. Benchmark
+// medians and heap leaks become testsuite properties.
+std::string toJUnit(const std::vector<Record>& records);
+
+// Result of all runs in a log, which may hold several (a soak loop, a
+// reboot): FAILED when any run_end reports a failure, UNFINISHED when the
+// last run started has no run_end
+enum class RunStatus { PASSED, FAILED, UNFINISHED };
+RunStatus runStatus(const std::vector<Record>& records);
+
+// Benchmark records only, as a log the parser reads back
+std::string toBaseline(const std::vector<Record>& records);
+
+struct Comparison {
+    std::string test;
+    std::string benchmark;
+    double baseline_ns = 0.0;       // Median of the baseline
+    double current_ns = 0.0;        // Median of this run
+    double change_pct = 0.0;        // Positive when slower
+    bool regressed = false;         // Slower than the threshold allows
+};
+
+// Match benchmarks by test and name and compare medians; benchmarks missing
+// from either side are left out
+std::vector<Comparison> compareBenchmarks(const std::vector<Record>& current,
+                                          const std::vector<Record>& baseline,
+                                          double threshold_pct);
+
+} // namespace test_report
+
+#endif // TEST_REPORT_HPP
@@ -10,9 +10,17 @@
 #include <esp_system.h>
 #include <nvs_flash.h>
 #include <esp_heap_caps.h>
+#include <esp_timer.h>
+#include <esp_netif.h>
 #include "hardware_info.hpp"
 #include "bno055.h"
 #include "wifi_manager.h"
+#include "ros2_manager.h"
+#include "led_output.h"
+#include "led_color.h"
+#include "render_scheduler.h"
+#include "image_stream.h"
+#include "task_topology.h"
 
 static const char *TAG = "M5ATOMS3R";
 
@@ -22,9 +30,39 @@ static const char *TAG = "M5ATOMS3R";
 #define SDA_GPIO    GPIO_NUM_2       // I2C SDA
 #define SCL_GPIO    GPIO_NUM_1       // I2C SCL
 
+// LED sphere
+#define SPHERE_NUM_LEDS     3000
+#define SPHERE_NUM_CHAINS   4
+#define SPHERE_CURRENT_MA   8000
+#define IMU_SAMPLE_MS       10              // 100Hz orientation updates
+#define PATTERN_WIDTH       RENDER_SCHEDULER_DEFAULT_IMAGE_WIDTH
+#define PATTERN_HEIGHT      RENDER_SCHEDULER_DEFAULT_IMAGE_HEIGHT
+#define STREAM_WIDTH        128             // Received images, scaled up to the pattern size;
+#define STREAM_HEIGHT       64              // 18 fragments, so a frame fits the UDP receive mailbox
+#define STREAM_IMAGE_SIZE   ((size_t)STREAM_WIDTH * STREAM_HEIGHT * 3)
+
+static led_geometry_t sphere_geometry;
+
+// Firmware task table: core 1 carries the IMU and LED output, everything else runs on core 0.
+// Only tasks that never touch flash may use PSRAM stacks.
+static const task_topology_entry_t firmware_tasks[] = {
+    { "bno055_test_task",                   1, 12, 4096, TASK_STACK_INTERNAL },
+    { RENDER_SCHEDULER_RENDER_TASK_NAME,    1, 10, 4096, TASK_STACK_INTERNAL },
+    { IMAGE_STREAM_TASK_NAME,               0,  6, 4096, TASK_STACK_INTERNAL },
+    { RENDER_SCHEDULER_DECODE_TASK_NAME,    0,  5, 4096, TASK_STACK_INTERNAL },
+    { "ros2_publish",                       0,  5, 4096, TASK_STACK_INTERNAL },
+    { "ros2_subscribe",                     0,  4, 4096, TASK_STACK_INTERNAL },
+    { "hardware_test_task",                 0,  3, 4096, TASK_STACK_INTERNAL },  // Reads the flash chip ID
+    { "button_task",                        0,  4, 2048, TASK_STACK_INTERNAL },
+    { "wifi_test_task",                     0,  2, 4096, TASK_STACK_INTERNAL },  // Wi-Fi driver writes NVS
+    { WIFI_MANAGER_DISPATCH_TASK_NAME,      0,  2, 3072, TASK_STACK_INTERNAL },  // Writes the link cache to NVS
+    { "hello_world_task",                   0,  1, 2048, TASK_STACK_PSRAM },
+};
+
 // Function declarations
 extern "C" {
     void init_gpio(void);
+    esp_err_t init_render_pipeline(void);
     void hello_world_task(void *pvParameters);
     void button_task(void *pvParameters);
     void hardware_test_task(void *pvParameters);
@@ -55,18 +93,34 @@ extern "C" void app_main(void)
     }
     ESP_ERROR_CHECK(ret);
     
+    // lwIP's tcpip thread, which the image stream's netconn needs before WiFi comes up
+    ESP_ERROR_CHECK(esp_netif_init());
+    
     // Initialize GPIO
     init_gpio();
     
+    // Register the task table before any component starts a task
+    ESP_ERROR_CHECK(task_topology_init(firmware_tasks, sizeof(firmware_tasks) / sizeof(firmware_tasks[0])));
+    
+    // LED output and render scheduler (decode on core 0, render on core 1)
+    ret = init_render_pipeline();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Render pipeline initialization failed: %s", esp_err_to_name(ret));
+    }
+    
     // Create tasks
-    xTaskCreate(&hardware_test_task, "hardware_test_task", 4096, NULL, 5, NULL);
-    xTaskCreate(&hello_world_task, "hello_world_task", 2048, NULL, 4, NULL);
-    xTaskCreate(&button_task, "button_task", 2048, NULL, 4, NULL);
-    xTaskCreate(&bno055_test_task, "bno055_test_task", 4096, NULL, 3, NULL);
-    xTaskCreate(&wifi_test_task, "wifi_test_task", 4096, NULL, 2, NULL);
+    task_topology_create("hardware_test_task", &hardware_test_task, NULL, NULL);
+    task_topology_create("hello_world_task", &hello_world_task, NULL, NULL);
+    task_topology_create("button_task", &button_task, NULL, NULL);
+    task_topology_create("bno055_test_task", &bno055_test_task, NULL, NULL);
+    task_topology_create("wifi_test_task", &wifi_test_task, NULL, NULL);
     
     ESP_LOGI(TAG, "M5atomS3R Hardware Test initialized successfully!");
     ESP_LOGI(TAG, "Press the button to test GPIO functionality");
+    
+    // Placement and stack headroom once every task has run for a while
+    vTaskDelay(pdMS_TO_TICKS(TASK_TOPOLOGY_REPORT_DELAY_MS));
+    task_topology_report();
 }
 
 void init_gpio(void)
@@ -84,6 +138,126 @@ void init_gpio(void)
     ESP_LOGI(TAG, "GPIO initialized");
 }
 
+// Uncompressed STREAM_WIDTH x STREAM_HEIGHT RGB888 images only, until a JPEG
+// decoder is linked; nearest-neighbour scaled to the frame size
+static esp_err_t raw_rgb_decode(const uint8_t *data, size_t size,
+                                uint8_t *rgb, uint16_t width, uint16_t height, void *user_ctx)
+{
+    if (size != STREAM_IMAGE_SIZE) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    for (int row = 0; row < height; row++) {
+        const uint8_t *src_row = &data[(size_t)(row * STREAM_HEIGHT / height) * STREAM_WIDTH * 3];
+        uint8_t *dst = &rgb[(size_t)row * width * 3];
+        for (int col = 0; col < width; col++) {
+            const uint8_t *src = &src_row[(col * STREAM_WIDTH / width) * 3];
+            dst[0] = src[0];
+            dst[1] = src[1];
+            dst[2] = src[2];
+            dst += 3;
+        }
+    }
+    return ESP_OK;
+}
+
+// World-fixed test pattern: hue follows longitude, brightness follows latitude,
+// so the picture should stay still while the sphere is rotated
+static esp_err_t submit_test_pattern(void)
+{
+    uint8_t *pattern = (uint8_t *)heap_caps_malloc(STREAM_IMAGE_SIZE, MALLOC_CAP_SPIRAM);
+    if (!pattern) {
+        return ESP_ERR_NO_MEM;
+    }
+    
+    for (int row = 0; row < STREAM_HEIGHT; row++) {
+        uint8_t level = (uint8_t)(255 - row * 200 / STREAM_HEIGHT);
+        for (int col = 0; col < STREAM_WIDTH; col++) {
+            int sector = col * 3 / STREAM_WIDTH;
+            uint8_t *px = &pattern[((size_t)row * STREAM_WIDTH + col) * 3];
+            px[0] = sector == 0 ? level : 0;
+            px[1] = sector == 1 ? level : 0;
+            px[2] = sector == 2 ? level : 0;
+        }
+    }
+    
+    esp_err_t ret = render_scheduler_submit_image(pattern, STREAM_IMAGE_SIZE);
+    heap_caps_free(pattern);
+    return ret;
+}
+
+esp_err_t init_render_pipeline(void)
+{
+    // Fibonacci layout until the measured geometry file is loaded
+    esp_err_t ret = led_geometry_generate(SPHERE_NUM_LEDS, SPHERE_NUM_CHAINS, &sphere_geometry);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    led_output_config_t output_config = {};
+    const gpio_num_t chain_gpios[SPHERE_NUM_CHAINS] = {GPIO_NUM_5, GPIO_NUM_6, GPIO_NUM_7, GPIO_NUM_8};
+    for (int c = 0; c < SPHERE_NUM_CHAINS; c++) {
+        output_config.chains[c].gpio = chain_gpios[c];
+    }
+    output_config.num_chains = SPHERE_NUM_CHAINS;
+    output_config.resolution_hz = LED_OUTPUT_DEFAULT_RESOLUTION_HZ;
+    output_config.mem_block_symbols = LED_OUTPUT_DEFAULT_MEM_SYMBOLS;
+    output_config.with_dma = true;
+    output_config.geometry = &sphere_geometry;
+    
+    ret = led_output_init(&output_config);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    led_color_config_t color_config = {
+        .gamma = LED_COLOR_DEFAULT_GAMMA,
+        .brightness = 64,
+        .dither = true,
+        .current_limit_ma = SPHERE_CURRENT_MA,
+        .ma_per_channel = LED_COLOR_DEFAULT_MA_PER_CHANNEL,
+        .idle_ma_per_led = LED_COLOR_DEFAULT_IDLE_MA_PER_LED
+    };
+    ret = led_color_init(&color_config, led_output_get_num_leds());
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    render_scheduler_config_t render_config = {
+        .image_width = PATTERN_WIDTH,
+        .image_height = PATTERN_HEIGHT,
+        .max_image_size = STREAM_IMAGE_SIZE,
+        .decode = raw_rgb_decode,
+        .decode_ctx = NULL,
+        .geometry = &sphere_geometry
+    };
+    ret = render_scheduler_init(&render_config);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    ret = render_scheduler_start();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    ret = submit_test_pattern();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    // Image fragments over UDP, written straight into the render scheduler's slots
+    image_stream_config_t stream_config = {
+        .port = IMAGE_STREAM_DEFAULT_PORT,
+        .fragment_payload = IMAGE_FRAGMENT_DEFAULT_PAYLOAD
+    };
+    ret = image_stream_init(&stream_config);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    return image_stream_start();
+}
+
 void hardware_test_task(void *pvParameters)
 {
     ESP_LOGI(TAG, "Hardware test task started");
@@ -193,34 +367,52 @@ void bno055_test_task(void *pvParameters)
     ESP_LOGI(TAG, "Waiting for sensor stabilization...");
     vTaskDelay(pdMS_TO_TICKS(2000));
     
+    // Feed the render scheduler at a fixed rate; log once per second
+    TickType_t last_wake = xTaskGetTickCount();
     int counter = 0;
+    bool first_sample = true;
     while (1) {
         counter++;
         
         bno055_quaternion_t quat;
         ret = bno055_get_quaternion(&quat);
+        int64_t sample_time_us = esp_timer_get_time();
         
         if (ret == ESP_OK) {
-            ESP_LOGI(TAG, "=== BNO055 Quaternion Data #%d ===", counter);
-            ESP_LOGI(TAG, "W: %+.4f", quat.w);
-            ESP_LOGI(TAG, "X: %+.4f", quat.x);
-            ESP_LOGI(TAG, "Y: %+.4f", quat.y);
-            ESP_LOGI(TAG, "Z: %+.4f", quat.z);
+            render_quat_t q = { quat.w, quat.x, quat.y, quat.z };
+            render_scheduler_push_imu(&q, sample_time_us);
+            
+            if (first_sample) {
+                // Boot-to-first-IMU-sample, independent of WiFi association
+                ESP_LOGI(TAG, "First IMU sample %lld ms after boot", sample_time_us / 1000);
+                first_sample = false;
+            }
             
-            // Calculate magnitude for verification (should be close to 1.0)
-            float magnitude = sqrtf(quat.w*quat.w + quat.x*quat.x + quat.y*quat.y + quat.z*quat.z);
-            ESP_LOGI(TAG, "Magnitude: %.4f", magnitude);
-            ESP_LOGI(TAG, "==============================");
+            if (counter % (1000 / IMU_SAMPLE_MS) == 0) {
+                float magnitude = sqrtf(quat.w*quat.w + quat.x*quat.x + quat.y*quat.y + quat.z*quat.z);
+                ESP_LOGI(TAG, "BNO055 #%d: W %+.4f X %+.4f Y %+.4f Z %+.4f (|q| %.4f)",
+                         counter, quat.w, quat.x, quat.y, quat.z, magnitude);
+                
+                render_scheduler_stats_t stats;
+                if (render_scheduler_get_stats(&stats) == ESP_OK) {
+                    ESP_LOGI(TAG, "Render: %lu frames, %lu misses, project %lu us, color %lu us, photon age %lu us",
+                             stats.frames_rendered, stats.deadline_misses, stats.project.avg_us,
+                             stats.color.avg_us, stats.photon_age.avg_us);
+                }
+            }
         } else {
             ESP_LOGE(TAG, "Failed to read quaternion: %s", esp_err_to_name(ret));
         }
         
-        vTaskDelay(pdMS_TO_TICKS(1000)); // 1 second interval
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(IMU_SAMPLE_MS));
     }
 }
 
 void wifi_event_callback(wifi_status_t status, wifi_info_t *info)
 {
+    // Hold the ROS2 session across a roam instead of dropping it
+    ros2_manager_set_link_paused(status == WIFI_STATUS_ROAMING);
+    
     switch (status) {
         case WIFI_STATUS_CONNECTING:
             ESP_LOGI(TAG, "WiFi: Connecting... (retry: %d)", info->retry_count);
@@ -235,9 +427,24 @@ void wifi_event_callback(wifi_status_t status, wifi_info_t *info)
             ESP_LOGI(TAG, "RSSI: %d dBm", info->rssi);
             ESP_LOGI(TAG, "Channel: %d", info->channel);
             ESP_LOGI(TAG, "Connection time: %lu ms", info->connection_time_ms);
+            ESP_LOGI(TAG, "Connect took: %lu ms (%s)", info->last_connect_ms,
+                     info->last_connect_cached ? "cached link" : "full scan");
+            ESP_LOGI(TAG, "Cached: %u %u %u %u %u %u | Scan: %u %u %u %u %u %u (<250/500/1000/2000/4000/more ms)",
+                     info->connect_hist_cached[0], info->connect_hist_cached[1], info->connect_hist_cached[2],
+                     info->connect_hist_cached[3], info->connect_hist_cached[4], info->connect_hist_cached[5],
+                     info->connect_hist_scan[0], info->connect_hist_scan[1], info->connect_hist_scan[2],
+                     info->connect_hist_scan[3], info->connect_hist_scan[4], info->connect_hist_scan[5]);
+            if (info->roam.count) {
+                ESP_LOGI(TAG, "Roams: %u (%u failed), last %lu ms, max %lu ms without link",
+                         info->roam.count, info->roam.failed, info->roam.last_gap_ms, info->roam.max_gap_ms);
+            }
             ESP_LOGI(TAG, "==================================");
             break;
             
+        case WIFI_STATUS_ROAMING:
+            ESP_LOGI(TAG, "WiFi: Roaming away from %s (RSSI: %d dBm)", info->ssid, info->rssi);
+            break;
+            
         case WIFI_STATUS_DISCONNECTED:
             ESP_LOGI(TAG, "WiFi: Disconnected");
             break;
@@ -256,13 +463,41 @@ void wifi_event_callback(wifi_status_t status, wifi_info_t *info)
     }
 }
 
+// Forward link quality hints to the host transcoder; dropped until ROS2 runs
+static void stream_hint_callback(const wifi_stream_hint_t *hint)
+{
+    ros2_stream_hint_msg_t msg = {};
+    msg.bitrate_kbps = hint->bitrate_kbps;
+    msg.width = hint->width;
+    msg.height = hint->height;
+    msg.link_quality = hint->quality;
+    ros2_manager_publish_stream_hint(&msg);
+}
+
+static void compare_link_profiles(wifi_link_profile_t final_profile)
+{
+    for (int i = 0; i < WIFI_LINK_PROFILE_COUNT; i++) {
+        wifi_link_profile_t profile = (wifi_link_profile_t)i;
+        if (wifi_manager_set_link_profile(profile) != ESP_OK) {
+            continue;
+        }
+        vTaskDelay(pdMS_TO_TICKS(500));
+        
+        wifi_rtt_stats_t stats;
+        if (wifi_manager_probe_rtt(NULL, WIFI_MANAGER_RTT_PROBE_COUNT, &stats) == ESP_OK) {
+            ESP_LOGI(TAG, "RTT %-12s: avg %lu ms, max %lu ms, %lu/%lu replies",
+                     wifi_manager_link_profile_to_string(profile), stats.avg_ms, stats.max_ms,
+                     stats.received, stats.sent);
+        }
+    }
+    
+    wifi_manager_set_link_profile(final_profile);
+}
+
 void wifi_test_task(void *pvParameters)
 {
     ESP_LOGI(TAG, "WiFi test task started");
     
-    // Wait for other systems to initialize
-    vTaskDelay(pdMS_TO_TICKS(3000));
-    
     // Initialize WiFi manager
     esp_err_t ret = wifi_manager_init();
     if (ret != ESP_OK) {
@@ -273,8 +508,9 @@ void wifi_test_task(void *pvParameters)
     
     ESP_LOGI(TAG, "WiFi manager initialized successfully");
     
-    // Set event callback
+    // Set event callbacks
     wifi_manager_set_callback(wifi_event_callback);
+    wifi_manager_set_stream_hint_callback(stream_hint_callback);
     
     // Configure target WiFi network
     wifi_manager_config_t config = {
@@ -282,7 +518,11 @@ void wifi_test_task(void *pvParameters)
         .password = "isolation-sphere",
         .max_retry = 5,
         .timeout_ms = 15000,  // 15 seconds timeout
-        .auto_reconnect = true
+        .auto_reconnect = true,
+        .fast_reconnect = true,
+        .use_static_ip = false,
+        .link_profile = WIFI_LINK_PROFILE_LOW_LATENCY,
+        .roaming = true
     };
     
     ESP_LOGI(TAG, "=== WiFi Connection Test ===");
@@ -291,43 +531,63 @@ void wifi_test_task(void *pvParameters)
     ESP_LOGI(TAG, "Timeout: %lu ms", config.timeout_ms);
     ESP_LOGI(TAG, "===========================");
     
-    // Attempt connection
+    // Associate in the background while the IMU and renderer come up
     ESP_LOGI(TAG, "Attempting to connect to WiFi...");
-    ret = wifi_manager_connect(&config);
+    ret = wifi_manager_connect_async(&config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "WiFi connection request failed: %s", esp_err_to_name(ret));
+        vTaskDelete(NULL);
+        return;
+    }
     
-    if (ret == ESP_OK) {
-        ESP_LOGI(TAG, "WiFi connection successful!");
+    wifi_manager_event_t event;
+    bool profiles_compared = false;
+    while (1) {
+        if (wifi_manager_get_event(&event, 10000) != ESP_OK) {
+            // No change for 10 seconds
+            wifi_info_t info;
+            if (wifi_manager_is_connected() && wifi_manager_get_info(&info) == ESP_OK) {
+                ESP_LOGI(TAG, "WiFi Status: Connected to %s (RSSI: %d dBm, link %u, IP: %s)", 
+                         info.ssid, info.rssi, info.link_quality, info.ip_addr);
+            }
+            image_stream_stats_t stream;
+            if (image_stream_get_stats(&stream) == ESP_OK && stream.datagrams) {
+                ESP_LOGI(TAG, "Image stream: %lu frames, %lu incomplete, %lu datagrams, %lu cycles/MB",
+                         stream.frames_committed, stream.reassembly.frames_incomplete,
+                         stream.datagrams, stream.cycles_per_mb);
+            }
+            continue;
+        }
         
-        // Monitor connection status
-        while (1) {
-            if (wifi_manager_is_connected()) {
-                wifi_info_t info;
-                if (wifi_manager_get_info(&info) == ESP_OK) {
-                    ESP_LOGI(TAG, "WiFi Status: Connected to %s (RSSI: %d dBm, IP: %s)", 
-                             info.ssid, info.rssi, info.ip_addr);
+        switch (event.status) {
+            case WIFI_STATUS_CONNECTED:
+                ESP_LOGI(TAG, "WiFi connected %lu ms after request, %lld ms after boot",
+                         event.elapsed_ms, esp_timer_get_time() / 1000);
+                
+                // Record the latency each link profile gives against the AP, once
+                if (!profiles_compared) {
+                    compare_link_profiles(config.link_profile);
+                    profiles_compared = true;
                 }
-            } else {
-                ESP_LOGW(TAG, "WiFi Status: Disconnected");
+                break;
+                
+            case WIFI_STATUS_FAILED:
+                ESP_LOGE(TAG, "WiFi connection failed, please check:");
+                ESP_LOGE(TAG, "1. WiFi SSID 'ros2_atom_ap' is available");
+                ESP_LOGE(TAG, "2. Password 'isolation-sphere' is correct");
+                ESP_LOGE(TAG, "3. WiFi signal strength is sufficient");
                 
-                // Attempt reconnection
+                // Try again later
+                vTaskDelay(pdMS_TO_TICKS(10000));
                 ESP_LOGI(TAG, "Attempting to reconnect...");
-                ret = wifi_manager_connect(&config);
+                ret = wifi_manager_connect_async(&config);
                 if (ret != ESP_OK) {
                     ESP_LOGE(TAG, "Reconnection failed: %s", esp_err_to_name(ret));
                 }
-            }
-            
-            vTaskDelay(pdMS_TO_TICKS(10000)); // Check every 10 seconds
+                break;
+                
+            default:
+                break;
         }
-        
-    } else {
-        ESP_LOGE(TAG, "WiFi connection failed: %s", esp_err_to_name(ret));
-        ESP_LOGE(TAG, "Please check:");
-        ESP_LOGE(TAG, "1. WiFi SSID 'ros2_atom_ap' is available");
-        ESP_LOGE(TAG, "2. Password 'isolation-sphere' is correct");
-        ESP_LOGE(TAG, "3. WiFi signal strength is sufficient");
     }
-    
-    // Task ends here if connection fails
-    vTaskDelete(NULL);
-}
\ No newline at end of file
+}
@@ -14,6 +14,8 @@
 #include "test_manager.hpp"
 #include "psram_test.hpp"
 #include "bno055_test.hpp"
+#include "kernel_benchmark_test.hpp"
+#include "memory_benchmark_test.hpp"
 // Temporarily disabled for build compatibility
 // #include "wifi_test.hpp"
 // #include "ros2_test.hpp"
@@ -26,6 +28,17 @@ static const char *TAG = "TestMain";
 #define SDA_GPIO    GPIO_NUM_2       // I2C SDA
 #define SCL_GPIO    GPIO_NUM_1       // I2C SCL
 
+// Test selection from the build (see main/CMakeLists.txt); empty runs all tests
+#ifndef TEST_NAME
+#define TEST_NAME   ""               // Name pattern
+#endif
+#ifndef TEST_TAGS
+#define TEST_TAGS   ""               // Tag expression
+#endif
+#ifndef TEST_SHARD
+#define TEST_SHARD  ""               // "N/M"
+#endif
+
 // Function declarations
 extern "C" {
     void init_gpio(void);
@@ -98,6 +111,8 @@ void test_execution_task(void *pvParameters)
     // Configure test manager
     test_manager.setStopOnFirstFailure(false);  // Continue even if tests fail
     test_manager.setTestTimeout(300000);        // 5 minutes per test
+    test_manager.setParallelExecution(true);    // Tests sharing I2C0 or WiFi still run one at a time
+    test_manager.setDeferredLogging(true);      // Test output is printed between runs, not while timing
     
     // Create and configure PSRAM test
     auto psram_test = std::make_unique<PSRAMTest>();
@@ -113,6 +128,10 @@ void test_execution_task(void *pvParameters)
     bno055_test->setQuaternionTolerance(0.1f);
     test_manager.addTest(std::unique_ptr<BaseTest>(std::move(bno055_test)));
     
+    // Render path kernel and memory placement benchmarks, run alone
+    test_manager.addTest(std::unique_ptr<BaseTest>(std::make_unique<KernelBenchmarkTest>()));
+    test_manager.addTest(std::unique_ptr<BaseTest>(std::make_unique<MemoryBenchmarkTest>()));
+    
     // WiFi and ROS2 tests temporarily disabled for ESP-IDF library compatibility issues
     ESP_LOGI(TAG, "WiFi and ROS2 tests disabled due to ESP-IDF library compatibility");
     ESP_LOGI(TAG, "Running PSRAM and BNO055 tests only");
@@ -132,8 +151,24 @@ void test_execution_task(void *pvParameters)
     
     ESP_LOGI(TAG, "Starting test execution...");
     
-    // Run all tests
-    test_manager.runAllTests();
+    // Run all tests, or this board's selection
+    if (strlen(TEST_NAME) == 0 && strlen(TEST_TAGS) == 0 && strlen(TEST_SHARD) == 0) {
+        test_manager.runAllTests();
+    } else {
+        TestFilter filter;
+        esp_err_t ret = filter.setNamePattern(TEST_NAME);
+        if (ret == ESP_OK) {
+            ret = filter.setTagExpression(TEST_TAGS);
+        }
+        if (ret == ESP_OK && strlen(TEST_SHARD) > 0) {
+            ret = filter.parse(std::string("shard=") + TEST_SHARD);
+        }
+        if (ret == ESP_OK) {
+            test_manager.runSelected(filter);
+        } else {
+            ESP_LOGE(TAG, "Invalid test selection, no tests run");
+        }
+    }
     
     // Display results
     test_manager.printTestResults();
@@ -151,8 +186,8 @@ void test_execution_task(void *pvParameters)
     ESP_LOGI(TAG, "Final Statistics:");
     ESP_LOGI(TAG, "  Success Rate: %.1f%% (%lu/%lu tests passed)", 
              stats.success_rate, stats.passed_tests, stats.total_tests);
-    ESP_LOGI(TAG, "  Total Execution Time: %.1f seconds", 
-             stats.total_duration_ms / 1000.0f);
+    ESP_LOGI(TAG, "  Total Execution Time: %.1f seconds (%.1f seconds of test time)", 
+             stats.elapsed_ms / 1000.0f, stats.total_duration_ms / 1000.0f);
     
     ESP_LOGI(TAG, "Test execution completed. Task will continue monitoring...");
     